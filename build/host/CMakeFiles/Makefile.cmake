@@ -0,0 +1,74 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "/root/repo/host/CMakeLists.txt"
+  "/usr/share/cmake-3.25/Modules/CMakeCInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFile.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "CMakeFiles/pid_bench.dir/DependInfo.cmake"
+  "CMakeFiles/turbo_plant.dir/DependInfo.cmake"
+  "CMakeFiles/autotune_sim.dir/DependInfo.cmake"
+  "CMakeFiles/telemetry_frame.dir/DependInfo.cmake"
+  "CMakeFiles/pico_boost_sim.dir/DependInfo.cmake"
+  "CMakeFiles/boost_sim.dir/DependInfo.cmake"
+  "CMakeFiles/closed_loop_bench.dir/DependInfo.cmake"
+  "CMakeFiles/boost_bench.dir/DependInfo.cmake"
+  "CMakeFiles/gain_sweep.dir/DependInfo.cmake"
+  "CMakeFiles/telemetry_host.dir/DependInfo.cmake"
+  "CMakeFiles/telemetry_recorder.dir/DependInfo.cmake"
+  "CMakeFiles/telemetry_pty_test.dir/DependInfo.cmake"
+  "CMakeFiles/console_pty_test.dir/DependInfo.cmake"
+  "CMakeFiles/options_commit_test.dir/DependInfo.cmake"
+  "CMakeFiles/eeprom_delta_test.dir/DependInfo.cmake"
+  "CMakeFiles/eeprom_crc_test.dir/DependInfo.cmake"
+  "CMakeFiles/options_schema_test.dir/DependInfo.cmake"
+  "CMakeFiles/eeprom_power_loss_test.dir/DependInfo.cmake"
+  "CMakeFiles/adc_filter_test.dir/DependInfo.cmake"
+  "CMakeFiles/eeprom_boot_test.dir/DependInfo.cmake"
+  "CMakeFiles/learner_sim.dir/DependInfo.cmake"
+  )
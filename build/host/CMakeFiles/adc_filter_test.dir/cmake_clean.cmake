@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/adc_filter_test.dir/adc_filter_test.cpp.o"
+  "CMakeFiles/adc_filter_test.dir/adc_filter_test.cpp.o.d"
+  "adc_filter_test"
+  "adc_filter_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/adc_filter_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
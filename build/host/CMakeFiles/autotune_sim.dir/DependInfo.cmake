@@ -0,0 +1,22 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/host/autotune_sim.cpp" "CMakeFiles/autotune_sim.dir/autotune_sim.cpp.o" "gcc" "CMakeFiles/autotune_sim.dir/autotune_sim.cpp.o.d"
+  "/root/repo/src/FixedPointPid.cpp" "CMakeFiles/autotune_sim.dir/root/repo/src/FixedPointPid.cpp.o" "gcc" "CMakeFiles/autotune_sim.dir/root/repo/src/FixedPointPid.cpp.o.d"
+  "/root/repo/src/RelayAutoTuner.cpp" "CMakeFiles/autotune_sim.dir/root/repo/src/RelayAutoTuner.cpp.o" "gcc" "CMakeFiles/autotune_sim.dir/root/repo/src/RelayAutoTuner.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/build/host/CMakeFiles/turbo_plant.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/autotune_sim.dir/autotune_sim.cpp.o"
+  "CMakeFiles/autotune_sim.dir/autotune_sim.cpp.o.d"
+  "CMakeFiles/autotune_sim.dir/root/repo/src/FixedPointPid.cpp.o"
+  "CMakeFiles/autotune_sim.dir/root/repo/src/FixedPointPid.cpp.o.d"
+  "CMakeFiles/autotune_sim.dir/root/repo/src/RelayAutoTuner.cpp.o"
+  "CMakeFiles/autotune_sim.dir/root/repo/src/RelayAutoTuner.cpp.o.d"
+  "autotune_sim"
+  "autotune_sim.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/autotune_sim.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
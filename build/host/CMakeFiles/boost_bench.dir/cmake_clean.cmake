@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/boost_bench.dir/boost_bench.cpp.o"
+  "CMakeFiles/boost_bench.dir/boost_bench.cpp.o.d"
+  "boost_bench"
+  "boost_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/boost_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,22 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/host/boost_sim.cpp" "CMakeFiles/boost_sim.dir/boost_sim.cpp.o" "gcc" "CMakeFiles/boost_sim.dir/boost_sim.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/build/host/CMakeFiles/pico_boost_sim.dir/DependInfo.cmake"
+  "/root/repo/build/host/CMakeFiles/turbo_plant.dir/DependInfo.cmake"
+  "/root/repo/build/host/CMakeFiles/telemetry_frame.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/boost_sim.dir/boost_sim.cpp.o"
+  "CMakeFiles/boost_sim.dir/boost_sim.cpp.o.d"
+  "boost_sim"
+  "boost_sim.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/boost_sim.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
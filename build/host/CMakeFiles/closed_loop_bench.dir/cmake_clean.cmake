@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/closed_loop_bench.dir/BoostBench.cpp.o"
+  "CMakeFiles/closed_loop_bench.dir/BoostBench.cpp.o.d"
+  "libclosed_loop_bench.a"
+  "libclosed_loop_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/closed_loop_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
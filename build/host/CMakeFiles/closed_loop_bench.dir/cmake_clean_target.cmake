@@ -0,0 +1,3 @@
+file(REMOVE_RECURSE
+  "libclosed_loop_bench.a"
+)
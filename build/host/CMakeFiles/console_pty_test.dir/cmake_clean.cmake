@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/console_pty_test.dir/console_pty_test.cpp.o"
+  "CMakeFiles/console_pty_test.dir/console_pty_test.cpp.o.d"
+  "console_pty_test"
+  "console_pty_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/console_pty_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/eeprom_boot_test.dir/eeprom_boot_test.cpp.o"
+  "CMakeFiles/eeprom_boot_test.dir/eeprom_boot_test.cpp.o.d"
+  "eeprom_boot_test"
+  "eeprom_boot_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/eeprom_boot_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
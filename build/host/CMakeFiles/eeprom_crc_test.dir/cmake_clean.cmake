@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/eeprom_crc_test.dir/eeprom_crc_test.cpp.o"
+  "CMakeFiles/eeprom_crc_test.dir/eeprom_crc_test.cpp.o.d"
+  "eeprom_crc_test"
+  "eeprom_crc_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/eeprom_crc_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/eeprom_delta_test.dir/eeprom_delta_test.cpp.o"
+  "CMakeFiles/eeprom_delta_test.dir/eeprom_delta_test.cpp.o.d"
+  "eeprom_delta_test"
+  "eeprom_delta_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/eeprom_delta_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
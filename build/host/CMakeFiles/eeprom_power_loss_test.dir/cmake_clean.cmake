@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/eeprom_power_loss_test.dir/eeprom_power_loss_test.cpp.o"
+  "CMakeFiles/eeprom_power_loss_test.dir/eeprom_power_loss_test.cpp.o.d"
+  "eeprom_power_loss_test"
+  "eeprom_power_loss_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/eeprom_power_loss_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,24 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/host/WorkStealingPool.cpp" "CMakeFiles/gain_sweep.dir/WorkStealingPool.cpp.o" "gcc" "CMakeFiles/gain_sweep.dir/WorkStealingPool.cpp.o.d"
+  "/root/repo/host/gain_sweep.cpp" "CMakeFiles/gain_sweep.dir/gain_sweep.cpp.o" "gcc" "CMakeFiles/gain_sweep.dir/gain_sweep.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/build/host/CMakeFiles/closed_loop_bench.dir/DependInfo.cmake"
+  "/root/repo/build/host/CMakeFiles/pico_boost_sim.dir/DependInfo.cmake"
+  "/root/repo/build/host/CMakeFiles/telemetry_frame.dir/DependInfo.cmake"
+  "/root/repo/build/host/CMakeFiles/turbo_plant.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/gain_sweep.dir/WorkStealingPool.cpp.o"
+  "CMakeFiles/gain_sweep.dir/WorkStealingPool.cpp.o.d"
+  "CMakeFiles/gain_sweep.dir/gain_sweep.cpp.o"
+  "CMakeFiles/gain_sweep.dir/gain_sweep.cpp.o.d"
+  "gain_sweep"
+  "gain_sweep.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/gain_sweep.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/learner_sim.dir/learner_sim.cpp.o"
+  "CMakeFiles/learner_sim.dir/learner_sim.cpp.o.d"
+  "learner_sim"
+  "learner_sim.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/learner_sim.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
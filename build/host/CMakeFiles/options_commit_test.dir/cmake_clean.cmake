@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/options_commit_test.dir/options_commit_test.cpp.o"
+  "CMakeFiles/options_commit_test.dir/options_commit_test.cpp.o.d"
+  "options_commit_test"
+  "options_commit_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/options_commit_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,45 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/host/SimHal.cpp" "CMakeFiles/pico_boost_sim.dir/SimHal.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/SimHal.cpp.o.d"
+  "/root/repo/src/AdcFilter.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/AdcFilter.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/AdcFilter.cpp.o.d"
+  "/root/repo/src/AdcReader.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/AdcReader.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/AdcReader.cpp.o.d"
+  "/root/repo/src/BiquadAdcFilter.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/BiquadAdcFilter.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/BiquadAdcFilter.cpp.o.d"
+  "/root/repo/src/BoostControl.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/BoostControl.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/BoostControl.cpp.o.d"
+  "/root/repo/src/BoostControlSnapshotBuffer.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/BoostControlSnapshotBuffer.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/BoostControlSnapshotBuffer.cpp.o.d"
+  "/root/repo/src/BoostOptions.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/BoostOptions.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/BoostOptions.cpp.o.d"
+  "/root/repo/src/BoschMap_0261230119.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/BoschMap_0261230119.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/BoschMap_0261230119.cpp.o.d"
+  "/root/repo/src/BoxcarAdcFilter.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/BoxcarAdcFilter.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/BoxcarAdcFilter.cpp.o.d"
+  "/root/repo/src/Eeprom.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/Eeprom.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/Eeprom.cpp.o.d"
+  "/root/repo/src/EepromCommitter.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/EepromCommitter.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/EepromCommitter.cpp.o.d"
+  "/root/repo/src/Eeprom_24CS256.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/Eeprom_24CS256.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/Eeprom_24CS256.cpp.o.d"
+  "/root/repo/src/EmaAdcFilter.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/EmaAdcFilter.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/EmaAdcFilter.cpp.o.d"
+  "/root/repo/src/FeedForwardMap.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/FeedForwardMap.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/FeedForwardMap.cpp.o.d"
+  "/root/repo/src/FixedPointPid.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/FixedPointPid.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/FixedPointPid.cpp.o.d"
+  "/root/repo/src/MedianAdcFilter.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/MedianAdcFilter.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/MedianAdcFilter.cpp.o.d"
+  "/root/repo/src/PicoAdcReader.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/PicoAdcReader.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/PicoAdcReader.cpp.o.d"
+  "/root/repo/src/PicoPwm.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/PicoPwm.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/PicoPwm.cpp.o.d"
+  "/root/repo/src/PicoSwitch.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/PicoSwitch.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/PicoSwitch.cpp.o.d"
+  "/root/repo/src/RelayAutoTuner.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/RelayAutoTuner.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/RelayAutoTuner.cpp.o.d"
+  "/root/repo/src/SerialConsole.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/SerialConsole.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/SerialConsole.cpp.o.d"
+  "/root/repo/src/TM1637_pico.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/TM1637_pico.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/TM1637_pico.cpp.o.d"
+  "/root/repo/src/TelemetryStream.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/TelemetryStream.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/TelemetryStream.cpp.o.d"
+  "/root/repo/src/TlvReader.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/TlvReader.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/TlvReader.cpp.o.d"
+  "/root/repo/src/TlvWriter.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/TlvWriter.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/TlvWriter.cpp.o.d"
+  "/root/repo/src/ZeroPointLearner.cpp" "CMakeFiles/pico_boost_sim.dir/root/repo/src/ZeroPointLearner.cpp.o" "gcc" "CMakeFiles/pico_boost_sim.dir/root/repo/src/ZeroPointLearner.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/build/host/CMakeFiles/telemetry_frame.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
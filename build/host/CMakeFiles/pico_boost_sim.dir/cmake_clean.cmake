@@ -0,0 +1,61 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/pico_boost_sim.dir/SimHal.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/SimHal.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/AdcFilter.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/AdcFilter.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/AdcReader.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/AdcReader.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/BiquadAdcFilter.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/BiquadAdcFilter.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/BoostControl.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/BoostControl.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/BoostControlSnapshotBuffer.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/BoostControlSnapshotBuffer.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/BoostOptions.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/BoostOptions.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/BoschMap_0261230119.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/BoschMap_0261230119.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/BoxcarAdcFilter.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/BoxcarAdcFilter.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/Eeprom.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/Eeprom.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/EepromCommitter.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/EepromCommitter.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/Eeprom_24CS256.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/Eeprom_24CS256.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/EmaAdcFilter.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/EmaAdcFilter.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/FeedForwardMap.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/FeedForwardMap.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/FixedPointPid.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/FixedPointPid.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/MedianAdcFilter.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/MedianAdcFilter.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/PicoAdcReader.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/PicoAdcReader.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/PicoPwm.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/PicoPwm.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/PicoSwitch.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/PicoSwitch.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/RelayAutoTuner.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/RelayAutoTuner.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/SerialConsole.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/SerialConsole.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/TM1637_pico.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/TM1637_pico.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/TelemetryStream.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/TelemetryStream.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/TlvReader.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/TlvReader.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/TlvWriter.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/TlvWriter.cpp.o.d"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/ZeroPointLearner.cpp.o"
+  "CMakeFiles/pico_boost_sim.dir/root/repo/src/ZeroPointLearner.cpp.o.d"
+  "libpico_boost_sim.a"
+  "libpico_boost_sim.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/pico_boost_sim.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
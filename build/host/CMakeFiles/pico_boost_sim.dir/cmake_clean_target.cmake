@@ -0,0 +1,3 @@
+file(REMOVE_RECURSE
+  "libpico_boost_sim.a"
+)
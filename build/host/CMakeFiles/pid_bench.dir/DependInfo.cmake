@@ -0,0 +1,20 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/host/pid_bench.cpp" "CMakeFiles/pid_bench.dir/pid_bench.cpp.o" "gcc" "CMakeFiles/pid_bench.dir/pid_bench.cpp.o.d"
+  "/root/repo/src/FixedPointPid.cpp" "CMakeFiles/pid_bench.dir/root/repo/src/FixedPointPid.cpp.o" "gcc" "CMakeFiles/pid_bench.dir/root/repo/src/FixedPointPid.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/pid_bench.dir/pid_bench.cpp.o"
+  "CMakeFiles/pid_bench.dir/pid_bench.cpp.o.d"
+  "CMakeFiles/pid_bench.dir/root/repo/src/FixedPointPid.cpp.o"
+  "CMakeFiles/pid_bench.dir/root/repo/src/FixedPointPid.cpp.o.d"
+  "pid_bench"
+  "pid_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/pid_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/Cobs.cpp" "CMakeFiles/telemetry_frame.dir/root/repo/src/Cobs.cpp.o" "gcc" "CMakeFiles/telemetry_frame.dir/root/repo/src/Cobs.cpp.o.d"
+  "/root/repo/src/Crc16.cpp" "CMakeFiles/telemetry_frame.dir/root/repo/src/Crc16.cpp.o" "gcc" "CMakeFiles/telemetry_frame.dir/root/repo/src/Crc16.cpp.o.d"
+  "/root/repo/src/TelemetryFrame.cpp" "CMakeFiles/telemetry_frame.dir/root/repo/src/TelemetryFrame.cpp.o" "gcc" "CMakeFiles/telemetry_frame.dir/root/repo/src/TelemetryFrame.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/telemetry_frame.dir/root/repo/src/Cobs.cpp.o"
+  "CMakeFiles/telemetry_frame.dir/root/repo/src/Cobs.cpp.o.d"
+  "CMakeFiles/telemetry_frame.dir/root/repo/src/Crc16.cpp.o"
+  "CMakeFiles/telemetry_frame.dir/root/repo/src/Crc16.cpp.o.d"
+  "CMakeFiles/telemetry_frame.dir/root/repo/src/TelemetryFrame.cpp.o"
+  "CMakeFiles/telemetry_frame.dir/root/repo/src/TelemetryFrame.cpp.o.d"
+  "libtelemetry_frame.a"
+  "libtelemetry_frame.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/telemetry_frame.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,3 @@
+file(REMOVE_RECURSE
+  "libtelemetry_frame.a"
+)
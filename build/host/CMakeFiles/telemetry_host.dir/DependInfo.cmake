@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/host/TelemetryDecoder.cpp" "CMakeFiles/telemetry_host.dir/TelemetryDecoder.cpp.o" "gcc" "CMakeFiles/telemetry_host.dir/TelemetryDecoder.cpp.o.d"
+  "/root/repo/host/TelemetryRecorder.cpp" "CMakeFiles/telemetry_host.dir/TelemetryRecorder.cpp.o" "gcc" "CMakeFiles/telemetry_host.dir/TelemetryRecorder.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/build/host/CMakeFiles/telemetry_frame.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
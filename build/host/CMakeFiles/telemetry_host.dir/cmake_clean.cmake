@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/telemetry_host.dir/TelemetryDecoder.cpp.o"
+  "CMakeFiles/telemetry_host.dir/TelemetryDecoder.cpp.o.d"
+  "CMakeFiles/telemetry_host.dir/TelemetryRecorder.cpp.o"
+  "CMakeFiles/telemetry_host.dir/TelemetryRecorder.cpp.o.d"
+  "libtelemetry_host.a"
+  "libtelemetry_host.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/telemetry_host.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/telemetry_pty_test.dir/telemetry_pty_test.cpp.o"
+  "CMakeFiles/telemetry_pty_test.dir/telemetry_pty_test.cpp.o.d"
+  "telemetry_pty_test"
+  "telemetry_pty_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/telemetry_pty_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/telemetry_recorder.dir/telemetry_recorder.cpp.o"
+  "CMakeFiles/telemetry_recorder.dir/telemetry_recorder.cpp.o.d"
+  "telemetry_recorder"
+  "telemetry_recorder.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/telemetry_recorder.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
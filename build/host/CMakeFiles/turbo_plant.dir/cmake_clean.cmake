@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/turbo_plant.dir/TurboPlant.cpp.o"
+  "CMakeFiles/turbo_plant.dir/TurboPlant.cpp.o.d"
+  "libturbo_plant.a"
+  "libturbo_plant.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/turbo_plant.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
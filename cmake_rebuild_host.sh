@@ -0,0 +1,13 @@
+#!/bin/bash
+
+# Full cmake rebuild of the host (Linux) tools and benchmarks.
+
+mkdir -p ./build/host
+
+cd ./build/host
+
+rm -rf *
+
+cmake -DCMAKE_BUILD_TYPE=Release ../../host/
+
+make
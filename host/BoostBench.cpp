@@ -0,0 +1,125 @@
+#include <cmath>
+
+#include "BoostBench.hpp"
+#include "BoostControl.hpp"
+#include "SimHal.hpp"
+
+/** Bosch 0261230119 transfer function constants. Match BoschMap_0261230119. */
+static const double boschMapC0 = 5.4 / 280.0;
+static const double boschMapC1 = 0.85 / 280.0;
+
+/** MAP sensor input divider ratio. Matches BoostControl. */
+static const double mapDividerRatio = 3.2 / (2.2 + 3.2);
+
+static const BoostBenchEvent tipInEvents[] = {{1.0, 1.0}};
+
+static const BoostBenchEvent partThenFullEvents[] = {{0.5, 0.5}, {3.0, 1.0}};
+
+static const BoostBenchEvent gearChangeEvents[] = {{0.5, 1.0}, {4.0, 0.0}, {4.4, 1.0}};
+
+static const BoostBenchEvent rollOnEvents[] = {{0.5, 0.3}, {1.5, 0.45}, {2.5, 0.6}, {3.5, 0.8}, {4.5, 1.0}};
+
+const BoostBenchScenario BoostBench::scenarios[] = {
+	{"tip-in", tipInEvents, 1, 8.0, 1.0},
+	{"part-full", partThenFullEvents, 2, 9.0, 3.0},
+	{"gear-change", gearChangeEvents, 3, 9.0, 4.4},
+	{"roll-on", rollOnEvents, 5, 10.0, 4.5}
+};
+
+const unsigned BoostBench::scenarioCount = sizeof(scenarios) / sizeof(scenarios[0]);
+
+BoostBench::~BoostBench()
+{
+}
+
+BoostBench::BoostBench(const TurboPlantConfig* plantConfig) : _plantConfig(*plantConfig)
+{
+}
+
+const TurboPlantConfig* BoostBench::getPlantConfig()
+{
+	return &_plantConfig;
+}
+
+void BoostBench::run(const BoostControlParameters* params, const BoostBenchScenario* scenario, BoostBenchResult* result)
+{
+	sim_hal_reset();
+
+	TurboPlant plant(&_plantConfig, BOOST_BENCH_STEP_US / 1000000.0);
+
+	plant.setThrottle(0);
+
+	// The Pico divides VSys by 3 before the ADC.
+	sim_adc_set_voltage(CONTROL_VSYS_ADC_INPUT, BOOST_BENCH_VSYS / 3.0);
+
+	BoostControl boostControl;
+
+	BoostControlParameters runParams = *params;
+	boostControl.setParameters(&runParams);
+
+	double targetKpa = params -> maxKpaScaled / 1000.0;
+
+	unsigned stepCount = scenario -> durationS * 1000000 / BOOST_BENCH_STEP_US;
+	unsigned nextEvent = 0;
+
+	double startKpa = 0;
+	double peakKpa = -1000;
+	double riseLowS = -1;
+	double riseHighS = -1;
+	double lastOutsideS = 0;
+	double iae = 0;
+	bool measuring = false;
+
+	for(unsigned step = 0; step < stepCount; step++)
+	{
+		double timeS = step * (BOOST_BENCH_STEP_US / 1000000.0);
+
+		while(nextEvent < scenario -> eventCount && scenario -> events[nextEvent].timeS <= timeS)
+		{
+			plant.setThrottle(scenario -> events[nextEvent].throttle);
+			nextEvent++;
+		}
+
+		double sensorKpa = plant.step(sim_pwm_get_duty(CONTROL_SOLENOID_CHAN_A_GPIO));
+
+		double mapSensorVolts = BOOST_BENCH_VSYS * (boschMapC0 + boschMapC1 * (sensorKpa + STD_ATM_PRESSURE / 1000.0));
+
+		sim_adc_set_voltage(CONTROL_MAP_ADC_INPUT, mapSensorVolts * mapDividerRatio);
+
+		boostControl.poll();
+
+		sim_advance_us(BOOST_BENCH_STEP_US);
+
+		// Measure the true boost, not what the noisy sensor saw.
+		double kpa = plant.getBoostKpa();
+
+		if(timeS < scenario -> measureFromS) continue;
+
+		double measureS = timeS - scenario -> measureFromS;
+
+		if(!measuring)
+		{
+			measuring = true;
+			startKpa = kpa;
+		}
+
+		double fraction = targetKpa > startKpa ? (kpa - startKpa) / (targetKpa - startKpa) : 1.0;
+
+		if(riseLowS < 0 && fraction >= 0.1) riseLowS = measureS;
+		if(riseHighS < 0 && fraction >= 0.9) riseHighS = measureS;
+
+		if(kpa > peakKpa) peakKpa = kpa;
+
+		if(fabs(kpa - targetKpa) > BOOST_BENCH_SETTLE_BAND_KPA) lastOutsideS = measureS + BOOST_BENCH_STEP_US / 1000000.0;
+
+		iae += fabs(targetKpa - kpa) * (BOOST_BENCH_STEP_US / 1000000.0);
+	}
+
+	double measureLengthS = scenario -> durationS - scenario -> measureFromS;
+
+	result -> riseTimeS = riseHighS >= 0 ? riseHighS - riseLowS : -1;
+	result -> overshootKpa = peakKpa > targetKpa ? peakKpa - targetKpa : 0;
+	result -> settleTimeS = lastOutsideS < measureLengthS - 0.001 ? lastOutsideS : -1;
+	result -> iaeKpaS = iae;
+	result -> finalKpa = plant.getBoostKpa();
+}
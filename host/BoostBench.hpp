@@ -0,0 +1,113 @@
+#ifndef BOOST_BENCH_H
+#define BOOST_BENCH_H
+
+#include <stdint.h>
+
+#include "BoostControlParameters.hpp"
+#include "TurboPlant.hpp"
+
+/** Simulation step, in microseconds. Matches CONTROL_LATCH_PERIOD_US. */
+#define BOOST_BENCH_STEP_US 1000
+
+/** VSys, in volts. */
+#define BOOST_BENCH_VSYS 5.0
+
+/** Boost within this of the target counts as settled. In kPa. */
+#define BOOST_BENCH_SETTLE_BAND_KPA 2.0
+
+/**
+ * A change of throttle at a point in a scenario.
+ */
+struct BoostBenchEvent
+{
+	/** Time of the change, from the start of the scenario. In seconds. */
+	double timeS;
+
+	/** Throttle from then on. 0 for closed to 1 for full throttle. */
+	double throttle;
+};
+
+/**
+ * A scripted sequence of throttle events.
+ */
+struct BoostBenchScenario
+{
+	/** Short name for reports. */
+	const char* name;
+
+	/** Throttle events, in time order. Throttle is closed before the first. */
+	const BoostBenchEvent* events;
+
+	/** Number of events. */
+	unsigned eventCount;
+
+	/** Length of the scenario. In seconds. */
+	double durationS;
+
+	/** Time from which the response is measured. Typically the last full throttle event. In seconds. */
+	double measureFromS;
+};
+
+/**
+ * Measured response of one run. All times are from the scenario measureFromS.
+ */
+struct BoostBenchResult
+{
+	/** Time from 10% to 90% of the way from the boost at the measure start to the target. In seconds. -1 if never. */
+	double riseTimeS;
+
+	/** Peak boost over the target. 0 if it never went over. In kPa. */
+	double overshootKpa;
+
+	/** Time after which boost stayed within BOOST_BENCH_SETTLE_BAND_KPA of target. In seconds. -1 if never. */
+	double settleTimeS;
+
+	/** Integral absolute error from the target. In kPa.s. */
+	double iaeKpaS;
+
+	/** Boost at the end of the scenario. In kPa. */
+	double finalKpa;
+};
+
+/**
+ * Closed loop benchmark of the boost control firmware against a simulated turbo.
+ * BoostControl runs, unmodified, on the simulated HAL. The plant drives the MAP sensor and VSys ADC inputs that
+ * BoschMap_0261230119 reads, and is driven by the duty the PicoPwm solenoid output is set to. Boost control is polled
+ * exactly as debug mode does on the Pico: latch every millisecond and control every 10.
+ * @note The simulated HAL is thread local, so runs on different threads are independent.
+ */
+class BoostBench
+{
+	public:
+
+		virtual ~BoostBench();
+
+		/**
+		 * @param plantConfig Plant to benchmark against. Copied.
+		 */
+		BoostBench(const TurboPlantConfig* plantConfig);
+
+		/**
+		 * Run a scenario with a controller configuration. Resets the simulated HAL of the calling thread first.
+		 * @param params Boost control parameters to run with.
+		 * @param scenario Scenario to run.
+		 * @param result Populate this with the measured response.
+		 */
+		void run(const BoostControlParameters* params, const BoostBenchScenario* scenario, BoostBenchResult* result);
+
+		/** Get the plant configuration. */
+		const TurboPlantConfig* getPlantConfig();
+
+		/** Standard scenarios. */
+		static const BoostBenchScenario scenarios[];
+
+		/** Number of standard scenarios. */
+		static const unsigned scenarioCount;
+
+	private:
+
+		/** Plant configuration. */
+		TurboPlantConfig _plantConfig;
+};
+
+#endif
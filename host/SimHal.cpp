@@ -0,0 +1,633 @@
+#include <string.h>
+#include <unistd.h>
+
+#include "HalAdc.hpp"
+#include "HalCrc.hpp"
+#include "HalGpio.hpp"
+#include "HalI2c.hpp"
+#include "HalPwm.hpp"
+#include "HalSerial.hpp"
+#include "HalSync.hpp"
+#include "HalTime.hpp"
+#include "SimHal.hpp"
+
+// Firmware globals normally defined by pico_boost.cpp.
+bool debug = false;
+bool debugMsgActive = false;
+
+/** Pull resistor of a simulated GPIO. */
+enum SimPull { SIM_PULL_NONE, SIM_PULL_UP, SIM_PULL_DOWN };
+
+/** State of a simulated GPIO. */
+struct SimGpio
+{
+	bool out;
+	bool level;
+	bool driven;
+	bool drivenLevel;
+	uint8_t pull;
+	uint8_t function;
+	uint8_t outover;
+};
+
+/** State of a simulated PWM slice. */
+struct SimPwmSlice
+{
+	uint16_t wrap;
+	uint16_t level[2];
+	bool enabled;
+};
+
+/** i2c bus instance. Only bus 0 exists. */
+struct hal_i2c_inst
+{
+	unsigned index;
+};
+
+/** All simulated hardware of one thread. */
+struct SimHalState
+{
+	uint64_t timeUs;
+
+	/** System clock cycles busy waited that haven't made up a whole microsecond yet. */
+	uint32_t cycleRemainder;
+
+	SimGpio gpios[SIM_GPIO_COUNT];
+
+	uint16_t adcRaw[SIM_ADC_INPUT_COUNT];
+
+	unsigned adcInput;
+
+	SimPwmSlice pwmSlices[SIM_PWM_SLICE_COUNT];
+
+	uint8_t eeprom[SIM_EEPROM_SIZE];
+
+	/** EEPROM address pointer. The next read starts here. */
+	unsigned eepromPointer;
+
+	/** Time at which the EEPROM write cycle in progress finishes. */
+	uint64_t eepromBusyUntilUs;
+
+	unsigned eepromWriteCount;
+
+	/** Time each EEPROM write cycle takes. */
+	unsigned eepromWriteCycleUs;
+
+	/** True if the EEPROM loses power once eepromPowerCutByteCount more bytes have been programmed. */
+	bool eepromPowerCutArmed;
+
+	unsigned eepromPowerCutByteCount;
+
+	/** True once the EEPROM has lost power. It doesn't respond until it is restored. */
+	bool eepromPoweredOff;
+
+	/** File descriptor the serial port sends to. -1 if detached. */
+	int serialFd;
+
+	bool serialConnected;
+
+	/** Bytes written by the firmware and not yet sent. */
+	uint8_t serialTxFifo[SIM_SERIAL_TX_FIFO_SIZE];
+
+	unsigned serialTxCount;
+
+	/** Time up to which the serial port has sent what it could. */
+	uint64_t serialSentUntilUs;
+
+	uint64_t serialSentCount;
+};
+
+static thread_local SimHalState simState;
+
+static thread_local bool simStateInitialised = false;
+
+static hal_i2c_inst simI2c0 = {0};
+
+/** Get the calling thread's state, resetting it on first use. */
+static SimHalState* __state()
+{
+	if(!simStateInitialised) sim_hal_reset();
+
+	return &simState;
+}
+
+/** Check a GPIO number, returning its state or 0 if it doesn't exist. */
+static SimGpio* __gpio(unsigned gpio)
+{
+	return gpio < SIM_GPIO_COUNT ? __state() -> gpios + gpio : 0;
+}
+
+/** Account for an i2c transfer of a number of bytes, plus the address byte. Returns false if it would time out. */
+static bool __i2cTransfer(size_t len, unsigned timeoutUs)
+{
+	uint64_t durationUs = (uint64_t)(len + 1) * SIM_I2C_BYTE_US;
+
+	if(durationUs > timeoutUs)
+	{
+		sim_advance_us(timeoutUs);
+		return false;
+	}
+
+	sim_advance_us(durationUs);
+
+	return true;
+}
+
+/** Send whatever the serial port could have sent since it last did, up to now. */
+static void __serialSend(SimHalState* state)
+{
+	uint64_t elapsedUs = state -> timeUs - state -> serialSentUntilUs;
+	uint64_t sendable = elapsedUs * SIM_SERIAL_BYTES_PER_MS / 1000;
+
+	if(sendable == 0) return;
+
+	// Only move on by the time the bytes took, so partial bytes carry over to the next send.
+	state -> serialSentUntilUs += sendable * 1000 / SIM_SERIAL_BYTES_PER_MS;
+
+	unsigned count = sendable < state -> serialTxCount ? (unsigned)sendable : state -> serialTxCount;
+
+	if(count == 0) return;
+
+	if(state -> serialFd >= 0)
+	{
+		ssize_t written = write(state -> serialFd, state -> serialTxFifo, count);
+
+		count = written > 0 ? written : 0;
+	}
+
+	state -> serialTxCount -= count;
+	state -> serialSentCount += count;
+
+	memmove(state -> serialTxFifo, state -> serialTxFifo + count, state -> serialTxCount);
+}
+
+void sim_hal_reset()
+{
+	simStateInitialised = true;
+
+	memset(&simState, 0, sizeof(simState));
+	memset(simState.eeprom, 0xFF, SIM_EEPROM_SIZE);
+
+	simState.eepromWriteCycleUs = SIM_EEPROM_WRITE_CYCLE_US;
+
+	simState.serialFd = -1;
+}
+
+void sim_advance_us(uint64_t us)
+{
+	SimHalState* state = __state();
+
+	state -> timeUs += us;
+
+	__serialSend(state);
+}
+
+void sim_gpio_drive(unsigned gpio, bool level)
+{
+	SimGpio* state = __gpio(gpio);
+
+	if(!state) return;
+
+	state -> driven = true;
+	state -> drivenLevel = level;
+}
+
+void sim_gpio_release(unsigned gpio)
+{
+	SimGpio* state = __gpio(gpio);
+
+	if(state) state -> driven = false;
+}
+
+bool sim_gpio_get_output(unsigned gpio)
+{
+	SimGpio* state = __gpio(gpio);
+
+	if(!state) return false;
+
+	if(state -> outover == HAL_GPIO_OVERRIDE_LOW) return false;
+	if(state -> outover == HAL_GPIO_OVERRIDE_HIGH) return true;
+
+	return state -> out && state -> level;
+}
+
+void sim_adc_set_raw(unsigned input, uint16_t raw)
+{
+	if(input < SIM_ADC_INPUT_COUNT) __state() -> adcRaw[input] = raw & 0xFFF;
+}
+
+void sim_adc_set_voltage(unsigned input, double volts)
+{
+	if(volts < 0) volts = 0;
+	if(volts > SIM_ADC_VREF) volts = SIM_ADC_VREF;
+
+	sim_adc_set_raw(input, (uint16_t)(volts / SIM_ADC_VREF * 4095.0 + 0.5));
+}
+
+double sim_pwm_get_duty(unsigned gpio)
+{
+	SimGpio* state = __gpio(gpio);
+
+	if(!state) return 0;
+
+	if(state -> outover == HAL_GPIO_OVERRIDE_LOW) return 0;
+	if(state -> outover == HAL_GPIO_OVERRIDE_HIGH) return 100.0;
+
+	if(state -> function != HAL_GPIO_FUNC_PWM) return 0;
+
+	SimPwmSlice* slice = __state() -> pwmSlices + hal_pwm_gpio_to_slice_num(gpio);
+
+	if(!slice -> enabled) return 0;
+
+	double duty = 100.0 * slice -> level[gpio & 1] / ((double)slice -> wrap + 1.0);
+
+	return duty > 100.0 ? 100.0 : duty;
+}
+
+uint8_t* sim_eeprom_get_memory()
+{
+	return __state() -> eeprom;
+}
+
+unsigned sim_eeprom_get_write_count()
+{
+	return __state() -> eepromWriteCount;
+}
+
+void sim_eeprom_set_write_cycle_us(unsigned us)
+{
+	__state() -> eepromWriteCycleUs = us;
+}
+
+void sim_eeprom_cut_power_after(unsigned byteCount)
+{
+	SimHalState* state = __state();
+
+	state -> eepromPowerCutArmed = true;
+	state -> eepromPowerCutByteCount = byteCount;
+}
+
+void sim_eeprom_restore_power()
+{
+	SimHalState* state = __state();
+
+	state -> eepromPowerCutArmed = false;
+	state -> eepromPoweredOff = false;
+
+	// Any write cycle in progress ended with the power.
+	state -> eepromBusyUntilUs = 0;
+}
+
+bool sim_eeprom_is_powered()
+{
+	return !__state() -> eepromPoweredOff;
+}
+
+void sim_serial_attach(int fd)
+{
+	SimHalState* state = __state();
+
+	state -> serialFd = fd;
+	state -> serialConnected = fd >= 0;
+}
+
+void sim_serial_set_connected(bool connected)
+{
+	__state() -> serialConnected = connected;
+}
+
+uint64_t sim_serial_get_sent_count()
+{
+	return __state() -> serialSentCount;
+}
+
+// HalTime.hpp
+
+uint32_t hal_time_us_32()
+{
+	return (uint32_t)__state() -> timeUs;
+}
+
+uint64_t hal_time_us_64()
+{
+	return __state() -> timeUs;
+}
+
+void hal_sleep_us(uint64_t us)
+{
+	sim_advance_us(us);
+}
+
+void hal_busy_wait_cycles(uint32_t cycles)
+{
+	SimHalState* state = __state();
+
+	uint64_t totalCycles = (uint64_t)state -> cycleRemainder + cycles;
+
+	state -> timeUs += totalCycles / (SIM_CLOCK_SYS_HZ / 1000000);
+	state -> cycleRemainder = totalCycles % (SIM_CLOCK_SYS_HZ / 1000000);
+}
+
+uint32_t hal_clock_sys_hz()
+{
+	return SIM_CLOCK_SYS_HZ;
+}
+
+// HalGpio.hpp
+
+void hal_gpio_init(unsigned gpio)
+{
+	SimGpio* state = __gpio(gpio);
+
+	if(!state) return;
+
+	state -> out = false;
+	state -> level = false;
+	state -> function = 0;
+	state -> outover = HAL_GPIO_OVERRIDE_NORMAL;
+}
+
+void hal_gpio_deinit(unsigned gpio)
+{
+	hal_gpio_init(gpio);
+}
+
+void hal_gpio_set_dir(unsigned gpio, bool out)
+{
+	SimGpio* state = __gpio(gpio);
+
+	if(state) state -> out = out;
+}
+
+void hal_gpio_put(unsigned gpio, bool value)
+{
+	SimGpio* state = __gpio(gpio);
+
+	if(state) state -> level = value;
+}
+
+bool hal_gpio_get(unsigned gpio)
+{
+	SimGpio* state = __gpio(gpio);
+
+	if(!state) return false;
+
+	if(state -> out) return sim_gpio_get_output(gpio);
+
+	if(state -> driven) return state -> drivenLevel;
+
+	return state -> pull == SIM_PULL_UP;
+}
+
+void hal_gpio_pull_up(unsigned gpio)
+{
+	SimGpio* state = __gpio(gpio);
+
+	if(state) state -> pull = SIM_PULL_UP;
+}
+
+void hal_gpio_pull_down(unsigned gpio)
+{
+	SimGpio* state = __gpio(gpio);
+
+	if(state) state -> pull = SIM_PULL_DOWN;
+}
+
+void hal_gpio_set_function(unsigned gpio, unsigned function)
+{
+	SimGpio* state = __gpio(gpio);
+
+	if(state) state -> function = function;
+}
+
+void hal_gpio_set_outover(unsigned gpio, unsigned value)
+{
+	SimGpio* state = __gpio(gpio);
+
+	if(state) state -> outover = value;
+}
+
+// HalAdc.hpp
+
+void hal_adc_init()
+{
+}
+
+void hal_adc_gpio_init(unsigned gpio)
+{
+	hal_gpio_init(gpio);
+}
+
+void hal_adc_select_input(unsigned input)
+{
+	if(input < SIM_ADC_INPUT_COUNT) __state() -> adcInput = input;
+}
+
+uint16_t hal_adc_read()
+{
+	SimHalState* state = __state();
+
+	return state -> adcRaw[state -> adcInput];
+}
+
+// HalPwm.hpp
+
+unsigned hal_pwm_gpio_to_slice_num(unsigned gpio)
+{
+	return (gpio >> 1) & (SIM_PWM_SLICE_COUNT - 1);
+}
+
+void hal_pwm_set_phase_correct(unsigned, bool)
+{
+}
+
+void hal_pwm_set_wrap(unsigned slice, uint16_t wrap)
+{
+	if(slice < SIM_PWM_SLICE_COUNT) __state() -> pwmSlices[slice].wrap = wrap;
+}
+
+void hal_pwm_set_clkdiv_int_frac4(unsigned, uint8_t, uint8_t)
+{
+}
+
+void hal_pwm_set_chan_level(unsigned slice, unsigned chan, uint16_t level)
+{
+	if(slice < SIM_PWM_SLICE_COUNT && chan < 2) __state() -> pwmSlices[slice].level[chan] = level;
+}
+
+void hal_pwm_set_enabled(unsigned slice, bool enabled)
+{
+	if(slice < SIM_PWM_SLICE_COUNT) __state() -> pwmSlices[slice].enabled = enabled;
+}
+
+// HalI2c.hpp
+
+hal_i2c_inst_t* hal_i2c0()
+{
+	return &simI2c0;
+}
+
+int hal_i2c_write_timeout_us(hal_i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop,
+	unsigned timeoutUs)
+{
+	SimHalState* state = __state();
+
+	// Only the address byte goes out if nothing acknowledges it.
+	if(i2c != &simI2c0 || addr != SIM_EEPROM_I2C_ADDR || state -> timeUs < state -> eepromBusyUntilUs ||
+		state -> eepromPoweredOff)
+	{
+		__i2cTransfer(0, timeoutUs);
+		return HAL_I2C_ERROR_GENERIC;
+	}
+
+	if(!__i2cTransfer(len, timeoutUs)) return HAL_I2C_ERROR_TIMEOUT;
+
+	// The first two bytes are the word address, high byte first. Only 15 bits are used.
+	if(len < 2) return len;
+
+	unsigned pointer = ((src[0] & 0x7F) << 8) | src[1];
+
+	if(len > 2)
+	{
+		// Data wraps within the write page rather than crossing into the next.
+		unsigned pageStart = pointer & ~(SIM_EEPROM_WRITE_PAGE_SIZE - 1);
+
+		for(size_t index = 2; index < len; index++)
+		{
+			if(state -> eepromPowerCutArmed && state -> eepromPowerCutByteCount-- == 0)
+			{
+				// The rest of the write never reaches the memory.
+				state -> eepromPowerCutArmed = false;
+				state -> eepromPoweredOff = true;
+
+				return HAL_I2C_ERROR_GENERIC;
+			}
+
+			state -> eeprom[pageStart | (pointer & (SIM_EEPROM_WRITE_PAGE_SIZE - 1))] = src[index];
+			pointer = pageStart | ((pointer + 1) & (SIM_EEPROM_WRITE_PAGE_SIZE - 1));
+		}
+
+		// The write cycle starts on the stop condition.
+		if(!nostop)
+		{
+			state -> eepromBusyUntilUs = state -> timeUs + state -> eepromWriteCycleUs;
+			state -> eepromWriteCount++;
+		}
+	}
+
+	state -> eepromPointer = pointer;
+
+	return len;
+}
+
+int hal_i2c_read_timeout_us(hal_i2c_inst_t* i2c, uint8_t addr, uint8_t* dst, size_t len, bool,
+	unsigned timeoutUs)
+{
+	SimHalState* state = __state();
+
+	if(i2c != &simI2c0 || addr != SIM_EEPROM_I2C_ADDR || state -> timeUs < state -> eepromBusyUntilUs ||
+		state -> eepromPoweredOff)
+	{
+		__i2cTransfer(0, timeoutUs);
+		return HAL_I2C_ERROR_GENERIC;
+	}
+
+	if(!__i2cTransfer(len, timeoutUs)) return HAL_I2C_ERROR_TIMEOUT;
+
+	// Sequential reads roll over at the end of the memory.
+	for(size_t index = 0; index < len; index++)
+	{
+		dst[index] = state -> eeprom[state -> eepromPointer];
+		state -> eepromPointer = (state -> eepromPointer + 1) % SIM_EEPROM_SIZE;
+	}
+
+	return len;
+}
+
+// HalSerial.hpp
+
+bool hal_serial_connected()
+{
+	return __state() -> serialConnected;
+}
+
+unsigned hal_serial_write_available()
+{
+	SimHalState* state = __state();
+
+	__serialSend(state);
+
+	return SIM_SERIAL_TX_FIFO_SIZE - state -> serialTxCount;
+}
+
+unsigned hal_serial_write(const uint8_t* data, unsigned len)
+{
+	unsigned available = hal_serial_write_available();
+
+	if(len > available) len = available;
+
+	SimHalState* state = __state();
+
+	memcpy(state -> serialTxFifo + state -> serialTxCount, data, len);
+	state -> serialTxCount += len;
+
+	return len;
+}
+
+void hal_serial_flush()
+{
+}
+
+unsigned hal_serial_read(uint8_t* data, unsigned maxLen)
+{
+	SimHalState* state = __state();
+
+	if(state -> serialFd < 0 || maxLen == 0) return 0;
+
+	ssize_t len = read(state -> serialFd, data, maxLen);
+
+	return len > 0 ? len : 0;
+}
+
+// HalSync.hpp
+
+uint32_t hal_save_and_disable_interrupts()
+{
+	return 0;
+}
+
+void hal_restore_interrupts(uint32_t)
+{
+}
+
+// HalCrc.hpp
+
+/** CRC-32 lookup table, for the reflected polynomial. */
+struct SimCrc32Table
+{
+	uint32_t entries[256];
+
+	SimCrc32Table()
+	{
+		for(uint32_t index = 0; index < 256; index++)
+		{
+			uint32_t crc = index;
+
+			for(unsigned bit = 0; bit < 8; bit++) crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+
+			entries[index] = crc;
+		}
+	}
+};
+
+uint32_t hal_crc32(const uint8_t* data, unsigned len)
+{
+	// Built the first time. Shared by all threads, which is safe as it is never changed after.
+	static const SimCrc32Table table;
+
+	uint32_t crc = 0xFFFFFFFF;
+
+	for(unsigned index = 0; index < len; index++) crc = table.entries[(crc ^ data[index]) & 0xFF] ^ (crc >> 8);
+
+	return ~crc;
+}
@@ -0,0 +1,121 @@
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+#include <stdint.h>
+
+// Simulated back end of the HAL (HalTime.hpp, HalGpio.hpp, HalAdc.hpp, HalPwm.hpp, HalI2c.hpp, HalSerial.hpp, HalSync.hpp
+// and HalCrc.hpp) for host builds.
+// These are the functions a host program uses to drive the simulated hardware and inspect what the firmware did to it.
+// All simulated state is thread local, so each thread runs its own independent instance of the hardware.
+// Time is virtual. It only moves when the firmware sleeps or busy waits, when i2c bytes are transferred, or when it is
+// advanced by the host program.
+
+/** Simulated system clock frequency, in hz. */
+#define SIM_CLOCK_SYS_HZ 125000000
+
+/** Number of GPIOs. */
+#define SIM_GPIO_COUNT 30
+
+/** Number of ADC inputs. */
+#define SIM_ADC_INPUT_COUNT 5
+
+/** ADC reference voltage. */
+#define SIM_ADC_VREF 3.0
+
+/** Number of PWM slices. */
+#define SIM_PWM_SLICE_COUNT 8
+
+/** Time to transfer one byte on the i2c bus, including the ACK, in microseconds. ie 400 kbit/s, as pico_boost uses. */
+#define SIM_I2C_BYTE_US 23
+
+/** 7 bit i2c address of the simulated 24CS256 EEPROM on bus 0. */
+#define SIM_EEPROM_I2C_ADDR 0x50
+
+/** Size of the simulated 24CS256 EEPROM, in bytes. */
+#define SIM_EEPROM_SIZE 32768
+
+/** Write page size of the simulated 24CS256 EEPROM, in bytes. Writes wrap within a page. */
+#define SIM_EEPROM_WRITE_PAGE_SIZE 64
+
+/**
+ * Default write cycle time of the simulated 24CS256 EEPROM, in microseconds. It doesn't ACK while busy.
+ * The 5 ms datasheet maximum (Twc). Real parts usually finish sooner. See sim_eeprom_set_write_cycle_us().
+ */
+#define SIM_EEPROM_WRITE_CYCLE_US 5000
+
+/** Size of the simulated USB serial transmit FIFO, in bytes. Matches the TinyUSB CDC default on the Pico. */
+#define SIM_SERIAL_TX_FIFO_SIZE 256
+
+/** Bytes the simulated USB serial port sends per millisecond of virtual time. One full speed bulk packet per frame. */
+#define SIM_SERIAL_BYTES_PER_MS 64
+
+/** Reset all simulated hardware, and time, of the calling thread to power on state. The EEPROM is erased to 0xFF. */
+void sim_hal_reset();
+
+/** Advance virtual time. */
+void sim_advance_us(uint64_t us);
+
+/**
+ * Drive a GPIO input from outside. eg A switch.
+ * @param gpio GPIO to drive.
+ * @param level Level to drive it to.
+ */
+void sim_gpio_drive(unsigned gpio, bool level);
+
+/** Stop driving a GPIO from outside. It then reads as its pull up/down, or low if there is none. */
+void sim_gpio_release(unsigned gpio);
+
+/** Get the level the firmware is outputting on a GPIO. Takes output overrides into account, but not PWM. */
+bool sim_gpio_get_output(unsigned gpio);
+
+/** Set the raw 12 bit value an ADC input converts to. */
+void sim_adc_set_raw(unsigned input, uint16_t raw);
+
+/** Set the voltage on an ADC input. Clamped between 0 and SIM_ADC_VREF. */
+void sim_adc_set_voltage(unsigned input, double volts);
+
+/**
+ * Get the duty cycle a GPIO is being driven at by its PWM slice, in %.
+ * Takes output overrides into account. 0 if the slice is disabled, or the GPIO is not a PWM output.
+ */
+double sim_pwm_get_duty(unsigned gpio);
+
+/** Get the contents of the simulated EEPROM. SIM_EEPROM_SIZE bytes. Can be modified. eg To inject corruption. */
+uint8_t* sim_eeprom_get_memory();
+
+/** Get the number of page writes the simulated EEPROM has done since reset. */
+unsigned sim_eeprom_get_write_count();
+
+/** Set the write cycle time of the simulated EEPROM, in microseconds. eg 5000 for the datasheet worst case. */
+void sim_eeprom_set_write_cycle_us(unsigned us);
+
+/**
+ * Cut the power to the simulated EEPROM once it has programmed a number more bytes, as if the ignition was switched off
+ * part way through a write. Bytes are programmed in the order they are sent. The rest are lost, and it doesn't respond
+ * until sim_eeprom_restore_power().
+ * @param byteCount Number of bytes still programmed. 0 to lose the next one.
+ */
+void sim_eeprom_cut_power_after(unsigned byteCount);
+
+/** Restore power to the simulated EEPROM. A power cut that hasn't happened yet is cancelled. */
+void sim_eeprom_restore_power();
+
+/** Get whether the simulated EEPROM has power. ie A power cut hasn't happened. */
+bool sim_eeprom_is_powered();
+
+/**
+ * Attach the simulated USB serial port to a file descriptor, and connect it. eg The master side of a pseudo-terminal.
+ * Bytes the firmware reads are read from it, without waiting. Bytes the firmware writes are written to it as virtual
+ * time passes. If it won't take them (it should be non blocking)
+ * they back up in the transmit FIFO, the same as a host that isn't reading.
+ * @param fd File descriptor. -1 to detach, after which sent bytes are discarded.
+ */
+void sim_serial_attach(int fd);
+
+/** Connect or disconnect the simulated USB serial port. ie A host opening or closing it. */
+void sim_serial_set_connected(bool connected);
+
+/** Get the number of bytes the simulated USB serial port has sent since reset. */
+uint64_t sim_serial_get_sent_count();
+
+#endif
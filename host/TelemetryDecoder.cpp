@@ -0,0 +1,93 @@
+#include <string.h>
+
+#include "TelemetryDecoder.hpp"
+
+TelemetryDecoder::~TelemetryDecoder()
+{
+}
+
+TelemetryDecoder::TelemetryDecoder()
+{
+}
+
+void TelemetryDecoder::push(const uint8_t* data, unsigned len)
+{
+	for(unsigned index = 0; index < len; index++)
+	{
+		if(data[index] == 0)
+		{
+			// Frames start with a delimiter as well as ending with one, so empty frames are normal.
+			if(_overflow) _badFrameCount++;
+			else if(_encodedLen) __decodeFrame();
+
+			_encodedLen = 0;
+			_overflow = false;
+		}
+		else if(_encodedLen < sizeof(_encoded))
+		{
+			_encoded[_encodedLen++] = data[index];
+		}
+		else
+		{
+			_overflow = true;
+		}
+	}
+}
+
+uint64_t TelemetryDecoder::getFrameCount()
+{
+	return _frameCount;
+}
+
+uint64_t TelemetryDecoder::getBadFrameCount()
+{
+	return _badFrameCount;
+}
+
+uint64_t TelemetryDecoder::getMissingRecordCount()
+{
+	return _missingRecordCount;
+}
+
+void TelemetryDecoder::__decodeFrame()
+{
+	uint8_t type;
+	uint8_t payload[TELEMETRY_FRAME_MAX_PAYLOAD];
+
+	int len = TelemetryFrame::decode(_encoded, _encodedLen, &type, payload);
+
+	if(len < 0)
+	{
+		_badFrameCount++;
+		return;
+	}
+
+	if(type == TELEMETRY_FRAME_RECORD && len == sizeof(BoostTelemetryRecord))
+	{
+		BoostTelemetryRecord record;
+		memcpy(&record, payload, sizeof(record));
+
+		if(_haveSequence) _missingRecordCount += (uint16_t)(record.sequence - _nextSequence);
+
+		_haveSequence = true;
+		_nextSequence = record.sequence + 1;
+
+		_frameCount++;
+
+		if(onRecord) onRecord(&record);
+	}
+	else if(type == TELEMETRY_FRAME_COUNTERS && len == sizeof(TelemetryCounters))
+	{
+		TelemetryCounters counters;
+		memcpy(&counters, payload, sizeof(counters));
+
+		_frameCount++;
+
+		if(onCounters) onCounters(&counters);
+	}
+	else
+	{
+		// A valid frame of a type, or size, from a newer firmware.
+		_badFrameCount++;
+	}
+}
@@ -0,0 +1,69 @@
+#ifndef TELEMETRY_DECODER_H
+#define TELEMETRY_DECODER_H
+
+#include <functional>
+#include <stdint.h>
+
+#include "TelemetryFrame.hpp"
+
+/**
+ * Decodes a telemetry byte stream from the Pico serial port (see TelemetryFrame) into records and counters.
+ * Bytes can be pushed in pieces of any size. Text, partial frames and corruption are skipped, and counted, and decoding
+ * picks up again at the next frame delimiter.
+ */
+class TelemetryDecoder
+{
+	public:
+
+		virtual ~TelemetryDecoder();
+
+		TelemetryDecoder();
+
+		/** Called for each record decoded. */
+		std::function<void(const BoostTelemetryRecord*)> onRecord;
+
+		/** Called for each counters frame decoded. */
+		std::function<void(const TelemetryCounters*)> onCounters;
+
+		/**
+		 * Decode more of the stream.
+		 * @param data Bytes read from the serial port.
+		 * @param len Number of bytes.
+		 */
+		void push(const uint8_t* data, unsigned len);
+
+		/** Get the number of valid frames decoded. */
+		uint64_t getFrameCount();
+
+		/** Get the number of frames that were invalid, failed their CRC or were too long. eg printf text. */
+		uint64_t getBadFrameCount();
+
+		/** Get the number of records missing from sequence gaps. Includes records the decimation skipped. */
+		uint64_t getMissingRecordCount();
+
+	private:
+
+		/** Encoded bytes of the frame being received. */
+		uint8_t _encoded[TELEMETRY_FRAME_MAX_ENCODED];
+
+		/** Number of bytes in _encoded. */
+		unsigned _encodedLen = 0;
+
+		/** Whether the frame being received has overflowed _encoded. */
+		bool _overflow = false;
+
+		uint64_t _frameCount = 0;
+		uint64_t _badFrameCount = 0;
+		uint64_t _missingRecordCount = 0;
+
+		/** Whether a record has been decoded yet, and so _nextSequence is valid. */
+		bool _haveSequence = false;
+
+		/** Sequence number the next record should have. */
+		uint16_t _nextSequence = 0;
+
+		/** Decode the frame received, now that its delimiter has been seen. */
+		void __decodeFrame();
+};
+
+#endif
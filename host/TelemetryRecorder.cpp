@@ -0,0 +1,303 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "TelemetryRecorder.hpp"
+
+const TelemetryColumn TelemetryRecorder::columns[] = {
+	{"time_us", TELEMETRY_COLUMN_U32, offsetof(BoostTelemetryRecord, timeUs), 1},
+	{"sequence", TELEMETRY_COLUMN_U16, offsetof(BoostTelemetryRecord, sequence), 1},
+	{"flags", TELEMETRY_COLUMN_U16, offsetof(BoostTelemetryRecord, flags), 1},
+	{"map_raw", TELEMETRY_COLUMN_U16, offsetof(BoostTelemetryRecord, mapRaw), 1},
+	{"vsys_raw", TELEMETRY_COLUMN_U16, offsetof(BoostTelemetryRecord, vsysRaw), 1},
+	{"kpa", TELEMETRY_COLUMN_I32, offsetof(BoostTelemetryRecord, kpaScaled), 0.001},
+	{"error_kpa", TELEMETRY_COLUMN_I32, offsetof(BoostTelemetryRecord, errorKpaScaled), 0.001},
+	{"p_term", TELEMETRY_COLUMN_I16, offsetof(BoostTelemetryRecord, propTermScaled), 0.1},
+	{"i_term", TELEMETRY_COLUMN_I16, offsetof(BoostTelemetryRecord, integTermScaled), 0.1},
+	{"d_term", TELEMETRY_COLUMN_I16, offsetof(BoostTelemetryRecord, derivTermScaled), 0.1},
+	{"duty", TELEMETRY_COLUMN_U16, offsetof(BoostTelemetryRecord, dutyScaled), 0.1}
+};
+
+const unsigned TelemetryRecorder::columnCount = sizeof(columns) / sizeof(columns[0]);
+
+TelemetryRecorder::~TelemetryRecorder()
+{
+	close();
+
+	delete[] _columnData;
+}
+
+TelemetryRecorder::TelemetryRecorder()
+{
+	_columnData = new std::vector<uint8_t>[columnCount];
+}
+
+bool TelemetryRecorder::open(const char* path, unsigned format)
+{
+	close();
+
+	_file = fopen(path, "wb");
+
+	if(!_file) return false;
+
+	_format = format;
+	_rowCount = 0;
+	_error = false;
+	_groupRows = 0;
+	_groupOffsets.clear();
+	_groupRowCounts.clear();
+
+	if(_format == TELEMETRY_RECORDER_COLUMNAR)
+	{
+		uint32_t version = TELEMETRY_COLUMNAR_VERSION;
+
+		__write(TELEMETRY_COLUMNAR_MAGIC, 4);
+		__write(&version, sizeof(version));
+	}
+	else
+	{
+		for(unsigned index = 0; index < columnCount; index++)
+		{
+			fprintf(_file, index ? ",%s" : "%s", columns[index].name);
+		}
+
+		fprintf(_file, "\n");
+	}
+
+	return !_error;
+}
+
+void TelemetryRecorder::write(const BoostTelemetryRecord* record)
+{
+	if(!_file) return;
+
+	_rowCount++;
+
+	if(_format != TELEMETRY_RECORDER_COLUMNAR)
+	{
+		__writeCsv(record);
+		return;
+	}
+
+	const uint8_t* fields = (const uint8_t*)record;
+
+	for(unsigned index = 0; index < columnCount; index++)
+	{
+		const uint8_t* field = fields + columns[index].offset;
+
+		_columnData[index].insert(_columnData[index].end(), field, field + __typeSize(columns[index].type));
+	}
+
+	if(++_groupRows >= TELEMETRY_COLUMNAR_ROW_GROUP_ROWS) __flushRowGroup();
+}
+
+bool TelemetryRecorder::close()
+{
+	if(!_file) return !_error;
+
+	if(_format == TELEMETRY_RECORDER_COLUMNAR)
+	{
+		__flushRowGroup();
+		__writeFooter();
+	}
+
+	if(fclose(_file) != 0) _error = true;
+
+	_file = 0;
+
+	return !_error;
+}
+
+uint64_t TelemetryRecorder::getRowCount()
+{
+	return _rowCount;
+}
+
+void TelemetryRecorder::__writeCsv(const BoostTelemetryRecord* record)
+{
+	const uint8_t* fields = (const uint8_t*)record;
+
+	for(unsigned index = 0; index < columnCount; index++)
+	{
+		const TelemetryColumn* column = &columns[index];
+		const uint8_t* field = fields + column -> offset;
+
+		int64_t value;
+
+		switch(column -> type)
+		{
+			case TELEMETRY_COLUMN_U16: value = *(const uint16_t*)field; break;
+			case TELEMETRY_COLUMN_I16: value = *(const int16_t*)field; break;
+			case TELEMETRY_COLUMN_U32: value = *(const uint32_t*)field; break;
+			default: value = *(const int32_t*)field; break;
+		}
+
+		if(index) fputc(',', _file);
+
+		// Only as many decimal places as the scale gives.
+		if(column -> scale == 1) fprintf(_file, "%lld", (long long)value);
+		else if(column -> scale == 0.1) fprintf(_file, "%.1f", value * column -> scale);
+		else fprintf(_file, "%.3f", value * column -> scale);
+	}
+
+	if(fputc('\n', _file) == EOF) _error = true;
+}
+
+void TelemetryRecorder::__flushRowGroup()
+{
+	if(_groupRows == 0) return;
+
+	_groupOffsets.push_back(ftell(_file));
+	_groupRowCounts.push_back(_groupRows);
+
+	for(unsigned index = 0; index < columnCount; index++)
+	{
+		__write(_columnData[index].data(), _columnData[index].size());
+
+		_columnData[index].clear();
+	}
+
+	_groupRows = 0;
+}
+
+void TelemetryRecorder::__writeFooter()
+{
+	long footerStart = ftell(_file);
+
+	uint32_t count = columnCount;
+	__write(&count, sizeof(count));
+
+	for(unsigned index = 0; index < columnCount; index++)
+	{
+		uint8_t nameLen = strlen(columns[index].name);
+
+		__write(&nameLen, 1);
+		__write(columns[index].name, nameLen);
+		__write(&columns[index].type, 1);
+		__write(&columns[index].scale, sizeof(double));
+	}
+
+	count = _groupOffsets.size();
+	__write(&count, sizeof(count));
+
+	for(unsigned index = 0; index < _groupOffsets.size(); index++)
+	{
+		__write(&_groupOffsets[index], sizeof(uint64_t));
+		__write(&_groupRowCounts[index], sizeof(uint32_t));
+	}
+
+	uint32_t footerLen = ftell(_file) - footerStart;
+
+	__write(&footerLen, sizeof(footerLen));
+	__write(TELEMETRY_COLUMNAR_MAGIC, 4);
+}
+
+void TelemetryRecorder::__write(const void* data, size_t len)
+{
+	if(len && fwrite(data, 1, len, _file) != len) _error = true;
+}
+
+unsigned TelemetryRecorder::__typeSize(uint8_t type)
+{
+	return type == TELEMETRY_COLUMN_U32 || type == TELEMETRY_COLUMN_I32 ? 4 : 2;
+}
+
+bool TelemetryRecorder::readColumnar(const char* path, std::vector<BoostTelemetryRecord>& records)
+{
+	FILE* file = fopen(path, "rb");
+
+	if(!file) return false;
+
+	std::vector<uint8_t> data;
+	uint8_t buffer[4096];
+	size_t readLen;
+
+	while((readLen = fread(buffer, 1, sizeof(buffer), file)) > 0) data.insert(data.end(), buffer, buffer + readLen);
+
+	fclose(file);
+
+	// Header, then footer length and magic at the end.
+	if(data.size() < 16 || memcmp(data.data(), TELEMETRY_COLUMNAR_MAGIC, 4) != 0 ||
+		memcmp(data.data() + data.size() - 4, TELEMETRY_COLUMNAR_MAGIC, 4) != 0) return false;
+
+	uint32_t footerLen;
+	memcpy(&footerLen, data.data() + data.size() - 8, 4);
+
+	if(footerLen > data.size() - 16) return false;
+
+	const uint8_t* posn = data.data() + data.size() - 8 - footerLen;
+	const uint8_t* end = data.data() + data.size() - 8;
+
+	// Map the file columns onto the record fields by name, so files with columns in a different order still read.
+	uint32_t fileColumnCount;
+
+	if(end - posn < 4) return false;
+	memcpy(&fileColumnCount, posn, 4);
+	posn += 4;
+
+	std::vector<int> fieldIndex(fileColumnCount, -1);
+	std::vector<unsigned> fileTypeSize(fileColumnCount);
+
+	for(unsigned column = 0; column < fileColumnCount; column++)
+	{
+		if(end - posn < 1) return false;
+
+		unsigned nameLen = *posn++;
+
+		if((unsigned)(end - posn) < nameLen + 1 + sizeof(double)) return false;
+
+		for(unsigned index = 0; index < columnCount; index++)
+		{
+			if(strlen(columns[index].name) == nameLen && memcmp(columns[index].name, posn, nameLen) == 0 &&
+				columns[index].type == posn[nameLen]) fieldIndex[column] = index;
+		}
+
+		fileTypeSize[column] = __typeSize(posn[nameLen]);
+
+		posn += nameLen + 1 + sizeof(double);
+	}
+
+	uint32_t groupCount;
+
+	if(end - posn < 4) return false;
+	memcpy(&groupCount, posn, 4);
+	posn += 4;
+
+	if((uint64_t)(end - posn) < (uint64_t)groupCount * 12) return false;
+
+	for(unsigned group = 0; group < groupCount; group++)
+	{
+		uint64_t offset;
+		uint32_t rows;
+
+		memcpy(&offset, posn, 8);
+		memcpy(&rows, posn + 8, 4);
+		posn += 12;
+
+		size_t first = records.size();
+		records.resize(first + rows);
+
+		memset(&records[first], 0, rows * sizeof(BoostTelemetryRecord));
+
+		for(unsigned column = 0; column < fileColumnCount; column++)
+		{
+			uint64_t columnLen = (uint64_t)rows * fileTypeSize[column];
+
+			if(offset + columnLen > data.size()) return false;
+
+			if(fieldIndex[column] >= 0)
+			{
+				const TelemetryColumn* field = &columns[fieldIndex[column]];
+
+				for(uint32_t row = 0; row < rows; row++)
+				{
+					memcpy((uint8_t*)&records[first + row] + field -> offset,
+						data.data() + offset + row * fileTypeSize[column], fileTypeSize[column]);
+				}
+			}
+
+			offset += columnLen;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,152 @@
+#ifndef TELEMETRY_RECORDER_H
+#define TELEMETRY_RECORDER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+#include "BoostTelemetry.hpp"
+
+/** Magic at the start and end of a columnar telemetry file. */
+#define TELEMETRY_COLUMNAR_MAGIC "PBTC"
+
+/** Version of the columnar telemetry file format. */
+#define TELEMETRY_COLUMNAR_VERSION 1
+
+/** Rows in each row group of a columnar telemetry file. */
+#define TELEMETRY_COLUMNAR_ROW_GROUP_ROWS 4096
+
+/** Telemetry recorder output formats. */
+enum TelemetryRecorderFormat
+{
+	/** Comma separated text, with a header row. Values are in engineering units. eg kPa rather than kPa scaled by 1000. */
+	TELEMETRY_RECORDER_CSV,
+
+	/**
+	 * Binary columnar file, laid out like Parquet. Each row group holds the values of each column in turn, stored as they
+	 * are in the record. A footer at the end holds the schema (name, type and scale to engineering units of each column)
+	 * and the offset and row count of each row group, followed by the footer length and the magic.
+	 * All values are little endian.
+	 *
+	 * "PBTC" version:u32
+	 * row groups: column 0 values, column 1 values, ...
+	 * footer: columnCount:u32 {nameLen:u8 name type:u8 scale:f64}... rowGroupCount:u32 {offset:u64 rows:u32}...
+	 * footerLen:u32 "PBTC"
+	 */
+	TELEMETRY_RECORDER_COLUMNAR
+};
+
+/** Value types of a telemetry column. */
+enum TelemetryColumnType
+{
+	TELEMETRY_COLUMN_U16,
+	TELEMETRY_COLUMN_I16,
+	TELEMETRY_COLUMN_U32,
+	TELEMETRY_COLUMN_I32
+};
+
+/** A field of BoostTelemetryRecord, as a column. */
+struct TelemetryColumn
+{
+	/** Column name. */
+	const char* name;
+
+	/** One of TelemetryColumnType. */
+	uint8_t type;
+
+	/** Offset of the field in BoostTelemetryRecord. */
+	unsigned offset;
+
+	/** Multiply the stored value by this to get engineering units. */
+	double scale;
+};
+
+/**
+ * Records decoded telemetry to a CSV or columnar file.
+ */
+class TelemetryRecorder
+{
+	public:
+
+		/** Closes the file if it is still open. */
+		virtual ~TelemetryRecorder();
+
+		TelemetryRecorder();
+
+		/**
+		 * Create the output file.
+		 * @param path File to create.
+		 * @param format One of TelemetryRecorderFormat.
+		 * @returns False if the file couldn't be created.
+		 */
+		bool open(const char* path, unsigned format);
+
+		/** Write a record. */
+		void write(const BoostTelemetryRecord* record);
+
+		/**
+		 * Finish and close the file.
+		 * @returns False if anything failed to write.
+		 */
+		bool close();
+
+		/** Get the number of records written. */
+		uint64_t getRowCount();
+
+		/**
+		 * Read all records back from a columnar file.
+		 * @param path File to read.
+		 * @param records Records are appended to this.
+		 * @returns False if the file is not a valid columnar telemetry file.
+		 */
+		static bool readColumnar(const char* path, std::vector<BoostTelemetryRecord>& records);
+
+		/** The columns, in file order. */
+		static const TelemetryColumn columns[];
+
+		/** Number of columns. */
+		static const unsigned columnCount;
+
+	private:
+
+		/** Output file. 0 if not open. */
+		FILE* _file = 0;
+
+		/** One of TelemetryRecorderFormat. */
+		unsigned _format = TELEMETRY_RECORDER_CSV;
+
+		/** Number of records written. */
+		uint64_t _rowCount = 0;
+
+		/** Whether a write has failed. */
+		bool _error = false;
+
+		/** Columnar values of the row group being built, per column. */
+		std::vector<uint8_t>* _columnData = 0;
+
+		/** Rows in the row group being built. */
+		uint32_t _groupRows = 0;
+
+		/** File offset of each row group written. */
+		std::vector<uint64_t> _groupOffsets;
+
+		/** Row count of each row group written. */
+		std::vector<uint32_t> _groupRowCounts;
+
+		/** Write a record as a CSV row. */
+		void __writeCsv(const BoostTelemetryRecord* record);
+
+		/** Write the row group being built, if it has any rows. */
+		void __flushRowGroup();
+
+		/** Write the columnar footer. */
+		void __writeFooter();
+
+		/** Write bytes, noting any failure. */
+		void __write(const void* data, size_t len);
+
+		/** Get the size of a value of a column type, in bytes. */
+		static unsigned __typeSize(uint8_t type);
+};
+
+#endif
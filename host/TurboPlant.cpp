@@ -0,0 +1,102 @@
+#include "TurboPlant.hpp"
+
+TurboPlant::~TurboPlant()
+{
+	delete[] _dutyHistory;
+}
+
+TurboPlant::TurboPlant(const TurboPlantConfig* config, double stepS) : _config(*config), _stepS(stepS)
+{
+	_dutyHistoryLen = (unsigned)(_config.deadTimeS / _stepS + 0.5);
+	if(_dutyHistoryLen == 0) _dutyHistoryLen = 1;
+
+	_dutyHistory = new double[_dutyHistoryLen];
+
+	reset();
+}
+
+void TurboPlant::reset()
+{
+	for(unsigned index = 0; index < _dutyHistoryLen; index++) _dutyHistory[index] = 0;
+
+	_dutyHistoryPosn = 0;
+	_boostKpa = 0;
+	_spoolKpa = 0;
+	_throttle = 1;
+	_noiseState = 12345;
+}
+
+void TurboPlant::setThrottle(double throttle)
+{
+	if(throttle < 0) throttle = 0;
+	if(throttle > 1) throttle = 1;
+
+	_throttle = throttle;
+}
+
+double TurboPlant::step(double dutyPercent)
+{
+	if(dutyPercent < 0) dutyPercent = 0;
+	if(dutyPercent > 100) dutyPercent = 100;
+
+	// The oldest duty in the history is the one that is acting now.
+	double delayedDuty = _dutyHistory[_dutyHistoryPosn];
+
+	_dutyHistory[_dutyHistoryPosn] = dutyPercent;
+	_dutyHistoryPosn = (_dutyHistoryPosn + 1) % _dutyHistoryLen;
+
+	// The turbo spools up slowly, but the boost it can make drops away as soon as the throttle closes.
+	double throttleKpa = _config.closedThrottleKpa + (_config.maxKpa - _config.closedThrottleKpa) * _throttle;
+
+	double spoolTimeConstantS = throttleKpa > _spoolKpa ? _config.spoolTimeConstantS : _config.timeConstantS;
+
+	_spoolKpa += (throttleKpa - _spoolKpa) * _stepS / (spoolTimeConstantS + _stepS);
+
+	// Most boost the wastegate allows. The solenoid bleeding actuator pressure holds the wastegate shut for longer.
+	double wastegateKpa = _config.springKpa / (1.0 - _config.solenoidFlow * delayedDuty / 100.0);
+
+	double settleKpa = _spoolKpa < wastegateKpa ? _spoolKpa : wastegateKpa;
+
+	_boostKpa += (settleKpa - _boostKpa) * _stepS / (_config.timeConstantS + _stepS);
+
+	// Simple LCG noise.
+	_noiseState = _noiseState * 1664525 + 1013904223;
+	double noise = ((double)(_noiseState >> 8) / (double)(1 << 23) - 1.0) * _config.noiseKpa;
+
+	return _boostKpa + noise;
+}
+
+double TurboPlant::getBoostKpa()
+{
+	return _boostKpa;
+}
+
+double TurboPlant::calcHoldDuty(double boostKpa)
+{
+	// Inverse of the wastegate limit.
+	double duty = 100.0 * (1.0 - _config.springKpa / boostKpa) / _config.solenoidFlow;
+
+	if(boostKpa <= 0 || duty < 0) return 0;
+	if(duty > 100) return 100;
+
+	return duty;
+}
+
+double TurboPlant::calcGain(double boostKpa)
+{
+	// Derivative of springKpa / (1 - solenoidFlow * duty / 100) with respect to duty.
+	return boostKpa * boostKpa * _config.solenoidFlow / (100.0 * _config.springKpa);
+}
+
+void TurboPlant::populateDefaultConfig(TurboPlantConfig* config)
+{
+	// Roughly a small turbo with 0.5 bar of spring and about 1.8 bar at 100% duty.
+	config -> springKpa = 50;
+	config -> maxKpa = 200;
+	config -> closedThrottleKpa = -60;
+	config -> solenoidFlow = 0.72;
+	config -> spoolTimeConstantS = 0.8;
+	config -> timeConstantS = 0.35;
+	config -> deadTimeS = 0.05;
+	config -> noiseKpa = 0.5;
+}
@@ -0,0 +1,119 @@
+#ifndef TURBO_PLANT_H
+#define TURBO_PLANT_H
+
+#include <stdint.h>
+
+/**
+ * Configuration of a simulated turbo and wastegate.
+ */
+struct TurboPlantConfig
+{
+	/** Boost with the solenoid de-energised. ie Wastegate spring pressure. In kPa. */
+	double springKpa;
+
+	/** Most boost the turbo can make, at full throttle with the wastegate shut. In kPa. */
+	double maxKpa;
+
+	/** Manifold pressure with the throttle closed. Relative to std atm, so negative. In kPa. */
+	double closedThrottleKpa;
+
+	/**
+	 * Fraction of the boost pressure the solenoid bleeds off the wastegate actuator at 100% duty. 0 to 1.
+	 * The wastegate opens when the actuator pressure reaches the spring pressure, so this sets the most boost the
+	 * wastegate allows: springKpa / (1 - solenoidFlow * duty).
+	 */
+	double solenoidFlow;
+
+	/** Time constant of the turbo spooling up towards what the throttle allows. In seconds. */
+	double spoolTimeConstantS;
+
+	/** Time constant of the boost response to a change in duty, once spooled. In seconds. */
+	double timeConstantS;
+
+	/** Dead time between a change in duty and the boost starting to respond. In seconds. */
+	double deadTimeS;
+
+	/** Peak MAP sensor noise. In kPa. */
+	double noiseKpa;
+};
+
+/**
+ * Simulated turbo and wastegate, as seen through the boost control solenoid and MAP sensor.
+ * Two lags. The turbo spools, with spoolTimeConstantS, towards the boost the throttle allows. The boost follows that,
+ * with timeConstantS, but is capped by the wastegate. The cap is set by the solenoid duty, after the dead time, bleeding
+ * pressure off the wastegate actuator. So once spooled and on the wastegate this is first order plus dead time.
+ */
+class TurboPlant
+{
+	public:
+
+		virtual ~TurboPlant();
+
+		/**
+		 * @param config Plant configuration. Copied.
+		 * @param stepS Simulation step. In seconds.
+		 */
+		TurboPlant(const TurboPlantConfig* config, double stepS);
+
+		/** Reset to no boost, spooled down, at full throttle. */
+		void reset();
+
+		/**
+		 * Set the throttle.
+		 * @param throttle 0 for closed to 1 for full throttle.
+		 */
+		void setThrottle(double throttle);
+
+		/**
+		 * Advance the simulation by one step.
+		 * @param dutyPercent Solenoid duty cycle. In %.
+		 * @returns The boost, relative to std atm, as the MAP sensor would read it. In kPa.
+		 */
+		double step(double dutyPercent);
+
+		/** Get the boost without sensor noise. In kPa. */
+		double getBoostKpa();
+
+		/**
+		 * Get the duty that holds a given boost at full throttle, once settled. In %.
+		 * Clamped between 0 and 100 if the boost is out of the range of the wastegate.
+		 */
+		double calcHoldDuty(double boostKpa);
+
+		/** Get the settled change in boost per % duty, at full throttle, about a given boost. In kPa/%. */
+		double calcGain(double boostKpa);
+
+		/** Get the standard first order plus dead time config used by the host tools. */
+		static void populateDefaultConfig(TurboPlantConfig* config);
+
+	private:
+
+		/** Plant configuration. */
+		TurboPlantConfig _config;
+
+		/** Simulation step. In seconds. */
+		double _stepS;
+
+		/** Duty cycle history for the dead time. */
+		double* _dutyHistory;
+
+		/** Number of entries in the duty cycle history. */
+		unsigned _dutyHistoryLen;
+
+		/** Next write position in the duty cycle history. */
+		unsigned _dutyHistoryPosn = 0;
+
+		/** Current boost. In kPa. */
+		double _boostKpa = 0;
+
+		/** Boost the turbo could currently make with the wastegate shut. In kPa. */
+		double _spoolKpa = 0;
+
+		/** Throttle. 0 to 1. */
+		double _throttle = 1;
+
+		/** Noise generator state. */
+		uint32_t _noiseState = 12345;
+};
+
+#endif
@@ -0,0 +1,96 @@
+#include <thread>
+#include <vector>
+
+#include "WorkStealingPool.hpp"
+
+WorkStealingPool::~WorkStealingPool()
+{
+	delete[] _workers;
+}
+
+WorkStealingPool::WorkStealingPool(unsigned threadCount) : _stealCount(0)
+{
+	if(threadCount == 0) threadCount = std::thread::hardware_concurrency();
+	if(threadCount == 0) threadCount = 1;
+
+	_threadCount = threadCount;
+
+	_workers = new Worker[_threadCount];
+}
+
+void WorkStealingPool::run(unsigned taskCount, const std::function<void(unsigned)>& task)
+{
+	// Deal out contiguous blocks, so neighbouring tasks (which tend to cost about the same) start on the same worker.
+	for(unsigned workerIndex = 0; workerIndex < _threadCount; workerIndex++)
+	{
+		unsigned first = (unsigned)((uint64_t)taskCount * workerIndex / _threadCount);
+		unsigned last = (unsigned)((uint64_t)taskCount * (workerIndex + 1) / _threadCount);
+
+		// Popped from the back, so push in reverse to run each block in order.
+		for(unsigned taskIndex = last; taskIndex > first; taskIndex--) _workers[workerIndex].tasks.push_back(taskIndex - 1);
+	}
+
+	std::vector<std::thread> threads;
+
+	for(unsigned workerIndex = 1; workerIndex < _threadCount; workerIndex++)
+		threads.emplace_back(&WorkStealingPool::__work, this, workerIndex, &task);
+
+	// The calling thread is worker 0.
+	__work(0, &task);
+
+	for(std::thread& thread : threads) thread.join();
+}
+
+unsigned WorkStealingPool::getThreadCount()
+{
+	return _threadCount;
+}
+
+unsigned WorkStealingPool::getStealCount()
+{
+	return _stealCount;
+}
+
+bool WorkStealingPool::__pop(unsigned workerIndex, unsigned* task)
+{
+	Worker* worker = &_workers[workerIndex];
+
+	std::lock_guard<std::mutex> guard(worker -> lock);
+
+	if(worker -> tasks.empty()) return false;
+
+	*task = worker -> tasks.back();
+	worker -> tasks.pop_back();
+
+	return true;
+}
+
+bool WorkStealingPool::__steal(unsigned thiefIndex, unsigned* task)
+{
+	for(unsigned offset = 1; offset < _threadCount; offset++)
+	{
+		Worker* victim = &_workers[(thiefIndex + offset) % _threadCount];
+
+		std::lock_guard<std::mutex> guard(victim -> lock);
+
+		if(victim -> tasks.empty()) continue;
+
+		// Take from the opposite end to the owner, which is the work it would get to last.
+		*task = victim -> tasks.front();
+		victim -> tasks.pop_front();
+
+		_stealCount++;
+
+		return true;
+	}
+
+	return false;
+}
+
+void WorkStealingPool::__work(unsigned workerIndex, const std::function<void(unsigned)>* task)
+{
+	unsigned taskIndex;
+
+	// No task adds more tasks, so once every queue is empty there is nothing left to do.
+	while(__pop(workerIndex, &taskIndex) || __steal(workerIndex, &taskIndex)) (*task)(taskIndex);
+}
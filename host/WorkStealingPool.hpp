@@ -0,0 +1,83 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+
+/**
+ * Thread pool that runs a batch of independent, numbered tasks across all host cores.
+ * Tasks are dealt out in contiguous blocks, one per worker. Each worker takes tasks from the back of its own queue and,
+ * once that is empty, steals from the front of the others. So workers that draw cheap tasks help out the ones that drew
+ * expensive ones, and a worker rarely contends on a lock other than its own.
+ * @note This is for the host tools only.
+ */
+class WorkStealingPool
+{
+	public:
+
+		virtual ~WorkStealingPool();
+
+		/**
+		 * @param threadCount Number of worker threads. 0 for one per host core.
+		 */
+		WorkStealingPool(unsigned threadCount);
+
+		/**
+		 * Run a batch of tasks and wait for all of them to finish.
+		 * @param taskCount Number of tasks. They are numbered from 0.
+		 * @param task Called once per task number, from any worker thread.
+		 */
+		void run(unsigned taskCount, const std::function<void(unsigned)>& task);
+
+		/** Get the number of worker threads. */
+		unsigned getThreadCount();
+
+		/** Get the number of tasks that were stolen by another worker, over all runs. */
+		unsigned getStealCount();
+
+	private:
+
+		/** Task queue of one worker. */
+		struct Worker
+		{
+			std::mutex lock;
+			std::deque<unsigned> tasks;
+		};
+
+		/** Number of worker threads. */
+		unsigned _threadCount;
+
+		/** Worker task queues. One per thread. */
+		Worker* _workers;
+
+		/** Number of tasks stolen. */
+		std::atomic<unsigned> _stealCount;
+
+		/**
+		 * Take the next task from the back of a worker's own queue.
+		 * @param workerIndex Worker to take the task for.
+		 * @param task Set to the task number.
+		 * @returns True if there was a task.
+		 */
+		bool __pop(unsigned workerIndex, unsigned* task);
+
+		/**
+		 * Steal a task from the front of another worker's queue.
+		 * @param thiefIndex Worker that is stealing. Its own queue is not checked.
+		 * @param task Set to the task number.
+		 * @returns True if a task was stolen. False if all other queues are empty.
+		 */
+		bool __steal(unsigned thiefIndex, unsigned* task);
+
+		/**
+		 * Worker thread body. Runs tasks until there are none left to take or steal.
+		 * @param workerIndex Index of this worker.
+		 * @param task Task function.
+		 */
+		void __work(unsigned workerIndex, const std::function<void(unsigned)>* task);
+};
+
+#endif
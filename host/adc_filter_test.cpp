@@ -0,0 +1,219 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "BiquadAdcFilter.hpp"
+#include "EmaAdcFilter.hpp"
+#include "MedianAdcFilter.hpp"
+
+// Test of the ADC filters AdcReader can be given. Each is pushed steps, and noise, in raw ADC units and its output
+// compared, sample by sample, with the same filter calculated in double precision. The biquad's DC gain must be exactly 1,
+// so a steady value comes out unchanged, and the median must reject single sample spikes.
+
+/** Number of values pushed before and after each step. */
+#define TEST_STEP_LENGTH 2000
+
+/** Level before the step, in raw ADC units. */
+#define TEST_LOW 1000
+
+/** Level after the step, in raw ADC units. Full scale. */
+#define TEST_HIGH 4095
+
+/** Most an EMA output may differ from the double precision one, in raw ADC units. It is truncated. */
+#define TEST_EMA_MAX_ERROR 1
+
+/** Most a biquad output may differ from the double precision one, in raw ADC units. */
+#define TEST_BIQUAD_MAX_ERROR 1
+
+/** Rate values are pushed at by the biquad tests, in hz. The latch rate. */
+#define TEST_SAMPLE_RATE_HZ 1000.0
+
+static uint32_t randomState = 12345;
+
+/** Simple LCG. */
+static uint32_t random(uint32_t range)
+{
+	randomState = randomState * 1664525 + 1013904223;
+
+	return (randomState >> 8) % range;
+}
+
+/** Get the value pushed at a sample of the test. A step up, then back down. */
+static uint32_t stepValue(unsigned sample)
+{
+	return sample >= TEST_STEP_LENGTH && sample < TEST_STEP_LENGTH * 2 ? TEST_HIGH : TEST_LOW;
+}
+
+static bool checkEma(unsigned shift)
+{
+	EmaAdcFilter filter(shift);
+
+	double average = 0;
+	double maxError = 0;
+
+	bool ok = true;
+
+	for(unsigned sample = 0; sample < TEST_STEP_LENGTH * 3; sample++)
+	{
+		uint32_t value = stepValue(sample);
+
+		filter.push(value);
+
+		average = sample == 0 ? value : average + (value - average) / (1 << shift);
+
+		double error = fabs(filter.output() - average);
+
+		if(error > maxError) maxError = error;
+
+		// Settled on each level exactly, not just near it.
+		if(sample % TEST_STEP_LENGTH == TEST_STEP_LENGTH - 1 && filter.output() != value) ok = false;
+	}
+
+	printf("EMA shift %u: max error %.3f\n", shift, maxError);
+
+	return ok && maxError <= TEST_EMA_MAX_ERROR;
+}
+
+static bool checkMedian(unsigned length)
+{
+	MedianAdcFilter filter(length);
+
+	uint32_t window[MEDIAN_ADC_FILTER_MAX_LENGTH] = {0};
+
+	bool ok = true;
+
+	// Few distinct values, so there are plenty of equal ones in the window.
+	for(unsigned sample = 0; ok && sample < TEST_STEP_LENGTH; sample++)
+	{
+		uint32_t value = random(8) * 500;
+
+		filter.push(value);
+
+		window[sample % length] = value;
+
+		// Median of a sorted copy.
+		uint32_t sorted[MEDIAN_ADC_FILTER_MAX_LENGTH];
+
+		for(unsigned index = 0; index < length; index++)
+		{
+			unsigned posn = index;
+
+			while(posn > 0 && sorted[posn - 1] > window[index])
+			{
+				sorted[posn] = sorted[posn - 1];
+				posn--;
+			}
+
+			sorted[posn] = window[index];
+		}
+
+		if(filter.output() != sorted[length / 2]) ok = false;
+	}
+
+	// A spike every few values, of no more than half the window, never gets through. Needs a window of at least 3.
+	for(unsigned sample = 0; ok && length >= 3 && sample < TEST_STEP_LENGTH; sample++)
+	{
+		filter.push(sample % length == 0 ? TEST_HIGH : TEST_LOW);
+
+		if(sample >= length && filter.output() != TEST_LOW) ok = false;
+	}
+
+	printf("Median length %u: %s\n", length, ok ? "matches" : "doesn't match");
+
+	return ok;
+}
+
+static bool checkBiquad(double cutoffHz)
+{
+	BiquadAdcFilter* filter = BiquadAdcFilter::createLowPass(cutoffHz, TEST_SAMPLE_RATE_HZ);
+
+	// Same RBJ cookbook coefficients, unrounded.
+	double w0 = 2.0 * M_PI * cutoffHz / TEST_SAMPLE_RATE_HZ;
+	double alpha = sin(w0) / (2.0 * M_SQRT1_2);
+	double a0 = 1.0 + alpha;
+
+	double b0 = (1.0 - cos(w0)) / 2.0 / a0;
+	double b1 = (1.0 - cos(w0)) / a0;
+	double a1 = -2.0 * cos(w0) / a0;
+	double a2 = (1.0 - alpha) / a0;
+
+	double x1 = TEST_LOW, x2 = TEST_LOW, y1 = TEST_LOW, y2 = TEST_LOW;
+	double maxError = 0;
+
+	bool ok = true;
+
+	for(unsigned sample = 0; sample < TEST_STEP_LENGTH * 3; sample++)
+	{
+		uint32_t value = stepValue(sample);
+
+		filter -> push(value);
+
+		double y = b0 * value + b1 * x1 + b0 * x2 - a1 * y1 - a2 * y2;
+
+		x2 = x1;
+		x1 = value;
+		y2 = y1;
+		y1 = y;
+
+		double error = fabs(filter -> output() - y);
+
+		if(error > maxError) maxError = error;
+
+		// DC gain of exactly 1. A steady value, once settled, comes out unchanged.
+		if(sample % TEST_STEP_LENGTH == TEST_STEP_LENGTH - 1 && filter -> output() != value) ok = false;
+	}
+
+	// Impulse response. The double precision one decays to nothing, so the fixed point one must settle back on the level.
+	filter -> push(TEST_HIGH);
+
+	for(unsigned sample = 0; sample < TEST_STEP_LENGTH; sample++) filter -> push(TEST_LOW);
+
+	if(filter -> output() != TEST_LOW) ok = false;
+
+	printf("Biquad %.0f hz: max error %.3f, settled on %u\n", cutoffHz, maxError, (unsigned)filter -> output());
+
+	delete filter;
+
+	return ok && maxError <= TEST_BIQUAD_MAX_ERROR;
+}
+
+int main()
+{
+	bool ok = true;
+
+	const unsigned emaShifts[] = {1, 3, 6};
+
+	for(unsigned shift : emaShifts)
+	{
+		if(!checkEma(shift))
+		{
+			printf("FAILED: EMA shift %u\n", shift);
+			ok = false;
+		}
+	}
+
+	const unsigned medianLengths[] = {1, 3, 5, 8, MEDIAN_ADC_FILTER_MAX_LENGTH};
+
+	for(unsigned length : medianLengths)
+	{
+		if(!checkMedian(length))
+		{
+			printf("FAILED: median length %u\n", length);
+			ok = false;
+		}
+	}
+
+	const double biquadCutoffsHz[] = {5, 20, 100, 400};
+
+	for(double cutoffHz : biquadCutoffsHz)
+	{
+		if(!checkBiquad(cutoffHz))
+		{
+			printf("FAILED: biquad %.0f hz\n", cutoffHz);
+			ok = false;
+		}
+	}
+
+	if(ok) printf("ADC filters passed\n");
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,196 @@
+#include <cmath>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "BoostControlParameters.hpp"
+#include "FixedPointPid.hpp"
+#include "RelayAutoTuner.hpp"
+#include "TurboPlant.hpp"
+
+// Host side check of the relay auto tuner against a simulated turbo plant.
+// The tuner is run at the MAP latch rate exactly as it is on core 1, then the calculated gains are run closed loop.
+// The point on the plant frequency response that the relay measured is printed against the analytic value. It is only
+// informational: the describing function is a first harmonic approximation, and boost through a first order lag is far
+// from sinusoidal, so 20-40% gain error is normal for this method.
+
+/** MAP sensor latch period in microseconds. Matches CONTROL_LATCH_PERIOD_US. */
+#define SIM_LATCH_US 1000
+
+/** Control step period in microseconds. Matches CONTROL_STEP_PERIOD_US. */
+#define SIM_STEP_US 10000
+
+/** Integral sum time in seconds. Matches CONTROL_PID_INTEG_SUM_TIME. */
+#define SIM_INTEG_SUM_TIME 0.5
+
+/** Relay amplitude. In %, scaled by 10. Matches CONTROL_AUTO_TUNE_RELAY_DUTY. */
+#define SIM_RELAY_DUTY 100
+
+/** Maximum allowed closed loop overshoot with the tuned constants. In kPa. */
+#define SIM_MAX_OVERSHOOT_KPA 5.0
+
+/** Length of the closed loop run. In seconds. */
+#define SIM_CLOSED_LOOP_S 10
+
+/**
+ * Calculate the ultimate gain and period of a first order plus dead time plant.
+ * The phase crossover is where w * L + atan(w * T) = pi.
+ */
+static void calcUltimate(const TurboPlantConfig* config, double gain, double* ultimateGain, double* ultimatePeriodS)
+{
+	double low = 0;
+	double high = M_PI / config -> deadTimeS;
+
+	for(int iter = 0; iter < 100; iter++)
+	{
+		double mid = (low + high) / 2;
+
+		if(mid * config -> deadTimeS + atan(mid * config -> timeConstantS) < M_PI) low = mid; else high = mid;
+	}
+
+	double w = (low + high) / 2;
+
+	*ultimateGain = sqrt(1 + w * w * config -> timeConstantS * config -> timeConstantS) / gain;
+	*ultimatePeriodS = 2 * M_PI / w;
+}
+
+int main()
+{
+	TurboPlantConfig plantConfig;
+	TurboPlant::populateDefaultConfig(&plantConfig);
+
+	// Tuning is about the wastegate loop, so leave spool lag out of it.
+	plantConfig.spoolTimeConstantS = 0;
+
+	TurboPlant plant(&plantConfig, SIM_LATCH_US / 1000000.0);
+
+	BoostControlParameters params;
+
+	// Same as BoostControl::populateDefaultParameters.
+	params.maxKpaScaled = 100000;
+	params.deEnergiseKpaScaled = 50000;
+	params.pidActiveKpaScaled = 75000;
+	params.pidPropConstScaled = 6000;
+	params.pidIntegConstScaled = 1000;
+	params.pidDerivConstScaled = 500;
+	params.maxDuty = 950;
+
+	// Use the duty that would hold the target as the bias, as a tuned preset would have.
+	params.zeroPointDuty = (uint32_t)(10.0 * plant.calcHoldDuty(params.maxKpaScaled / 1000.0));
+
+	// Relay tune.
+
+	RelayAutoTuner tuner;
+
+	uint32_t timeUs = 1;
+	tuner.start(params.maxKpaScaled, params.zeroPointDuty, SIM_RELAY_DUTY, params.maxDuty, timeUs);
+
+	while(tuner.getState() == RelayAutoTuner::RUNNING)
+	{
+		double kpa = plant.step(tuner.getDutyScaled() / 10.0);
+
+		timeUs += SIM_LATCH_US;
+
+		tuner.sample((int32_t)(kpa * 1000), timeUs);
+	}
+
+	RelayAutoTuneResult result;
+	tuner.getResult(SIM_STEP_US, &result);
+
+	printf("Relay tune %s after %.2f s\n", result.success ? "completed" : "FAILED", timeUs / 1000000.0);
+
+	if(!result.success) return 1;
+
+	double ultimateGain;
+	double ultimatePeriodS;
+	double gain = plant.calcGain(params.maxKpaScaled / 1000.0);
+	calcUltimate(&plantConfig, gain, &ultimateGain, &ultimatePeriodS);
+
+	// A relay with hysteresis e oscillates where G(jw) = -pi * (sqrt(a^2 - e^2) + je) / 4d. So at the measured frequency
+	// the plant gain should be pi * a / 4d and its phase -180 + asin(e / a) degrees.
+	double amplitude = result.amplitudeKpaScaled / 1000.0;
+	double relay = SIM_RELAY_DUTY / 10.0;
+	double hyst = AUTO_TUNE_HYSTERESIS_KPA_SCALED / 1000.0;
+
+	double w = 2 * M_PI * 1000000.0 / result.ultimatePeriodUs;
+	double wT = w * plantConfig.timeConstantS;
+
+	double plantGain = gain / sqrt(1 + wT * wT);
+	double plantPhase = (-w * plantConfig.deadTimeS - atan(wT)) * 180 / M_PI;
+
+	double measuredGain = M_PI * amplitude / (4 * relay);
+	double measuredPhase = -180 + asin(hyst / amplitude) * 180 / M_PI;
+
+	double gainError = 100.0 * fabs(measuredGain - plantGain) / plantGain;
+	double phaseError = fabs(measuredPhase - plantPhase);
+
+	printf("  Ultimate gain:   %.3f %%/kPa (analytic %.3f)\n", result.ultimateGainScaled / 1000.0, ultimateGain);
+	printf("  Ultimate period: %.3f s (analytic %.3f)\n", result.ultimatePeriodUs / 1000000.0, ultimatePeriodS);
+	printf("  Amplitude:       %.2f kPa\n", amplitude);
+	printf("  Plant gain:      %.4f kPa/%% (analytic %.4f, error %.1f %%)\n", measuredGain, plantGain, gainError);
+	printf("  Plant phase:     %.1f deg (analytic %.1f, error %.1f deg)\n", measuredPhase, plantPhase, phaseError);
+	printf("  PID constants:   P %.3f, I %.3f, D %.3f\n", result.pidPropConstScaled / 1000.0,
+		result.pidIntegConstScaled / 1000.0, result.pidDerivConstScaled / 1000.0);
+
+	// Closed loop with the tuned constants. The PID is stepped at the control rate, the plant at the latch rate.
+
+	params.pidPropConstScaled = result.pidPropConstScaled;
+	params.pidIntegConstScaled = result.pidIntegConstScaled;
+	params.pidDerivConstScaled = result.pidDerivConstScaled;
+
+	FixedPointPid pid(SIM_INTEG_SUM_TIME * 1000000);
+	pid.setParameters(&params);
+
+	plant.reset();
+
+	double duty = params.maxDuty / 10.0;
+	double kpa = 0;
+	double peakKpa = 0;
+	double settleS = -1;
+	bool pidActive = false;
+
+	unsigned latchesPerStep = SIM_STEP_US / SIM_LATCH_US;
+	unsigned totalLatches = SIM_CLOSED_LOOP_S * 1000000 / SIM_LATCH_US;
+
+	for(unsigned latch = 0; latch < totalLatches; latch++)
+	{
+		kpa = plant.step(duty);
+
+		if(kpa > peakKpa) peakKpa = kpa;
+
+		if(latch % latchesPerStep) continue;
+
+		int32_t kpaScaled = (int32_t)(kpa * 1000);
+
+		// Same as BoostControl: max duty to spool, then PID.
+		if(!pidActive && kpaScaled >= (int32_t)params.pidActiveKpaScaled)
+		{
+			pid.reset();
+			pidActive = true;
+		}
+
+		if(pidActive) duty = (double)pid.process(params.maxKpaScaled, kpaScaled, SIM_STEP_US, 0) / FIXED_PID_ONE;
+
+		double boostError = fabs(plant.getBoostKpa() - params.maxKpaScaled / 1000.0);
+
+		if(boostError > 2.0) settleS = -1; else if(settleS < 0) settleS = latch * SIM_LATCH_US / 1000000.0;
+	}
+
+	printf("Closed loop with tuned constants:\n");
+	printf("  Overshoot:       %.2f kPa\n", peakKpa - params.maxKpaScaled / 1000.0);
+	printf("  Settled (2 kPa): %s%.2f s\n", settleS < 0 ? "never " : "", settleS < 0 ? 0 : settleS);
+	printf("  Final boost:     %.2f kPa\n", plant.getBoostKpa());
+
+	if(peakKpa - params.maxKpaScaled / 1000.0 > SIM_MAX_OVERSHOOT_KPA)
+	{
+		printf("FAILED: tuned constants overshoot by more than %.1f kPa\n", SIM_MAX_OVERSHOOT_KPA);
+		return 1;
+	}
+
+	if(settleS < 0)
+	{
+		printf("FAILED: tuned constants don't settle on the target\n");
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,83 @@
+#include <stdio.h>
+
+#include "BoostBench.hpp"
+#include "BoostControl.hpp"
+
+// Closed loop benchmark of boost control configurations against the simulated turbo.
+// Each configuration runs each standard scenario, and the rise time, overshoot, settling time and integral absolute
+// error are reported. See BoostBench for how these are measured.
+
+/** A named controller configuration. */
+struct BenchConfig
+{
+	const char* name;
+	BoostControlParameters params;
+};
+
+/** Print a time, or "-" if it never happened. */
+static void printTime(double timeS)
+{
+	if(timeS < 0) printf(" %8s", "-");
+	else printf(" %8.2f", timeS);
+}
+
+int main()
+{
+	TurboPlantConfig plantConfig;
+	TurboPlant::populateDefaultConfig(&plantConfig);
+
+	// Only used to work out duties from the plant config.
+	TurboPlant plant(&plantConfig, BOOST_BENCH_STEP_US / 1000000.0);
+
+	BoostBench bench(&plantConfig);
+
+	BoostControl boostControl;
+
+	BenchConfig configs[4];
+	unsigned configCount = sizeof(configs) / sizeof(configs[0]);
+
+	for(unsigned index = 0; index < configCount; index++) boostControl.populateDefaultParameters(&configs[index].params);
+
+	double targetKpa = configs[0].params.maxKpaScaled / 1000.0;
+	unsigned holdDuty = plant.calcHoldDuty(targetKpa) * 10 + 0.5;
+
+	configs[0].name = "default";
+
+	// Zero point duty is the duty that holds the target.
+	configs[1].name = "zero-point";
+	configs[1].params.zeroPointDuty = holdDuty;
+
+	configs[2].name = "soft";
+	configs[2].params.zeroPointDuty = holdDuty;
+	configs[2].params.pidPropConstScaled /= 2;
+	configs[2].params.pidIntegConstScaled /= 2;
+
+	configs[3].name = "firm";
+	configs[3].params.zeroPointDuty = holdDuty;
+	configs[3].params.pidPropConstScaled = configs[3].params.pidPropConstScaled * 3 / 2;
+	configs[3].params.pidDerivConstScaled *= 2;
+
+	printf("Target %.1f kPa, settling band +/-%.1f kPa\n\n", targetKpa, BOOST_BENCH_SETTLE_BAND_KPA);
+	printf("%-12s %-12s %8s %8s %8s %8s %8s\n", "scenario", "config", "rise s", "over kPa", "settle s", "IAE kPas",
+		"final");
+
+	for(unsigned scenarioIndex = 0; scenarioIndex < BoostBench::scenarioCount; scenarioIndex++)
+	{
+		const BoostBenchScenario* scenario = &BoostBench::scenarios[scenarioIndex];
+
+		for(unsigned configIndex = 0; configIndex < configCount; configIndex++)
+		{
+			BoostBenchResult result;
+
+			bench.run(&configs[configIndex].params, scenario, &result);
+
+			printf("%-12s %-12s", scenario -> name, configs[configIndex].name);
+			printTime(result.riseTimeS);
+			printf(" %8.2f", result.overshootKpa);
+			printTime(result.settleTimeS);
+			printf(" %8.2f %8.2f\n", result.iaeKpaS, result.finalKpa);
+		}
+	}
+
+	return 0;
+}
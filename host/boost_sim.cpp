@@ -0,0 +1,109 @@
+#include <cmath>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "BoostControl.hpp"
+#include "BoostOptions.hpp"
+#include "SimHal.hpp"
+#include "TurboPlant.hpp"
+
+// Host run of the complete boost control and options firmware against the simulated HAL and a simulated turbo.
+// Core 1 (latch and control ticks) and core 0 (options) are polled from one thread, the way debug mode does on the Pico.
+// Each millisecond of virtual time the plant sees the solenoid PWM duty and drives the MAP sensor ADC input.
+
+/** Length of the run, in seconds. */
+#define SIM_RUN_S 10
+
+/** Simulation step, in microseconds. Matches CONTROL_LATCH_PERIOD_US. */
+#define SIM_STEP_US 1000
+
+/** VSys, in volts. */
+#define SIM_VSYS 5.0
+
+/** Largest error from the target, at the end of the run, that counts as settled. In kPa. */
+#define SIM_SETTLED_KPA 5.0
+
+/** Bosch 0261230119 transfer function constants. Match BoschMap_0261230119. */
+static const double boschMapC0 = 5.4 / 280.0;
+static const double boschMapC1 = 0.85 / 280.0;
+
+/** MAP sensor input divider ratio. Matches BoostControl. */
+static const double mapDividerRatio = 3.2 / (2.2 + 3.2);
+
+int main()
+{
+	sim_hal_reset();
+
+	TurboPlantConfig plantConfig;
+	TurboPlant::populateDefaultConfig(&plantConfig);
+
+	TurboPlant plant(&plantConfig, SIM_STEP_US / 1000000.0);
+
+	// The Pico divides VSys by 3 before the ADC.
+	sim_adc_set_voltage(CONTROL_VSYS_ADC_INPUT, SIM_VSYS / 3.0);
+
+	BoostControl boostControl;
+	BoostOptions boostOptions(&boostControl);
+
+	// Drain telemetry as core 0 would, checking nothing was lost on the way.
+	BoostControlCommand command = {};
+	command.type = BOOST_COMMAND_SET_TELEMETRY;
+	command.telemetryEnabled = true;
+	boostControl.sendCommand(&command);
+
+	BoostTelemetryRecord record;
+	unsigned telemetryCount = 0;
+	unsigned telemetryGapCount = 0;
+	uint16_t nextSequence = 0;
+
+	double targetKpa = boostControl.getMaxKpaScaled() / 1000.0;
+	double peakKpa = 0;
+	double kpa = 0;
+
+	for(unsigned step = 0; step < SIM_RUN_S * 1000000 / SIM_STEP_US; step++)
+	{
+		kpa = plant.step(sim_pwm_get_duty(CONTROL_SOLENOID_CHAN_A_GPIO));
+
+		if(kpa > peakKpa) peakKpa = kpa;
+
+		double mapSensorVolts = SIM_VSYS * (boschMapC0 + boschMapC1 * (kpa + STD_ATM_PRESSURE / 1000.0));
+
+		sim_adc_set_voltage(CONTROL_MAP_ADC_INPUT, mapSensorVolts * mapDividerRatio);
+
+		boostControl.poll();
+		boostOptions.poll();
+
+		while(boostControl.readTelemetry(&record))
+		{
+			if(telemetryCount && record.sequence != nextSequence) telemetryGapCount++;
+
+			nextSequence = record.sequence + 1;
+			telemetryCount++;
+		}
+
+		sim_advance_us(SIM_STEP_US);
+	}
+
+	printf("Simulated run of %u s:\n", SIM_RUN_S);
+	printf("  Target boost:    %.2f kPa\n", targetKpa);
+	printf("  Peak boost:      %.2f kPa\n", peakKpa);
+	printf("  Final boost:     %.2f kPa (measured %.2f kPa)\n", kpa, boostControl.getKpaScaled() / 1000.0);
+	printf("  Final duty:      %.1f %%\n", boostControl.getCurrentDutyScaled() / 10.0);
+	printf("  EEPROM writes:   %u\n", sim_eeprom_get_write_count());
+	printf("  Telemetry:       %u records, %u dropped, %u gaps\n", telemetryCount, boostControl.getTelemetryDropCount(),
+		telemetryGapCount);
+
+	if(fabs(kpa - targetKpa) > SIM_SETTLED_KPA)
+	{
+		printf("FAILED: boost didn't settle within %.1f kPa of the target\n", SIM_SETTLED_KPA);
+		return 1;
+	}
+
+	if(boostControl.getTelemetryDropCount() || telemetryGapCount || telemetryCount == 0)
+	{
+		printf("FAILED: telemetry records were lost\n");
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,232 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <termios.h>
+#include <unistd.h>
+
+#include "BoostControl.hpp"
+#include "BoostOptions.hpp"
+#include "SerialConsole.hpp"
+#include "SimHal.hpp"
+#include "TelemetryStream.hpp"
+
+// End to end test of the serial console on Linux. The firmware runs against the simulated HAL with its USB serial port
+// attached to the master side of a pseudo-terminal, and commands are typed into the slave side. Each command is checked
+// for its reply and its effect on the control loop, and the commit for not holding up the options poll and for reading
+// back on a fresh start. Then a burst of commands is sent while the host isn't reading, to check that the console
+// stalls rather than losing replies, and that the options keep being polled throughout.
+
+/** Simulation step, in microseconds. Matches CONTROL_LATCH_PERIOD_US. */
+#define TEST_STEP_US 1000
+
+/** Steps to run for each command. Long enough for the reply to be sent. */
+#define TEST_COMMAND_STEPS 200
+
+/** Number of commands in the burst. */
+#define TEST_BURST_COUNT 100
+
+/** Steps the burst runs for. */
+#define TEST_BURST_STEPS 6000
+
+/** Steps of the burst before the host starts reading. */
+#define TEST_BURST_STALL_STEPS 2000
+
+/** VSys, in volts. */
+#define TEST_VSYS 5.0
+
+/** A command and the reply it should get. */
+struct TestCommand
+{
+	const char* command;
+	const char* reply;
+};
+
+static const TestCommand testCommands[] = {
+	{"help", "ok get"},
+	{"telemetry", "ok telemetry off decimation 1"},
+	{"preset 2", "ok preset 2\n"},
+	{"preset 7", "err expected preset 0-4\n"},
+	{"preset", "ok preset 2\n"},
+	{"get maxKpaScaled", "ok maxKpaScaled 100000\n"},
+	{"set maxKpaScaled 90000", "ok maxKpaScaled 90000\n"},
+	{"set pidPropConstScaled 0x800", "ok pidPropConstScaled 2048\n"},
+	{"  get   pidPropConstScaled  ", "ok pidPropConstScaled 2048\n"},
+	{"set maxDuty -1", "err maxDuty out of range 0-999\n"},
+	{"set maxDuty 1000", "err maxDuty out of range 0-999\n"},
+	{"set maxKpaScaled 1000000", "err maxKpaScaled out of range 0-999000\n"},
+	{"set maxDuty", "err expected set <field> <value>\n"},
+	{"set notAField 1", "err unknown field notAField\n"},
+	{"set feedForwardDuty 2 3 450", "ok feedForwardDuty 2 3 450\n"},
+	{"get feedForwardDuty 2 3", "ok feedForwardDuty 2 3 450\n"},
+	{"get learnedDuty 9 0", "err cell out of range"},
+	{"telemetry off", "ok telemetry off decimation 1"},
+	{"telemetry decimation 4", "ok telemetry off decimation 4"},
+	{"commit", "ok commit queued"},
+	{"commit status", "ok commit idle pages 3 failed 0\n"},
+	{"bogus", "err unknown command bogus\n"},
+	{"get aVeryLongFieldNameThatDoesNotFitInTheLineBufferAtAllNotEvenCloseToItSoItIsRejected", "err line too long\n"}
+};
+
+/** Read everything waiting on the slave side. */
+static void readSlave(int slaveFd, std::string* received)
+{
+	char buffer[4096];
+	ssize_t len;
+
+	while((len = read(slaveFd, buffer, sizeof(buffer))) > 0) received -> append(buffer, len);
+}
+
+/** Type a line into the slave side. */
+static void writeSlave(int slaveFd, const char* line)
+{
+	if(write(slaveFd, line, strlen(line)) < 0 || write(slaveFd, "\r\n", 2) < 0) printf("Can't write to the pty\n");
+}
+
+int main()
+{
+	int masterFd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+	if(masterFd < 0 || grantpt(masterFd) != 0 || unlockpt(masterFd) != 0)
+	{
+		printf("FAILED: can't create a pseudo-terminal\n");
+		return 1;
+	}
+
+	int slaveFd = open(ptsname(masterFd), O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+	struct termios tio;
+	tcgetattr(slaveFd, &tio);
+	cfmakeraw(&tio);
+	tcsetattr(slaveFd, TCSANOW, &tio);
+
+	sim_hal_reset();
+	sim_serial_attach(masterFd);
+
+	sim_adc_set_voltage(CONTROL_VSYS_ADC_INPUT, TEST_VSYS / 3.0);
+
+	BoostControl boostControl;
+	BoostOptions boostOptions(&boostControl);
+	TelemetryStream stream(&boostControl);
+	SerialConsole console(&boostControl, &boostOptions, &stream);
+
+	bool ok = true;
+	std::string received;
+	unsigned maxOptionsPollUs = 0;
+
+	for(const TestCommand& test : testCommands)
+	{
+		writeSlave(slaveFd, test.command);
+
+		received.clear();
+
+		for(unsigned step = 0; step < TEST_COMMAND_STEPS; step++)
+		{
+			boostControl.poll();
+
+			// Time the options poll, which includes any EEPROM commit, in virtual time as the HAL sees it.
+			uint64_t startUs = hal_time_us_64();
+			boostOptions.poll();
+			unsigned pollUs = (unsigned)(hal_time_us_64() - startUs);
+
+			if(pollUs > maxOptionsPollUs) maxOptionsPollUs = pollUs;
+
+			stream.poll();
+			console.poll();
+
+			sim_advance_us(TEST_STEP_US);
+
+			readSlave(slaveFd, &received);
+		}
+
+		if(received.compare(0, strlen(test.reply), test.reply) != 0)
+		{
+			printf("FAILED: %s replied '%s', expected '%s'\n", test.command, received.c_str(), test.reply);
+			ok = false;
+		}
+	}
+
+	// The changes reached the control loop, and the commit wrote to the EEPROM.
+	if(boostControl.getMaxKpaScaled() != 90000 || boostControl.getFeedForwardDutyScaled(2, 3) != 450 ||
+		stream.getDecimation() != 4 || sim_eeprom_get_write_count() == 0)
+	{
+		printf("FAILED: commands didn't take effect\n");
+		ok = false;
+	}
+
+	printf("Commands: longest options poll %u us\n", maxOptionsPollUs);
+
+	// The commit is written in the background, so it mustn't hold up the options poll for a whole write cycle.
+	if(maxOptionsPollUs >= SIM_EEPROM_WRITE_CYCLE_US)
+	{
+		printf("FAILED: options poll was held up by the EEPROM\n");
+		ok = false;
+	}
+
+	// What was committed is read back by a fresh start.
+	{
+		BoostControl reloadedControl;
+		BoostOptions reloadedOptions(&reloadedControl);
+
+		if(reloadedOptions.getPresetIndex() != 2 || reloadedControl.getMaxKpaScaled() != 90000 ||
+			reloadedControl.getFeedForwardDutyScaled(2, 3) != 450)
+		{
+			printf("FAILED: committed options didn't read back\n");
+			ok = false;
+		}
+	}
+
+	// Burst of commands whose replies are far more than the serial port and pty buffers hold, with the host not reading.
+	std::string burst;
+
+	for(unsigned index = 0; index < TEST_BURST_COUNT; index++) burst += "get\n";
+
+	if(write(slaveFd, burst.c_str(), burst.size()) < 0) printf("Can't write to the pty\n");
+
+	unsigned maxPollUs = 0;
+
+	received.clear();
+
+	for(unsigned step = 0; step < TEST_BURST_STEPS; step++)
+	{
+		boostControl.poll();
+
+		boostOptions.poll();
+
+		// Time the console poll, in virtual time as the HAL sees it.
+		uint64_t startUs = hal_time_us_64();
+		console.poll();
+		unsigned pollUs = (unsigned)(hal_time_us_64() - startUs);
+
+		if(pollUs > maxPollUs) maxPollUs = pollUs;
+
+		sim_advance_us(TEST_STEP_US);
+
+		// Only start reading after a while, so the replies back up.
+		if(step >= TEST_BURST_STALL_STEPS) readSlave(slaveFd, &received);
+	}
+
+	unsigned lineCount = 0;
+
+	for(char c : received)
+	{
+		if(c == '\n') lineCount++;
+	}
+
+	printf("Burst: %u lines of replies, longest poll %u us\n", lineCount, maxPollUs);
+
+	if(lineCount != TEST_BURST_COUNT * SerialConsole::fieldCount || received.find("err") != std::string::npos ||
+		maxPollUs)
+	{
+		printf("FAILED: expected %u lines of replies without blocking\n", TEST_BURST_COUNT * SerialConsole::fieldCount);
+		ok = false;
+	}
+
+	close(slaveFd);
+	close(masterFd);
+
+	if(ok) printf("Serial console passed\n");
+
+	return ok ? 0 : 1;
+}
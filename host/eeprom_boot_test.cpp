@@ -0,0 +1,183 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "BoostControl.hpp"
+#include "BoostOptions.hpp"
+#include "Eeprom_24CS256.hpp"
+#include "SimHal.hpp"
+
+// Test of finding the current pages when the EEPROM is initialised, as at boot. Pages laid out as BoostOptions does,
+// plus a whole page with as many instances as the options page used to have, are written over and over against the
+// simulated 24CS256. After every few writes a fresh instance is booted without the RAM mirror, so every read is an i2c
+// transaction. It must find every page by binary search, reading a few wear indexes rather than all of them. After a write
+// cut short by power loss it must fall back to reading them all, and still find the previous page.
+// The init times reported are mostly the delta pages replaying their records, which are read in full, not the search.
+// Lastly the time from boot to options ready is reported as shipped, with BoostOptions, the RAM mirror and delta pages.
+// That is almost all loading the mirror, the header and pages regions in MIRROR_LOAD_CHUNK_SIZE reads. Init then runs
+// from RAM, so the search makes next to no difference to it.
+
+/** Number of writes of each page. Enough to wrap around all of them. */
+#define TEST_WRITE_COUNT 300
+
+/** Boot after every so many writes. */
+#define TEST_BOOT_INTERVAL 7
+
+/** Most wear indexes read to find all the pages. One, and then about log2 of the slots, of each page. */
+#define TEST_MAX_WEAR_INDEX_READS 40
+
+/** Number of pages. */
+#define TEST_PAGE_COUNT 4
+
+/** Largest page, in bytes. */
+#define TEST_MAX_PAGE_SIZE 200
+
+/** Number of options commits before booting as shipped. Enough to wrap around the delta records of the options page. */
+#define TEST_OPTIONS_COMMIT_COUNT 150
+
+/** Simulation step, in microseconds, while waiting for an options commit. */
+#define TEST_STEP_US 1000
+
+static EepromPage testPages[TEST_PAGE_COUNT] = {{192, 64, true}, {200, 16, true}, {200, 16, true}, {100, 64}};
+
+static uint8_t pages[TEST_PAGE_COUNT][TEST_MAX_PAGE_SIZE];
+
+static uint32_t randomState = 12345;
+
+/** Simple LCG. */
+static uint32_t random(uint32_t range)
+{
+	randomState = randomState * 1664525 + 1013904223;
+
+	return (randomState >> 8) % range;
+}
+
+/**
+ * Boot a fresh instance and check it finds every page.
+ * @param fullScanCount Expected number of pages that needed all their wear indexes read.
+ */
+static bool checkBoot(const char* when, unsigned fullScanCount, bool report)
+{
+	Eeprom_24CS256 eeprom(hal_i2c0(), 0, testPages, TEST_PAGE_COUNT);
+
+	bool ok = true;
+
+	for(unsigned pageId = 0; pageId < TEST_PAGE_COUNT; pageId++)
+	{
+		uint8_t page[TEST_MAX_PAGE_SIZE];
+
+		if(!eeprom.readPage(pageId, page) || memcmp(page, pages[pageId], testPages[pageId].pageSize) != 0)
+		{
+			printf("FAILED: %s, page %u didn't read back\n", when, pageId);
+			ok = false;
+		}
+	}
+
+	if(report)
+	{
+		printf("%s: init %u us, %u wear index reads, %u full scans\n", when, (unsigned)eeprom.getInitTimeUs(),
+			eeprom.getInitWearIndexReadCount(), eeprom.getInitFullScanCount());
+	}
+
+	if(eeprom.getInitFullScanCount() != fullScanCount)
+	{
+		printf("FAILED: %s, expected %u full scans\n", when, fullScanCount);
+		ok = false;
+	}
+
+	if(fullScanCount == 0 && eeprom.getInitWearIndexReadCount() > TEST_MAX_WEAR_INDEX_READS)
+	{
+		printf("FAILED: %s, %u wear index reads\n", when, eeprom.getInitWearIndexReadCount());
+		ok = false;
+	}
+
+	return ok;
+}
+
+int main()
+{
+	sim_hal_reset();
+
+	bool ok = true;
+
+	Eeprom_24CS256* eeprom = new Eeprom_24CS256(hal_i2c0(), 0, testPages, TEST_PAGE_COUNT);
+
+	for(unsigned pageId = 0; pageId < TEST_PAGE_COUNT; pageId++)
+	{
+		for(unsigned index = 0; index < testPages[pageId].pageSize; index++) pages[pageId][index] = random(256);
+	}
+
+	for(unsigned write = 0; ok && write < TEST_WRITE_COUNT; write++)
+	{
+		for(unsigned pageId = 0; pageId < TEST_PAGE_COUNT; pageId++)
+		{
+			pages[pageId][random(testPages[pageId].pageSize)] = random(256);
+
+			if(!eeprom -> writePage(pageId, pages[pageId]))
+			{
+				printf("FAILED: write %u of page %u\n", write, pageId);
+				ok = false;
+			}
+		}
+
+		if(write % TEST_BOOT_INTERVAL == 0 && !checkBoot("Boot", 0, write == TEST_WRITE_COUNT - 1)) ok = false;
+	}
+
+	delete eeprom;
+
+	if(!checkBoot("Boot", 0, true)) ok = false;
+
+	// Cut the power part way through writing the whole page's data. Its wear index is never written, so the one there is
+	// from the previous lap, and the page has to be found the slow way.
+	eeprom = new Eeprom_24CS256(hal_i2c0(), 0, testPages, TEST_PAGE_COUNT);
+
+	uint8_t page[TEST_MAX_PAGE_SIZE];
+
+	memcpy(page, pages[3], testPages[3].pageSize);
+
+	for(unsigned index = 0; index < testPages[3].pageSize; index++) page[index] ^= 0x55;
+
+	// The wear index is lost, then everything after it.
+	sim_eeprom_cut_power_after(testPages[3].pageSize + EEPROM_PAGE_CRC_SIZE + 1);
+
+	eeprom -> writePage(3, page);
+
+	delete eeprom;
+
+	sim_eeprom_restore_power();
+	sim_advance_us(SIM_EEPROM_WRITE_CYCLE_US);
+
+	if(!checkBoot("Boot after power cut", 1, true)) ok = false;
+
+	// As shipped. Options are committed over and over, as edits would, then a fresh start is timed.
+	sim_hal_reset();
+
+	{
+		BoostControl boostControl;
+		BoostOptions boostOptions(&boostControl);
+
+		for(unsigned commit = 0; commit < TEST_OPTIONS_COMMIT_COUNT; commit++)
+		{
+			boostControl.alterMaxKpaScaled(commit % 2 ? 1000 : -1000);
+			boostControl.setFeedForwardDutyScaled(commit % 5, commit % 4, commit);
+
+			boostOptions.commit();
+
+			while(boostOptions.getCommitState() != EEPROM_COMMIT_IDLE)
+			{
+				boostOptions.poll();
+				sim_advance_us(TEST_STEP_US);
+			}
+		}
+	}
+
+	{
+		BoostControl boostControl;
+		BoostOptions boostOptions(&boostControl);
+
+		printf("Boot as shipped: options ready %u us\n", (unsigned)boostOptions.getOptionsReadyTimeUs());
+	}
+
+	if(ok) printf("EEPROM boot passed\n");
+
+	return ok ? 0 : 1;
+}
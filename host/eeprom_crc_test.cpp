@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "Eeprom_24CS256.hpp"
+#include "HalCrc.hpp"
+#include "SimHal.hpp"
+
+// Test of the CRC-32 stored with each wear levelled page. Checks the CRC against the standard check value, then corrupts
+// pages on the simulated 24CS256 the way a failing chip might, by swapping bytes and flipping bits. A corrupted whole
+// page must fail to read rather than return bad data, and a corrupted delta page write must be dropped, leaving the page
+// as it was before it.
+
+/** Size of the test pages, in bytes. */
+#define TEST_PAGE_SIZE 64
+
+static EepromPage testPages[2] = {{TEST_PAGE_SIZE, 8}, {TEST_PAGE_SIZE, 16, true}};
+
+/** Read a page with a fresh instance, as if after power on. */
+static bool reloadPage(uint8_t pageId, uint8_t* page)
+{
+	Eeprom_24CS256 eeprom(hal_i2c0(), 0, testPages, 2);
+
+	return eeprom.readPage(pageId, page);
+}
+
+/** Write a page and get the address of the first byte of the chip that it changed. */
+static uint32_t writePage(Eeprom* eeprom, uint8_t pageId, uint8_t* page)
+{
+	static uint8_t before[SIM_EEPROM_SIZE];
+
+	memcpy(before, sim_eeprom_get_memory(), SIM_EEPROM_SIZE);
+
+	eeprom -> writePage(pageId, page);
+
+	uint32_t addr = 0;
+
+	while(addr < SIM_EEPROM_SIZE && sim_eeprom_get_memory()[addr] == before[addr]) addr++;
+
+	return addr;
+}
+
+int main()
+{
+	bool ok = true;
+
+	// CRC-32/ISO-HDLC check value.
+	uint32_t check = hal_crc32((const uint8_t*)"123456789", 9);
+
+	printf("CRC-32 of \"123456789\": %08X\n", check);
+
+	if(check != 0xCBF43926)
+	{
+		printf("FAILED: expected CBF43926\n");
+		ok = false;
+	}
+
+	sim_hal_reset();
+
+	Eeprom_24CS256* eeprom = new Eeprom_24CS256(hal_i2c0(), 0, testPages, 2);
+
+	uint8_t page[TEST_PAGE_SIZE];
+	uint8_t readBack[TEST_PAGE_SIZE];
+
+	for(unsigned index = 0; index < TEST_PAGE_SIZE; index++) page[index] = index * 7;
+
+	// Whole page. Swapping two bytes isn't caught by an additive checksum.
+	uint32_t addr = writePage(eeprom, 0, page);
+
+	if(!reloadPage(0, readBack) || memcmp(readBack, page, TEST_PAGE_SIZE) != 0)
+	{
+		printf("FAILED: whole page didn't read back\n");
+		ok = false;
+	}
+
+	uint8_t* memory = sim_eeprom_get_memory();
+
+	// The page data comes first.
+	uint8_t swap = memory[addr + 10];
+
+	memory[addr + 10] = memory[addr + 11];
+	memory[addr + 11] = swap;
+
+	if(reloadPage(0, readBack))
+	{
+		printf("FAILED: whole page with swapped bytes was read\n");
+		ok = false;
+	}
+	else
+	{
+		printf("Whole page with swapped bytes not read\n");
+	}
+
+	// Delta page. The second write is changes only, which are corrupted.
+	writePage(eeprom, 1, page);
+
+	page[20] ^= 0x11;
+	page[21] ^= 0x22;
+
+	addr = writePage(eeprom, 1, page);
+
+	eeprom -> readPage(1, readBack);
+
+	if(memcmp(readBack, page, TEST_PAGE_SIZE) != 0)
+	{
+		printf("FAILED: delta page didn't read back\n");
+		ok = false;
+	}
+
+	// First changed byte is in the record's first run, after the record and run headers.
+	memory[addr + EEPROM_RECORD_HEADER_SIZE + EEPROM_RUN_HEADER_SIZE] ^= 0x04;
+
+	page[20] ^= 0x11;
+	page[21] ^= 0x22;
+
+	if(!reloadPage(1, readBack) || memcmp(readBack, page, TEST_PAGE_SIZE) != 0)
+	{
+		printf("FAILED: corrupted delta page write wasn't dropped\n");
+		ok = false;
+	}
+	else
+	{
+		printf("Corrupted delta page write dropped\n");
+	}
+
+	delete eeprom;
+
+	if(ok) printf("Page CRC passed\n");
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,218 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "Eeprom_24CS256.hpp"
+#include "HalTime.hpp"
+#include "SimHal.hpp"
+
+// Test of delta pages. A page is written over and over with small changes, and the odd large one, against the
+// simulated 24CS256. Checks that a small change is a single chip page write, that the page reloads the same after every
+// write through bases being rewritten and the records wrapping around, and that a write cut short by power loss leaves
+// the previous page in place. Then reports how long a base write takes for a few chip write cycle times, as the write
+// acknowledge polls the chip rather than waiting out the 5 ms datasheet maximum.
+
+/** Size of the test page, in bytes. Same as the options page. */
+#define TEST_PAGE_SIZE 192
+
+/** Wear count of the test page. Same as the options page. */
+#define TEST_WEAR_COUNT 64
+
+/** Number of writes of small changes. Enough to wrap around the page's memory several times. */
+#define TEST_WRITE_COUNT 2000
+
+/** Every so many writes is a large change, which is written as a base. */
+#define TEST_LARGE_CHANGE_INTERVAL 499
+
+/** Chip write cycle times to time a base write with, in microseconds. The datasheet maximum first. */
+static const unsigned testWriteCyclesUs[] = {5000, 3000, 1500};
+
+static EepromPage testPages[2] = {{TEST_PAGE_SIZE, TEST_WEAR_COUNT, true}, {16, 4}};
+
+static uint32_t randomState = 12345;
+
+/** Simple LCG. */
+static uint32_t random(uint32_t range)
+{
+	randomState = randomState * 1664525 + 1013904223;
+
+	return (randomState >> 8) % range;
+}
+
+/** Write a page, either all at once or incrementally. */
+static bool writePage(Eeprom* eeprom, uint8_t* page, bool incremental)
+{
+	if(!incremental) return eeprom -> writePage(0, page);
+
+	if(!eeprom -> startWritePage(0, page)) return false;
+
+	EepromWriteResult result;
+
+	while((result = eeprom -> stepWritePage()) == EEPROM_WRITE_IN_PROGRESS) sim_advance_us(100);
+
+	return result == EEPROM_WRITE_COMPLETE;
+}
+
+/** Check a fresh instance, as if after power on, reads back the expected page. */
+static bool checkReload(const char* when, uint8_t* expected, bool mirror)
+{
+	Eeprom_24CS256 eeprom(hal_i2c0(), 0, testPages, 2, 0, mirror);
+
+	uint8_t page[TEST_PAGE_SIZE];
+
+	if(eeprom.readPage(0, page) && memcmp(page, expected, TEST_PAGE_SIZE) == 0) return true;
+
+	printf("FAILED: %s, page didn't reload\n", when);
+
+	return false;
+}
+
+int main()
+{
+	sim_hal_reset();
+
+	bool ok = true;
+
+	Eeprom_24CS256* eeprom = new Eeprom_24CS256(hal_i2c0(), 0, testPages, 2);
+
+	uint8_t page[TEST_PAGE_SIZE];
+
+	for(unsigned index = 0; index < TEST_PAGE_SIZE; index++) page[index] = random(256);
+
+	unsigned writeCount = sim_eeprom_get_write_count();
+
+	// The first write is always a base.
+	if(!writePage(eeprom, page, false) || !checkReload("First write", page, false)) ok = false;
+
+	printf("First write: %u chip page writes\n", sim_eeprom_get_write_count() - writeCount);
+
+	// A small change only costs one chip page.
+	page[40]++;
+	page[41]--;
+	page[150] ^= 0x5A;
+
+	writeCount = sim_eeprom_get_write_count();
+
+	if(!writePage(eeprom, page, true) || !checkReload("Small change", page, false)) ok = false;
+
+	unsigned smallWriteCount = sim_eeprom_get_write_count() - writeCount;
+
+	printf("Small change: %u chip page writes\n", smallWriteCount);
+
+	if(smallWriteCount != 1)
+	{
+		printf("FAILED: expected 1 chip page write\n");
+		ok = false;
+	}
+
+	// Nothing changed, so nothing to write.
+	writeCount = sim_eeprom_get_write_count();
+
+	if(!writePage(eeprom, page, true) || sim_eeprom_get_write_count() != writeCount)
+	{
+		printf("FAILED: unchanged page was written\n");
+		ok = false;
+	}
+
+	writeCount = sim_eeprom_get_write_count();
+
+	for(unsigned write = 0; ok && write < TEST_WRITE_COUNT; write++)
+	{
+		if(write % TEST_LARGE_CHANGE_INTERVAL == 0)
+		{
+			for(unsigned index = 0; index < TEST_PAGE_SIZE; index++) page[index] = random(256);
+		}
+		else
+		{
+			// A few scattered cells, like an edited option and the checksum.
+			unsigned changeCount = 1 + random(3);
+
+			for(unsigned change = 0; change < changeCount; change++) page[random(TEST_PAGE_SIZE)] = random(256);
+		}
+
+		if(!writePage(eeprom, page, write % 2))
+		{
+			printf("FAILED: write %u\n", write);
+			ok = false;
+		}
+
+		if(write % 7 == 0 && !checkReload("Reload", page, write % 14 == 0)) ok = false;
+	}
+
+	printf("%u writes: %u chip page writes, %u as changes only, %u as bases\n", TEST_WRITE_COUNT,
+		sim_eeprom_get_write_count() - writeCount, eeprom -> getDeltaWriteCount(), eeprom -> getBaseWriteCount());
+
+	// Bases are rewritten when the records fill the page's memory, as well as for large changes.
+	if(eeprom -> getBaseWriteCount() <= TEST_WRITE_COUNT / TEST_LARGE_CHANGE_INTERVAL + 2)
+	{
+		printf("FAILED: expected bases to be rewritten when the page's memory filled\n");
+		ok = false;
+	}
+
+	// Cut the power part way through a write of more than one record. The previous page is still there afterwards.
+	uint8_t previous[TEST_PAGE_SIZE];
+
+	memcpy(previous, page, TEST_PAGE_SIZE);
+
+	for(unsigned index = 0; index < TEST_PAGE_SIZE; index += 3) page[index] = ~page[index];
+
+	eeprom -> startWritePage(0, page);
+
+	while(eeprom -> getWriteChipPageIndex() < 2)
+	{
+		eeprom -> stepWritePage();
+		sim_advance_us(100);
+	}
+
+	delete eeprom;
+
+	// Power is off for longer than the write cycle in progress.
+	sim_advance_us(SIM_EEPROM_WRITE_CYCLE_US);
+
+	if(!checkReload("Power cut", previous, false)) ok = false;
+
+	// Carries on from there.
+	eeprom = new Eeprom_24CS256(hal_i2c0(), 0, testPages, 2);
+
+	page[7]++;
+
+	if(!writePage(eeprom, page, true) || !checkReload("After power cut", page, false)) ok = false;
+
+	page[8]++;
+
+	if(!writePage(eeprom, page, false) || !checkReload("After power cut", page, true)) ok = false;
+
+	// The saving over a fixed wait depends on how quickly the part actually finishes its write cycles.
+	unsigned datasheetWriteUs = 0;
+
+	for(unsigned writeCycleUs : testWriteCyclesUs)
+	{
+		sim_eeprom_set_write_cycle_us(writeCycleUs);
+
+		for(unsigned index = 0; index < TEST_PAGE_SIZE; index++) page[index] = ~page[index];
+
+		writeCount = sim_eeprom_get_write_count();
+		uint64_t startUs = hal_time_us_64();
+
+		if(!writePage(eeprom, page, false)) ok = false;
+
+		unsigned writeUs = (unsigned)(hal_time_us_64() - startUs);
+
+		printf("Base write, %.1f ms write cycle: %u chip page writes in %.1f ms\n", writeCycleUs / 1000.0,
+			sim_eeprom_get_write_count() - writeCount, writeUs / 1000.0);
+
+		if(writeCycleUs == testWriteCyclesUs[0]) datasheetWriteUs = writeUs;
+		else if(writeUs >= datasheetWriteUs)
+		{
+			printf("FAILED: a faster write cycle didn't make the write faster\n");
+			ok = false;
+		}
+	}
+
+	sim_eeprom_set_write_cycle_us(SIM_EEPROM_WRITE_CYCLE_US);
+
+	delete eeprom;
+
+	if(ok) printf("Delta pages passed\n");
+
+	return ok ? 0 : 1;
+}
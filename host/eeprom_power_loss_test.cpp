@@ -0,0 +1,326 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "Eeprom_24CS256.hpp"
+#include "SimHal.hpp"
+
+// Fault injection test of page writes losing power part way through. A sequence of writes is made to a whole page and a
+// delta page on the simulated 24CS256, and each write is repeated from the same starting point with the power cut after
+// every byte it programs in turn. After each cut the chip is powered back up and the page reloaded, as after the
+// ignition is switched back on. It must read back as either the page before the write or the page written, never
+// anything else, and carry on being written from there. Done for whole and incremental writes, with and without the RAM
+// mirror. The power is also cut at every byte of a format, after the pages have changed, which must be started again.
+
+/** Size of the whole test page, in bytes. Spans chip pages. */
+#define TEST_WHOLE_PAGE_SIZE 100
+
+/** Size of the delta test page, in bytes. Same as the options page. */
+#define TEST_DELTA_PAGE_SIZE 192
+
+/** Number of writes of the whole page. Enough to wrap around its instances twice. */
+#define TEST_WHOLE_WRITE_COUNT 9
+
+/** Number of writes of the delta page. Enough to wrap around its record slots, and rewrite bases. */
+#define TEST_DELTA_WRITE_COUNT 40
+
+/** Every so many writes of the delta page is a large change, which is written as a base. */
+#define TEST_LARGE_CHANGE_INTERVAL 7
+
+static EepromPage testPages[2] = {{TEST_WHOLE_PAGE_SIZE, 4}, {TEST_DELTA_PAGE_SIZE, 4, true}};
+
+/** Test pages after a firmware update that changed them. Same count, so only the descriptors change. */
+static EepromPage changedPages[2] = {{TEST_WHOLE_PAGE_SIZE, 6}, {TEST_DELTA_PAGE_SIZE, 4, true}};
+
+static uint32_t randomState = 12345;
+
+/** Simple LCG. */
+static uint32_t random(uint32_t range)
+{
+	randomState = randomState * 1664525 + 1013904223;
+
+	return (randomState >> 8) % range;
+}
+
+/** Write a page, either all at once or incrementally. */
+static bool writePage(Eeprom* eeprom, uint8_t pageId, uint8_t* page, bool incremental)
+{
+	if(!incremental) return eeprom -> writePage(pageId, page);
+
+	if(!eeprom -> startWritePage(pageId, page)) return false;
+
+	EepromWriteResult result;
+
+	while((result = eeprom -> stepWritePage()) == EEPROM_WRITE_IN_PROGRESS) sim_advance_us(100);
+
+	return result == EEPROM_WRITE_COMPLETE;
+}
+
+/** Power up a fresh instance and read the page. */
+static bool reloadPage(uint8_t pageId, uint8_t* page, bool mirror)
+{
+	Eeprom_24CS256 eeprom(hal_i2c0(), 0, testPages, 2, 0, mirror);
+
+	return eeprom.readPage(pageId, page);
+}
+
+/**
+ * Cut the power at every byte of a write in turn, checking what is read back after each.
+ * @param previous Page before the write. nullptr if it has never been written.
+ * @param page Page to write.
+ * @param cutCount Incremented by the number of power cuts.
+ * @returns True if all passed. The write has been made in full.
+ */
+static bool checkWrite(uint8_t pageId, const uint8_t* previous, uint8_t* page, bool incremental, bool mirror,
+	unsigned* cutCount)
+{
+	static uint8_t before[SIM_EEPROM_SIZE];
+
+	uint8_t pageSize = testPages[pageId].pageSize;
+
+	uint8_t readBack[TEST_DELTA_PAGE_SIZE];
+	uint8_t next[TEST_DELTA_PAGE_SIZE];
+
+	memcpy(before, sim_eeprom_get_memory(), SIM_EEPROM_SIZE);
+
+	for(unsigned byteCount = 0; ; byteCount++)
+	{
+		memcpy(sim_eeprom_get_memory(), before, SIM_EEPROM_SIZE);
+
+		Eeprom_24CS256* eeprom = new Eeprom_24CS256(hal_i2c0(), 0, testPages, 2, 0, mirror);
+
+		sim_eeprom_cut_power_after(byteCount);
+
+		bool written = writePage(eeprom, pageId, page, incremental);
+
+		delete eeprom;
+
+		bool powered = sim_eeprom_is_powered();
+
+		sim_eeprom_restore_power();
+
+		// Power stays off for longer than any write cycle in progress.
+		sim_advance_us(SIM_EEPROM_WRITE_CYCLE_US);
+
+		if(powered)
+		{
+			// Got through the whole write without the power being cut.
+			if(!written || !reloadPage(pageId, readBack, mirror) || memcmp(readBack, page, pageSize) != 0)
+			{
+				printf("FAILED: page %u, write without a power cut didn't read back\n", pageId);
+				return false;
+			}
+
+			return true;
+		}
+
+		(*cutCount)++;
+
+		bool read = reloadPage(pageId, readBack, mirror);
+
+		bool isPrevious = read && previous && memcmp(readBack, previous, pageSize) == 0;
+		bool isWritten = read && memcmp(readBack, page, pageSize) == 0;
+
+		if(!isPrevious && !isWritten && (read || previous))
+		{
+			printf("FAILED: page %u, power cut after %u bytes read back %s\n", pageId, byteCount,
+				read ? "neither page" : "nothing");
+			return false;
+		}
+
+		// Carries on from whichever it is.
+		for(unsigned index = 0; index < pageSize; index++) next[index] = page[index] ^ (index + byteCount);
+
+		eeprom = new Eeprom_24CS256(hal_i2c0(), 0, testPages, 2, 0, mirror);
+
+		written = writePage(eeprom, pageId, next, incremental);
+
+		delete eeprom;
+
+		if(!written || !reloadPage(pageId, readBack, mirror) || memcmp(readBack, next, pageSize) != 0)
+		{
+			printf("FAILED: page %u, write after power cut after %u bytes didn't read back\n", pageId, byteCount);
+			return false;
+		}
+	}
+}
+
+/** Run a sequence of writes of a page, cutting the power at every byte of each. */
+static bool checkPage(uint8_t pageId, unsigned writeCount, bool incremental, bool mirror)
+{
+	sim_hal_reset();
+
+	uint8_t pageSize = testPages[pageId].pageSize;
+
+	uint8_t previous[TEST_DELTA_PAGE_SIZE];
+	uint8_t page[TEST_DELTA_PAGE_SIZE];
+
+	for(unsigned index = 0; index < pageSize; index++) page[index] = random(256);
+
+	unsigned cutCount = 0;
+
+	for(unsigned write = 0; write < writeCount; write++)
+	{
+		if(write > 0)
+		{
+			memcpy(previous, page, pageSize);
+
+			if(write % TEST_LARGE_CHANGE_INTERVAL == 0)
+			{
+				for(unsigned index = 0; index < pageSize; index++) page[index] = random(256);
+			}
+			else
+			{
+				unsigned changeCount = 1 + random(3);
+
+				for(unsigned change = 0; change < changeCount; change++) page[random(pageSize)] = random(256);
+			}
+		}
+
+		if(!checkWrite(pageId, write > 0 ? previous : nullptr, page, incremental, mirror, &cutCount)) return false;
+	}
+
+	printf("%s page, %s%s: %u writes, %u power cuts\n", pageId ? "Delta" : "Whole", incremental ? "incremental" : "all at once",
+		mirror ? ", mirrored" : "", writeCount, cutCount);
+
+	return true;
+}
+
+/**
+ * Cut the power at every byte of the format that follows a change of pages, checking each is started again when powered
+ * back up, rather than the pages being found in what was there before.
+ */
+static bool checkFormat(bool mirror)
+{
+	sim_hal_reset();
+
+	uint8_t page[TEST_DELTA_PAGE_SIZE];
+
+	for(unsigned index = 0; index < TEST_DELTA_PAGE_SIZE; index++) page[index] = random(256);
+
+	// Fill the pages region, so there is something for a format that is cut short to leave behind.
+	Eeprom_24CS256* eeprom = new Eeprom_24CS256(hal_i2c0(), 0, testPages, 2, 0, mirror);
+
+	for(unsigned write = 0; write < TEST_WHOLE_WRITE_COUNT; write++)
+	{
+		page[write] ^= 0xFF;
+
+		eeprom -> writePage(0, page);
+		eeprom -> writePage(1, page);
+	}
+
+	delete eeprom;
+
+	static uint8_t before[SIM_EEPROM_SIZE];
+
+	memcpy(before, sim_eeprom_get_memory(), SIM_EEPROM_SIZE);
+
+	unsigned cutCount = 0;
+
+	for(unsigned byteCount = 0; ; byteCount++)
+	{
+		memcpy(sim_eeprom_get_memory(), before, SIM_EEPROM_SIZE);
+
+		sim_eeprom_cut_power_after(byteCount);
+
+		eeprom = new Eeprom_24CS256(hal_i2c0(), 0, changedPages, 2, 0, mirror);
+
+		delete eeprom;
+
+		bool powered = sim_eeprom_is_powered();
+
+		sim_eeprom_restore_power();
+		sim_advance_us(SIM_EEPROM_WRITE_CYCLE_US);
+
+		if(powered) break;
+
+		cutCount++;
+
+		// Nothing has been written since the pages changed. If it wasn't started again, the magic, which is written last,
+		// was programmed before the cut. So the format was finished and the pages region must be blank.
+		Eeprom_24CS256 restarted(hal_i2c0(), 0, changedPages, 2, 0, mirror);
+
+		bool blank = true;
+
+		for(uint32_t addr = EEPROM_PAGE_COUNT_ADDR + 1 + 2 * 3; addr < restarted.getNonPageRegionStartAddress(); addr++)
+		{
+			if(sim_eeprom_get_memory()[addr] != 0xFF) blank = false;
+		}
+
+		if((restarted.getClearedByteCount() == 0 && !blank) || restarted.readPage(0, page) || restarted.readPage(1, page))
+		{
+			printf("FAILED: format cut short after %u bytes wasn't started again\n", byteCount);
+			return false;
+		}
+	}
+
+	printf("Format after pages changed%s: %u power cuts\n", mirror ? ", mirrored" : "", cutCount);
+
+	return true;
+}
+
+int main()
+{
+	bool ok = true;
+
+	for(unsigned mode = 0; mode < 4; mode++)
+	{
+		bool incremental = mode & 1;
+		bool mirror = mode & 2;
+
+		if(!checkPage(0, TEST_WHOLE_WRITE_COUNT, incremental, mirror)) ok = false;
+		if(!checkPage(1, TEST_DELTA_WRITE_COUNT, incremental, mirror)) ok = false;
+	}
+
+	if(!checkFormat(false)) ok = false;
+	if(!checkFormat(true)) ok = false;
+
+	// A page instance that is complete, but doesn't match its CRC, falls back to the one before. eg A write cycle cut
+	// short that left the wear index programmed but not all of the data.
+	sim_hal_reset();
+
+	uint8_t previous[TEST_WHOLE_PAGE_SIZE];
+	uint8_t page[TEST_WHOLE_PAGE_SIZE];
+
+	for(unsigned index = 0; index < TEST_WHOLE_PAGE_SIZE; index++) previous[index] = random(256);
+
+	previous[0] = 1;
+
+	memcpy(page, previous, TEST_WHOLE_PAGE_SIZE);
+
+	// Not blank, so it is the first byte the second instance changes.
+	page[0] = 0;
+
+	Eeprom_24CS256* eeprom = new Eeprom_24CS256(hal_i2c0(), 0, testPages, 2);
+
+	eeprom -> writePage(0, previous);
+
+	static uint8_t before[SIM_EEPROM_SIZE];
+
+	memcpy(before, sim_eeprom_get_memory(), SIM_EEPROM_SIZE);
+
+	eeprom -> writePage(0, page);
+
+	delete eeprom;
+
+	uint32_t addr = 0;
+
+	while(sim_eeprom_get_memory()[addr] == before[addr]) addr++;
+
+	uint8_t readBack[TEST_WHOLE_PAGE_SIZE];
+
+	sim_eeprom_get_memory()[addr + 50] ^= 0x01;
+
+	if(!reloadPage(0, readBack, false) || memcmp(readBack, previous, TEST_WHOLE_PAGE_SIZE) != 0)
+	{
+		printf("FAILED: corrupted newest instance didn't fall back to the one before\n");
+		ok = false;
+	}
+	else
+	{
+		printf("Corrupted newest instance fell back to the one before\n");
+	}
+
+	if(ok) printf("Power loss passed\n");
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,309 @@
+#include <algorithm>
+#include <atomic>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "BoostBench.hpp"
+#include "BoostControl.hpp"
+#include "WorkStealingPool.hpp"
+
+// Sweep of the boost control parameter space against the simulated turbo.
+// Every candidate set of gains, zero point duty and PID active pressure is run through the same set of randomised boost
+// events, spread across all host cores. The Pareto front of mean overshoot against mean rise time is printed, and
+// optionally written as CSV with the BoostControlParameters fields, so a point on it can be entered into a preset.
+//
+// Usage: gain_sweep [-e events] [-t threads] [-o front.csv]
+
+/** Default number of boost events each candidate is run through. */
+#define SWEEP_DEFAULT_EVENTS 1000
+
+/** Seed of the random boost events. Fixed so every candidate, and every run, sees the same events. */
+#define SWEEP_SEED 0x2545F491
+
+/** Longest part throttle time before the tip-in. In seconds. */
+#define SWEEP_MAX_HOLD_S 2.0
+
+/** Shortest part throttle time before the tip-in. In seconds. */
+#define SWEEP_MIN_HOLD_S 0.3
+
+/** Highest part throttle before the tip-in. 0 for closed to 1 for full throttle. */
+#define SWEEP_MAX_PART_THROTTLE 0.7
+
+/** Time measured after the tip-in. In seconds. */
+#define SWEEP_MEASURE_S 4.0
+
+/**
+ * Most the plant spring pressure is raised from the default, as a fraction.
+ * It is never lowered, as the default is the de-energise pressure and below that the solenoid can't hold the gate shut.
+ */
+#define SWEEP_SPRING_VARIATION 0.2
+
+/** Most the plant solenoid flow is varied from the default, as a fraction. */
+#define SWEEP_FLOW_VARIATION 0.05
+
+/** PID proportional constants swept. */
+static const double propConsts[] = {2, 4, 6, 9};
+
+/** PID integration constants swept. */
+static const double integConsts[] = {0.25, 0.5, 1, 2};
+
+/** PID derivative constants swept. */
+static const double derivConsts[] = {0, 0.5, 1.5};
+
+/** Zero point duties swept. In %. */
+static const double zeroPointDuties[] = {50, 60, 70};
+
+/** PID active pressures swept. In kPa. */
+static const double pidActiveKpas[] = {50, 65, 80};
+
+#define SWEEP_COUNT(array) (sizeof(array) / sizeof(array[0]))
+
+/** One randomised boost event: part throttle for a while, then full throttle, on a slightly different turbo. */
+struct SweepEvent
+{
+	BoostBenchEvent events[2];
+	BoostBenchScenario scenario;
+	TurboPlantConfig plantConfig;
+};
+
+/** Summary of one candidate over all events. */
+struct SweepResult
+{
+	BoostControlParameters params;
+
+	/** Events that rose to 90% of the target, and that settled. */
+	unsigned risenCount;
+	unsigned settledCount;
+
+	double meanRiseS;
+	double meanOvershootKpa;
+	double maxOvershootKpa;
+
+	/** Mean over the events that settled. */
+	double meanSettleS;
+
+	double meanIaeKpaS;
+};
+
+/** Uniform random number in [low, high). */
+static double randomUniform(uint32_t* state, double low, double high)
+{
+	// xorshift32
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+
+	return low + (high - low) * (*state / 4294967296.0);
+}
+
+static void generateEvents(std::vector<SweepEvent>& events, unsigned eventCount)
+{
+	TurboPlantConfig defaultConfig;
+	TurboPlant::populateDefaultConfig(&defaultConfig);
+
+	uint32_t state = SWEEP_SEED;
+
+	events.resize(eventCount);
+
+	for(SweepEvent& event : events)
+	{
+		double holdS = randomUniform(&state, SWEEP_MIN_HOLD_S, SWEEP_MAX_HOLD_S);
+
+		event.events[0] = {0.0, randomUniform(&state, 0, SWEEP_MAX_PART_THROTTLE)};
+		event.events[1] = {holdS, 1.0};
+
+		event.scenario = {"sweep", event.events, 2, holdS + SWEEP_MEASURE_S, holdS};
+
+		event.plantConfig = defaultConfig;
+		event.plantConfig.springKpa *= randomUniform(&state, 1, 1 + SWEEP_SPRING_VARIATION);
+		event.plantConfig.solenoidFlow *= randomUniform(&state, 1 - SWEEP_FLOW_VARIATION, 1 + SWEEP_FLOW_VARIATION);
+	}
+}
+
+static void generateCandidates(std::vector<SweepResult>& candidates)
+{
+	BoostControl boostControl;
+
+	BoostControlParameters defaultParams;
+	boostControl.populateDefaultParameters(&defaultParams);
+
+	for(double prop : propConsts)
+		for(double integ : integConsts)
+			for(double deriv : derivConsts)
+				for(double zeroPoint : zeroPointDuties)
+					for(double pidActive : pidActiveKpas)
+					{
+						SweepResult candidate = {};
+
+						candidate.params = defaultParams;
+						candidate.params.pidPropConstScaled = prop * 1000 + 0.5;
+						candidate.params.pidIntegConstScaled = integ * 1000 + 0.5;
+						candidate.params.pidDerivConstScaled = deriv * 1000 + 0.5;
+						candidate.params.zeroPointDuty = zeroPoint * 10 + 0.5;
+						candidate.params.pidActiveKpaScaled = pidActive * 1000 + 0.5;
+
+						candidates.push_back(candidate);
+					}
+}
+
+static void runCandidate(SweepResult* candidate, const std::vector<SweepEvent>& events)
+{
+	double riseSum = 0;
+	double overshootSum = 0;
+	double settleSum = 0;
+	double iaeSum = 0;
+
+	for(const SweepEvent& event : events)
+	{
+		BoostBench bench(&event.plantConfig);
+		BoostBenchResult result;
+
+		bench.run(&candidate -> params, &event.scenario, &result);
+
+		if(result.riseTimeS >= 0)
+		{
+			candidate -> risenCount++;
+			riseSum += result.riseTimeS;
+		}
+
+		if(result.settleTimeS >= 0)
+		{
+			candidate -> settledCount++;
+			settleSum += result.settleTimeS;
+		}
+
+		overshootSum += result.overshootKpa;
+		iaeSum += result.iaeKpaS;
+
+		if(result.overshootKpa > candidate -> maxOvershootKpa) candidate -> maxOvershootKpa = result.overshootKpa;
+	}
+
+	candidate -> meanRiseS = candidate -> risenCount ? riseSum / candidate -> risenCount : -1;
+	candidate -> meanSettleS = candidate -> settledCount ? settleSum / candidate -> settledCount : -1;
+	candidate -> meanOvershootKpa = overshootSum / events.size();
+	candidate -> meanIaeKpaS = iaeSum / events.size();
+}
+
+/**
+ * Find the candidates that no other beats on both mean rise time and mean overshoot.
+ * Candidates that failed to reach the target on any event are left out.
+ */
+static void findParetoFront(const std::vector<SweepResult>& candidates, unsigned eventCount,
+	std::vector<const SweepResult*>& front)
+{
+	std::vector<const SweepResult*> sorted;
+
+	for(const SweepResult& candidate : candidates)
+		if(candidate.risenCount == eventCount) sorted.push_back(&candidate);
+
+	std::sort(sorted.begin(), sorted.end(), [](const SweepResult* a, const SweepResult* b) {
+		if(a -> meanRiseS != b -> meanRiseS) return a -> meanRiseS < b -> meanRiseS;
+		return a -> meanOvershootKpa < b -> meanOvershootKpa;
+	});
+
+	// In order of rise time, each point on the front must have less overshoot than every faster one.
+	for(const SweepResult* candidate : sorted)
+		if(front.empty() || candidate -> meanOvershootKpa < front.back() -> meanOvershootKpa) front.push_back(candidate);
+}
+
+static void writeCsv(FILE* file, const std::vector<const SweepResult*>& front, unsigned eventCount)
+{
+	fprintf(file, "maxKpaScaled,pidActiveKpaScaled,pidPropConstScaled,pidIntegConstScaled,pidDerivConstScaled,"
+		"zeroPointDuty,meanRiseS,meanOvershootKpa,maxOvershootKpa,meanSettleS,settledFraction,meanIaeKpaS\n");
+
+	for(const SweepResult* candidate : front)
+	{
+		const BoostControlParameters* params = &candidate -> params;
+
+		fprintf(file, "%u,%u,%u,%u,%u,%u,%.4f,%.3f,%.3f,%.4f,%.4f,%.3f\n", (unsigned)params -> maxKpaScaled,
+			(unsigned)params -> pidActiveKpaScaled, (unsigned)params -> pidPropConstScaled,
+			(unsigned)params -> pidIntegConstScaled, (unsigned)params -> pidDerivConstScaled,
+			(unsigned)params -> zeroPointDuty, candidate -> meanRiseS, candidate -> meanOvershootKpa,
+			candidate -> maxOvershootKpa, candidate -> meanSettleS, (double)candidate -> settledCount / eventCount,
+			candidate -> meanIaeKpaS);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	unsigned eventCount = SWEEP_DEFAULT_EVENTS;
+	unsigned threadCount = 0;
+	const char* csvPath = NULL;
+
+	for(int index = 1; index < argc; index++)
+	{
+		if(strcmp(argv[index], "-e") == 0 && index + 1 < argc) eventCount = strtoul(argv[++index], NULL, 0);
+		else if(strcmp(argv[index], "-t") == 0 && index + 1 < argc) threadCount = strtoul(argv[++index], NULL, 0);
+		else if(strcmp(argv[index], "-o") == 0 && index + 1 < argc) csvPath = argv[++index];
+		else
+		{
+			fprintf(stderr, "Usage: %s [-e events] [-t threads] [-o front.csv]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if(eventCount == 0) eventCount = 1;
+
+	std::vector<SweepEvent> events;
+	generateEvents(events, eventCount);
+
+	std::vector<SweepResult> candidates;
+	generateCandidates(candidates);
+
+	WorkStealingPool pool(threadCount);
+
+	fprintf(stderr, "%u candidates x %u events on %u threads\n", (unsigned)candidates.size(), eventCount,
+		pool.getThreadCount());
+
+	std::atomic<unsigned> doneCount(0);
+	unsigned candidateCount = candidates.size();
+
+	pool.run(candidateCount, [&](unsigned index) {
+		runCandidate(&candidates[index], events);
+
+		unsigned done = ++doneCount;
+
+		if(done * 10 / candidateCount != (done - 1) * 10 / candidateCount)
+			fprintf(stderr, "  %u%%\n", done * 100 / candidateCount);
+	});
+
+	fprintf(stderr, "%u tasks stolen\n", pool.getStealCount());
+
+	std::vector<const SweepResult*> front;
+	findParetoFront(candidates, eventCount, front);
+
+	printf("Pareto front of mean overshoot against mean rise time, target %.1f kPa:\n\n",
+		candidates[0].params.maxKpaScaled / 1000.0);
+	printf("%6s %6s %6s %6s %6s | %7s %8s %8s %8s %7s %8s\n", "P", "I", "D", "zero%", "active", "rise s", "over kPa",
+		"max kPa", "settle s", "settled", "IAE kPas");
+
+	for(const SweepResult* candidate : front)
+	{
+		const BoostControlParameters* params = &candidate -> params;
+
+		printf("%6.2f %6.2f %6.2f %6.1f %6.1f | %7.3f %8.2f %8.2f %8.3f %6.1f%% %8.2f\n",
+			params -> pidPropConstScaled / 1000.0, params -> pidIntegConstScaled / 1000.0,
+			params -> pidDerivConstScaled / 1000.0, params -> zeroPointDuty / 10.0, params -> pidActiveKpaScaled / 1000.0,
+			candidate -> meanRiseS, candidate -> meanOvershootKpa, candidate -> maxOvershootKpa, candidate -> meanSettleS,
+			100.0 * candidate -> settledCount / eventCount, candidate -> meanIaeKpaS);
+	}
+
+	if(csvPath)
+	{
+		FILE* file = fopen(csvPath, "w");
+
+		if(!file)
+		{
+			fprintf(stderr, "Can't write %s\n", csvPath);
+			return 1;
+		}
+
+		writeCsv(file, front, eventCount);
+		fclose(file);
+	}
+
+	return 0;
+}
@@ -0,0 +1,132 @@
+#include <cmath>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "BoostControl.hpp"
+#include "BoostOptions.hpp"
+#include "FeedForwardMap.hpp"
+#include "SimHal.hpp"
+#include "TurboPlant.hpp"
+
+// Host check of zero point learning against a simulated turbo. The zero point duty is set well below what holds the
+// target, so the PID integral term has to make up the difference on every spool up. The same throttle cycle is run over
+// and over, with boost control and options polled the way debug mode does on the Pico, so learned offsets make the full
+// trip to core 0 and are published back. Learning should take much of the error out of the later cycles. Not all of it:
+// the PID integral is time limited, so at the hold it carries only part of the missing duty, the proportional term the
+// rest, and the learner only transfers from the integral term.
+
+/** Simulation step, in microseconds. Matches CONTROL_LATCH_PERIOD_US. */
+#define SIM_STEP_US 1000
+
+/** VSys, in volts. On a feed forward load axis point, so one learned cell covers the operating point. */
+#define SIM_VSYS 5.0
+
+/** How far the zero point duty is set below what holds the target. In %, scaled by 10. */
+#define SIM_ZERO_POINT_ERROR 100
+
+/** Number of throttle cycles. */
+#define SIM_CYCLES 10
+
+/** Time with the throttle closed at the start of each cycle. In seconds. */
+#define SIM_CLOSED_S 1.5
+
+/** Time at full throttle in each cycle. In seconds. */
+#define SIM_OPEN_S 20.0
+
+/** Time after the throttle opens that the IAE is measured from, so it is the hold and not the spool up. In seconds. */
+#define SIM_MEASURE_FROM_S 3.0
+
+/** The last cycle's IAE must be no more than this fraction of the first's. */
+#define SIM_MAX_IAE_RATIO 0.75
+
+/** Bosch 0261230119 transfer function constants. Match BoschMap_0261230119. */
+static const double boschMapC0 = 5.4 / 280.0;
+static const double boschMapC1 = 0.85 / 280.0;
+
+/** MAP sensor input divider ratio. Matches BoostControl. */
+static const double mapDividerRatio = 3.2 / (2.2 + 3.2);
+
+int main()
+{
+	sim_hal_reset();
+
+	TurboPlantConfig plantConfig;
+	TurboPlant::populateDefaultConfig(&plantConfig);
+
+	TurboPlant plant(&plantConfig, SIM_STEP_US / 1000000.0);
+
+	// The Pico divides VSys by 3 before the ADC.
+	sim_adc_set_voltage(CONTROL_VSYS_ADC_INPUT, SIM_VSYS / 3.0);
+
+	BoostControl boostControl;
+	BoostOptions boostOptions(&boostControl);
+
+	BoostControlParameters params;
+	boostControl.getParameters(&params);
+
+	double targetKpa = params.maxKpaScaled / 1000.0;
+
+	int holdDuty = (int)lround(plant.calcHoldDuty(targetKpa) * 10);
+
+	params.zeroPointDuty = holdDuty - SIM_ZERO_POINT_ERROR;
+	boostControl.setParameters(&params);
+
+	unsigned boostIndex = FeedForwardMap::nearestIndex(FeedForwardMap::boostAxis, FEED_FORWARD_BOOST_POINTS,
+		params.maxKpaScaled);
+	unsigned loadIndex = FeedForwardMap::nearestIndex(FeedForwardMap::loadAxis, FEED_FORWARD_LOAD_POINTS,
+		(int32_t)(SIM_VSYS * 1000));
+
+	printf("Zero point learning, %u cycles of %.1f s closed then %.1f s full throttle:\n", SIM_CYCLES, SIM_CLOSED_S,
+		SIM_OPEN_S);
+	printf("  Target boost:    %.2f kPa\n", targetKpa);
+	printf("  Hold duty:       %.1f %%\n", holdDuty / 10.0);
+	printf("  Zero point duty: %.1f %%\n", params.zeroPointDuty / 10.0);
+
+	unsigned cycleSteps = (SIM_CLOSED_S + SIM_OPEN_S) * 1000000 / SIM_STEP_US;
+	unsigned closedSteps = SIM_CLOSED_S * 1000000 / SIM_STEP_US;
+	unsigned measureSteps = (SIM_CLOSED_S + SIM_MEASURE_FROM_S) * 1000000 / SIM_STEP_US;
+
+	double firstIae = 0;
+	double lastIae = 0;
+
+	for(unsigned cycle = 0; cycle < SIM_CYCLES; cycle++)
+	{
+		double iae = 0;
+
+		for(unsigned step = 0; step < cycleSteps; step++)
+		{
+			plant.setThrottle(step < closedSteps ? 0 : 1);
+
+			double sensorKpa = plant.step(sim_pwm_get_duty(CONTROL_SOLENOID_CHAN_A_GPIO));
+
+			double mapSensorVolts = SIM_VSYS * (boschMapC0 + boschMapC1 * (sensorKpa + STD_ATM_PRESSURE / 1000.0));
+
+			sim_adc_set_voltage(CONTROL_MAP_ADC_INPUT, mapSensorVolts * mapDividerRatio);
+
+			boostControl.poll();
+			boostOptions.poll();
+
+			sim_advance_us(SIM_STEP_US);
+
+			// Measure the true boost, not what the noisy sensor saw.
+			if(step >= measureSteps) iae += fabs(targetKpa - plant.getBoostKpa()) * (SIM_STEP_US / 1000000.0);
+		}
+
+		printf("  Cycle %2u:        IAE %6.2f kPa.s, learned %+5.1f %%\n", cycle + 1, iae,
+			boostControl.getLearnedDutyScaled(boostIndex, loadIndex) / 10.0);
+
+		if(cycle == 0) firstIae = iae;
+
+		lastIae = iae;
+	}
+
+	if(lastIae > firstIae * SIM_MAX_IAE_RATIO)
+	{
+		printf("FAILED: learning didn't cut the IAE to %.0f%% of the first cycle\n", SIM_MAX_IAE_RATIO * 100);
+		return 1;
+	}
+
+	printf("Zero point learning passed\n");
+
+	return 0;
+}
@@ -0,0 +1,186 @@
+#include <stdio.h>
+
+#include "BoostControl.hpp"
+#include "BoostOptions.hpp"
+#include "SimHal.hpp"
+#include "gpioAlloc.hpp"
+
+// Test of when changed options are committed to EEPROM. The firmware runs against the simulated HAL, with the preset
+// buttons pressed through GPIO and the MAP sensor and VSys set through the ADC. Checks that flicking through presets
+// costs one commit once the buttons go quiet, that commits wait for the solenoid to be de-energised, that a brown
+// out commits straight away, and that pages that fail to commit are committed again.
+
+/** Simulation step, in microseconds. Matches CONTROL_LATCH_PERIOD_US. */
+#define TEST_STEP_US 1000
+
+/** VSys, in volts. */
+#define TEST_VSYS 5.0
+
+/** VSys during a brown out, in volts. */
+#define TEST_BROWN_OUT_VSYS 4.0
+
+/** Boost that has the solenoid energised, in kPa. Above the default de-energise boost. */
+#define TEST_ENERGISED_KPA 70.0
+
+/** Number of page commits in a commit of all options. Options, feed forward tables and learned offsets. */
+#define TEST_PAGES_PER_COMMIT 3
+
+/** Bosch 0261230119 transfer function constants. Match BoschMap_0261230119. */
+static const double boschMapC0 = 5.4 / 280.0;
+static const double boschMapC1 = 0.85 / 280.0;
+
+/** MAP sensor input divider ratio. Matches BoostControl. */
+static const double mapDividerRatio = 3.2 / (2.2 + 3.2);
+
+static BoostControl* boostControl;
+static BoostOptions* boostOptions;
+
+/** Run the firmware for a time, in milliseconds. */
+static void run(unsigned ms)
+{
+	for(unsigned step = 0; step < ms * 1000 / TEST_STEP_US; step++)
+	{
+		boostControl -> poll();
+		boostOptions -> poll();
+
+		sim_advance_us(TEST_STEP_US);
+	}
+}
+
+/** Set the boost the MAP sensor reads, in kPa, and VSys, in volts. */
+static void setInputs(double kpa, double vsys)
+{
+	double mapSensorVolts = vsys * (boschMapC0 + boschMapC1 * (kpa + STD_ATM_PRESSURE / 1000.0));
+
+	sim_adc_set_voltage(CONTROL_MAP_ADC_INPUT, mapSensorVolts * mapDividerRatio);
+
+	// The Pico divides VSys by 3 before the ADC.
+	sim_adc_set_voltage(CONTROL_VSYS_ADC_INPUT, vsys / 3.0);
+}
+
+/** Press and release the increase button, to step to the next preset. */
+static void pressIncrease()
+{
+	// Buttons have pull ups, so pressed is low.
+	sim_gpio_drive(NAV_BTN_FORWARD, false);
+	run(100);
+
+	sim_gpio_release(NAV_BTN_FORWARD);
+	run(200);
+}
+
+/** Check the number of page commits so far. */
+static bool check(const char* when, unsigned expected)
+{
+	unsigned commitCount = boostOptions -> getCommitCount();
+
+	printf("%s: %u page commits, %u EEPROM writes\n", when, commitCount, sim_eeprom_get_write_count());
+
+	if(commitCount == expected) return true;
+
+	printf("FAILED: expected %u page commits\n", expected);
+
+	return false;
+}
+
+int main()
+{
+	sim_hal_reset();
+
+	setInputs(0, TEST_VSYS);
+
+	boostControl = new BoostControl();
+	boostOptions = new BoostOptions(boostControl);
+
+	bool ok = true;
+
+	run(1000);
+
+	// Flick through presets. Nothing is written until the buttons have been quiet for a while.
+	for(unsigned press = 0; press < 4; press++) pressIncrease();
+
+	if(!check("Flicked through 4 presets", 0)) ok = false;
+
+	run(OPTIONS_COMMIT_QUIET_MS + 500);
+
+	if(!check("Quiet period passed", TEST_PAGES_PER_COMMIT)) ok = false;
+
+	if(boostOptions -> getPresetIndex() != 4)
+	{
+		printf("FAILED: expected preset 4\n");
+		ok = false;
+	}
+
+	// Held back while the solenoid is energised.
+	setInputs(TEST_ENERGISED_KPA, TEST_VSYS);
+	run(500);
+
+	pressIncrease();
+	run(OPTIONS_COMMIT_QUIET_MS + 500);
+
+	if(!boostControl -> isEnergised() || !check("Energised", TEST_PAGES_PER_COMMIT)) ok = false;
+
+	setInputs(0, TEST_VSYS);
+	run(500);
+
+	if(!check("De-energised", TEST_PAGES_PER_COMMIT * 2)) ok = false;
+
+	// Straight away on brown out, without waiting for the quiet period.
+	pressIncrease();
+
+	setInputs(0, TEST_BROWN_OUT_VSYS);
+	run(200);
+
+	if(!check("Brown out", TEST_PAGES_PER_COMMIT * 3)) ok = false;
+
+	// Pages the committer gives up on are committed again, rather than lost until the next change.
+	setInputs(0, TEST_VSYS);
+	run(500);
+
+	sim_eeprom_cut_power_after(0);
+
+	pressIncrease();
+	run(OPTIONS_COMMIT_QUIET_MS + 500);
+
+	unsigned failCount = boostOptions -> getCommitFailCount();
+
+	printf("EEPROM not responding: %u failed page commits\n", failCount);
+
+	sim_eeprom_restore_power();
+	run(OPTIONS_COMMIT_QUIET_MS + 500);
+
+	BoostControl reloadedControl;
+	BoostOptions reloadedOptions(&reloadedControl);
+
+	if(failCount == 0 || reloadedOptions.getPresetIndex() != boostOptions -> getPresetIndex())
+	{
+		printf("FAILED: the preset change wasn't committed once the EEPROM responded again\n");
+		ok = false;
+	}
+
+	// Parameters far out of range make the options too big for their page. The commit says so rather than cut them short.
+	BoostControlParameters outOfRange;
+	boostControl -> getParameters(&outOfRange);
+
+	outOfRange.maxKpaScaled = outOfRange.deEnergiseKpaScaled = outOfRange.pidActiveKpaScaled = UINT32_MAX;
+	outOfRange.pidPropConstScaled = outOfRange.pidIntegConstScaled = outOfRange.pidDerivConstScaled = UINT32_MAX;
+
+	for(int index = 0; index < 5; index++)
+	{
+		boostOptions -> setPresetIndex(index);
+		boostControl -> setParameters(&outOfRange);
+	}
+
+	if(boostOptions -> commit())
+	{
+		printf("FAILED: options too big for their page were committed\n");
+		ok = false;
+	}
+
+	delete boostOptions;
+	delete boostControl;
+
+	if(ok) printf("Options commit passed\n");
+
+	return ok ? 0 : 1;
+}
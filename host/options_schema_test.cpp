@@ -0,0 +1,313 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "BoostControl.hpp"
+#include "BoostOptions.hpp"
+#include "Eeprom_24CS256.hpp"
+#include "SimHal.hpp"
+#include "TlvReader.hpp"
+#include "TlvWriter.hpp"
+
+// Test of the versioned, tagged, layout of the options page. Checks tagged values round trip, then boots the firmware
+// against the simulated HAL on an EEPROM in the original format, holding options in the old hand packed layout, and on
+// an options page written by a newer version with tags, and presets, this one doesn't know. Both must come up with the
+// options they hold.
+
+/** Simulation step, in microseconds. */
+#define TEST_STEP_US 1000
+
+/** Preset the test pages select. */
+#define TEST_PRESET_INDEX 2
+
+/** Max boost of the selected preset, scaled. */
+#define TEST_MAX_KPA_SCALED 120000
+
+/** PID proportional constant of the selected preset, scaled. */
+#define TEST_PID_PROP_CONST_SCALED 7000
+
+/** Same layout as BoostOptions, so the pages written here are the ones it reads. */
+static EepromPage testPages[3] = {{OPTIONS_EEPROM_PAGE_SIZE, 64, OPTIONS_EEPROM_DELTA},
+	{FEED_FORWARD_EEPROM_PAGE_SIZE, FEED_FORWARD_EEPROM_WEAR_COUNT, OPTIONS_EEPROM_DELTA},
+	{LEARNED_EEPROM_PAGE_SIZE, LEARNED_EEPROM_WEAR_COUNT, OPTIONS_EEPROM_DELTA}};
+
+/** Number of instances of the options page in the original EEPROM format. */
+#define TEST_LEGACY_WEAR_COUNT 64
+
+/**
+ * Write options pages to an EEPROM in the original format, as the first firmware did. Its only page is the options page,
+ * and an instance is the wear index and then the page. The last page written is the newest.
+ */
+static void writeLegacyEeprom(uint8_t (*pages)[OPTIONS_EEPROM_PAGE_SIZE], unsigned count)
+{
+	sim_hal_reset();
+
+	uint8_t* memory = sim_eeprom_get_memory();
+
+	memory[0] = EEPROM_LEGACY_MAGIC;
+	memory[EEPROM_PAGE_COUNT_ADDR] = 1;
+	memory[EEPROM_PAGE_COUNT_ADDR + 1] = OPTIONS_EEPROM_PAGE_SIZE;
+	memory[EEPROM_PAGE_COUNT_ADDR + 2] = TEST_LEGACY_WEAR_COUNT & 0xFF;
+	memory[EEPROM_PAGE_COUNT_ADDR + 3] = TEST_LEGACY_WEAR_COUNT >> 8;
+
+	uint8_t* instance = memory + EEPROM_PAGE_COUNT_ADDR + 4;
+
+	for(unsigned index = 0; index < count; index++)
+	{
+		uint16_t wearIndex = index + 1;
+
+		memcpy(instance, &wearIndex, 2);
+		memcpy(instance + 2, pages[index], OPTIONS_EEPROM_PAGE_SIZE);
+
+		instance += OPTIONS_EEPROM_PAGE_SIZE + 2;
+	}
+}
+
+/** Fill in an options page in the old hand packed layout, with the test preset. */
+static void packLegacyPage(uint8_t* page, const BoostControlParameters* defaults, uint8_t presetIndex)
+{
+	memset(page, 0, OPTIONS_EEPROM_PAGE_SIZE);
+
+	uint32_t* page32 = (uint32_t*)page;
+
+	for(unsigned index = 0; index < 5; index++)
+	{
+		BoostControlParameters preset = *defaults;
+
+		if(index == TEST_PRESET_INDEX)
+		{
+			preset.maxKpaScaled = TEST_MAX_KPA_SCALED;
+			preset.pidPropConstScaled = TEST_PID_PROP_CONST_SCALED;
+		}
+
+		// After the checksum.
+		uint32_t* fields = page32 + 1 + index * 8;
+
+		fields[0] = preset.maxKpaScaled;
+		fields[1] = preset.deEnergiseKpaScaled;
+		fields[2] = preset.pidActiveKpaScaled;
+		fields[3] = preset.pidPropConstScaled;
+		fields[4] = preset.pidIntegConstScaled;
+		fields[5] = preset.pidDerivConstScaled;
+		fields[6] = preset.maxDuty;
+		fields[7] = preset.zeroPointDuty;
+	}
+
+	page[164] = 7;
+	page[165] = 4;
+	page[166] = presetIndex;
+	page[167] = 0;
+
+	uint32_t checksum = 0;
+
+	for(unsigned index = 4; index < OPTIONS_EEPROM_PAGE_SIZE; index++) checksum += page[index];
+
+	page32[0] = checksum;
+}
+
+/** Write the options page, as if by other firmware. */
+static void writeOptionsPage(uint8_t* page)
+{
+	Eeprom_24CS256 eeprom(hal_i2c0(), 0, testPages, 3);
+
+	eeprom.writePage(OPTIONS_EEPROM_PAGE, page);
+}
+
+/** Boot the firmware and check it picked up the test preset. */
+static bool checkBoot(const char* when, bool runUntilCommitted)
+{
+	sim_adc_set_voltage(CONTROL_VSYS_ADC_INPUT, 5.0 / 3.0);
+
+	BoostControl* boostControl = new BoostControl();
+	BoostOptions* boostOptions = new BoostOptions(boostControl);
+
+	BoostControlParameters params;
+
+	boostControl -> getParameters(&params);
+
+	bool ok = boostOptions -> getPresetIndex() == TEST_PRESET_INDEX && params.maxKpaScaled == TEST_MAX_KPA_SCALED &&
+		params.pidPropConstScaled == TEST_PID_PROP_CONST_SCALED;
+
+	printf("%s: preset %d, max kPa scaled %u, PID prop const scaled %u\n", when, boostOptions -> getPresetIndex(),
+		(unsigned)params.maxKpaScaled, (unsigned)params.pidPropConstScaled);
+
+	if(!ok) printf("FAILED: expected preset %d, %u, %u\n", TEST_PRESET_INDEX, TEST_MAX_KPA_SCALED,
+		TEST_PID_PROP_CONST_SCALED);
+
+	for(unsigned step = 0; runUntilCommitted && step < (OPTIONS_COMMIT_QUIET_MS + 1000) * 1000 / TEST_STEP_US; step++)
+	{
+		boostControl -> poll();
+		boostOptions -> poll();
+
+		sim_advance_us(TEST_STEP_US);
+	}
+
+	delete boostOptions;
+	delete boostControl;
+
+	return ok;
+}
+
+static bool checkTlv()
+{
+	uint8_t buffer[64];
+
+	TlvWriter writer(buffer, sizeof(buffer));
+
+	writer.putUnsigned(1, 0);
+	writer.putUnsigned(2, 0xFFFFFFFF);
+	writer.putSigned(3, -1);
+	writer.putSigned(4, INT32_MIN);
+	writer.beginGroup(5);
+	writer.putUnsigned(1, 300);
+	writer.putBytes(2, (const uint8_t*)"abc", 3);
+	writer.endGroup();
+	writer.putSigned(TLV_MAX_TAG, 1000);
+
+	if(writer.isOverflowed()) return false;
+
+	TlvReader reader(buffer, sizeof(buffer));
+
+	bool ok = reader.next() && reader.getTag() == 1 && reader.getUnsigned() == 0;
+
+	ok = ok && reader.next() && reader.getTag() == 2 && reader.getUnsigned() == 0xFFFFFFFF;
+	ok = ok && reader.next() && reader.getTag() == 3 && reader.getSigned() == -1;
+	ok = ok && reader.next() && reader.getTag() == 4 && reader.getSigned() == INT32_MIN;
+	ok = ok && reader.next() && reader.getTag() == 5 && reader.isBytes();
+
+	if(ok)
+	{
+		TlvReader groupReader = reader.getGroup();
+
+		ok = groupReader.next() && groupReader.getTag() == 1 && groupReader.getUnsigned() == 300;
+		ok = ok && groupReader.next() && groupReader.getBytesLength() == 3 && memcmp(groupReader.getBytes(), "abc", 3) == 0;
+		ok = ok && !groupReader.next() && !groupReader.isMalformed();
+	}
+
+	ok = ok && reader.next() && reader.getTag() == TLV_MAX_TAG && reader.getSigned() == 1000;
+	ok = ok && !reader.next() && !reader.isMalformed();
+
+	// Doesn't fit.
+	TlvWriter smallWriter(buffer, 4);
+
+	smallWriter.putUnsigned(1, 0xFFFFFFFF);
+
+	ok = ok && smallWriter.isOverflowed();
+
+	// Cut short in a varint, and a length past the end.
+	const uint8_t truncated[] = {(1 << 1) | TLV_TYPE_VARINT, 0x80, 0x80};
+	const uint8_t overrun[] = {(1 << 1) | TLV_TYPE_BYTES, 10, 0};
+
+	TlvReader truncatedReader(truncated, sizeof(truncated));
+	TlvReader overrunReader(overrun, sizeof(overrun));
+
+	ok = ok && !truncatedReader.next() && truncatedReader.isMalformed();
+	ok = ok && !overrunReader.next() && overrunReader.isMalformed();
+
+	return ok;
+}
+
+int main()
+{
+	bool ok = true;
+
+	if(!checkTlv())
+	{
+		printf("FAILED: tagged values didn't round trip\n");
+		ok = false;
+	}
+
+	sim_hal_reset();
+
+	BoostControlParameters defaults;
+
+	BoostControl* boostControl = new BoostControl();
+
+	boostControl -> populateDefaultParameters(&defaults);
+
+	delete boostControl;
+
+	// Version 0. Hand packed, with no signature, on an EEPROM in the original format. The newest of a few instances is
+	// carried over when it is reformatted.
+	uint8_t legacyPages[3][OPTIONS_EEPROM_PAGE_SIZE];
+
+	packLegacyPage(legacyPages[0], &defaults, 0);
+	packLegacyPage(legacyPages[1], &defaults, 1);
+	packLegacyPage(legacyPages[2], &defaults, TEST_PRESET_INDEX);
+
+	writeLegacyEeprom(legacyPages, 3);
+
+	// Rewritten in the tagged layout once the quiet period has passed.
+	if(!checkBoot("Version 0 page", true)) ok = false;
+
+	uint8_t page[OPTIONS_EEPROM_PAGE_SIZE];
+
+	Eeprom_24CS256* eeprom = new Eeprom_24CS256(hal_i2c0(), 0, testPages, 3);
+
+	if(!eeprom -> readPage(OPTIONS_EEPROM_PAGE, page) || page[0] != OPTIONS_SCHEMA_SIGNATURE_0 ||
+		page[1] != OPTIONS_SCHEMA_SIGNATURE_1)
+	{
+		printf("FAILED: version 0 page wasn't rewritten tagged\n");
+		ok = false;
+	}
+
+	delete eeprom;
+
+	if(!checkBoot("Version 1 page", false)) ok = false;
+
+	// Out of range preset indexes in a version 0 page. They would be past the end of the presets.
+	packLegacyPage(legacyPages[0], &defaults, 200);
+
+	writeLegacyEeprom(legacyPages, 1);
+
+	boostControl = new BoostControl();
+	BoostOptions* boostOptions = new BoostOptions(boostControl);
+
+	if(boostOptions -> getPresetIndex() != 0)
+	{
+		printf("FAILED: version 0 page with preset index 200 selected preset %d\n", boostOptions -> getPresetIndex());
+		ok = false;
+	}
+
+	delete boostOptions;
+	delete boostControl;
+
+	// A newer version, with a tag and a preset field this one doesn't know, and more presets.
+	page[0] = OPTIONS_SCHEMA_SIGNATURE_0;
+	page[1] = OPTIONS_SCHEMA_SIGNATURE_1;
+
+	TlvWriter writer(page + OPTIONS_SCHEMA_SIGNATURE_SIZE, OPTIONS_EEPROM_PAGE_SIZE - OPTIONS_SCHEMA_SIGNATURE_SIZE);
+
+	writer.putUnsigned(OPTIONS_TAG_VERSION, OPTIONS_SCHEMA_VERSION + 1);
+	writer.putBytes(40, (const uint8_t*)"new", 3);
+	writer.putUnsigned(OPTIONS_TAG_PRESET_INDEX, TEST_PRESET_INDEX);
+
+	for(unsigned index = 0; index < 7; index++)
+	{
+		writer.beginGroup(OPTIONS_TAG_PRESET);
+		writer.putSigned(41, -5);
+
+		if(index == TEST_PRESET_INDEX)
+		{
+			writer.putUnsigned(PRESET_TAG_MAX_KPA, TEST_MAX_KPA_SCALED);
+			writer.putUnsigned(PRESET_TAG_PID_PROP_CONST, TEST_PID_PROP_CONST_SCALED);
+		}
+
+		writer.endGroup();
+	}
+
+	writer.putUnsigned(42, 1);
+
+	if(writer.isOverflowed())
+	{
+		printf("FAILED: newer version page didn't fit\n");
+		ok = false;
+	}
+
+	writeOptionsPage(page);
+
+	if(!checkBoot("Newer version page", false)) ok = false;
+
+	if(ok) printf("Options schema passed\n");
+
+	return ok ? 0 : 1;
+}
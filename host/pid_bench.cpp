@@ -0,0 +1,277 @@
+#include <chrono>
+#include <cmath>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "BoostControlParameters.hpp"
+#include "FixedPointPid.hpp"
+
+// Host side benchmark of the fixed point PID engine against the float path it replaced.
+// Both engines are fed the same boost trajectory and their duty cycle outputs are compared step by step.
+
+/** Number of control steps per benchmark pass. */
+#define BENCH_STEPS 200000
+
+/** Control step period in microseconds. ie 100hz. */
+#define BENCH_STEP_US 10000
+
+/** Integral sum time in seconds. Matches CONTROL_PID_INTEG_SUM_TIME. */
+#define BENCH_INTEG_SUM_TIME 0.5
+
+/** Maximum allowed difference between float and fixed point duty cycle, in %. */
+#define BENCH_MAX_DUTY_ERROR 0.05
+
+/**
+ * Float reference engine.
+ * This is the float maths that used to be in BoostControl::__processControlSolenoid, with the following corrected so that
+ * it matches the documented units of BoostControlParameters:
+ *   - Error is target - current, so that more duty is applied when under target.
+ *   - Scaled constants are divided by their scale.
+ *   - Delta time is in seconds to match the integral sum time.
+ */
+class FloatPid
+{
+	public:
+
+		void setParameters(const BoostControlParameters* params)
+		{
+			_prop = (float)params -> pidPropConstScaled / 1000.0f;
+			_integ = (float)params -> pidIntegConstScaled / 1000.0f;
+			_deriv = (float)params -> pidDerivConstScaled / 1000.0f;
+			_zeroPointDuty = (float)params -> zeroPointDuty / 10.0f;
+			_maxDuty = (float)params -> maxDuty / 10.0f;
+		}
+
+		void reset()
+		{
+			_prevError = 0;
+			_integSum = 0;
+		}
+
+		float process(int targetKpaScaled, int curKpaScaled, uint32_t deltaTimeUs)
+		{
+			float error = (targetKpaScaled - curKpaScaled) / 1000.0f;
+
+			float deltaTime = deltaTimeUs / 1000000.0f;
+
+			float controlVar = error * _prop + (error - _prevError) * _deriv;
+
+			_integSum -= deltaTime * _integSum / (float)BENCH_INTEG_SUM_TIME;
+			_integSum += error * deltaTime;
+
+			controlVar += _integSum * _integ;
+
+			float duty = controlVar + _zeroPointDuty;
+
+			if(duty > _maxDuty) duty = _maxDuty;
+			if(duty < 0.0f) duty = 0.0f;
+
+			_prevError = error;
+
+			return duty;
+		}
+
+	private:
+
+		float _prop = 0;
+		float _integ = 0;
+		float _deriv = 0;
+		float _zeroPointDuty = 0;
+		float _maxDuty = 0;
+		float _prevError = 0;
+		float _integSum = 0;
+};
+
+/**
+ * The float path exactly as it was in BoostControl::__processControlSolenoid. Only used for timing because its units
+ * don't match the documented parameter scaling.
+ */
+class LegacyFloatPid
+{
+	public:
+
+		void reset()
+		{
+			_pidPrevError = 0;
+			_pidInteg = 0;
+		}
+
+		float process(const BoostControlParameters* params, int curBoostScaled, uint32_t deltaTimeUs)
+		{
+			float error = (curBoostScaled - (int)params -> maxKpaScaled) / 1000.0;
+
+			float deltaTime = deltaTimeUs / 1000.0;
+
+			float controlVar = error * (float)params -> pidPropConstScaled + (error - _pidPrevError) *
+				(float)params -> pidDerivConstScaled;
+
+			_pidInteg -= deltaTime * _pidInteg / BENCH_INTEG_SUM_TIME;
+			_pidInteg += error * deltaTime;
+
+			// Stop the (unstable) legacy integral from becoming inf/nan and skewing the timing.
+			if(!std::isfinite(_pidInteg)) _pidInteg = 0;
+
+			controlVar += _pidInteg * (float)params -> pidIntegConstScaled;
+
+			float duty = controlVar + (float)params -> zeroPointDuty / 10.0;
+
+			float maxDuty = (float)params -> maxDuty / 10.0;
+
+			if(duty > maxDuty) duty = maxDuty;
+			if(duty < 0.0) duty = 0.0;
+
+			_pidPrevError = error;
+
+			return duty;
+		}
+
+	private:
+
+		float _pidPrevError = 0;
+		float _pidInteg = 0;
+};
+
+/** Read a cycle counter, or nanoseconds where there isn't one. */
+static inline uint64_t readCycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * Generate a boost trajectory, relative to std atm, in kPa scaled by 1000.
+ * Spools up to overshoot the target, oscillates about it and has a little sensor noise added.
+ */
+static void generateTrajectory(int* trajectory, unsigned count, int targetKpaScaled)
+{
+	uint32_t noiseState = 12345;
+
+	for(unsigned index = 0; index < count; index++)
+	{
+		// Repeat a 5 second boost event.
+		double t = (index % 500) * (BENCH_STEP_US / 1000000.0);
+
+		double spool = 1.0 - exp(-t / 0.4);
+		double ringing = 0.15 * exp(-t / 0.8) * sin(2.0 * M_PI * 1.5 * t);
+
+		// Simple LCG noise of about +/- 1 kPa.
+		noiseState = noiseState * 1664525 + 1013904223;
+		int noise = (int)(noiseState >> 21) - 1024;
+
+		trajectory[index] = (int)(targetKpaScaled * (spool + ringing)) + noise;
+	}
+}
+
+int main()
+{
+	BoostControlParameters params;
+
+	// Same as BoostControl::populateDefaultParameters.
+	params.maxKpaScaled = 100000;
+	params.deEnergiseKpaScaled = 50000;
+	params.pidActiveKpaScaled = 75000;
+	params.pidPropConstScaled = 6000;
+	params.pidIntegConstScaled = 1000;
+	params.pidDerivConstScaled = 500;
+	params.maxDuty = 950;
+	params.zeroPointDuty = 500;
+
+	int* trajectory = new int[BENCH_STEPS];
+	generateTrajectory(trajectory, BENCH_STEPS, params.maxKpaScaled);
+
+	FixedPointPid fixedPid(BENCH_INTEG_SUM_TIME * 1000000);
+	FloatPid floatPid;
+	LegacyFloatPid legacyPid;
+
+	fixedPid.setParameters(&params);
+	floatPid.setParameters(&params);
+
+	// Numerical equivalence.
+
+	double maxError = 0;
+	double sumError = 0;
+
+	for(unsigned index = 0; index < BENCH_STEPS; index++)
+	{
+		int32_t fixedDuty = fixedPid.process(params.maxKpaScaled, trajectory[index], BENCH_STEP_US, 0);
+		float floatDuty = floatPid.process(params.maxKpaScaled, trajectory[index], BENCH_STEP_US);
+
+		double error = fabs((double)fixedDuty / FIXED_PID_ONE - floatDuty);
+
+		sumError += error;
+		if(error > maxError) maxError = error;
+	}
+
+	printf("Equivalence over %u steps (Q%u.%u vs float):\n", BENCH_STEPS, 32 - FIXED_PID_FRAC_BITS, FIXED_PID_FRAC_BITS);
+	printf("  Max duty error:  %.6f %%\n", maxError);
+	printf("  Mean duty error: %.6f %%\n", sumError / BENCH_STEPS);
+
+	// Timing. The sink stops the compiler optimising the loops away.
+
+	volatile int64_t sink = 0;
+	int64_t localSink = 0;
+
+	fixedPid.reset();
+	uint64_t start = readCycles();
+
+	for(unsigned index = 0; index < BENCH_STEPS; index++)
+	{
+		localSink += fixedPid.process(params.maxKpaScaled, trajectory[index], BENCH_STEP_US, 0);
+	}
+
+	uint64_t fixedCycles = readCycles() - start;
+
+	floatPid.reset();
+	start = readCycles();
+
+	for(unsigned index = 0; index < BENCH_STEPS; index++)
+	{
+		localSink += (int64_t)floatPid.process(params.maxKpaScaled, trajectory[index], BENCH_STEP_US);
+	}
+
+	uint64_t floatCycles = readCycles() - start;
+
+	legacyPid.reset();
+	start = readCycles();
+
+	for(unsigned index = 0; index < BENCH_STEPS; index++)
+	{
+		localSink += (int64_t)legacyPid.process(&params, trajectory[index], BENCH_STEP_US);
+	}
+
+	uint64_t legacyCycles = readCycles() - start;
+
+	sink = localSink;
+
+#if defined(__x86_64__) || defined(__i386__)
+	const char* unit = "cycles";
+#else
+	const char* unit = "ns";
+#endif
+
+	printf("Timing per step (host %s, hardware FPU so float is flattered vs a Cortex-M0+):\n", unit);
+	printf("  Fixed point:     %.2f\n", (double)fixedCycles / BENCH_STEPS);
+	printf("  Float reference: %.2f\n", (double)floatCycles / BENCH_STEPS);
+	printf("  Legacy float:    %.2f\n", (double)legacyCycles / BENCH_STEPS);
+
+	delete[] trajectory;
+
+	if(maxError > BENCH_MAX_DUTY_ERROR)
+	{
+		printf("FAILED: fixed point duty differs from float by more than %.3f %%\n", BENCH_MAX_DUTY_ERROR);
+		return 1;
+	}
+
+	(void)sink;
+
+	return 0;
+}
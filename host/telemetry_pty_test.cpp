@@ -0,0 +1,202 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+
+#include "BoostControl.hpp"
+#include "HalSerial.hpp"
+#include "SimHal.hpp"
+#include "TelemetryDecoder.hpp"
+#include "TelemetryRecorder.hpp"
+#include "TelemetryStream.hpp"
+#include "TurboPlant.hpp"
+
+// End to end test of the telemetry stream on Linux. The firmware runs against the simulated HAL with its USB serial
+// port attached to the master side of a pseudo-terminal. The slave side stands in for /dev/ttyACM0 and is read the way
+// telemetry_recorder reads the real port. Each decimation is checked for lost or corrupt records, including with printf
+// text mixed into the stream, and the records are checked to survive a round trip through a columnar file.
+
+/** Length of each run, in seconds. */
+#define TEST_RUN_S 5
+
+/** Simulation step, in microseconds. Matches CONTROL_LATCH_PERIOD_US. */
+#define TEST_STEP_US 1000
+
+/** VSys, in volts. */
+#define TEST_VSYS 5.0
+
+/** Text written to the port part way through, as printf would. */
+static const char testText[] = "Map supply V: 5.000\n";
+
+/** Bosch 0261230119 transfer function constants. Match BoschMap_0261230119. */
+static const double boschMapC0 = 5.4 / 280.0;
+static const double boschMapC1 = 0.85 / 280.0;
+
+/** MAP sensor input divider ratio. Matches BoostControl. */
+static const double mapDividerRatio = 3.2 / (2.2 + 3.2);
+
+/** Read everything waiting on the slave side into the decoder. */
+static void readSlave(int slaveFd, TelemetryDecoder* decoder)
+{
+	uint8_t buffer[4096];
+	ssize_t len;
+
+	while((len = read(slaveFd, buffer, sizeof(buffer))) > 0) decoder -> push(buffer, len);
+}
+
+static bool runDecimation(unsigned decimation, const char* columnarPath)
+{
+	int masterFd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+	if(masterFd < 0 || grantpt(masterFd) != 0 || unlockpt(masterFd) != 0)
+	{
+		printf("FAILED: can't create a pseudo-terminal\n");
+		return false;
+	}
+
+	int slaveFd = open(ptsname(masterFd), O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+	struct termios tio;
+	tcgetattr(slaveFd, &tio);
+	cfmakeraw(&tio);
+	tcsetattr(slaveFd, TCSANOW, &tio);
+
+	sim_hal_reset();
+	sim_serial_attach(masterFd);
+
+	TurboPlantConfig plantConfig;
+	TurboPlant::populateDefaultConfig(&plantConfig);
+
+	TurboPlant plant(&plantConfig, TEST_STEP_US / 1000000.0);
+
+	sim_adc_set_voltage(CONTROL_VSYS_ADC_INPUT, TEST_VSYS / 3.0);
+
+	BoostControl boostControl;
+	TelemetryStream stream(&boostControl);
+
+	// As the console telemetry on command would.
+	stream.setEnabled(true);
+	stream.setDecimation(decimation);
+
+	TelemetryDecoder decoder;
+	TelemetryRecorder recorder;
+	TelemetryCounters lastCounters = {};
+	std::vector<BoostTelemetryRecord> decoded;
+
+	recorder.open(columnarPath, TELEMETRY_RECORDER_COLUMNAR);
+
+	decoder.onRecord = [&](const BoostTelemetryRecord* record) {
+		decoded.push_back(*record);
+		recorder.write(record);
+	};
+
+	decoder.onCounters = [&](const TelemetryCounters* counters) { lastCounters = *counters; };
+
+	for(unsigned step = 0; step < TEST_RUN_S * 1000000 / TEST_STEP_US; step++)
+	{
+		double kpa = plant.step(sim_pwm_get_duty(CONTROL_SOLENOID_CHAN_A_GPIO));
+
+		double mapSensorVolts = TEST_VSYS * (boschMapC0 + boschMapC1 * (kpa + STD_ATM_PRESSURE / 1000.0));
+
+		sim_adc_set_voltage(CONTROL_MAP_ADC_INPUT, mapSensorVolts * mapDividerRatio);
+
+		boostControl.poll();
+		stream.poll();
+
+		if(step == TEST_RUN_S * 1000000 / TEST_STEP_US / 2)
+		{
+			hal_serial_write((const uint8_t*)testText, sizeof(testText) - 1);
+		}
+
+		sim_advance_us(TEST_STEP_US);
+
+		readSlave(slaveFd, &decoder);
+	}
+
+	// Let the port send whatever is left.
+	sim_advance_us(100000);
+	readSlave(slaveFd, &decoder);
+
+	recorder.close();
+
+	close(slaveFd);
+	close(masterFd);
+
+	std::vector<BoostTelemetryRecord> readBack;
+	bool readOk = TelemetryRecorder::readColumnar(columnarPath, readBack);
+
+	unsigned expected = boostControl.getTelemetryRecordCount() / decimation;
+
+	printf("Decimation %u: %u records decoded of %u logged, %llu bad frames, %llu missing, %u port drops\n", decimation,
+		(unsigned)decoded.size(), boostControl.getTelemetryRecordCount(),
+		(unsigned long long)decoder.getBadFrameCount(), (unsigned long long)decoder.getMissingRecordCount(),
+		stream.getStreamDropCount());
+
+	bool ok = true;
+
+	if(decoded.size() + 1 < expected || decoded.size() > expected)
+	{
+		printf("FAILED: expected %u records\n", expected);
+		ok = false;
+	}
+
+	// Every gap in the sequence should be exactly the decimation.
+	if(decoder.getMissingRecordCount() != (decoded.size() - 1) * (decimation - 1))
+	{
+		printf("FAILED: records were lost\n");
+		ok = false;
+	}
+
+	// Only the text should fail to decode.
+	if(decoder.getBadFrameCount() != 1)
+	{
+		printf("FAILED: expected only the text to be a bad frame\n");
+		ok = false;
+	}
+
+	if(boostControl.getTelemetryDropCount() || stream.getStreamDropCount() || lastCounters.decimation != decimation)
+	{
+		printf("FAILED: records were dropped, or the counters weren't received\n");
+		ok = false;
+	}
+
+	if(!readOk || readBack.size() != decoded.size() ||
+		memcmp(readBack.data(), decoded.data(), decoded.size() * sizeof(BoostTelemetryRecord)) != 0)
+	{
+		printf("FAILED: columnar file didn't read back the same records\n");
+		ok = false;
+	}
+
+	return ok;
+}
+
+int main()
+{
+	char columnarPath[] = "/tmp/telemetry_pty_test_XXXXXX";
+
+	int fd = mkstemp(columnarPath);
+
+	if(fd < 0)
+	{
+		printf("FAILED: can't create a temporary file\n");
+		return 1;
+	}
+
+	close(fd);
+
+	bool ok = true;
+
+	static const unsigned decimations[] = {1, 4};
+
+	for(unsigned decimation : decimations)
+	{
+		if(!runDecimation(decimation, columnarPath)) ok = false;
+	}
+
+	unlink(columnarPath);
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "TelemetryDecoder.hpp"
+#include "TelemetryRecorder.hpp"
+
+// Records the binary telemetry stream from the Pico USB serial port to a CSV or columnar file.
+// The stream is off until enabled through the serial console, so this turns it on, and off again when done. Anything
+// else on the port, such as printf text and the console replies, is skipped.
+//
+// Usage: telemetry_recorder <serial device> <output file> [-f csv|columnar] [-s seconds]
+// Runs until the time is up or it is interrupted.
+
+static volatile bool stopRequested = false;
+
+static void onSignal(int)
+{
+	stopRequested = true;
+}
+
+/** Send a serial console command. */
+static bool writeCommand(int fd, const char* command)
+{
+	return write(fd, command, strlen(command)) >= 0 && write(fd, "\n", 1) >= 0;
+}
+
+int main(int argc, char** argv)
+{
+	const char* devicePath = NULL;
+	const char* outputPath = NULL;
+	unsigned format = TELEMETRY_RECORDER_CSV;
+	double runS = 0;
+	bool usage = false;
+
+	for(int index = 1; index < argc; index++)
+	{
+		if(strcmp(argv[index], "-f") == 0 && index + 1 < argc)
+		{
+			index++;
+
+			if(strcmp(argv[index], "csv") == 0) format = TELEMETRY_RECORDER_CSV;
+			else if(strcmp(argv[index], "columnar") == 0) format = TELEMETRY_RECORDER_COLUMNAR;
+			else usage = true;
+		}
+		else if(strcmp(argv[index], "-s") == 0 && index + 1 < argc) runS = atof(argv[++index]);
+		else if(!devicePath) devicePath = argv[index];
+		else if(!outputPath) outputPath = argv[index];
+		else usage = true;
+	}
+
+	if(usage || !devicePath || !outputPath)
+	{
+		fprintf(stderr, "Usage: %s <serial device> <output file> [-f csv|columnar] [-s seconds]\n", argv[0]);
+		return 1;
+	}
+
+	int fd = open(devicePath, O_RDWR | O_NOCTTY);
+
+	if(fd < 0)
+	{
+		fprintf(stderr, "Can't open %s\n", devicePath);
+		return 1;
+	}
+
+	// Binary, with no line discipline.
+	struct termios tio;
+
+	if(tcgetattr(fd, &tio) == 0)
+	{
+		cfmakeraw(&tio);
+		tio.c_cc[VMIN] = 0;
+		tio.c_cc[VTIME] = 1;
+
+		tcsetattr(fd, TCSANOW, &tio);
+	}
+
+	TelemetryRecorder recorder;
+
+	if(!recorder.open(outputPath, format))
+	{
+		fprintf(stderr, "Can't create %s\n", outputPath);
+		return 1;
+	}
+
+	TelemetryDecoder decoder;
+	TelemetryCounters lastCounters = {};
+
+	if(!writeCommand(fd, "telemetry on"))
+	{
+		fprintf(stderr, "Can't write to %s\n", devicePath);
+		return 1;
+	}
+
+	decoder.onRecord = [&](const BoostTelemetryRecord* record) { recorder.write(record); };
+	decoder.onCounters = [&](const TelemetryCounters* counters) { lastCounters = *counters; };
+
+	signal(SIGINT, onSignal);
+	signal(SIGTERM, onSignal);
+
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	uint8_t buffer[4096];
+
+	while(!stopRequested)
+	{
+		ssize_t len = read(fd, buffer, sizeof(buffer));
+
+		if(len > 0) decoder.push(buffer, len);
+
+		if(runS > 0)
+		{
+			struct timespec now;
+			clock_gettime(CLOCK_MONOTONIC, &now);
+
+			if(now.tv_sec - start.tv_sec + (now.tv_nsec - start.tv_nsec) / 1e9 >= runS) break;
+		}
+	}
+
+	writeCommand(fd, "telemetry off");
+
+	close(fd);
+
+	bool ok = recorder.close();
+
+	fprintf(stderr, "Records: %llu, bad frames: %llu, missing: %llu\n", (unsigned long long)recorder.getRowCount(),
+		(unsigned long long)decoder.getBadFrameCount(), (unsigned long long)decoder.getMissingRecordCount());
+	fprintf(stderr, "Pico: %u logged, %u dropped by core 1, %u dropped by the port, decimation %u\n",
+		lastCounters.recordCount, lastCounters.ringDropCount, lastCounters.streamDropCount, lastCounters.decimation);
+
+	return ok ? 0 : 1;
+}
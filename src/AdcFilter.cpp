@@ -0,0 +1,5 @@
+#include "AdcFilter.hpp"
+
+AdcFilter::~AdcFilter()
+{
+}
@@ -0,0 +1,28 @@
+#ifndef ADC_FILTER_H
+#define ADC_FILTER_H
+
+#include <stdint.h>
+
+/**
+ * Base of all filters applied to latched raw ADC values.
+ * Filters do their work as each value is pushed so that reading the output is always O(1), no matter how many values the
+ * filter spans.
+ */
+class AdcFilter
+{
+	public:
+
+		virtual ~AdcFilter();
+
+		/**
+		 * Push a newly latched raw ADC value through the filter.
+		 */
+		virtual void push(uint32_t value) = 0;
+
+		/**
+		 * Get the current filter output, in raw ADC units.
+		 */
+		virtual uint32_t output() = 0;
+};
+
+#endif
@@ -1,52 +1,42 @@
 #include "AdcReader.hpp"
+#include "BoxcarAdcFilter.hpp"
 
 AdcReader::~AdcReader()
 {
-	delete[] _rawVals;
+	delete _filter;
 }
 
 AdcReader::AdcReader(unsigned adcInput, unsigned avgCount, double vRef, unsigned adcResolution, double scale) :
-	_adcInput(adcInput), _avgCount(avgCount)
+	_adcInput(adcInput)
 {
-	_rawVals = new uint32_t[avgCount];
-
-	for(int index = 0; index < avgCount; index++)
-	{
-		_rawVals[index] = 0;
-	}
+	_filter = new BoxcarAdcFilter(avgCount);
 
 	_voltageScale = scale * vRef / (double)(1 << adcResolution);
 }
 
 void AdcReader::latch()
 {
-	_rawVals[_curRawValPosn] = _readFromAdc(_adcInput);
-
-	_curRawValPosn++;
-
-	if(_curRawValPosn >= _avgCount) _curRawValPosn = 0;
+	_filter -> push(_readFromAdc(_adcInput));
 }
 
 uint32_t AdcReader::readRaw()
 {
-	return __calcRawAvgVals();
+	return _filter -> output();
 }
 
 double AdcReader::read()
 {
-	uint32_t rawAvgVal = __calcRawAvgVals();
-
-	return (double)rawAvgVal * _voltageScale;
+	return (double)_filter -> output() * _voltageScale;
 }
 
-uint32_t AdcReader::__calcRawAvgVals()
+void AdcReader::setFilter(AdcFilter* filter)
 {
-	uint32_t sum = 0;
+	delete _filter;
 
-	for(unsigned index = 0; index < _avgCount; index++)
-	{
-		sum += _rawVals[index];
-	}
+	_filter = filter;
+}
 
-	return sum / _avgCount;
+double AdcReader::getVoltageScale()
+{
+	return _voltageScale;
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 
+#include "AdcFilter.hpp"
+
 /**
  * Base of all Analog to Digital reading.
  */
@@ -23,43 +25,42 @@ class AdcReader
 		AdcReader(unsigned adcInput, unsigned avgCount, double vRef, unsigned adcResolution, double scale);
 
 		/**
-		 * Read the ADC.
+		 * Read the ADC and push the value through the filter.
 		 */
 		void latch();
 
 		/**
-		 * Return the raw averaged ADC value.
+		 * Return the raw filtered ADC value.
 		 * @note This has _not_ been converted to a voltage.
 		 */
 		uint32_t readRaw();
 
 		/**
-		 * Read the averaged ADC voltage.
+		 * Read the filtered ADC voltage.
 		 */
 		double read();
 
-	protected:
-
-		/** Read raw ADC input value. */
-		virtual uint32_t _readFromAdc(unsigned adcInput) = 0;
-
-	private:
-
 		/**
-		 * Calculate the ADC averge values across all raw latched data.
+		 * Replace the filter applied to latched values. By default this is a boxcar average over avgCount values.
+		 * @param filter Filter to use. Owned by this.
+		 * @note This must not be called while latching could be happening, eg from a timer interrupt.
 		 */
-		uint32_t __calcRawAvgVals();
+		void setFilter(AdcFilter* filter);
 
 		/**
-		 * Total number of raw ADC values averaged over.
+		 * Get the scale that converts a raw ADC value into a voltage.
 		 */
-		unsigned _avgCount;
+		double getVoltageScale();
+
+	protected:
 
-		/** Raw ADC values that have been latched. */
-		uint32_t* _rawVals;
+		/** Read raw ADC input value. */
+		virtual uint32_t _readFromAdc(unsigned adcInput) = 0;
+
+	private:
 
-		/** The current position that raw vals are written into. */
-		unsigned _curRawValPosn = 0;
+		/** Filter that latched raw ADC values are pushed through. */
+		AdcFilter* _filter;
 
 		/** ADC Input to read from. */
 		unsigned _adcInput;
@@ -0,0 +1,71 @@
+#include <math.h>
+
+#include "BiquadAdcFilter.hpp"
+
+BiquadAdcFilter::~BiquadAdcFilter()
+{
+}
+
+BiquadAdcFilter::BiquadAdcFilter(int32_t b0, int32_t b1, int32_t b2, int32_t a1, int32_t a2) :
+	_b0(b0), _b1(b1), _b2(b2), _a1(a1), _a2(a2)
+{
+}
+
+BiquadAdcFilter* BiquadAdcFilter::createLowPass(double cutoffHz, double sampleRateHz)
+{
+	// From the RBJ audio EQ cookbook.
+	double w0 = 2.0 * M_PI * cutoffHz / sampleRateHz;
+	double alpha = sin(w0) / (2.0 * M_SQRT1_2);
+	double cosW0 = cos(w0);
+
+	double a0 = 1.0 + alpha;
+
+	double scale = (double)(1 << BIQUAD_ADC_FILTER_COEFF_FRAC_BITS) / a0;
+
+	int32_t a1 = lround(-2.0 * cosW0 * scale);
+	int32_t a2 = lround((1.0 - alpha) * scale);
+
+	// The feed forward coefficients are derived from the rounded feedback ones, rather than each rounded on its own, so
+	// that b0 + b1 + b2 is exactly 1 + a1 + a2. ie The DC gain is exactly 1 and a steady value comes out unchanged.
+	int32_t bSum = (1 << BIQUAD_ADC_FILTER_COEFF_FRAC_BITS) + a1 + a2;
+
+	int32_t b0 = lround((1.0 - cosW0) / 2.0 * scale);
+	int32_t b1 = bSum - 2 * b0;
+
+	return new BiquadAdcFilter(b0, b1, b0, a1, a2);
+}
+
+void BiquadAdcFilter::push(uint32_t value)
+{
+	int32_t x = value;
+
+	if(!_primed)
+	{
+		// Start in the steady state for the first value rather than ringing up from zero.
+		_x1 = x;
+		_x2 = x;
+		_y1 = x << BIQUAD_ADC_FILTER_STATE_FRAC_BITS;
+		_y2 = _y1;
+
+		_primed = true;
+	}
+
+	int64_t acc = ((int64_t)_b0 * x + (int64_t)_b1 * _x1 + (int64_t)_b2 * _x2) << BIQUAD_ADC_FILTER_STATE_FRAC_BITS;
+
+	acc -= (int64_t)_a1 * _y1 + (int64_t)_a2 * _y2;
+
+	// Round to nearest, keeping the state's fractional bits.
+	int32_t y = (acc + ((int64_t)1 << (BIQUAD_ADC_FILTER_COEFF_FRAC_BITS - 1))) >> BIQUAD_ADC_FILTER_COEFF_FRAC_BITS;
+
+	_x2 = _x1;
+	_x1 = x;
+	_y2 = _y1;
+	_y1 = y;
+}
+
+uint32_t BiquadAdcFilter::output()
+{
+	int32_t y = (_y1 + (1 << (BIQUAD_ADC_FILTER_STATE_FRAC_BITS - 1))) >> BIQUAD_ADC_FILTER_STATE_FRAC_BITS;
+
+	return y < 0 ? 0 : y;
+}
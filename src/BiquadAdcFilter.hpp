@@ -0,0 +1,66 @@
+#ifndef BIQUAD_ADC_FILTER_H
+#define BIQUAD_ADC_FILTER_H
+
+#include <stdint.h>
+
+#include "AdcFilter.hpp"
+
+/** Number of fractional bits of the biquad filter coefficients. */
+#define BIQUAD_ADC_FILTER_COEFF_FRAC_BITS 28
+
+/**
+ * Number of fractional bits kept of the previous outputs. Rounding each output to a whole ADC value before feeding it
+ * back would leave low cutoff filters settled well away from their input.
+ */
+#define BIQUAD_ADC_FILTER_STATE_FRAC_BITS 12
+
+/**
+ * Fixed point second order IIR (biquad) filter, in direct form I.
+ * Coefficients are Q3.28, previous outputs are Q.12 and the accumulator is 64 bits so 16 bit ADC values can be filtered
+ * without overflow.
+ */
+class BiquadAdcFilter : public AdcFilter
+{
+	public:
+
+		virtual ~BiquadAdcFilter();
+
+		/**
+		 * All coefficients are normalised so that a0 is 1 and are in Q3.28 fixed point.
+		 * y[n] = b0.x[n] + b1.x[n-1] + b2.x[n-2] - a1.y[n-1] - a2.y[n-2]
+		 */
+		BiquadAdcFilter(int32_t b0, int32_t b1, int32_t b2, int32_t a1, int32_t a2);
+
+		/**
+		 * Create a Butterworth (Q = 1/sqrt(2)) low pass filter.
+		 * @note The floating point maths only happens here, not as values are pushed.
+		 * @param cutoffHz The -3dB cutoff frequency.
+		 * @param sampleRateHz The rate values are pushed at. ie The latch rate.
+		 */
+		static BiquadAdcFilter* createLowPass(double cutoffHz, double sampleRateHz);
+
+		// Impl.
+		void push(uint32_t value);
+
+		// Impl.
+		uint32_t output();
+
+	private:
+
+		/** Feed forward coefficients. */
+		int32_t _b0, _b1, _b2;
+
+		/** Feedback coefficients. */
+		int32_t _a1, _a2;
+
+		/** Previous inputs. */
+		int32_t _x1 = 0, _x2 = 0;
+
+		/** Previous outputs, with BIQUAD_ADC_FILTER_STATE_FRAC_BITS fractional bits. */
+		int32_t _y1 = 0, _y2 = 0;
+
+		/** Whether a value has been pushed yet. The first value primes the filter state. */
+		bool _primed = false;
+};
+
+#endif
@@ -4,29 +4,78 @@ extern bool debug;
 
 BoostControl::~BoostControl()
 {
+	delete _pid;
+	delete _autoTuner;
+	delete _learner;
+	delete _snapshotBuffer;
 	delete _pwmControl;
-	delete _vsysRefAdc;
 	delete _mapSensor;
+	delete _mapAdc;
+	delete _vsysRefAdc;
+	delete _adcCapture;
 }
 
 BoostControl::BoostControl()
 {
 	populateDefaultParameters(&_curParams);
 
+	_pid = new FixedPointPid(CONTROL_PID_INTEG_SUM_TIME * 1000000);
+
+	_snapshotBuffer = new BoostControlSnapshotBuffer();
+
+	_autoTuner = new RelayAutoTuner();
+
+	_learner = new ZeroPointLearner();
+
+	__publishParameters();
+
 	_pwmControl = new PicoPwm(CONTROL_SOLENOID_CHAN_A_GPIO, CONTROL_SOLENOID_CHAN_A_GPIO + 1, CONTROL_SOLENOID_FREQ, 0, 0, true,
 			CONTROL_SOLENOID_DISABLE_GATE_STATE);
 
+	// Voltage divider scale of the map sensor input is calculated from (R1 + R2) / R2.
+	double mapVoltageScale = (2.2 + 3.2) / 3.2;
+
+#if CONTROL_ADC_DMA_CAPTURE
+
+	_adcCapture = new PicoAdcDmaCapture((1 << CONTROL_MAP_ADC_INPUT) | (1 << CONTROL_VSYS_ADC_INPUT),
+		CONTROL_ADC_DMA_SAMPLE_RATE, CONTROL_ADC_DMA_RING_BITS);
+
+	// Started first, as the readers take the position they start consuming from when constructed.
+	_adcCapture -> start();
+
+	// Create ADC reader to read VSys. The Pico divides this voltage by 3.
+	_vsysRefAdc = new PicoDmaAdcReader(_adcCapture, CONTROL_VSYS_ADC_INPUT, 10, 3.0, 3.0);
+
+	_mapAdc = new PicoDmaAdcReader(_adcCapture, CONTROL_MAP_ADC_INPUT, 10, 3.0, mapVoltageScale);
+
+#else
+
 	// Create ADC reader to read VSys. The Pico divides this voltage by 3.
-	_vsysRefAdc = new PicoAdcReader(3, 10, 3.0, 3.0);
+	_vsysRefAdc = new PicoAdcReader(CONTROL_VSYS_ADC_INPUT, 10, 3.0, 3.0);
+
+	_mapAdc = new PicoAdcReader(CONTROL_MAP_ADC_INPUT, 10, 3.0, mapVoltageScale);
+
+#endif
+
+	// Set before anything is latched.
+#if CONTROL_MAP_FILTER == CONTROL_MAP_FILTER_EMA
+	_mapAdc -> setFilter(new EmaAdcFilter(CONTROL_MAP_FILTER_EMA_SHIFT));
+#elif CONTROL_MAP_FILTER == CONTROL_MAP_FILTER_MEDIAN
+	_mapAdc -> setFilter(new MedianAdcFilter(CONTROL_MAP_FILTER_MEDIAN_LENGTH));
+#elif CONTROL_MAP_FILTER == CONTROL_MAP_FILTER_BIQUAD
+	_mapAdc -> setFilter(BiquadAdcFilter::createLowPass(CONTROL_MAP_FILTER_CUTOFF_HZ, 1000000.0 / CONTROL_LATCH_PERIOD_US));
+#endif
+
+	_mapSensor = new BoschMap_0261230119(_mapAdc, _vsysRefAdc);
 
-	// Start map sensor on ADC Channel 0. This should map to GP26.
-	// Voltage divider scale is calculated from (R1 + R2) / R2.
-	_mapSensor = new BoschMap_0261230119(0, 3.0, (2.2 + 3.2) / 3.2, _vsysRefAdc);
+	_vsysMilliVoltsPerRaw = _vsysRefAdc -> getVoltageScale() * 1000.0 * 65536.0;
 
-	_nextBoostLatchTime = get_absolute_time();
+	_nextBoostLatchTime = hal_get_absolute_time();
 	_nextBoostReadTime = _nextBoostLatchTime;
 	_lastSolenoidProcTime = _nextBoostLatchTime;
 
+	__resetLoopTiming();
+
 	_initialised = true;
 }
 
@@ -52,6 +101,15 @@ void BoostControl::getParameters(BoostControlParameters* params)
 	params -> maxDuty = _curParams.maxDuty;
 
 	params -> zeroPointDuty = _curParams.zeroPointDuty;
+
+	for(unsigned boostIndex = 0; boostIndex < FEED_FORWARD_BOOST_POINTS; boostIndex++)
+	{
+		for(unsigned loadIndex = 0; loadIndex < FEED_FORWARD_LOAD_POINTS; loadIndex++)
+		{
+			params -> feedForwardDuty[boostIndex][loadIndex] = _curParams.feedForwardDuty[boostIndex][loadIndex];
+			params -> learnedDuty[boostIndex][loadIndex] = _curParams.learnedDuty[boostIndex][loadIndex];
+		}
+	}
 }
 
 void BoostControl::setParameters(BoostControlParameters* params)
@@ -71,6 +129,18 @@ void BoostControl::setParameters(BoostControlParameters* params)
 	__setMaxDutyScaled(params -> maxDuty);
 
 	__setZeroPointDutyScaled(params -> zeroPointDuty);
+
+	for(unsigned boostIndex = 0; boostIndex < FEED_FORWARD_BOOST_POINTS; boostIndex++)
+	{
+		for(unsigned loadIndex = 0; loadIndex < FEED_FORWARD_LOAD_POINTS; loadIndex++)
+		{
+			__setFeedForwardDutyScaled(boostIndex, loadIndex, params -> feedForwardDuty[boostIndex][loadIndex]);
+			__setLearnedDutyScaled(boostIndex, loadIndex, params -> learnedDuty[boostIndex][loadIndex]);
+		}
+	}
+
+	// Publish them all at once so the control loop never sees a mix of old and new parameters.
+	__publishParameters();
 }
 
 void BoostControl::populateDefaultParameters(BoostControlParameters* params)
@@ -92,33 +162,366 @@ void BoostControl::populateDefaultParameters(BoostControlParameters* params)
 	params -> maxDuty = 950;
 
 	params -> zeroPointDuty = 500;
+
+	// No feed forward beyond the zero point duty.
+	FeedForwardMap::populateDefaultTable(params);
 }
 
 void BoostControl::poll()
 {
-	absolute_time_t curTime = get_absolute_time();
+	hal_time_t curTime = hal_get_absolute_time();
 
 	if(debug || curTime >= _nextBoostLatchTime)
 	{
 		// Latch data at approximately 1000hz. This is a higher frequency to allow for averaging to be effective.
-		_nextBoostLatchTime = delayed_by_ms(_nextBoostLatchTime, 1);
+		_nextBoostLatchTime = hal_delayed_by_us(_nextBoostLatchTime, CONTROL_LATCH_PERIOD_US);
 
-		_mapSensor -> latch();
+		latchTick();
 	}
 
 	if(debug || curTime >= _nextBoostReadTime)
 	{
 		// Process map sensor and control solenoid at approximately 100hz
-		_nextBoostReadTime = delayed_by_ms(_nextBoostReadTime, 10);
+		_nextBoostReadTime = hal_delayed_by_us(_nextBoostReadTime, CONTROL_STEP_PERIOD_US);
+
+		controlTick();
+
+		processCommands();
+	}
+}
+
+void BoostControl::latchTick()
+{
+	uint32_t curTimeUs = hal_time_us_32();
 
-		_mapKpaScaled = _mapSensor -> readKpa() * 1000.0;
+	if(_lastLatchTimeUs)
+	{
+		// Unsigned maths copes with the timer wrapping.
+		uint32_t period = curTimeUs - _lastLatchTimeUs;
+
+		uint32_t jitter = period > CONTROL_LATCH_PERIOD_US ? period - CONTROL_LATCH_PERIOD_US :
+			CONTROL_LATCH_PERIOD_US - period;
+
+		_loopTiming.latchPeriodUs = period;
+
+		if(jitter > _loopTiming.latchJitterMaxUs) _loopTiming.latchJitterMaxUs = jitter;
+	}
+
+	_lastLatchTimeUs = curTimeUs;
+
+	_mapSensor -> latch();
+
+	// The tuner sees every latch, rather than every step, to time the oscillation and find its peaks more accurately.
+	if(_autoTuneActive) _autoTuner -> sample((int)_mapSensor -> readKpaScaled() - STD_ATM_PRESSURE, curTimeUs);
+}
+
+void BoostControl::controlTick()
+{
+	uint32_t curTimeUs = hal_time_us_32();
+
+	if(_lastStepTimeUs)
+	{
+		uint32_t period = curTimeUs - _lastStepTimeUs;
+
+		uint32_t jitter = period > CONTROL_STEP_PERIOD_US ? period - CONTROL_STEP_PERIOD_US :
+			CONTROL_STEP_PERIOD_US - period;
+
+		_loopTiming.stepPeriodUs = period;
+
+		if(period < _loopTiming.stepPeriodMinUs) _loopTiming.stepPeriodMinUs = period;
+		if(period > _loopTiming.stepPeriodMaxUs) _loopTiming.stepPeriodMaxUs = period;
+		if(jitter > _loopTiming.stepJitterMaxUs) _loopTiming.stepJitterMaxUs = jitter;
+
+		if(period > CONTROL_STEP_PERIOD_US + CONTROL_STEP_PERIOD_US / 2) _loopTiming.stepLateCount++;
+	}
+
+	_lastStepTimeUs = curTimeUs;
 
-		double boost_atm_scaled = (double)_mapKpaScaled - STD_ATM_PRESSURE;
+	_loopTiming.stepCount++;
 
-		_energised = boost_atm_scaled >= _curParams.deEnergiseKpaScaled;
+	// Feed forward at the last step's operating point, to compare with once a pending learned offset is published back.
+	int32_t learnTargetKpaScaled = _activeSnapshot.targetKpaScaled;
+	int32_t learnFeedForward = _learnPending ? _activeSnapshot.feedForward.evaluate(learnTargetKpaScaled, _vsysMilliVolts) :
+		0;
 
+	// Pick up any newly published parameters. This is all or nothing, so a step never sees a mix of old and new.
+	if(_snapshotBuffer -> fetch(&_activeSnapshot, &_activeSnapshotVersion))
+	{
+		_pid -> setGains(&_activeSnapshot.pidGains);
+
+		if(_learnPending && _activeSnapshot.params.learnedDuty[_learnedOffset.boostIndex][_learnedOffset.loadIndex] ==
+			_learnedOffset.dutyScaled)
+		{
+			// The learned offset is in the feed forward from this step on. Take exactly what it changed by, at the same
+			// operating point, out of the integral term so the output doesn't step. The PID is still settled, so the
+			// learner carries on.
+			_pid -> shiftIntegTerm(_activeSnapshot.feedForward.evaluate(learnTargetKpaScaled, _vsysMilliVolts) -
+				learnFeedForward);
+
+			_learnPending = false;
+		}
+		else
+		{
+			// Only learn from a PID that has settled under the new parameters.
+			_learner -> reset();
+		}
+	}
+
+	// The latch interrupt pushes into the ADC filters. Masked so that the MAP sensor and VSys readings, including the
+	// VSys reading the MAP sensor scales by, are all from the same latch.
+	uint32_t interrupts = hal_save_and_disable_interrupts();
+
+	_mapKpaScaled = _mapSensor -> readKpaScaled();
+
+	uint32_t vsysRaw = _vsysRefAdc -> readRaw();
+
+	hal_restore_interrupts(interrupts);
+
+	_vsysMilliVolts = ((uint64_t)vsysRaw * _vsysMilliVoltsPerRaw) >> 16;
+
+	if(_autoTuneActive)
+	{
+		__processAutoTune();
+	}
+	else if(_testActive)
+	{
+		__processSolenoidTest();
+	}
+	else
+	{
 		__processControlSolenoid();
 	}
+
+	if(_telemetryEnabled) __logTelemetry(curTimeUs);
+}
+
+void BoostControl::processCommands()
+{
+	BoostControlCommand command;
+
+	while(_commands.pop(&command))
+	{
+		__processCommand(&command);
+	}
+}
+
+bool BoostControl::sendCommand(BoostControlCommand* command)
+{
+	command -> id = _nextCommandId;
+
+	if(!_commands.push(command)) return false;
+
+	_nextCommandId++;
+
+	return true;
+}
+
+bool BoostControl::receiveResponse(BoostControlResponse* response)
+{
+	return _responses.pop(response);
+}
+
+bool BoostControl::readTelemetry(BoostTelemetryRecord* record)
+{
+	return _telemetry.pop(record);
+}
+
+uint32_t BoostControl::getTelemetryRecordCount()
+{
+	return _telemetryRecordCount;
+}
+
+uint32_t BoostControl::getTelemetryDropCount()
+{
+	return _telemetryDropCount;
+}
+
+void BoostControl::__processCommand(BoostControlCommand* command)
+{
+	switch(command -> type)
+	{
+		case BOOST_COMMAND_REQUEST_STATUS:
+
+			__sendResponse(BOOST_RESPONSE_STATUS, command -> id);
+			break;
+
+		case BOOST_COMMAND_RESET_LOOP_TIMING:
+
+			__resetLoopTiming();
+			break;
+
+		case BOOST_COMMAND_PRESET_SWITCH:
+
+			// The PID is reset, with the new preset parameters, on the next step it is active.
+			_pidActive = false;
+
+			_presetIndex = command -> presetIndex;
+
+			// Core 0 doesn't publish a learned offset back once its preset isn't active. It was never taken out of the
+			// integral term, so nothing is lost.
+			_learnPending = false;
+			break;
+
+		case BOOST_COMMAND_START_TEST:
+
+			if(_testActive || _autoTuneActive)
+			{
+				__sendResponse(BOOST_RESPONSE_REJECTED, command -> id);
+			}
+			else
+			{
+				__startTest(command);
+			}
+			break;
+
+		case BOOST_COMMAND_STOP_TEST:
+
+			if(_testActive) __stopTest();
+			break;
+
+		case BOOST_COMMAND_START_AUTO_TUNE:
+
+			if(_testActive || _autoTuneActive)
+			{
+				__sendResponse(BOOST_RESPONSE_REJECTED, command -> id);
+			}
+			else
+			{
+				__startAutoTune(command);
+			}
+			break;
+
+		case BOOST_COMMAND_STOP_AUTO_TUNE:
+
+			if(_autoTuneActive)
+			{
+				// Masked so the latch interrupt isn't part way through feeding the tuner a sample.
+				uint32_t interrupts = hal_save_and_disable_interrupts();
+
+				_autoTuner -> stop();
+				_autoTuneActive = false;
+
+				hal_restore_interrupts(interrupts);
+
+				__stopAutoTune();
+			}
+			break;
+
+		case BOOST_COMMAND_SET_TELEMETRY:
+
+			_telemetryEnabled = command -> telemetryEnabled;
+			break;
+
+		default:
+
+			__sendResponse(BOOST_RESPONSE_REJECTED, command -> id);
+			break;
+	}
+}
+
+bool BoostControl::__sendResponse(uint32_t type, uint32_t commandId)
+{
+	BoostControlResponse response;
+
+	response.type = type;
+	response.commandId = commandId;
+
+	if(type == BOOST_RESPONSE_STATUS) __populateStatus(&response.status);
+
+	if(type == BOOST_RESPONSE_AUTO_TUNE_PROGRESS) response.progress = _autoTuneProgress;
+
+	if(type == BOOST_RESPONSE_AUTO_TUNE_COMPLETE) _autoTuner -> getResult(CONTROL_STEP_PERIOD_US, &response.autoTune);
+
+	if(type == BOOST_RESPONSE_LEARNED_OFFSET) response.learnedOffset = _learnedOffset;
+
+	if(_responses.push(&response)) return true;
+
+	_responseDropCount++;
+
+	return false;
+}
+
+void BoostControl::__logTelemetry(uint32_t curTimeUs)
+{
+	BoostTelemetryRecord record;
+
+	int curBoostScaled = _mapKpaScaled - STD_ATM_PRESSURE;
+
+	record.timeUs = curTimeUs;
+	record.sequence = _telemetryRecordCount;
+
+	record.flags = (_energised ? BOOST_TELEMETRY_ENERGISED : 0) | (_pidActive ? BOOST_TELEMETRY_PID_ACTIVE : 0) |
+		(_testActive ? BOOST_TELEMETRY_TEST_ACTIVE : 0) | (_autoTuneActive ? BOOST_TELEMETRY_AUTO_TUNE_ACTIVE : 0) |
+		(curBoostScaled >= _activeSnapshot.targetKpaScaled ? BOOST_TELEMETRY_MAX_BOOST : 0);
+
+	record.mapRaw = _mapAdc -> readRaw();
+	record.vsysRaw = _vsysRefAdc -> readRaw();
+
+	record.kpaScaled = curBoostScaled;
+	record.errorKpaScaled = _activeSnapshot.targetKpaScaled - curBoostScaled;
+
+	if(_pidActive)
+	{
+		record.propTermScaled = __toTelemetryTerm(_pid -> getPropTerm());
+		record.integTermScaled = __toTelemetryTerm(_pid -> getIntegTerm());
+		record.derivTermScaled = __toTelemetryTerm(_pid -> getDerivTerm());
+	}
+	else
+	{
+		record.propTermScaled = 0;
+		record.integTermScaled = 0;
+		record.derivTermScaled = 0;
+	}
+
+	record.dutyScaled = getCurrentDutyScaled();
+
+	_telemetryRecordCount++;
+
+	if(!_telemetry.push(&record)) _telemetryDropCount++;
+}
+
+int16_t BoostControl::__toTelemetryTerm(int32_t term)
+{
+	// PID fixed point % to % scaled by 10.
+	int32_t termScaled = ((int64_t)term * 10) >> FIXED_PID_FRAC_BITS;
+
+	// Individual terms aren't clamped by the PID, only their sum.
+	if(termScaled > INT16_MAX) return INT16_MAX;
+	if(termScaled < INT16_MIN) return INT16_MIN;
+
+	return termScaled;
+}
+
+void BoostControl::__populateStatus(BoostControlStatus* status)
+{
+	status -> loopTiming = _loopTiming;
+
+	status -> mapSupplyVoltage = _mapSensor -> readSupplyVoltage();
+	status -> mapSensorVoltage = _mapSensor -> readSensorVoltage();
+
+	status -> kpaScaled = getKpaScaled();
+	status -> dutyScaled = getCurrentDutyScaled();
+	status -> paramsVersion = _activeSnapshotVersion;
+	status -> responseDropCount = _responseDropCount;
+	status -> telemetryRecordCount = _telemetryRecordCount;
+	status -> telemetryDropCount = _telemetryDropCount;
+
+	status -> energised = _energised;
+	status -> pidActive = _pidActive;
+	status -> testActive = _testActive;
+	status -> autoTuneActive = _autoTuneActive;
+}
+
+void BoostControl::__resetLoopTiming()
+{
+	_loopTiming.latchPeriodUs = 0;
+	_loopTiming.latchJitterMaxUs = 0;
+	_loopTiming.stepPeriodUs = 0;
+	_loopTiming.stepPeriodMinUs = UINT32_MAX;
+	_loopTiming.stepPeriodMaxUs = 0;
+	_loopTiming.stepJitterMaxUs = 0;
+	_loopTiming.stepLateCount = 0;
+	_loopTiming.stepCount = 0;
 }
 
 bool BoostControl::isEnergised()
@@ -126,6 +529,11 @@ bool BoostControl::isEnergised()
 	return _energised;
 }
 
+int32_t BoostControl::getVsysMilliVolts()
+{
+	return _vsysMilliVolts;
+}
+
 bool BoostControl::isMaxBoostReached()
 {
 	return getKpaScaled() >= (int)_curParams.maxKpaScaled;
@@ -156,6 +564,8 @@ void BoostControl::alterMaxKpaScaled(int maxBoostKpaScaledDelta)
 	int newVal = (int)_curParams.maxKpaScaled + maxBoostKpaScaledDelta;
 
 	if(newVal > 0) _curParams.maxKpaScaled = newVal; else _curParams.maxKpaScaled = 0;
+
+	__publishParameters();
 }
 
 unsigned BoostControl::getDeEnergiseKpaScaled()
@@ -173,6 +583,8 @@ void BoostControl::alterDeEnergiseKpaScaled(int deEnergiseKpaScaledDelta)
 	int newVal = (int)_curParams.deEnergiseKpaScaled + deEnergiseKpaScaledDelta;
 
 	if(newVal > 0) _curParams.deEnergiseKpaScaled = newVal; else _curParams.deEnergiseKpaScaled = 0;
+
+	__publishParameters();
 }
 
 unsigned BoostControl::getPidActiveKpaScaled()
@@ -190,6 +602,8 @@ void BoostControl::alterPidActiveKpaScaled(int delta)
 	int newVal = (int)_curParams.pidActiveKpaScaled + delta;
 
 	if(newVal > 0) _curParams.pidActiveKpaScaled = newVal; else _curParams.pidActiveKpaScaled = 0;
+
+	__publishParameters();
 }
 
 unsigned BoostControl::getPidPropConstScaled()
@@ -207,6 +621,8 @@ void BoostControl::alterPidPropConstScaled(int pidPropConstScaledDelta)
 	int newVal = (int)_curParams.pidPropConstScaled + pidPropConstScaledDelta;
 
 	if(newVal > 0) _curParams.pidPropConstScaled = newVal; else _curParams.pidPropConstScaled = 0;
+
+	__publishParameters();
 }
 
 unsigned BoostControl::getPidIntegConstScaled()
@@ -224,6 +640,8 @@ void BoostControl::alterPidIntegConstScaled(int pidIntegConstScaledDelta)
 	int newVal = (int)_curParams.pidIntegConstScaled + pidIntegConstScaledDelta;
 
 	if(newVal > 0) _curParams.pidIntegConstScaled = newVal; else _curParams.pidIntegConstScaled = 0;
+
+	__publishParameters();
 }
 
 unsigned BoostControl::getPidDerivConstScaled()
@@ -241,6 +659,8 @@ void BoostControl::alterPidDerivConstScaled(int pidDerivConstScaledDelta)
 	int newVal = (int)_curParams.pidDerivConstScaled + pidDerivConstScaledDelta;
 
 	if(newVal > 0) _curParams.pidDerivConstScaled = newVal; else _curParams.pidDerivConstScaled = 0;
+
+	__publishParameters();
 }
 
 unsigned BoostControl::getMaxDutyScaled()
@@ -262,6 +682,8 @@ void BoostControl::alterMaxDutyScaled(int maxDutyDelta)
 	if(newVal > 0) _curParams.maxDuty = newVal; else _curParams.maxDuty = 0;
 
 	if(_curParams.maxDuty > 999) _curParams.maxDuty = 999;
+
+	__publishParameters();
 }
 
 unsigned BoostControl::getZeroPointDutyScaled()
@@ -283,18 +705,93 @@ void BoostControl::alterZeroPointDutyScaled(int dutyDelta)
 	if(newVal > 0) _curParams.zeroPointDuty = newVal; else _curParams.zeroPointDuty = 0;
 
 	if(_curParams.zeroPointDuty > 999) _curParams.zeroPointDuty = 999;
+
+	__publishParameters();
+}
+
+int BoostControl::getFeedForwardDutyScaled(unsigned boostIndex, unsigned loadIndex)
+{
+	if(boostIndex >= FEED_FORWARD_BOOST_POINTS || loadIndex >= FEED_FORWARD_LOAD_POINTS) return 0;
+
+	return _curParams.feedForwardDuty[boostIndex][loadIndex];
+}
+
+void BoostControl::__setFeedForwardDutyScaled(unsigned boostIndex, unsigned loadIndex, int duty)
+{
+	if(boostIndex >= FEED_FORWARD_BOOST_POINTS || loadIndex >= FEED_FORWARD_LOAD_POINTS) return;
+
+	if(duty > 999) duty = 999;
+	if(duty < -999) duty = -999;
+
+	_curParams.feedForwardDuty[boostIndex][loadIndex] = duty;
+}
+
+void BoostControl::setFeedForwardDutyScaled(unsigned boostIndex, unsigned loadIndex, int duty)
+{
+	__setFeedForwardDutyScaled(boostIndex, loadIndex, duty);
+
+	__publishParameters();
+}
+
+int BoostControl::getLearnedDutyScaled(unsigned boostIndex, unsigned loadIndex)
+{
+	if(boostIndex >= FEED_FORWARD_BOOST_POINTS || loadIndex >= FEED_FORWARD_LOAD_POINTS) return 0;
+
+	return _curParams.learnedDuty[boostIndex][loadIndex];
+}
+
+void BoostControl::__setLearnedDutyScaled(unsigned boostIndex, unsigned loadIndex, int duty)
+{
+	if(boostIndex >= FEED_FORWARD_BOOST_POINTS || loadIndex >= FEED_FORWARD_LOAD_POINTS) return;
+
+	if(duty > LEARN_OFFSET_MAX) duty = LEARN_OFFSET_MAX;
+	if(duty < -LEARN_OFFSET_MAX) duty = -LEARN_OFFSET_MAX;
+
+	_curParams.learnedDuty[boostIndex][loadIndex] = duty;
+}
+
+void BoostControl::setLearnedDutyScaled(unsigned boostIndex, unsigned loadIndex, int duty)
+{
+	__setLearnedDutyScaled(boostIndex, loadIndex, duty);
+
+	__publishParameters();
 }
 
 unsigned BoostControl::getCurrentDutyScaled()
 {
-	if(_energised) return _pwmControl -> getDutyA() * 10.0;
+	if(_energised) return (_pwmControl -> getDutyAFixed() * 10) >> PICO_PWM_DUTY_FRAC_BITS;
 
 	return 0;
 }
 
-void BoostControl::__setSolenoidDuty(float duty)
+void BoostControl::__publishParameters()
 {
-	_pwmControl -> setDuty(duty, -1);
+	BoostControlSnapshot snapshot;
+
+	snapshot.params = _curParams;
+
+	// Derive everything the control step needs here, once per publish, rather than once per step.
+	snapshot.targetKpaScaled = _curParams.maxKpaScaled;
+	snapshot.energiseKpaScaled = _curParams.deEnergiseKpaScaled;
+	snapshot.deEnergiseKpaScaled = (int)_curParams.deEnergiseKpaScaled - CONTROL_DE_ENERGISE_HYSTERESIS;
+	snapshot.pidActiveKpaScaled = _curParams.pidActiveKpaScaled;
+	snapshot.maxDutyFixed = FixedPointPid::fromDeci(_curParams.maxDuty);
+
+	FixedPointPid::calcGains(&_curParams, &snapshot.pidGains);
+
+	snapshot.feedForward.setTable(&_curParams);
+
+	_snapshotBuffer -> publish(&snapshot);
+}
+
+void BoostControl::__setSolenoidDutyFixed(int32_t duty)
+{
+	// Convert from the PID fixed point format to the PWM one.
+#if FIXED_PID_FRAC_BITS >= PICO_PWM_DUTY_FRAC_BITS
+	_pwmControl -> setDutyFixed(duty >> (FIXED_PID_FRAC_BITS - PICO_PWM_DUTY_FRAC_BITS), -1);
+#else
+	_pwmControl -> setDutyFixed(duty << (PICO_PWM_DUTY_FRAC_BITS - FIXED_PID_FRAC_BITS), -1);
+#endif
 }
 
 void BoostControl::__enableSolenoid()
@@ -309,116 +806,227 @@ void BoostControl::__disableSolenoid()
 
 void BoostControl::__processControlSolenoid()
 {
-	if(!_testMode)
+	int curBoostScaled = _mapKpaScaled - STD_ATM_PRESSURE;
+
+	// Apply hysterisis to enable/disable about de-energise point.
+	if(_energised && curBoostScaled < _activeSnapshot.deEnergiseKpaScaled)
 	{
-		int curBoostScaled = _mapKpaScaled - STD_ATM_PRESSURE;
+		_energised = false;
+		__disableSolenoid();
+	}
+	else if(!_energised && curBoostScaled > _activeSnapshot.energiseKpaScaled)
+	{
+		_energised = true;
+		__enableSolenoid();
+	}
 
-		// Apply hysterisis to enable/disable about de-energise point.
-		if(_energised && curBoostScaled < ((int)_curParams.deEnergiseKpaScaled - CONTROL_DE_ENERGISE_HYSTERESIS))
+	if(_energised)
+	{
+		if(curBoostScaled < _activeSnapshot.pidActiveKpaScaled)
 		{
-			_energised = false;
-			__disableSolenoid();
+			// Pin at max duty to get maximum boost.
+			__setSolenoidDutyFixed(_activeSnapshot.maxDutyFixed);
+
+			_pidActive = false;
 		}
-		else if(!_energised && curBoostScaled > (int)_curParams.deEnergiseKpaScaled)
+		else
 		{
-			_energised = true;
-			__enableSolenoid();
-		}
+			hal_time_t cur_proc_time = hal_get_absolute_time();
 
-		if(_energised)
-		{
-			if(curBoostScaled < (int)_curParams.pidActiveKpaScaled)
+			if(!_pidActive)
 			{
-				// Pin at max duty to get maximum boost.
-				__setSolenoidDuty(_curParams.maxDuty);
+				// Setup initial PID vars.
+				_pid -> reset();
+				_learner -> reset();
+				_lastPidProcTime = cur_proc_time;
 
-				_pidActive = false;
+				_pidActive = true;
 			}
-			else
-			{
-				absolute_time_t cur_proc_time = get_absolute_time();
 
-				if(!_pidActive)
-				{
-					// Setup initial PID vars.
-					_pidPrevError = 0;
-					_pidInteg = 0;
-					_lastPidProcTime = cur_proc_time;
+			uint32_t deltaTimeUs = hal_absolute_time_diff_us(_lastPidProcTime, cur_proc_time);
+
+			int32_t feedForward = _activeSnapshot.feedForward.evaluate(_activeSnapshot.targetKpaScaled, _vsysMilliVolts);
+
+			__setSolenoidDutyFixed(_pid -> process(_activeSnapshot.targetKpaScaled, curBoostScaled, deltaTimeUs,
+				feedForward));
 
-					_pidActive = true;
-				}
+#if CONTROL_ZERO_POINT_LEARNING
+			__processLearning(curBoostScaled, deltaTimeUs);
+#endif
+
+			_lastPidProcTime = cur_proc_time;
+		}
+	}
+	else
+	{
+		_pidActive = false;
+	}
+}
 
-				float error = (curBoostScaled - (int)_curParams.maxKpaScaled) / 1000.0;
+void BoostControl::__processLearning(int curBoostScaled, uint32_t deltaTimeUs)
+{
+	// Still run while waiting on core 0, so the learner sees the boost leave the settled band.
+	int32_t transfer = _learner -> process(_activeSnapshot.targetKpaScaled - curBoostScaled, _pid -> getIntegTerm(),
+		deltaTimeUs);
 
-				float deltaTime = absolute_time_diff_us(_lastPidProcTime, cur_proc_time) / 1000.0;
+	if(_learnPending)
+	{
+		// Core 0 hasn't published it back. Give up eventually, rather than never learn again. Nothing was taken out of the
+		// integral term, so nothing is lost.
+		if(++_learnPendingSteps >= CONTROL_LEARN_PUBLISH_TIMEOUT_STEPS)
+		{
+			_learnPending = false;
+			_learner -> reset();
+		}
 
-				// Calc proportional and deriviative terms.
-				float controlVar = error * (float)_curParams.pidPropConstScaled + (error - _pidPrevError) *
-					(float)_curParams.pidDerivConstScaled;
+		return;
+	}
 
-				// Use an approximation to a time limited integration term.
-				// This removes a proportion of the average from the term and adds in the value associated with the current
-				// delta time.
-				_pidInteg -= deltaTime * _pidInteg / CONTROL_PID_INTEG_SUM_TIME;
-				_pidInteg += error * deltaTime;
+	if(transfer == 0) return;
 
-				controlVar += _pidInteg * (float)_curParams.pidIntegConstScaled;
+	unsigned boostIndex = FeedForwardMap::nearestIndex(FeedForwardMap::boostAxis, FEED_FORWARD_BOOST_POINTS,
+		_activeSnapshot.targetKpaScaled);
+	unsigned loadIndex = FeedForwardMap::nearestIndex(FeedForwardMap::loadAxis, FEED_FORWARD_LOAD_POINTS, _vsysMilliVolts);
 
-				// Map control var to duty cycle and set duty cycle.
-				// Use one to one correspondence between control var and duty cycle with zero point adjustment so that
-				// a control var of zero should match the required boost output.
+	int32_t learned = _activeSnapshot.params.learnedDuty[boostIndex][loadIndex];
 
-				float duty = controlVar + (float)_curParams.zeroPointDuty / 10.0;
+	int32_t newDuty = learned + transfer;
 
-				float maxDuty = (float)_curParams.maxDuty / 10.0;
+	if(newDuty > LEARN_OFFSET_MAX) newDuty = LEARN_OFFSET_MAX;
+	if(newDuty < -LEARN_OFFSET_MAX) newDuty = -LEARN_OFFSET_MAX;
 
-				if(duty > maxDuty) duty = maxDuty;
-				if(duty < 0.0) duty = 0.0;
+	if(newDuty == learned) return;
 
-				__setSolenoidDuty(duty);
+	// Core 0 owns the parameters. It stores the new value in the preset, persists it, and publishes it back. Nothing
+	// changes here until that snapshot is fetched, so a publish from core 0 in the meantime can't undo it.
+	_learnedOffset.presetIndex = _presetIndex;
+	_learnedOffset.boostIndex = boostIndex;
+	_learnedOffset.loadIndex = loadIndex;
+	_learnedOffset.dutyScaled = newDuty;
 
-				_lastPidProcTime = cur_proc_time;
+	// If it is dropped the integral term still holds it, so it is learnt again.
+	if(!__sendResponse(BOOST_RESPONSE_LEARNED_OFFSET, 0)) return;
 
-				_pidPrevError = error;
-			}
-		}
-		else
-		{
-			_pidActive = false;
-		}
-	}
+	_learnPending = true;
+	_learnPendingSteps = 0;
 }
 
-void BoostControl::testSolenoid()
+void BoostControl::__startTest(BoostControlCommand* command)
 {
-	_testMode = true;
+	_testSweep = command -> testSweep;
+	_testCommandId = command -> id;
+
+	if(_testSweep.endDutyScaled > 999) _testSweep.endDutyScaled = 999;
+	if(_testSweep.stepDutyScaled == 0) _testSweep.stepDutyScaled = 1;
+
+	_testDutyScaled = _testSweep.startDutyScaled;
+	_testStepStartUs = hal_time_us_32();
 
+	_testActive = true;
+
+	__setSolenoidDutyFixed(FixedPointPid::fromDeci(_testDutyScaled));
 	__enableSolenoid();
 
-	for(float duty = 0; duty < 100; duty += 1)
+	_energised = true;
+	_pidActive = false;
+}
+
+void BoostControl::__stopTest()
+{
+	__disableSolenoid();
+
+	// Hand back to normal control from a known state. The hysteresis will energise again if required.
+	_energised = false;
+	_pidActive = false;
+
+	_testActive = false;
+
+	__sendResponse(BOOST_RESPONSE_TEST_COMPLETE, _testCommandId);
+}
+
+void BoostControl::__processSolenoidTest()
+{
+	uint32_t curTimeUs = hal_time_us_32();
+
+	if(curTimeUs - _testStepStartUs < _testSweep.stepPeriodMs * 1000) return;
+
+	_testStepStartUs = curTimeUs;
+
+	_testDutyScaled += _testSweep.stepDutyScaled;
+
+	if(_testDutyScaled > _testSweep.endDutyScaled)
+	{
+		__stopTest();
+	}
+	else
 	{
-		__setSolenoidDuty(duty);
-		sleep_ms(100);
+		__setSolenoidDutyFixed(FixedPointPid::fromDeci(_testDutyScaled));
 	}
+}
 
-	/*
-	set_solenoid_duty(5);
-	sleep_ms(60000);
-	set_solenoid_duty(0);
-	sleep_ms(1000);
-	*/
+void BoostControl::__startAutoTune(BoostControlCommand* command)
+{
+	_autoTuneCommandId = command -> id;
+	_autoTuneProgress = 0;
 
-	__disableSolenoid();
+	uint32_t interrupts = hal_save_and_disable_interrupts();
+
+	// Oscillate about the target, switching either side of the duty that should hold it.
+	_autoTuner -> start(_activeSnapshot.targetKpaScaled, _activeSnapshot.params.zeroPointDuty, CONTROL_AUTO_TUNE_RELAY_DUTY,
+		_activeSnapshot.params.maxDuty, hal_time_us_32());
+
+	// Only now let the latch interrupt feed the tuner. Masked, so it never sees the flag before the tuner has started.
+	_autoTuneActive = true;
+
+	uint32_t dutyScaled = _autoTuner -> getDutyScaled();
 
-	_testMode = false;
+	hal_restore_interrupts(interrupts);
+
+	__setSolenoidDutyFixed(FixedPointPid::fromDeci(dutyScaled));
+	__enableSolenoid();
+
+	_energised = true;
+	_pidActive = false;
+
+	__sendResponse(BOOST_RESPONSE_AUTO_TUNE_PROGRESS, _autoTuneCommandId);
 }
 
-double BoostControl::mapReadSupplyVoltage()
+void BoostControl::__stopAutoTune()
 {
-	return _mapSensor -> readSupplyVoltage();
+	_autoTuneActive = false;
+
+	__disableSolenoid();
+
+	// Hand back to normal control from a known state. The hysteresis will energise again if required.
+	_energised = false;
+	_pidActive = false;
+
+	__sendResponse(BOOST_RESPONSE_AUTO_TUNE_COMPLETE, _autoTuneCommandId);
 }
 
-double BoostControl::mapReadSensorVoltage()
+void BoostControl::__processAutoTune()
 {
-	return _mapSensor -> readSensorVoltage();
+	// The latch interrupt feeds the tuner samples. Masked so the state, duty and progress are all from the same one.
+	uint32_t interrupts = hal_save_and_disable_interrupts();
+
+	RelayAutoTuner::State state = _autoTuner -> getState();
+	uint32_t dutyScaled = _autoTuner -> getDutyScaled();
+	unsigned progress = _autoTuner -> getProgress();
+
+	hal_restore_interrupts(interrupts);
+
+	if(state != RelayAutoTuner::RUNNING)
+	{
+		__stopAutoTune();
+		return;
+	}
+
+	__setSolenoidDutyFixed(FixedPointPid::fromDeci(dutyScaled));
+
+	if(progress != _autoTuneProgress)
+	{
+		_autoTuneProgress = progress;
+
+		__sendResponse(BOOST_RESPONSE_AUTO_TUNE_PROGRESS, _autoTuneCommandId);
+	}
 }
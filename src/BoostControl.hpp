@@ -1,13 +1,25 @@
 #ifndef PICO_BOOST_CONTROL_H
 #define PICO_BOOST_CONTROL_H
 
-#include "pico/time.h"
-
+#include "BiquadAdcFilter.hpp"
+#include "BoostControlCommand.hpp"
 #include "BoostControlParameters.hpp"
+#include "BoostControlSnapshotBuffer.hpp"
+#include "BoostTelemetry.hpp"
 #include "BoschMap_0261230119.hpp"
+#include "EmaAdcFilter.hpp"
+#include "FixedPointPid.hpp"
 #include "gpioAlloc.hpp"
+#include "HalSync.hpp"
+#include "HalTime.hpp"
+#include "MedianAdcFilter.hpp"
+#include "PicoAdcDmaCapture.hpp"
 #include "PicoAdcReader.hpp"
+#include "PicoDmaAdcReader.hpp"
 #include "PicoPwm.hpp"
+#include "RelayAutoTuner.hpp"
+#include "SpscRing.hpp"
+#include "ZeroPointLearner.hpp"
 
 /** Standard atmospheric pressure in Pascals. */
 #define STD_ATM_PRESSURE 101325
@@ -27,13 +39,102 @@
  */
 #define CONTROL_DE_ENERGISE_HYSTERESIS 5000
 
+/** ADC input the MAP sensor is connected to. This should map to GP26. */
+#define CONTROL_MAP_ADC_INPUT 0
+
+/** ADC input that the Pico connects to VSys, divided by 3. */
+#define CONTROL_VSYS_ADC_INPUT 3
+
+/**
+ * Set to 1 to capture the MAP sensor and VSys ADC inputs continuously with DMA. Each latch then averages every sample
+ * captured since the previous one. Set to 0 to do a single blocking ADC read per input on each latch.
+ * @note DMA capture only exists on the Pico, so host builds set this to 0.
+ */
+#ifndef CONTROL_ADC_DMA_CAPTURE
+#define CONTROL_ADC_DMA_CAPTURE 1
+#endif
+
+/** Total ADC conversions per second when capturing with DMA. Shared equally between the MAP sensor and VSys. */
+#define CONTROL_ADC_DMA_SAMPLE_RATE 100000
+
+/** log2 of the DMA capture ring buffer size, in bytes. 2048 bytes holds about 10ms of samples at 100000hz. */
+#define CONTROL_ADC_DMA_RING_BITS 11
+
+/** MAP sensor filter. Boxcar average of the last 10 latches. */
+#define CONTROL_MAP_FILTER_BOXCAR 0
+
+/** MAP sensor filter. Exponential moving average, with a smoothing factor of 1 / 2^CONTROL_MAP_FILTER_EMA_SHIFT. */
+#define CONTROL_MAP_FILTER_EMA 1
+
+/** MAP sensor filter. Median of the last CONTROL_MAP_FILTER_MEDIAN_LENGTH latches. Rejects single latch spikes. */
+#define CONTROL_MAP_FILTER_MEDIAN 2
+
+/** MAP sensor filter. Butterworth biquad low pass, with a cutoff of CONTROL_MAP_FILTER_CUTOFF_HZ. */
+#define CONTROL_MAP_FILTER_BIQUAD 3
+
+/** Filter applied to latched MAP sensor values. One of the CONTROL_MAP_FILTER_ values. VSys always uses a boxcar. */
+#ifndef CONTROL_MAP_FILTER
+#define CONTROL_MAP_FILTER CONTROL_MAP_FILTER_BOXCAR
+#endif
+
+/** log2 of the inverse smoothing factor of the MAP sensor EMA filter. */
+#define CONTROL_MAP_FILTER_EMA_SHIFT 3
+
+/** Number of latches the MAP sensor median filter takes the median of. */
+#define CONTROL_MAP_FILTER_MEDIAN_LENGTH 5
+
+/** Cutoff frequency of the MAP sensor biquad filter, in hz. */
+#define CONTROL_MAP_FILTER_CUTOFF_HZ 20.0
+
 /** Time in seconds over which the PID integral term is summed. */
 #define CONTROL_PID_INTEG_SUM_TIME 0.5
 
+/** Period, in microseconds, between latching the MAP sensor. ie 1000hz. */
+#define CONTROL_LATCH_PERIOD_US 1000
+
+/** Number of MAP sensor latches per control step. ie The control step runs at 100hz. */
+#define CONTROL_LATCHES_PER_STEP 10
+
+/** Nominal period, in microseconds, between control steps. */
+#define CONTROL_STEP_PERIOD_US (CONTROL_LATCH_PERIOD_US * CONTROL_LATCHES_PER_STEP)
+
+/** Auto tune relay amplitude. ie How far the duty is switched either side of the zero point duty. In %, scaled by 10. */
+#define CONTROL_AUTO_TUNE_RELAY_DUTY 100
+
+/**
+ * Set to 1 to learn zero point offsets from the settled PID integral term. These are reported to core 0 to be persisted.
+ * Set to 0 to only use the learned offsets already in the parameters.
+ */
+#define CONTROL_ZERO_POINT_LEARNING 1
+
+/**
+ * Number of control steps to wait for core 0 to publish a learned offset back before giving up on it. Nothing more is
+ * learnt while waiting. ie 5 seconds.
+ */
+#define CONTROL_LEARN_PUBLISH_TIMEOUT_STEPS 500
+
+/** log2 of the number of commands that can be queued from core 0 to core 1. */
+#define CONTROL_COMMAND_RING_BITS 3
+
+/** log2 of the number of responses that can be queued from core 1 to core 0. */
+#define CONTROL_RESPONSE_RING_BITS 3
+
+/**
+ * log2 of the number of telemetry records that can be queued from core 1 to core 0. One is logged per control step, so
+ * 256 records gives core 0 2.5 seconds to catch up before any are dropped. Each record is 28 bytes.
+ */
+#ifndef CONTROL_TELEMETRY_RING_BITS
+#define CONTROL_TELEMETRY_RING_BITS 8
+#endif
+
 /**
  * Class to control a single instance of a boost control solenoid.
  * @note This _only_ controls duty cycle where an increase in duty increases boost. ie The solenoid de-energizing takes the
  *       system back to waste gate spring pressure.
+ * @note Parameters are get/set/altered on core 0 and the control loop runs on core 1. Parameter changes are published as
+ *       complete snapshots which the control loop picks up at the start of a step.
+ * @note Core 1 owns all actuator state. Everything else core 0 wants done (tests, status requests, etc) is sent as a
+ *       command, which core 1 processes between control steps.
  */
 class BoostControl
 {
@@ -56,7 +157,7 @@ class BoostControl
 
 		/**
 		 * Set all boost control parameters.
-		 * @note This doesn't copy but uses the supplied struct directly.
+		 * @note The parameters are copied and published to the control loop together.
 		 * @param params Parameter data to use.
 		 */
 		void setParameters(BoostControlParameters* params);
@@ -67,12 +168,70 @@ class BoostControl
 		 */
 		void populateDefaultParameters(BoostControlParameters* params);
 
-		/** Polling pass for boost control. */
+		/**
+		 * Polling pass for boost control.
+		 * Latches and processes the control step when due. Only used when the control loop is not timer driven.
+		 */
 		void poll();
 
+		/**
+		 * Latch (read and store) the current MAP sensor data.
+		 * @note Intended to be called every CONTROL_LATCH_PERIOD_US, typically from a timer interrupt.
+		 */
+		void latchTick();
+
+		/**
+		 * Process the MAP sensor data and control the solenoid.
+		 * @note Intended to be called every CONTROL_STEP_PERIOD_US.
+		 */
+		void controlTick();
+
+		/**
+		 * Process any commands sent from core 0.
+		 * @note Must only be called on core 1, between control steps.
+		 */
+		void processCommands();
+
+		/**
+		 * Send a command to core 1. Never blocks.
+		 * @note Must only be called on core 0.
+		 * @param command Command to send. The id is assigned by this.
+		 * @returns False if the command ring is full, in which case the command is not sent.
+		 */
+		bool sendCommand(BoostControlCommand* command);
+
+		/**
+		 * Get the next response from core 1, if there is one. Never blocks.
+		 * @note Must only be called on core 0.
+		 * @param response Copy the response into this.
+		 * @returns False if there are no responses waiting.
+		 */
+		bool receiveResponse(BoostControlResponse* response);
+
+		/**
+		 * Get the next telemetry record, if there is one. Never blocks, and never holds up the control loop.
+		 * @note Must only be called on core 0.
+		 * @note Records are only logged while enabled with BOOST_COMMAND_SET_TELEMETRY.
+		 * @param record Copy the record into this.
+		 * @returns False if there are no records waiting.
+		 */
+		bool readTelemetry(BoostTelemetryRecord* record);
+
+		/** Get the number of telemetry records logged, including those dropped. Can be called from either core. */
+		uint32_t getTelemetryRecordCount();
+
+		/**
+		 * Get the number of telemetry records dropped because the ring was full. ie Core 0 fell behind.
+		 * Can be called from either core.
+		 */
+		uint32_t getTelemetryDropCount();
+
 		/** Get whether the boost control solenoid is energised. */
 		bool isEnergised();
 
+		/** Get the system (supply) voltage, as latched for the last control step. In millivolts. 0 until first read. */
+		int32_t getVsysMilliVolts();
+
 		/** Get whether maximum boost has been reached. */
 		bool isMaxBoostReached();
 
@@ -177,24 +336,40 @@ class BoostControl
 		void alterZeroPointDutyScaled(int dutyDelta);
 
 		/**
-		 * Get the current boost control solenoid duty cycle, in %. Scaled by 10.
+		 * Get an entry of the feed forward duty table. In %, scaled by 10.
+		 * @param boostIndex Index on the target boost axis.
+		 * @param loadIndex Index on the load axis.
 		 */
-		unsigned getCurrentDutyScaled();
+		int getFeedForwardDutyScaled(unsigned boostIndex, unsigned loadIndex);
 
 		/**
-		 * Run a test cycle with the solenoid valve.
+		 * Set an entry of the feed forward duty table.
+		 * @param boostIndex Index on the target boost axis.
+		 * @param loadIndex Index on the load axis.
+		 * @param duty Duty cycle added to the zero point duty. In %, scaled by 10. Clamped to +/- 99.9%.
 		 */
-		void testSolenoid();
+		void setFeedForwardDutyScaled(unsigned boostIndex, unsigned loadIndex, int duty);
 
 		/**
-		 * Read the voltage supplied to the map sensor.
+		 * Get an entry of the learned zero point offset table. In %, scaled by 10.
+		 * @param boostIndex Index on the target boost axis.
+		 * @param loadIndex Index on the load axis.
 		 */
-		double mapReadSupplyVoltage();
+		int getLearnedDutyScaled(unsigned boostIndex, unsigned loadIndex);
 
 		/**
-		 * Read the current map sensor voltage.
+		 * Set an entry of the learned zero point offset table. Typically as reported by BOOST_RESPONSE_LEARNED_OFFSET.
+		 * @param boostIndex Index on the target boost axis.
+		 * @param loadIndex Index on the load axis.
+		 * @param duty Offset added to the feed forward duty. In %, scaled by 10. Clamped to +/- LEARN_OFFSET_MAX.
 		 */
-		double mapReadSensorVoltage();
+		void setLearnedDutyScaled(unsigned boostIndex, unsigned loadIndex, int duty);
+
+		/**
+		 * Get the current boost control solenoid duty cycle, in %. Scaled by 10.
+		 */
+		unsigned getCurrentDutyScaled();
+
 
 	protected:
 
@@ -206,12 +381,36 @@ class BoostControl
 		/** Bosch map sensor to read current turbo pressure from. */
 		BoschMap_0261230119* _mapSensor = 0;
 
+		/** Free running DMA capture of the ADC. Only used if CONTROL_ADC_DMA_CAPTURE is enabled. */
+		PicoAdcDmaCapture* _adcCapture = 0;
+
+		/** The ADC reader to read the MAP sensor voltage. */
+		AdcReader* _mapAdc = 0;
+
 		/** The ADC reader to read the system (supply) voltage. */
-		PicoAdcReader* _vsysRefAdc = 0;
+		AdcReader* _vsysRefAdc = 0;
 
-		/** The current boost parameters. */
+		/** Converts a raw VSys ADC value to millivolts. Scaled by 2^16. */
+		uint32_t _vsysMilliVoltsPerRaw = 0;
+
+		/**
+		 * System voltage, as latched for the last control step. Used as the feed forward load. In millivolts.
+		 * Read from core 0 too. Read/write on 32bit numbers are atomic on the RP2040.
+		 */
+		int32_t _vsysMilliVolts = 0;
+
+		/** The current boost parameters, as get/set/altered from core 0. Not used directly by the control loop. */
 		BoostControlParameters _curParams;
 
+		/** Exchanges complete parameter snapshots from core 0 to the control loop. */
+		BoostControlSnapshotBuffer* _snapshotBuffer;
+
+		/** The parameter snapshot being used by the control loop. */
+		BoostControlSnapshot _activeSnapshot = {};
+
+		/** Version of the parameter snapshot being used by the control loop. */
+		uint32_t _activeSnapshotVersion = 0;
+
 		/**
 		 * The current boost MAP sensor reading, scaled by 1000 so a float isn't required and 3 decimal places are used.
 		 * It is done this way because read/write on 32bit numbers are atomic on the RP2040.
@@ -225,35 +424,172 @@ class BoostControl
 		/** Whether solenoid is being controlled by the PID algorithm. */
 		bool _pidActive = false;
 
-		/** Previous error for the PID algorithm. */
-		float _pidPrevError = 0;
-
-		/** Current integral value for the PID algorithm. This is _not_ multiplied by the constant. */
-		float _pidInteg = 0;
+		/** Fixed point PID engine that calculates the solenoid duty cycle. */
+		FixedPointPid* _pid;
 
 		/** The last time the PID algorithm was processed. */
-		absolute_time_t _lastPidProcTime;
+		hal_time_t _lastPidProcTime;
 
 		/** The next time the boost map sensor is latched (reads and stores the current value of the sensor) */
-		absolute_time_t _nextBoostLatchTime;
+		hal_time_t _nextBoostLatchTime;
 
 		/** The next time the current boost value is read. This is typically averaged across several latched values. */
-		absolute_time_t _nextBoostReadTime;
+		hal_time_t _nextBoostReadTime;
 
 		/** The last time the solenoid duty cycle was processed. */
-		absolute_time_t _lastSolenoidProcTime;
+		hal_time_t _lastSolenoidProcTime;
+
+		/** Measured control loop timing. */
+		ControlLoopTiming _loopTiming;
+
+		/** Time, from the 32 bit microsecond timer, of the last latch. 0 if no latch has happened yet. */
+		uint32_t _lastLatchTimeUs = 0;
+
+		/** Time, from the 32 bit microsecond timer, of the last control step. 0 if no step has happened yet. */
+		uint32_t _lastStepTimeUs = 0;
 
 		/** PWM control. Assume N Channel Mosfet (IRLZ34N) is being used and the gate must be pulled to ground. */
 		PicoPwm* _pwmControl;
 
-		/** Whether test mode is currently active. */
-		bool _testMode = false;
+		/** Commands from core 0 to core 1. */
+		SpscRing<BoostControlCommand, CONTROL_COMMAND_RING_BITS> _commands;
+
+		/** Responses from core 1 to core 0. */
+		SpscRing<BoostControlResponse, CONTROL_RESPONSE_RING_BITS> _responses;
+
+		/** Identifier given to the next command sent. Only used by core 0. */
+		uint32_t _nextCommandId = 1;
+
+		/** Number of responses dropped because the response ring was full. */
+		uint32_t _responseDropCount = 0;
+
+		/** Telemetry records from core 1 to core 0. */
+		SpscRing<BoostTelemetryRecord, CONTROL_TELEMETRY_RING_BITS> _telemetry;
+
+		/** Whether a telemetry record is logged each control step. */
+		bool _telemetryEnabled = false;
+
+		/**
+		 * Number of telemetry records logged, including those dropped. Only written by core 1.
+		 * It is 32 bits so reads from core 0 are atomic on the RP2040.
+		 */
+		volatile uint32_t _telemetryRecordCount = 0;
+
+		/** Number of telemetry records dropped because the telemetry ring was full. Only written by core 1. */
+		volatile uint32_t _telemetryDropCount = 0;
+
+		/** Whether a solenoid test sweep is running. */
+		bool _testActive = false;
+
+		/** The running solenoid test sweep. */
+		BoostControlTestSweep _testSweep;
+
+		/** Identifier of the command that started the running test sweep. */
+		uint32_t _testCommandId = 0;
+
+		/** Current test sweep duty cycle. In %, scaled by 10. */
+		uint32_t _testDutyScaled = 0;
+
+		/** Time, from the 32 bit microsecond timer, that the current test sweep step started. */
+		uint32_t _testStepStartUs = 0;
+
+		/** Relay auto tuner for the PID constants. */
+		RelayAutoTuner* _autoTuner;
+
+		/** Whether an auto tune is running. Checked by the latch interrupt. */
+		volatile bool _autoTuneActive = false;
+
+		/** Identifier of the command that started the running auto tune. */
+		uint32_t _autoTuneCommandId = 0;
+
+		/** Auto tune progress last reported to core 0. In %. */
+		unsigned _autoTuneProgress = 0;
+
+		/** Decides when to move the settled PID integral term into the learned zero point offsets. */
+		ZeroPointLearner* _learner;
+
+		/** Index of the active preset, as sent with the last BOOST_COMMAND_PRESET_SWITCH. */
+		uint32_t _presetIndex = 0;
+
+		/** Learned zero point offset last changed. Sent with BOOST_RESPONSE_LEARNED_OFFSET. */
+		BoostControlLearnedOffset _learnedOffset;
+
+		/**
+		 * True while the learned offset sent to core 0 hasn't been seen in a fetched snapshot yet. It is only taken out of
+		 * the integral term once it is, as core 0 owns the parameters.
+		 */
+		bool _learnPending = false;
+
+		/** Number of control steps the learned offset has been pending for. */
+		unsigned _learnPendingSteps = 0;
+
+		/** Reset the measured control loop timing. */
+		void __resetLoopTiming();
+
+		/** Process a single command from core 0. */
+		void __processCommand(BoostControlCommand* command);
+
+		/**
+		 * Send a response to core 0. Dropped, and counted, if the response ring is full.
+		 * @param type One of BoostControlResponseType.
+		 * @param commandId Identifier of the command being responded to.
+		 * @returns False if it was dropped.
+		 */
+		bool __sendResponse(uint32_t type, uint32_t commandId);
+
+		/**
+		 * Log a telemetry record of the control step just processed. Dropped, and counted, if the telemetry ring is full.
+		 * @param curTimeUs Time of the control step, from the 32 bit microsecond timer.
+		 */
+		void __logTelemetry(uint32_t curTimeUs);
+
+		/**
+		 * Convert a PID term to the telemetry format.
+		 * @param term PID term. In %, PID fixed point.
+		 * @returns The term in %, scaled by 10. Clamped to 16 bits.
+		 */
+		static int16_t __toTelemetryTerm(int32_t term);
+
+		/** Populate a status snapshot from the current state. */
+		void __populateStatus(BoostControlStatus* status);
+
+		/** Start a solenoid test sweep, suspending normal control. */
+		void __startTest(BoostControlCommand* command);
+
+		/** Stop the solenoid test sweep and hand back to normal control. */
+		void __stopTest();
+
+		/** Advance the solenoid test sweep. Called each control step instead of normal control while a test is running. */
+		void __processSolenoidTest();
+
+		/** Start a relay auto tune, suspending normal control. */
+		void __startAutoTune(BoostControlCommand* command);
+
+		/** Stop the auto tune, report the result and hand back to normal control. */
+		void __stopAutoTune();
+
+		/** Apply the auto tune relay output. Called each control step instead of normal control while tuning. */
+		void __processAutoTune();
+
+		/** Publish the current parameters, and the constants derived from them, to the control loop. */
+		void __publishParameters();
 
 		/** Process the control solenoid parameters and energise it accordingly. */
 		void __processControlSolenoid();
 
-		/** Set percentage duty cycle. */
-		void __setSolenoidDuty(float duty);
+		/**
+		 * Move part of the settled PID integral term into the learned zero point offset nearest the operating point.
+		 * Called after each PID step.
+		 * @param curBoostScaled Current boost, relative to std atm. In kPa, scaled by 1000.
+		 * @param deltaTimeUs Time since the previous PID step, in microseconds.
+		 */
+		void __processLearning(int curBoostScaled, uint32_t deltaTimeUs);
+
+		/**
+		 * Set percentage duty cycle.
+		 * @param duty Duty cycle in the fixed point format used by the PID engine.
+		 */
+		void __setSolenoidDutyFixed(int32_t duty);
 
 		/** Enable the boost control solenoid. */
 		void __enableSolenoid();
@@ -300,6 +636,16 @@ class BoostControl
 		 * Set zero point duty cycle of the solenoid. Scaled by 10.
 		 */
 		void __setZeroPointDutyScaled(unsigned zeroPointDuty);
+
+		/**
+		 * Set an entry of the feed forward duty table. In %, scaled by 10.
+		 */
+		void __setFeedForwardDutyScaled(unsigned boostIndex, unsigned loadIndex, int duty);
+
+		/**
+		 * Set an entry of the learned zero point offset table. In %, scaled by 10.
+		 */
+		void __setLearnedDutyScaled(unsigned boostIndex, unsigned loadIndex, int duty);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,238 @@
+#ifndef BOOST_CONTROL_COMMAND_H
+#define BOOST_CONTROL_COMMAND_H
+
+#include <cstdint>
+
+#include "RelayAutoTuner.hpp"
+
+// Command/response protocol between core 0 (user interaction) and core 1 (boost control).
+// Core 0 sends commands and core 1 processes them between control steps, replying where required. Both directions are
+// lock free rings so neither core ever waits on the other.
+// Parameter values themselves are not sent as commands. They are published as snapshots (see BoostControlSnapshotBuffer)
+// because only the latest set matters and an update must never be dropped because a ring is full.
+
+/**
+ * Measured timing of the control loop.
+ * All values are in microseconds unless otherwise stated.
+ */
+struct ControlLoopTiming
+{
+	/** Last measured period between MAP sensor latches. */
+	uint32_t latchPeriodUs;
+
+	/** Maximum deviation of a latch period from CONTROL_LATCH_PERIOD_US. */
+	uint32_t latchJitterMaxUs;
+
+	/** Last measured period between control steps. */
+	uint32_t stepPeriodUs;
+
+	/** Minimum measured period between control steps. */
+	uint32_t stepPeriodMinUs;
+
+	/** Maximum measured period between control steps. */
+	uint32_t stepPeriodMaxUs;
+
+	/** Maximum deviation of a control step period from CONTROL_STEP_PERIOD_US. */
+	uint32_t stepJitterMaxUs;
+
+	/** Number of control steps that started more than half a period late. */
+	uint32_t stepLateCount;
+
+	/** Total number of control steps processed. */
+	uint32_t stepCount;
+};
+
+/**
+ * Solenoid test sweep. The duty cycle is stepped from the start to the end duty, holding each step for a period.
+ */
+struct BoostControlTestSweep
+{
+	/** Duty cycle to start at. In %, scaled by 10. */
+	uint32_t startDutyScaled;
+
+	/** Duty cycle to finish at. In %, scaled by 10. */
+	uint32_t endDutyScaled;
+
+	/** Duty cycle increase per step. In %, scaled by 10. */
+	uint32_t stepDutyScaled;
+
+	/** Time to hold each step for. In milliseconds. */
+	uint32_t stepPeriodMs;
+};
+
+/**
+ * Snapshot of the boost control state, as taken by core 1.
+ */
+struct BoostControlStatus
+{
+	/** Measured control loop timing. */
+	ControlLoopTiming loopTiming;
+
+	/** Voltage supplied to the MAP sensor. */
+	double mapSupplyVoltage;
+
+	/** MAP sensor output voltage. */
+	double mapSensorVoltage;
+
+	/** Current boost, relative to std atm. In kPa, scaled by 1000. */
+	int32_t kpaScaled;
+
+	/** Current solenoid duty cycle. In %, scaled by 10. */
+	uint32_t dutyScaled;
+
+	/** Version of the parameter snapshot in use. */
+	uint32_t paramsVersion;
+
+	/** Number of responses that were dropped because the response ring was full. */
+	uint32_t responseDropCount;
+
+	/** Number of telemetry records logged, including those dropped. */
+	uint32_t telemetryRecordCount;
+
+	/** Number of telemetry records that were dropped because the telemetry ring was full. */
+	uint32_t telemetryDropCount;
+
+	/** Whether the solenoid is energised. */
+	bool energised;
+
+	/** Whether the PID algorithm is controlling the solenoid. */
+	bool pidActive;
+
+	/** Whether a solenoid test sweep is running. */
+	bool testActive;
+
+	/** Whether a PID auto tune is running. */
+	bool autoTuneActive;
+};
+
+/**
+ * A learned zero point offset table entry that has changed.
+ */
+struct BoostControlLearnedOffset
+{
+	/** Index of the preset it was learnt under. As sent with the last BOOST_COMMAND_PRESET_SWITCH. */
+	uint32_t presetIndex;
+
+	/** Target boost axis index. */
+	uint32_t boostIndex;
+
+	/** Load axis index. */
+	uint32_t loadIndex;
+
+	/** New learned offset. In %, scaled by 10. */
+	int32_t dutyScaled;
+};
+
+/** Commands sent from core 0 to core 1. */
+enum BoostControlCommandType
+{
+	/** Reply with a BOOST_RESPONSE_STATUS. */
+	BOOST_COMMAND_REQUEST_STATUS,
+
+	/** Reset the measured control loop timing. */
+	BOOST_COMMAND_RESET_LOOP_TIMING,
+
+	/**
+	 * A different preset has been switched to. Its parameters have already been published. The PID state built up under
+	 * the previous preset is discarded.
+	 */
+	BOOST_COMMAND_PRESET_SWITCH,
+
+	/**
+	 * Start a solenoid test sweep. Normal control is suspended until it finishes. Replies with BOOST_RESPONSE_TEST_COMPLETE.
+	 */
+	BOOST_COMMAND_START_TEST,
+
+	/** Stop a running solenoid test sweep early. */
+	BOOST_COMMAND_STOP_TEST,
+
+	/**
+	 * Start a relay auto tune of the PID constants about the current target boost. Normal control is suspended until it
+	 * finishes. Replies with BOOST_RESPONSE_AUTO_TUNE_PROGRESS as it goes and BOOST_RESPONSE_AUTO_TUNE_COMPLETE at the end.
+	 */
+	BOOST_COMMAND_START_AUTO_TUNE,
+
+	/** Stop a running auto tune early. */
+	BOOST_COMMAND_STOP_AUTO_TUNE,
+
+	/** Start or stop logging a telemetry record every control step. See BoostControl::readTelemetry(). */
+	BOOST_COMMAND_SET_TELEMETRY
+};
+
+/** Responses sent from core 1 to core 0. */
+enum BoostControlResponseType
+{
+	/** Boost control status. */
+	BOOST_RESPONSE_STATUS,
+
+	/** A solenoid test sweep has finished, or was stopped. */
+	BOOST_RESPONSE_TEST_COMPLETE,
+
+	/** The command couldn't be carried out in the current state. eg Starting a test while one is running. */
+	BOOST_RESPONSE_REJECTED,
+
+	/** Auto tune progress has changed. */
+	BOOST_RESPONSE_AUTO_TUNE_PROGRESS,
+
+	/** Auto tune has finished, or was stopped. The calculated constants are only valid if it was successful. */
+	BOOST_RESPONSE_AUTO_TUNE_COMPLETE,
+
+	/**
+	 * A learned zero point offset has changed. Core 1 is already using the new value. Not in response to a command, so
+	 * the command id is 0.
+	 */
+	BOOST_RESPONSE_LEARNED_OFFSET
+};
+
+/**
+ * A command sent from core 0 to core 1.
+ */
+struct BoostControlCommand
+{
+	/** One of BoostControlCommandType. */
+	uint32_t type;
+
+	/** Identifier of the command. Assigned when sent and returned in any response. */
+	uint32_t id;
+
+	union
+	{
+		/** Index of the preset switched to. Used with BOOST_COMMAND_PRESET_SWITCH. */
+		uint32_t presetIndex;
+
+		/** Sweep to run. Used with BOOST_COMMAND_START_TEST. */
+		BoostControlTestSweep testSweep;
+
+		/** Whether to log telemetry. Used with BOOST_COMMAND_SET_TELEMETRY. */
+		bool telemetryEnabled;
+	};
+};
+
+/**
+ * A response sent from core 1 to core 0.
+ */
+struct BoostControlResponse
+{
+	/** One of BoostControlResponseType. */
+	uint32_t type;
+
+	/** Identifier of the command this is in response to. */
+	uint32_t commandId;
+
+	union
+	{
+		/** Used with BOOST_RESPONSE_STATUS. */
+		BoostControlStatus status;
+
+		/** Progress, in %. Used with BOOST_RESPONSE_AUTO_TUNE_PROGRESS. */
+		uint32_t progress;
+
+		/** Used with BOOST_RESPONSE_AUTO_TUNE_COMPLETE. */
+		RelayAutoTuneResult autoTune;
+
+		/** Used with BOOST_RESPONSE_LEARNED_OFFSET. */
+		BoostControlLearnedOffset learnedOffset;
+	};
+};
+
+#endif
@@ -3,6 +3,12 @@
 
 #include <cstdint>
 
+/** Number of target boost points in the feed forward duty table. */
+#define FEED_FORWARD_BOOST_POINTS 5
+
+/** Number of load points in the feed forward duty table. */
+#define FEED_FORWARD_LOAD_POINTS 4
+
 /**
  * All boost control parameters in one place.
  */
@@ -38,6 +44,20 @@ struct BoostControlParameters {
  	 * If this value is too small, it will cause the boost to undershoot the target. If it is too large, it will overshoot.
 	 */
 	uint32_t zeroPointDuty;
+
+	/**
+	 * Feed forward duty table. Indexed by target boost then load. See FeedForwardMap for the axes.
+	 * Each entry is added to the zero point duty, so a table of zeros is the same as zero point duty alone.
+	 * In %, scaled by 10. Can be negative.
+	 */
+	int16_t feedForwardDuty[FEED_FORWARD_BOOST_POINTS][FEED_FORWARD_LOAD_POINTS];
+
+	/**
+	 * Learned zero point offset table. Same axes as the feed forward table, and added to it.
+	 * This is not set by the user. It is learnt from the settled PID integral term (see ZeroPointLearner).
+	 * In %, scaled by 10. Can be negative.
+	 */
+	int16_t learnedDuty[FEED_FORWARD_BOOST_POINTS][FEED_FORWARD_LOAD_POINTS];
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include "BoostControlSnapshotBuffer.hpp"
+
+/** Number of times fetch will try to get a consistent copy before giving up until the next call. */
+#define SNAPSHOT_FETCH_ATTEMPTS 2
+
+BoostControlSnapshotBuffer::~BoostControlSnapshotBuffer()
+{
+}
+
+BoostControlSnapshotBuffer::BoostControlSnapshotBuffer() : _seq(0), _copies()
+{
+}
+
+void BoostControlSnapshotBuffer::publish(const BoostControlSnapshot* snapshot)
+{
+	// Only this (the single writer) modifies the sequence count, so a read-modify-write isn't required. The Cortex-M0+
+	// doesn't have exclusive load/store so an atomic increment would not be lock free anyway.
+	uint32_t seq = _seq.load(std::memory_order_relaxed);
+
+	// Odd: Readers are directed to copy 1 while copy 0 is written.
+	_seq.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	_copies[0] = *snapshot;
+
+	// Even: Readers are directed to copy 0 while copy 1 is written.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	_seq.store(seq + 2, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	_copies[1] = *snapshot;
+
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+bool BoostControlSnapshotBuffer::fetch(BoostControlSnapshot* snapshot, uint32_t* version)
+{
+	for(unsigned attempt = 0; attempt < SNAPSHOT_FETCH_ATTEMPTS; attempt++)
+	{
+		uint32_t seq = _seq.load(std::memory_order_acquire);
+
+		// While a publish is half way through (odd) the readable copy still holds the previous version.
+		uint32_t seqVersion = seq >> 1;
+
+		if(seqVersion == *version) return false;
+
+		BoostControlSnapshot copy = _copies[seq & 1];
+
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if(_seq.load(std::memory_order_relaxed) == seq)
+		{
+			*snapshot = copy;
+			*version = seqVersion;
+
+			return true;
+		}
+	}
+
+	// The writer kept publishing. Keep using the current snapshot and try again next time.
+	return false;
+}
+
+uint32_t BoostControlSnapshotBuffer::getVersion()
+{
+	return _seq.load(std::memory_order_acquire) >> 1;
+}
@@ -0,0 +1,84 @@
+#ifndef BOOST_CONTROL_SNAPSHOT_BUFFER_H
+#define BOOST_CONTROL_SNAPSHOT_BUFFER_H
+
+#include <atomic>
+#include <stdint.h>
+
+#include "BoostControlParameters.hpp"
+#include "FeedForwardMap.hpp"
+#include "FixedPointPid.hpp"
+
+/**
+ * A complete set of boost control parameters, together with all the constants derived from them, as used by a single
+ * control step.
+ */
+struct BoostControlSnapshot
+{
+	/** The parameters the rest of this snapshot was derived from. */
+	BoostControlParameters params;
+
+	/** Target (maximum) boost, relative to std atm. In kPa, scaled by 1000. */
+	int32_t targetKpaScaled;
+
+	/** Boost above which the solenoid is energised, relative to std atm. In kPa, scaled by 1000. */
+	int32_t energiseKpaScaled;
+
+	/** Boost below which the solenoid is de-energised, relative to std atm. Includes hysteresis. In kPa, scaled by 1000. */
+	int32_t deEnergiseKpaScaled;
+
+	/** Boost above which the PID algorithm is active, relative to std atm. In kPa, scaled by 1000. */
+	int32_t pidActiveKpaScaled;
+
+	/** Duty cycle used below PID active boost. In %, PID fixed point. */
+	int32_t maxDutyFixed;
+
+	/** PID engine constants. */
+	FixedPointPidGains pidGains;
+
+	/** Feed forward duty map, ready for fixed point lookups. */
+	FeedForwardMap feedForward;
+};
+
+/**
+ * Lock free, single writer, single reader exchange of boost control snapshots between cores.
+ * This is a "latched" sequence lock. There are two copies of the snapshot and the sequence count says which one is stable.
+ * While the writer is updating one copy the reader is directed to the other, so a reader only ever has to retry if the
+ * writer published twice while it was copying.
+ * @note The writer never waits on the reader and the reader never waits on the writer.
+ */
+class BoostControlSnapshotBuffer
+{
+	public:
+
+		virtual ~BoostControlSnapshotBuffer();
+
+		BoostControlSnapshotBuffer();
+
+		/**
+		 * Publish a complete snapshot. Must only be called by the single writer (core 0).
+		 * @param snapshot Snapshot to copy in.
+		 */
+		void publish(const BoostControlSnapshot* snapshot);
+
+		/**
+		 * Take a copy of the latest snapshot if it is newer than the given version. Never blocks.
+		 * Must only be called by the single reader (core 1).
+		 * @param snapshot Copy into this. Left as is if there is no newer version or a consistent copy couldn't be made.
+		 * @param version Version of the snapshot already held. Updated if a newer snapshot is copied.
+		 * @returns True if a newer snapshot was copied.
+		 */
+		bool fetch(BoostControlSnapshot* snapshot, uint32_t* version);
+
+		/** Get the version of the latest completely published snapshot. Starts at 0 and increments per publish. */
+		uint32_t getVersion();
+
+	private:
+
+		/** Sequence count. Incremented twice per publish. The low bit selects the copy that is safe to read. */
+		std::atomic<uint32_t> _seq;
+
+		/** The two copies of the snapshot. */
+		BoostControlSnapshot _copies[2];
+};
+
+#endif
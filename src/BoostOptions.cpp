@@ -1,10 +1,12 @@
 #include <stdio.h>
 
-#include "hardware/gpio.h"
-
 #include "BoostOptions.hpp"
+#include "HalGpio.hpp"
+#include "TlvReader.hpp"
+#include "TlvWriter.hpp"
 
 extern bool debug;
+extern bool debugMsgActive;
 
 /** Amount of time that button(s) have to be pressed to invoke a test pass. */
 #define TEST_START_TIMEOUT 10000
@@ -27,8 +29,18 @@ extern bool debug;
 /** Time between display refresh, in milliseconds. */
 #define DISPLAY_FRAME_RATE 50
 
+/** Test sweep maximum solenoid duty cycle. In %, scaled by 10. */
+#define TEST_SWEEP_END_DUTY 990
+
+/** Test sweep solenoid duty cycle increase per step. In %, scaled by 10. */
+#define TEST_SWEEP_STEP_DUTY 10
+
+/** Test sweep time each step is held for. In ms. */
+#define TEST_SWEEP_STEP_PERIOD 100
+
 BoostOptions::~BoostOptions()
 {
+	if(_eepromCommitter) delete _eepromCommitter;
 	if(_eeprom24CS256) delete _eeprom24CS256;
 
 	if(_display) delete _display;
@@ -48,17 +60,37 @@ BoostOptions::BoostOptions(BoostControl* boostControl)
 {
 	_boostControl = boostControl;
 
+	uint64_t startUs = hal_time_us_64();
+
 	// Create EEPROM instance and initialise it.
 	// Current Use wear levelled page of size 32.
 	// Current saved boost options size: 24
 
-	_eeprom24CS256 = new Eeprom_24CS256(i2c0, 0, _eepromPages, 1);
+	_eeprom24CS256 = new Eeprom_24CS256(hal_i2c0(), 0, _eepromPages, 3, __reportClearProgress,
+		OPTIONS_EEPROM_MIRROR);
+
+	if(debugMsgActive && _eeprom24CS256 -> getClearedByteCount())
+	{
+		printf("EEPROM formatted. Cleared %u bytes in %u ms.\n", _eeprom24CS256 -> getClearedByteCount(),
+			(unsigned)(_eeprom24CS256 -> getClearTimeUs() / 1000));
+	}
+
+	_eepromCommitter = new EepromCommitter(_eeprom24CS256);
 
 	__setDefaults();
 
 	// Read initial options.
 	__readFromEeprom();
 
+	_optionsReadyTimeUs = (uint32_t)(hal_time_us_64() - startUs);
+
+	if(debugMsgActive)
+	{
+		printf("Options ready in %u us. EEPROM init %u us, %u wear index reads, %u full scans.\n",
+			(unsigned)_optionsReadyTimeUs, (unsigned)_eeprom24CS256 -> getInitTimeUs(),
+			_eeprom24CS256 -> getInitWearIndexReadCount(), _eeprom24CS256 -> getInitFullScanCount());
+	}
+
 	// Create 4 digit display instance.
 	_display = new TM1637Display(DISPLAY_CLOCK_GPIO, DISPLAY_DATA_GPIO);
 
@@ -90,7 +122,7 @@ BoostOptions::BoostOptions(BoostControl* boostControl)
 	// Pre-defined preset index select.
 	_presetSelectInput = new PicoSwitch(PRESET_INDEX_SELECT_GPIO, PicoSwitch::PULL_DOWN, 5, 100);
 
-	_nextDisplayRenderTime = get_absolute_time();
+	_nextDisplayRenderTime = hal_get_absolute_time();
 
 	_nextDisplayFlashToggleTime = _nextDisplayRenderTime;
 }
@@ -110,10 +142,27 @@ void BoostOptions::poll()
 
 	__processSwitches();
 
+	__processResponses();
+
+	__processOptionsCommit();
+
+	__processLearnedCommit();
+
+	// One step of any EEPROM write. Never waits for the chip.
+	_eepromCommitter -> poll();
+
+	// The dirty flags are cleared once pages are queued. Set them again for any page the committer gave up on, so it is
+	// committed again the same way, rather than lost until the next change.
+	if(_eepromCommitter -> takeFailed(OPTIONS_EEPROM_PAGE)) __markOptionsDirty();
+	if(_eepromCommitter -> takeFailed(FEED_FORWARD_EEPROM_PAGE)) __markOptionsDirty();
+
+	if(_eepromCommitter -> takeFailed(LEARNED_EEPROM_PAGE)) _learnedDirty = true;
+
 	// Normal non-options display is active.
-	absolute_time_t curTime = get_absolute_time();
+	hal_time_t curTime = hal_get_absolute_time();
 
-	if(debug || curTime >= _nextDisplayRenderTime)
+	// The test indicator stays on the display until the tests complete.
+	if(!_testActive && (debug || curTime >= _nextDisplayRenderTime))
 	{
 		// Set brightness of display.
 		if(_displayUseMinBrightness)
@@ -130,11 +179,11 @@ void BoostOptions::poll()
 
 			_displayFlashOn = !_displayFlashOn;
 
-			_nextDisplayFlashToggleTime = delayed_by_ms(_nextDisplayFlashToggleTime, DISPLAY_FLASH_PERIOD);
+			_nextDisplayFlashToggleTime = hal_delayed_by_ms(_nextDisplayFlashToggleTime, DISPLAY_FLASH_PERIOD);
 		}
 
 		// Limit the frame rate so the display doesn't "strobe".
-		_nextDisplayRenderTime = delayed_by_ms(_nextDisplayRenderTime, DISPLAY_FRAME_RATE);
+		_nextDisplayRenderTime = hal_delayed_by_ms(_nextDisplayRenderTime, DISPLAY_FRAME_RATE);
 
 		switch(_curSelectedOption)
 		{
@@ -559,7 +608,22 @@ void BoostOptions::__displayFactoryReset()
 
 void BoostOptions::__displayAutoTune()
 {
-	if(!_editMode || _displayFlashOn)
+	if(_autoTuneActive)
+	{
+		// Show progress while tuning. eg "At42".
+		_dispData[0] = _display -> encodeAlpha('A');
+		_dispData[1] = _display -> encodeAlpha('T');
+
+		_display -> encodeNumber(_autoTuneProgress > 99 ? 99 : _autoTuneProgress, 2, 3, _dispData);
+	}
+	else if(_autoTuneFailed && (!_editMode || _displayFlashOn))
+	{
+		_dispData[0] = _display -> encodeAlpha('A');
+		_dispData[1] = _display -> encodeAlpha('T');
+		_dispData[2] = _display -> encodeAlpha('-');
+		_dispData[3] = _display -> encodeAlpha('-');
+	}
+	else if(!_editMode || _displayFlashOn)
 	{
 		_dispData[0] = _display -> encodeAlpha('A');
 		_dispData[1] = _display -> encodeAlpha('U');
@@ -631,13 +695,50 @@ void BoostOptions::__invokeFactoryReset()
 {
 	__setDefaults();
 
-	// Save options to EEPROM.
+	// Save options to EEPROM. The quiet period is skipped, so a power cycle straight after still comes up reset.
 	__commitToEeprom();
 }
 
 void BoostOptions::__invokeAutoTune()
 {
-	// TODO ...
+	BoostControlCommand command;
+
+	if(_autoTuneActive)
+	{
+		// The completion response still arrives, as a failure, and clears the active flag.
+		command.type = BOOST_COMMAND_STOP_AUTO_TUNE;
+
+		_boostControl -> sendCommand(&command);
+
+		return;
+	}
+
+	// Tunes about the max boost of the current preset. The engine needs to be held under load for the boost to oscillate.
+	command.type = BOOST_COMMAND_START_AUTO_TUNE;
+
+	if(_boostControl -> sendCommand(&command))
+	{
+		_autoTuneActive = true;
+		_autoTuneFailed = false;
+		_autoTuneCommandId = command.id;
+		_autoTuneProgress = 0;
+	}
+}
+
+void BoostOptions::__applyAutoTune(RelayAutoTuneResult* result)
+{
+	BoostControlParameters params;
+
+	_boostControl -> getParameters(&params);
+
+	params.pidPropConstScaled = result -> pidPropConstScaled;
+	params.pidIntegConstScaled = result -> pidIntegConstScaled;
+	params.pidDerivConstScaled = result -> pidDerivConstScaled;
+
+	_boostControl -> setParameters(&params);
+
+	// Save options to EEPROM once it is a good time to. This picks up the new constants into the current preset.
+	__markOptionsDirty();
 }
 
 void BoostOptions::__setDefaults()
@@ -651,7 +752,7 @@ void BoostOptions::__setDefaults()
 
 	_presetIndex = 0;
 
-	__setupControlFromCurPreset();
+	__switchControlToCurPreset();
 
 	_displayMaxBrightness = 7;
 	_displayMinBrightness = 4;
@@ -678,6 +779,19 @@ void BoostOptions::__setupControlFromCurPreset()
 	}
 }
 
+void BoostOptions::__switchControlToCurPreset()
+{
+	__setupControlFromCurPreset();
+
+	BoostControlCommand command;
+
+	command.type = BOOST_COMMAND_PRESET_SWITCH;
+	command.presetIndex = _presetSelectIndexActive ? _presetSelectIndex : _presetIndex;
+
+	// If the command ring is full the new parameters are still used, the PID state just isn't reset.
+	_boostControl -> sendCommand(&command);
+}
+
 void BoostOptions::__populateCurPresetFromControl()
 {
 	// Takes into account whether preset select is active.
@@ -694,135 +808,263 @@ void BoostOptions::__populateCurPresetFromControl()
 
 bool BoostOptions::__commitToEeprom()
 {
-	uint8_t readBuffer[OPTIONS_EEPROM_PAGE_SIZE];
 	uint8_t writeBuffer[OPTIONS_EEPROM_PAGE_SIZE];
 
-	// Zero the page so that there is not random data written. This is necessary for the checksum to be accurate.
-	for(int index = 0; index < OPTIONS_EEPROM_PAGE_SIZE; index++)
+	writeBuffer[0] = OPTIONS_SCHEMA_SIGNATURE_0;
+	writeBuffer[1] = OPTIONS_SCHEMA_SIGNATURE_1;
+
+	// Tagged entries follow the signature. The writer zeroes the rest of the page, so unused bytes never show up as
+	// changes. The EEPROM adds a CRC to each page.
+	TlvWriter writer(writeBuffer + OPTIONS_SCHEMA_SIGNATURE_SIZE, OPTIONS_EEPROM_PAGE_SIZE - OPTIONS_SCHEMA_SIGNATURE_SIZE);
+
+	// Make sure the local preset values are up to date.
+	__populateCurPresetFromControl();
+
+	writer.putUnsigned(OPTIONS_TAG_VERSION, OPTIONS_SCHEMA_VERSION);
+	writer.putUnsigned(OPTIONS_TAG_MAX_BRIGHTNESS, _displayMaxBrightness);
+	writer.putUnsigned(OPTIONS_TAG_MIN_BRIGHTNESS, _displayMinBrightness);
+	writer.putUnsigned(OPTIONS_TAG_PRESET_INDEX, _presetIndex);
+	writer.putUnsigned(OPTIONS_TAG_PRESET_SELECT_INDEX, _presetSelectIndex);
+
+	// Five presets.
+	for(int index = 0; index < 5; index++)
+	{
+		BoostControlParameters*  curBoostPresets = _boostPresets + index;
+
+		writer.beginGroup(OPTIONS_TAG_PRESET);
+
+		writer.putUnsigned(PRESET_TAG_MAX_KPA, curBoostPresets -> maxKpaScaled);
+		writer.putUnsigned(PRESET_TAG_DE_ENERGISE_KPA, curBoostPresets -> deEnergiseKpaScaled);
+		writer.putUnsigned(PRESET_TAG_PID_ACTIVE_KPA, curBoostPresets -> pidActiveKpaScaled);
+		writer.putUnsigned(PRESET_TAG_PID_PROP_CONST, curBoostPresets -> pidPropConstScaled);
+		writer.putUnsigned(PRESET_TAG_PID_INTEG_CONST, curBoostPresets -> pidIntegConstScaled);
+		writer.putUnsigned(PRESET_TAG_PID_DERIV_CONST, curBoostPresets -> pidDerivConstScaled);
+		writer.putUnsigned(PRESET_TAG_MAX_DUTY, curBoostPresets -> maxDuty);
+		writer.putUnsigned(PRESET_TAG_ZERO_POINT_DUTY, curBoostPresets -> zeroPointDuty);
+
+		writer.endGroup();
+	}
+
+	// Only out of range parameters take more room than the page has. Keep what is already stored rather than write a
+	// page that is cut short.
+	if(writer.isOverflowed())
+	{
+		if(debugMsgActive) printf("Options don't fit the EEPROM page. Not committed.\n");
+	}
+	else
+	{
+		// Queue page to be written to EEPROM. It is verified once written.
+		_eepromCommitter -> queue(OPTIONS_EEPROM_PAGE, writeBuffer);
+	}
+
+	__commitTableToEeprom(FEED_FORWARD_EEPROM_PAGE);
+	__commitTableToEeprom(LEARNED_EEPROM_PAGE);
+
+	_optionsDirty = false;
+	_learnedDirty = false;
+
+	return !writer.isOverflowed();
+}
+
+bool BoostOptions::__readFromEeprom()
+{
+	uint8_t readBuffer[OPTIONS_EEPROM_PAGE_SIZE];
+
+	// Fails if the page's CRC doesn't match, as well as if it has never been written.
+	bool okay = _eeprom24CS256 -> readPage(0, readBuffer);
+
+	if(okay)
+	{
+		if(readBuffer[0] == OPTIONS_SCHEMA_SIGNATURE_0 && readBuffer[1] == OPTIONS_SCHEMA_SIGNATURE_1)
+		{
+			__readOptionsTagged(readBuffer);
+		}
+		else if(__readOptionsLegacy(readBuffer))
+		{
+			// Rewritten in the tagged layout once it is a good time to.
+			__markOptionsDirty();
+		}
+		else
+		{
+			printf("Options read checksum failed. Could be bad EEPROM.\n");
+		}
+
+		// Feed forward and learned tables are on their own pages. If they can't be read the tables stay as they are.
+		__readTableFromEeprom(FEED_FORWARD_EEPROM_PAGE);
+		__readTableFromEeprom(LEARNED_EEPROM_PAGE);
+
+		// Set the params on control only after the preset index is read. Boost control needs to know the index so that
+		// offsets it learns are stored in the right preset.
+		__switchControlToCurPreset();
+	}
+
+	return okay;
+}
+
+void BoostOptions::__readOptionsTagged(const uint8_t* page)
+{
+	TlvReader reader(page + OPTIONS_SCHEMA_SIGNATURE_SIZE, OPTIONS_EEPROM_PAGE_SIZE - OPTIONS_SCHEMA_SIGNATURE_SIZE);
+
+	// Nothing has changed meaning since version 1, the first tagged one, so the version isn't needed yet. A page from a
+	// newer version is read the same. Tags it added are skipped, and ones it dropped keep their defaults. Values are
+	// range checked, as newer firmware could have more presets, or brightness levels, than this one.
+	int presetIndex = 0;
+
+	while(reader.next())
 	{
-		readBuffer[index] = 0;
-		writeBuffer[index] = 0;
+		if(reader.isBytes())
+		{
+			if(reader.getTag() != OPTIONS_TAG_PRESET) continue;
+
+			// Presets past the fifth are from newer firmware with more of them.
+			if(presetIndex >= 5) continue;
+
+			BoostControlParameters*  curBoostPresets = _boostPresets + presetIndex++;
+
+			TlvReader presetReader = reader.getGroup();
+
+			while(presetReader.next())
+			{
+				if(presetReader.isBytes()) continue;
+
+				uint32_t value = presetReader.getUnsigned();
+
+				switch(presetReader.getTag())
+				{
+					case PRESET_TAG_MAX_KPA: curBoostPresets -> maxKpaScaled = value; break;
+					case PRESET_TAG_DE_ENERGISE_KPA: curBoostPresets -> deEnergiseKpaScaled = value; break;
+					case PRESET_TAG_PID_ACTIVE_KPA: curBoostPresets -> pidActiveKpaScaled = value; break;
+					case PRESET_TAG_PID_PROP_CONST: curBoostPresets -> pidPropConstScaled = value; break;
+					case PRESET_TAG_PID_INTEG_CONST: curBoostPresets -> pidIntegConstScaled = value; break;
+					case PRESET_TAG_PID_DERIV_CONST: curBoostPresets -> pidDerivConstScaled = value; break;
+					case PRESET_TAG_MAX_DUTY: curBoostPresets -> maxDuty = value; break;
+					case PRESET_TAG_ZERO_POINT_DUTY: curBoostPresets -> zeroPointDuty = value; break;
+				}
+			}
+
+			continue;
+		}
+
+		uint32_t value = reader.getUnsigned();
+
+		switch(reader.getTag())
+		{
+			case OPTIONS_TAG_MAX_BRIGHTNESS: _displayMaxBrightness = value > 7 ? 7 : value; break;
+			case OPTIONS_TAG_MIN_BRIGHTNESS: _displayMinBrightness = value > 7 ? 7 : value; break;
+			case OPTIONS_TAG_PRESET_INDEX: _presetIndex = value > 4 ? 0 : value; break;
+			case OPTIONS_TAG_PRESET_SELECT_INDEX: _presetSelectIndex = value > 4 ? 0 : value; break;
+		}
 	}
+}
+
+bool BoostOptions::__readOptionsLegacy(const uint8_t* page)
+{
+	const uint32_t* readBuffer32 = (const uint32_t*) page;
+
+	// Calculate byte wise checksum and compare.
+	uint32_t checksum = 0;
 
-	// Write 32 bit data to page buffer.
+	for(int index = 4; index < OPTIONS_EEPROM_PAGE_SIZE; index++)
+	{
+		checksum += page[index];
+	}
 
-	uint32_t* writeBuffer32 = (uint32_t*) writeBuffer;
+	if(readBuffer32[0] != checksum) return false;
 
 	// Remember that the first entry in the buffer is the checksum.
 	int index32 = 1;
 
-	// Make sure the local preset values are up to date.
-	__populateCurPresetFromControl();
-
 	// Five presets.
 	for(int index = 0; index < 5; index++)
 	{
 		BoostControlParameters*  curBoostPresets = _boostPresets + index;
 
-		writeBuffer32[index32++] = curBoostPresets -> maxKpaScaled;
-		writeBuffer32[index32++] = curBoostPresets -> deEnergiseKpaScaled;
-		writeBuffer32[index32++] = curBoostPresets -> pidActiveKpaScaled;
-		writeBuffer32[index32++] = curBoostPresets -> pidPropConstScaled;
-		writeBuffer32[index32++] = curBoostPresets -> pidIntegConstScaled;
-		writeBuffer32[index32++] = curBoostPresets -> pidDerivConstScaled;
-		writeBuffer32[index32++] = curBoostPresets -> maxDuty;
-		writeBuffer32[index32++] = curBoostPresets -> zeroPointDuty;
+		curBoostPresets -> maxKpaScaled = readBuffer32[index32++];
+		curBoostPresets -> deEnergiseKpaScaled = readBuffer32[index32++];
+		curBoostPresets -> pidActiveKpaScaled = readBuffer32[index32++];
+		curBoostPresets -> pidPropConstScaled = readBuffer32[index32++];
+		curBoostPresets -> pidIntegConstScaled = readBuffer32[index32++];
+		curBoostPresets -> pidDerivConstScaled = readBuffer32[index32++];
+		curBoostPresets -> maxDuty = readBuffer32[index32++];
+		curBoostPresets -> zeroPointDuty = readBuffer32[index32++];
 	}
 
 	// index32 is pointing to the start of the memory after the boost presets.
 	int index8 = index32 * 4;
 
-	writeBuffer[index8++] = _displayMaxBrightness;
-	writeBuffer[index8++] = _displayMinBrightness;
-	writeBuffer[index8++] = _presetIndex;
-	writeBuffer[index8++] = _presetSelectIndex;
+	_displayMaxBrightness = page[index8++];
+	_displayMinBrightness = page[index8++];
+	_presetIndex = page[index8++];
+	_presetSelectIndex = page[index8++];
 
-	// Calculate byte wise checksum.
-	uint32_t checksum = 0;
+	// Range checked the same as tagged values. An out of range preset index would be past the end of the presets.
+	if(_displayMaxBrightness > 7) _displayMaxBrightness = 7;
+	if(_displayMinBrightness > 7) _displayMinBrightness = 7;
+	if(_presetIndex > 4) _presetIndex = 0;
+	if(_presetSelectIndex > 4) _presetSelectIndex = 0;
 
-	for(int index = 4; index < OPTIONS_EEPROM_PAGE_SIZE; index++)
-	{
-		checksum += writeBuffer[index];
-	}
+	return true;
+}
 
-	writeBuffer32[0] = checksum;
+int16_t (*BoostOptions::__tableOf(BoostControlParameters* preset, unsigned page))[FEED_FORWARD_LOAD_POINTS]
+{
+	return page == LEARNED_EEPROM_PAGE ? preset -> learnedDuty : preset -> feedForwardDuty;
+}
 
-	// Write page to EEPROM.
-	bool verified = _eeprom24CS256 -> writePage(0, writeBuffer);
+void BoostOptions::__commitTableToEeprom(unsigned page)
+{
+	// Both table pages are the same size.
+	uint8_t writeBuffer[FEED_FORWARD_EEPROM_PAGE_SIZE];
 
-	if(verified)
+	// Write 16 bit data to page buffer. The EEPROM adds a CRC to each page.
+
+	int16_t* writeBuffer16 = (int16_t*)writeBuffer;
+
+	int index16 = 0;
+
+	// Five presets.
+	for(int index = 0; index < 5; index++)
 	{
-		// Verify written data.
-		_eeprom24CS256 -> readPage(0, readBuffer);
+		int16_t (*table)[FEED_FORWARD_LOAD_POINTS] = __tableOf(_boostPresets + index, page);
 
-		for(int index = 0; index < OPTIONS_EEPROM_PAGE_SIZE; index++)
+		for(int boostIndex = 0; boostIndex < FEED_FORWARD_BOOST_POINTS; boostIndex++)
 		{
-			if(readBuffer[index] != writeBuffer[index])
+			for(int loadIndex = 0; loadIndex < FEED_FORWARD_LOAD_POINTS; loadIndex++)
 			{
-				verified = false;
-				printf("Boost options commit failed verify at index %u of EEPROM page.\n", index);
-				break;
+				writeBuffer16[index16++] = table[boostIndex][loadIndex];
 			}
 		}
 	}
 
-	return verified;
+	// Queue page to be written to EEPROM. It is verified once written.
+	_eepromCommitter -> queue(page, writeBuffer);
 }
 
-bool BoostOptions::__readFromEeprom()
+bool BoostOptions::__readTableFromEeprom(unsigned page)
 {
-	uint8_t readBuffer[OPTIONS_EEPROM_PAGE_SIZE];
+	uint8_t readBuffer[FEED_FORWARD_EEPROM_PAGE_SIZE];
 
-	bool okay = _eeprom24CS256 -> readPage(0, readBuffer);
+	// Fails if the page's CRC doesn't match, as well as if it has never been written.
+	bool okay = _eeprom24CS256 -> readPage(page, readBuffer);
 
 	if(okay)
 	{
-		uint32_t* readBuffer32 = (uint32_t*) readBuffer;
-
-		// Calculate byte wise checksum and compare.
-		uint32_t checksum = 0;
-
-		for(int index = 4; index < OPTIONS_EEPROM_PAGE_SIZE; index++)
-		{
-			checksum += readBuffer[index];
-		}
+		int16_t* readBuffer16 = (int16_t*)readBuffer;
 
-		okay = (readBuffer32[0] == checksum);
+		int index16 = 0;
 
-		if(okay)
+		// Five presets.
+		for(int index = 0; index < 5; index++)
 		{
-			// Remember that the first entry in the buffer is the checksum.
-			int index32 = 1;
+			int16_t (*table)[FEED_FORWARD_LOAD_POINTS] = __tableOf(_boostPresets + index, page);
 
-			// Five presets.
-			for(int index = 0; index < 5; index++)
+			for(int boostIndex = 0; boostIndex < FEED_FORWARD_BOOST_POINTS; boostIndex++)
 			{
-				BoostControlParameters*  curBoostPresets = _boostPresets + index;
-
-				curBoostPresets -> maxKpaScaled = readBuffer32[index32++];
-				curBoostPresets -> deEnergiseKpaScaled = readBuffer32[index32++];
-				curBoostPresets -> pidActiveKpaScaled = readBuffer32[index32++];
-				curBoostPresets -> pidPropConstScaled = readBuffer32[index32++];
-				curBoostPresets -> pidIntegConstScaled = readBuffer32[index32++];
-				curBoostPresets -> pidDerivConstScaled = readBuffer32[index32++];
-				curBoostPresets -> maxDuty = readBuffer32[index32++];
-				curBoostPresets -> zeroPointDuty = readBuffer32[index32++];
+				for(int loadIndex = 0; loadIndex < FEED_FORWARD_LOAD_POINTS; loadIndex++)
+				{
+					table[boostIndex][loadIndex] = readBuffer16[index16++];
+				}
 			}
-
-			// index32 is pointing to the start of the memory after the boost presets.
-			int index8 = index32 * 4;
-
-			_displayMaxBrightness = readBuffer[index8++];
-			_displayMinBrightness = readBuffer[index8++];
-			_presetIndex = readBuffer[index8++];
-			_presetSelectIndex = readBuffer[index8++];
-
-			// Set the params on control only after the preset index is read.
-			__setupControlFromCurPreset();
-		}
-		else
-		{
-			printf("Options read checksum failed. Could be bad EEPROM.\n");
 		}
 	}
 
@@ -844,7 +1086,7 @@ void BoostOptions::__alterPresetIndex(int delta)
 
 		_presetIndex = newPresetIndex;
 
-		if(!_presetSelectIndexActive) __setupControlFromCurPreset();
+		if(!_presetSelectIndexActive) __switchControlToCurPreset();
 	}
 }
 
@@ -863,7 +1105,7 @@ void BoostOptions::__alterPresetSelectIndex(int delta)
 
 		_presetIndex = newPresetSelectIndex;
 
-		if(_presetSelectIndexActive) __setupControlFromCurPreset();
+		if(_presetSelectIndexActive) __switchControlToCurPreset();
 	}
 }
 
@@ -888,7 +1130,7 @@ void BoostOptions::__processSwitches()
 	bool increaseProced = false;
 	bool decreaseProced = false;
 
-	// Whether to committo eeprom.
+	// Whether options have changed, and need committing to eeprom.
 	bool commitToEeprom = false;
 
 	// Check for test invocation. Select pressed for an extended duration.
@@ -915,7 +1157,7 @@ void BoostOptions::__processSwitches()
 		// Force going out of edit mode because it might now be in an inconsistent state.
 		_editMode = false;
 
-		__setupControlFromCurPreset();
+		__switchControlToCurPreset();
 	}
 
 	// Regardless of the current selected option, all switches not being pressed for greater than the mode complete timeout
@@ -1197,11 +1439,13 @@ void BoostOptions::__processSwitches()
 	if(increaseProced) _lastProcIncreaseButtonStateIndex = curIncreaseStateIndex;
 	if(decreaseProced) _lastProcDecreaseButtonStateIndex = curDecreaseStateIndex;
 
-	if(commitToEeprom) __commitToEeprom();
+	if(commitToEeprom) __markOptionsDirty();
 }
 
 void BoostOptions::__runTests()
 {
+	if(_testActive) return;
+
 	// Show "test" on display.
 	_dispData[0] = _display -> encodeAlpha('T');
 	_dispData[1] = _display -> encodeAlpha('E');
@@ -1211,19 +1455,271 @@ void BoostOptions::__runTests()
 	_display -> show(_dispData);
 
 	// Allows testing equipment to detect test start.
-	gpio_put(BOOST_OPTIONS_TEST_ACTIVE_GPIO, true);
+	hal_gpio_put(BOOST_OPTIONS_TEST_ACTIVE_GPIO, true);
 
 	printf("Run tests starting.\n");
 
-	printf("Map supply V: %.3f\n", _boostControl -> mapReadSupplyVoltage());
-	printf("Map sensor V: %.3f\n", _boostControl -> mapReadSensorVoltage());
+	BoostControlCommand command;
+
+	command.type = BOOST_COMMAND_REQUEST_STATUS;
+
+	_boostControl -> sendCommand(&command);
 
 	//__testEeprom();
 
-	printf("Testing solenoid valve.\n");
-	_boostControl -> testSolenoid();
+	// The sweep runs on core 1 and its completion is picked up by __processResponses().
+	command.type = BOOST_COMMAND_START_TEST;
+	command.testSweep.startDutyScaled = 0;
+	command.testSweep.endDutyScaled = TEST_SWEEP_END_DUTY;
+	command.testSweep.stepDutyScaled = TEST_SWEEP_STEP_DUTY;
+	command.testSweep.stepPeriodMs = TEST_SWEEP_STEP_PERIOD;
+
+	if(_boostControl -> sendCommand(&command))
+	{
+		printf("Testing solenoid valve.\n");
+
+		_testActive = true;
+		_testCommandId = command.id;
+	}
+	else
+	{
+		printf("Run tests failed. Boost control is busy.\n");
+
+		hal_gpio_put(BOOST_OPTIONS_TEST_ACTIVE_GPIO, false);
+	}
+}
+
+void BoostOptions::__processResponses()
+{
+	BoostControlResponse response;
+
+	while(_boostControl -> receiveResponse(&response))
+	{
+		switch(response.type)
+		{
+			case BOOST_RESPONSE_STATUS:
+			{
+				BoostControlStatus* status = &response.status;
+
+				printf("Map supply V: %.3f\n", status -> mapSupplyVoltage);
+				printf("Map sensor V: %.3f\n", status -> mapSensorVoltage);
+
+				printf("Control steps: %u (late: %u)\n", status -> loopTiming.stepCount, status -> loopTiming.stepLateCount);
+				printf("Control step period us: %u (min: %u, max: %u, max jitter: %u)\n", status -> loopTiming.stepPeriodUs,
+					status -> loopTiming.stepPeriodMinUs, status -> loopTiming.stepPeriodMaxUs,
+					status -> loopTiming.stepJitterMaxUs);
+				printf("Latch period us: %u (max jitter: %u)\n", status -> loopTiming.latchPeriodUs,
+					status -> loopTiming.latchJitterMaxUs);
+				printf("Telemetry records: %u (dropped: %u)\n", status -> telemetryRecordCount,
+					status -> telemetryDropCount);
+
+				unsigned writeCycleCount = _eeprom24CS256 -> getWriteCycleCount();
+
+				printf("EEPROM write cycles: %u (mean us: %u, max us: %u, timed out: %u)\n", writeCycleCount,
+					writeCycleCount ? (unsigned)(_eeprom24CS256 -> getWriteCycleTotalUs() / writeCycleCount) : 0,
+					(unsigned)_eeprom24CS256 -> getWriteCycleMaxUs(), _eeprom24CS256 -> getWriteCycleTimeoutCount());
+				printf("EEPROM page commits: %u (coalesced: %u, failed: %u)\n", _eepromCommitter -> getCommitCount(),
+					_eepromCommitter -> getCoalesceCount(), _eepromCommitter -> getFailCount());
+				printf("EEPROM delta page writes: %u (bases: %u)\n", _eeprom24CS256 -> getDeltaWriteCount(),
+					_eeprom24CS256 -> getBaseWriteCount());
+				printf("EEPROM mirror bytes: %u (load us: %u, chip pages written: %u, unchanged: %u)\n",
+					_eeprom24CS256 -> getMirrorSize(), (unsigned)_eeprom24CS256 -> getMirrorLoadTimeUs(),
+					_eeprom24CS256 -> getMirrorFlushCount(), _eeprom24CS256 -> getMirrorUnchangedCount());
+				printf("Options ready us: %u (EEPROM init us: %u, wear index reads: %u, full scans: %u)\n",
+					(unsigned)_optionsReadyTimeUs, (unsigned)_eeprom24CS256 -> getInitTimeUs(),
+					_eeprom24CS256 -> getInitWearIndexReadCount(), _eeprom24CS256 -> getInitFullScanCount());
+
+				break;
+			}
+
+			case BOOST_RESPONSE_TEST_COMPLETE:
+
+				if(response.commandId != _testCommandId) break;
+
+				printf("Run tests finished.\n");
+
+				hal_gpio_put(BOOST_OPTIONS_TEST_ACTIVE_GPIO, false);
+
+				_testActive = false;
+				break;
+
+			case BOOST_RESPONSE_AUTO_TUNE_PROGRESS:
+
+				if(response.commandId == _autoTuneCommandId) _autoTuneProgress = response.progress;
+				break;
+
+			case BOOST_RESPONSE_AUTO_TUNE_COMPLETE:
+			{
+				if(response.commandId != _autoTuneCommandId) break;
+
+				RelayAutoTuneResult* result = &response.autoTune;
+
+				_autoTuneActive = false;
+				_autoTuneFailed = !result -> success;
+
+				if(result -> success)
+				{
+					printf("Auto tune Ku: %u, Tu us: %u, amplitude: %u\n", result -> ultimateGainScaled,
+						result -> ultimatePeriodUs, result -> amplitudeKpaScaled);
+					printf("Auto tune P: %u, I: %u, D: %u\n", result -> pidPropConstScaled, result -> pidIntegConstScaled,
+						result -> pidDerivConstScaled);
+
+					__applyAutoTune(result);
+				}
+				else
+				{
+					printf("Auto tune failed.\n");
+				}
+
+				break;
+			}
 
-	printf("Run tests finished.\n");
+			case BOOST_RESPONSE_LEARNED_OFFSET:
+
+				__storeLearnedOffset(&response.learnedOffset);
+				break;
+
+			case BOOST_RESPONSE_REJECTED:
+
+				printf("Boost control rejected command %u.\n", response.commandId);
+
+				if(_autoTuneActive && response.commandId == _autoTuneCommandId)
+				{
+					_autoTuneActive = false;
+					_autoTuneFailed = true;
+				}
+
+				if(_testActive && response.commandId == _testCommandId)
+				{
+					hal_gpio_put(BOOST_OPTIONS_TEST_ACTIVE_GPIO, false);
 
-	gpio_put(BOOST_OPTIONS_TEST_ACTIVE_GPIO, false);
+					_testActive = false;
+				}
+				break;
+		}
+	}
+}
+
+int BoostOptions::getPresetIndex()
+{
+	return _presetIndex;
+}
+
+bool BoostOptions::setPresetIndex(int index)
+{
+	if(index < 0 || index > 4) return false;
+
+	__alterPresetIndex(index - _presetIndex);
+
+	return true;
+}
+
+bool BoostOptions::isPresetSelectActive()
+{
+	return _presetSelectIndexActive;
+}
+
+bool BoostOptions::commit()
+{
+	return __commitToEeprom();
+}
+
+EepromCommitState BoostOptions::getCommitState()
+{
+	return _eepromCommitter -> getState();
+}
+
+unsigned BoostOptions::getCommitCount()
+{
+	return _eepromCommitter -> getCommitCount();
+}
+
+unsigned BoostOptions::getCommitFailCount()
+{
+	return _eepromCommitter -> getFailCount();
+}
+
+uint32_t BoostOptions::getOptionsReadyTimeUs()
+{
+	return _optionsReadyTimeUs;
+}
+
+void BoostOptions::__storeLearnedOffset(BoostControlLearnedOffset* learnedOffset)
+{
+	if(learnedOffset -> presetIndex >= 5 || learnedOffset -> boostIndex >= FEED_FORWARD_BOOST_POINTS ||
+		learnedOffset -> loadIndex >= FEED_FORWARD_LOAD_POINTS) return;
+
+	// Store in the preset directly, rather than picking it up from control on commit, so it survives an edit being
+	// discarded.
+	_boostPresets[learnedOffset -> presetIndex].learnedDuty[learnedOffset -> boostIndex][learnedOffset -> loadIndex] =
+		learnedOffset -> dutyScaled;
+
+	// Publish it back to control, if it is still the active preset, so the next parameter change doesn't undo it.
+	int activeIndex = _presetSelectIndexActive ? _presetSelectIndex : _presetIndex;
+
+	if((int)learnedOffset -> presetIndex == activeIndex)
+	{
+		_boostControl -> setLearnedDutyScaled(learnedOffset -> boostIndex, learnedOffset -> loadIndex,
+			learnedOffset -> dutyScaled);
+	}
+
+	_learnedDirty = true;
+}
+
+void BoostOptions::__markOptionsDirty()
+{
+	_optionsDirty = true;
+	_optionsChangedTime = hal_get_absolute_time();
+}
+
+void BoostOptions::__processOptionsCommit()
+{
+	if(!_optionsDirty) return;
+
+	if(!__isBrownOut())
+	{
+		hal_time_t curTime = hal_get_absolute_time();
+
+		// A commit picks up the parameters from boost control, which mid edit aren't the preset's yet.
+		if(_editMode || curTime < hal_delayed_by_ms(_optionsChangedTime, OPTIONS_COMMIT_QUIET_MS)) return;
+
+		if(_boostControl -> isEnergised() && curTime < hal_delayed_by_ms(_optionsChangedTime, OPTIONS_COMMIT_MAX_DELAY_MS))
+		{
+			return;
+		}
+	}
+
+	__commitToEeprom();
+}
+
+bool BoostOptions::__isBrownOut()
+{
+	int32_t vsysMilliVolts = _boostControl -> getVsysMilliVolts();
+
+	return vsysMilliVolts > 0 && vsysMilliVolts < OPTIONS_BROWN_OUT_MILLIVOLTS;
+}
+
+void BoostOptions::__processLearnedCommit()
+{
+	if(!_learnedDirty) return;
+
+	hal_time_t curTime = hal_get_absolute_time();
+
+	if(!__isBrownOut() && (_boostControl -> isEnergised() || curTime < _nextLearnedCommitTime)) return;
+
+	// Only the learned page is written. It is small, and this happens off boost so the I2C traffic doesn't matter.
+	__commitTableToEeprom(LEARNED_EEPROM_PAGE);
+
+	_learnedDirty = false;
+
+	_nextLearnedCommitTime = hal_delayed_by_ms(curTime, LEARNED_COMMIT_INTERVAL_MS);
+}
+
+void BoostOptions::__reportClearProgress(unsigned clearedCount, unsigned totalCount)
+{
+	// Every 4 KB is often enough to see it is moving, on a clear that takes a few seconds.
+	if(debugMsgActive && (clearedCount % 4096 < WRITE_PAGE_SIZE || clearedCount == totalCount))
+	{
+		printf("EEPROM clearing: %u of %u bytes.\n", clearedCount, totalCount);
+	}
 }
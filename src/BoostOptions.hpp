@@ -6,6 +6,7 @@
 #include "PicoSwitch.hpp"
 #include "TM1637_pico.hpp"
 #include "Eeprom_24CS256.hpp"
+#include "EepromCommitter.hpp"
 
 #include "gpioAlloc.hpp"
 
@@ -35,6 +36,90 @@
 /** Size of EEPROM page, in bytes, that stores options. */
 #define OPTIONS_EEPROM_PAGE_SIZE 192
 
+/** Size of EEPROM page, in bytes, that stores the feed forward duty tables of all presets. */
+#define FEED_FORWARD_EEPROM_PAGE_SIZE (5 * FEED_FORWARD_BOOST_POINTS * FEED_FORWARD_LOAD_POINTS * 2)
+
+/** Number of wear levelled copies of the feed forward page. It changes much less often than the options page. */
+#define FEED_FORWARD_EEPROM_WEAR_COUNT 16
+
+/** Size of EEPROM page, in bytes, that stores the learned zero point offset tables of all presets. */
+#define LEARNED_EEPROM_PAGE_SIZE FEED_FORWARD_EEPROM_PAGE_SIZE
+
+/** Number of wear levelled copies of the learned offsets page. */
+#define LEARNED_EEPROM_WEAR_COUNT 16
+
+/**
+ * Minimum time between writing learned offsets to EEPROM, in milliseconds. Offsets are learnt at most once a second, so
+ * this stops every one of them costing an EEPROM write.
+ */
+#define LEARNED_COMMIT_INTERVAL_MS 60000
+
+/**
+ * Time options must go unchanged, in milliseconds, before they are committed to EEPROM. So flicking through presets
+ * only costs one commit.
+ */
+#define OPTIONS_COMMIT_QUIET_MS 3000
+
+/**
+ * Longest time, in milliseconds, changed options wait for the solenoid to be de-energised before they are committed
+ * anyway. Commits are held back while it is energised so EEPROM traffic doesn't land in the middle of a boost event.
+ */
+#define OPTIONS_COMMIT_MAX_DELAY_MS 30000
+
+/**
+ * VSys, in millivolts, below which changed options and learned offsets are committed straight away. ie Power is going,
+ * so they are written while there is still time to.
+ */
+#define OPTIONS_BROWN_OUT_MILLIVOLTS 4400
+
+/**
+ * Set to 1 to keep a RAM mirror of the EEPROM's wear levelled pages. Page reads then don't touch the bus, and chip pages
+ * a commit doesn't change aren't written.
+ */
+#define OPTIONS_EEPROM_MIRROR 1
+
+/**
+ * Set to 1 to store the EEPROM pages as changes only, so a small edit is a single chip page write.
+ * @note Changing this reformats the EEPROM, losing the stored options.
+ */
+#define OPTIONS_EEPROM_DELTA 1
+
+/** EEPROM page indexes. */
+#define OPTIONS_EEPROM_PAGE 0
+#define FEED_FORWARD_EEPROM_PAGE 1
+#define LEARNED_EEPROM_PAGE 2
+
+/**
+ * Version of the layout of the options page. Stored on the page. Bump it when the meaning of an existing tag changes, and
+ * convert the old meaning when reading. Adding tags doesn't need a bump, as readers skip tags they don't know.
+ * Version 0 is the hand packed layout from before the page was tagged. It has no signature.
+ */
+#define OPTIONS_SCHEMA_VERSION 1
+
+/** First bytes of a tagged options page. */
+#define OPTIONS_SCHEMA_SIGNATURE_0 'B'
+#define OPTIONS_SCHEMA_SIGNATURE_1 'O'
+#define OPTIONS_SCHEMA_SIGNATURE_SIZE 2
+
+/** Tags of the options page. Never reuse a tag, even once it is no longer written. */
+#define OPTIONS_TAG_VERSION 1
+#define OPTIONS_TAG_MAX_BRIGHTNESS 2
+#define OPTIONS_TAG_MIN_BRIGHTNESS 3
+#define OPTIONS_TAG_PRESET_INDEX 4
+#define OPTIONS_TAG_PRESET_SELECT_INDEX 5
+/** Group of a preset's parameters. One per preset, in order. */
+#define OPTIONS_TAG_PRESET 6
+
+/** Tags in a preset group. */
+#define PRESET_TAG_MAX_KPA 1
+#define PRESET_TAG_DE_ENERGISE_KPA 2
+#define PRESET_TAG_PID_ACTIVE_KPA 3
+#define PRESET_TAG_PID_PROP_CONST 4
+#define PRESET_TAG_PID_INTEG_CONST 5
+#define PRESET_TAG_PID_DERIV_CONST 6
+#define PRESET_TAG_MAX_DUTY 7
+#define PRESET_TAG_ZERO_POINT_DUTY 8
+
 /**
  * Boost option processing.
  * Controls the display and button input.
@@ -117,6 +202,40 @@ class BoostOptions
 		 */
 		void poll();
 
+		/** Get the preset index used when preset select is not active. 0-4. */
+		int getPresetIndex();
+
+		/**
+		 * Switch to a preset, as the preset index does. The current parameters are kept in the previous preset.
+		 * @param index Preset index. 0-4.
+		 * @returns False if the index is out of range.
+		 */
+		bool setPresetIndex(int index);
+
+		/** Get whether the preset select input is active, in which case the preset select index is in use. */
+		bool isPresetSelectActive();
+
+		/**
+		 * Queue the current parameters, and all other options, to be committed to EEPROM in the background.
+		 * @returns False if the options don't fit their page, so aren't committed. The tables still are.
+		 */
+		bool commit();
+
+		/** Get the state of the background EEPROM commit. */
+		EepromCommitState getCommitState();
+
+		/** Get the number of EEPROM pages committed and verified. */
+		unsigned getCommitCount();
+
+		/** Get the number of EEPROM page commits that failed. */
+		unsigned getCommitFailCount();
+
+		/**
+		 * Get the time from construction starting to the options having been read from EEPROM and applied, in micro
+		 * seconds. Includes loading the RAM mirror and finding the current pages.
+		 */
+		uint32_t getOptionsReadyTimeUs();
+
 	protected:
 
 	private:
@@ -176,7 +295,7 @@ class BoostOptions
 		uint8_t _dispData[4];
 
 		/** Next render time for display. Stops flickering of the display when values change rapidly. */
-		absolute_time_t _nextDisplayRenderTime;
+		hal_time_t _nextDisplayRenderTime;
 
 		/** The default selected option. */
 		int _defaultSelectOption = CURRENT_BOOST_PSI;
@@ -197,12 +316,18 @@ class BoostOptions
 		bool _displayFlashOn = true;
 
 		/** Next absolute time to toggle the current display flash flag. */
-		absolute_time_t _nextDisplayFlashToggleTime = 0;
+		hal_time_t _nextDisplayFlashToggleTime = 0;
 
 		/** 24CS256 EEPROM responding to address 0 on i2c bus 0. */
 		Eeprom_24CS256* _eeprom24CS256;
 
-		EepromPage _eepromPages[1] = {{OPTIONS_EEPROM_PAGE_SIZE, 64}};
+		/** Writes pages to the EEPROM in the background, so commits don't hold up the display and buttons. */
+		EepromCommitter* _eepromCommitter;
+
+		/** Wear levelled pages. Options, then feed forward tables, then learned offset tables. */
+		EepromPage _eepromPages[3] = {{OPTIONS_EEPROM_PAGE_SIZE, 64, OPTIONS_EEPROM_DELTA},
+			{FEED_FORWARD_EEPROM_PAGE_SIZE, FEED_FORWARD_EEPROM_WEAR_COUNT, OPTIONS_EEPROM_DELTA},
+			{LEARNED_EEPROM_PAGE_SIZE, LEARNED_EEPROM_WEAR_COUNT, OPTIONS_EEPROM_DELTA}};
 
 		/** Boost presets. */
 		BoostControlParameters _boostPresets[5];
@@ -216,9 +341,73 @@ class BoostOptions
 		/** True if the preset select index is active. */
 		bool _presetSelectIndexActive = false;
 
-		/** Run options related tests. */
+		/** True while options initiated tests are running on boost control. */
+		bool _testActive = false;
+
+		/** Identifier of the boost control command that started the running tests. */
+		uint32_t _testCommandId = 0;
+
+		/** True while an auto tune is running on boost control. */
+		bool _autoTuneActive = false;
+
+		/** True if the last auto tune failed. */
+		bool _autoTuneFailed = false;
+
+		/** Identifier of the boost control command that started the running auto tune. */
+		uint32_t _autoTuneCommandId = 0;
+
+		/** Progress of the running auto tune. In %. */
+		unsigned _autoTuneProgress = 0;
+
+		/** True if learned offsets have changed since they were last written to EEPROM. */
+		bool _learnedDirty = false;
+
+		/** Earliest time that learned offsets can next be written to EEPROM. */
+		hal_time_t _nextLearnedCommitTime = 0;
+
+		/** True if options have changed since they were last committed to EEPROM. */
+		bool _optionsDirty = false;
+
+		/** Time options last changed. */
+		hal_time_t _optionsChangedTime = 0;
+
+		/** Time from construction starting to the options being read from EEPROM, in micro seconds. */
+		uint32_t _optionsReadyTimeUs = 0;
+
+		/** Start options related tests. These run on boost control and complete asynchronously. */
 		void __runTests();
 
+		/** Process any responses from boost control. */
+		void __processResponses();
+
+		/**
+		 * Store a learned zero point offset reported by boost control in its preset. It is written to EEPROM later.
+		 */
+		void __storeLearnedOffset(BoostControlLearnedOffset* learnedOffset);
+
+		/**
+		 * Write changed learned offsets to EEPROM when it is a good time to.
+		 * ie The solenoid is de-energised and they haven't been written for LEARNED_COMMIT_INTERVAL_MS. Straight away on
+		 * brown out.
+		 */
+		void __processLearnedCommit();
+
+		/** Mark options as changed, so they are committed to EEPROM once it is a good time to. */
+		void __markOptionsDirty();
+
+		/**
+		 * Commit changed options to EEPROM when it is a good time to. ie They haven't changed for OPTIONS_COMMIT_QUIET_MS,
+		 * edit mode isn't active, and the solenoid is de-energised or they have waited OPTIONS_COMMIT_MAX_DELAY_MS.
+		 * Straight away on brown out.
+		 */
+		void __processOptionsCommit();
+
+		/** Get whether VSys has dropped below OPTIONS_BROWN_OUT_MILLIVOLTS. */
+		bool __isBrownOut();
+
+		/** Report progress of an EEPROM clear. ie Formatting on first boot. */
+		static void __reportClearProgress(unsigned clearedCount, unsigned totalCount);
+
 		/** Display the current boost, in kPa. */
 		void __displayCurrentBoostKpa();
 
@@ -273,21 +462,31 @@ class BoostOptions
 		/** Invoke the factory reset. */
 		void __invokeFactoryReset();
 
-		/** Invoke auto tune for current preset. */
+		/** Invoke auto tune for current preset. Stops it if it is already running. */
 		void __invokeAutoTune();
 
+		/**
+		 * Apply the result of an auto tune to the current preset and save it.
+		 * @param result Auto tune result from boost control.
+		 */
+		void __applyAutoTune(RelayAutoTuneResult* result);
+
 		/** Set all variables to default values. */
 		void __setDefaults();
 
 		/** Setup boost control parameters from the current preset. */
 		void __setupControlFromCurPreset();
 
+		/** Setup boost control parameters from the current preset, which has just been switched to. */
+		void __switchControlToCurPreset();
+
 		/** Populate current preset from current boost control parameters. */
 		void __populateCurPresetFromControl();
 
 		/**
-		 * Commit the current boost options to EEPROM.
-		 * @returns True if commit was verified as being successful.
+		 * Queue the current boost options, and tables, to be committed to EEPROM. They are written, and verified, by the
+		 * EEPROM committer over the following polls.
+		 * @returns False if the options don't fit their page, so aren't queued.
 		 */
 		bool __commitToEeprom();
 
@@ -297,6 +496,42 @@ class BoostOptions
 		 */
 		bool __readFromEeprom();
 
+		/**
+		 * Read options from a tagged options page. Options it doesn't have keep their current values.
+		 * @param page Options page, starting with the signature.
+		 */
+		void __readOptionsTagged(const uint8_t* page);
+
+		/**
+		 * Read options from a version 0, hand packed, options page, as carried over from an EEPROM in the original format.
+		 * A 32 bit byte wise checksum of the rest of the page, five presets of eight 32 bit parameters, then the max
+		 * brightness, min brightness, preset index and preset select index bytes.
+		 * @param page Options page.
+		 * @returns True if read. False if the checksum doesn't match, in which case nothing is changed.
+		 */
+		bool __readOptionsLegacy(const uint8_t* page);
+
+		/**
+		 * Queue a table of all presets to be committed to EEPROM.
+		 * @note The local presets must already be up to date.
+		 * @param page FEED_FORWARD_EEPROM_PAGE for the feed forward tables or LEARNED_EEPROM_PAGE for the learned offsets.
+		 */
+		void __commitTableToEeprom(unsigned page);
+
+		/**
+		 * Read a table of all presets from EEPROM into the local presets.
+		 * @param page FEED_FORWARD_EEPROM_PAGE for the feed forward tables or LEARNED_EEPROM_PAGE for the learned offsets.
+		 * @returns True if read was successful. The local presets are left as is if not.
+		 */
+		bool __readTableFromEeprom(unsigned page);
+
+		/**
+		 * Get the table stored on a page from a preset.
+		 * @param preset Preset to get the table of.
+		 * @param page FEED_FORWARD_EEPROM_PAGE or LEARNED_EEPROM_PAGE.
+		 */
+		static int16_t (*__tableOf(BoostControlParameters* preset, unsigned page))[FEED_FORWARD_LOAD_POINTS];
+
 		/**
 		 * Alter the preset index by the given delta.
 		 */
@@ -0,0 +1,69 @@
+#ifndef BOOST_TELEMETRY_H
+#define BOOST_TELEMETRY_H
+
+#include <cstdint>
+
+// Telemetry logged by core 1 on every control step, for core 0 to drain and pass on.
+// Records are small and fixed size so a ring of them costs little RAM, and logging one is a handful of stores.
+
+/** Flags of BoostTelemetryRecord::flags. */
+enum BoostTelemetryFlag
+{
+	/** The solenoid is energised. */
+	BOOST_TELEMETRY_ENERGISED = 0x01,
+
+	/** The PID algorithm is controlling the solenoid. The P, I and D terms are only valid with this set. */
+	BOOST_TELEMETRY_PID_ACTIVE = 0x02,
+
+	/** A solenoid test sweep is running. */
+	BOOST_TELEMETRY_TEST_ACTIVE = 0x04,
+
+	/** A PID auto tune is running. */
+	BOOST_TELEMETRY_AUTO_TUNE_ACTIVE = 0x08,
+
+	/** Boost is at or over the target. */
+	BOOST_TELEMETRY_MAX_BOOST = 0x10
+};
+
+/**
+ * State of one control step.
+ */
+struct BoostTelemetryRecord
+{
+	/** Time of the control step, from the 32 bit microsecond timer. */
+	uint32_t timeUs;
+
+	/** Low 16 bits of the record count. A gap between consecutive records means records were dropped. */
+	uint16_t sequence;
+
+	/** BoostTelemetryFlag bits. */
+	uint16_t flags;
+
+	/** Filtered MAP sensor ADC code. 12 bits, or 16 with DMA capture oversampling. */
+	uint16_t mapRaw;
+
+	/** Filtered VSys ADC code. 12 bits, or 16 with DMA capture oversampling. */
+	uint16_t vsysRaw;
+
+	/** Boost, relative to std atm. In kPa, scaled by 1000. */
+	int32_t kpaScaled;
+
+	/** Target boost - boost. In kPa, scaled by 1000. */
+	int32_t errorKpaScaled;
+
+	/** PID proportional term. In %, scaled by 10. */
+	int16_t propTermScaled;
+
+	/** PID integral term. In %, scaled by 10. */
+	int16_t integTermScaled;
+
+	/** PID derivative term. In %, scaled by 10. */
+	int16_t derivTermScaled;
+
+	/** Solenoid duty cycle. In %, scaled by 10. */
+	uint16_t dutyScaled;
+};
+
+static_assert(sizeof(BoostTelemetryRecord) == 28, "Telemetry record should be packed with no padding");
+
+#endif
@@ -1,7 +1,5 @@
 #include <stdio.h>
 
-#include "hardware/adc.h"
-
 #include "BoschMap_0261230119.hpp"
 
 extern bool debugMsgActive;
@@ -10,10 +8,16 @@ BoschMap_0261230119::~BoschMap_0261230119()
 {
 }
 
-BoschMap_0261230119::BoschMap_0261230119(unsigned adcInput,  double vRef, double vScale, PicoAdcReader* vSysAdcReader) :
-	_vSysAdcReader(vSysAdcReader)
+BoschMap_0261230119::BoschMap_0261230119(AdcReader* mapAdcReader, AdcReader* vSysAdcReader) :
+	_picoAdcReader(mapAdcReader), _vSysAdcReader(vSysAdcReader)
 {
-	_picoAdcReader = new PicoAdcReader(adcInput, 10, vRef, vScale);
+	// Pre-calculate the constants required for the integer only kPa calculation.
+	// The voltage scales take into account the resolution of each ADC reader.
+	double rawRatioToVoltageRatio = _picoAdcReader -> getVoltageScale() / _vSysAdcReader -> getVoltageScale();
+
+	_kpaScaledPerRawRatio = rawRatioToVoltageRatio * 1000.0 / _bosch_map_c1 + 0.5;
+
+	_c0OnC1Scaled = _bosch_map_c0 * 1000.0 / _bosch_map_c1 + 0.5;
 }
 
 void BoschMap_0261230119::latch()
@@ -32,6 +36,21 @@ double BoschMap_0261230119::readKpa()
 	return __readKpa();
 }
 
+uint32_t BoschMap_0261230119::readKpaScaled()
+{
+	uint32_t rawVSys = _vSysAdcReader -> readRaw();
+
+	if(rawVSys == 0) return 0;
+
+	// Same equation as __readKpa() but re-arranged so that only one divide is required.
+	// Oversampled readers can have more than 12 bits so the multiply is done in 64 bits.
+	uint32_t ratioKpaScaled = ((uint64_t)_picoAdcReader -> readRaw() * _kpaScaledPerRawRatio) / rawVSys;
+
+	if(ratioKpaScaled < _c0OnC1Scaled) return 0;
+
+	return ratioKpaScaled - _c0OnC1Scaled;
+}
+
 double BoschMap_0261230119::__readKpa()
 {
 	// The actual bosch map sensor output, referenced to 5V.
@@ -6,7 +6,7 @@
 
 #include <stdint.h>
 
-#include "PicoAdcReader.hpp"
+#include "AdcReader.hpp"
 
 /**
  * Bosch 0261230119 map sensor.
@@ -19,13 +19,11 @@ class BoschMap_0261230119
 		virtual ~BoschMap_0261230119();
 
 		/**
-		 * @param adcInput ADC input number (Pico I has 0, 1 and 2 as external pins).
-		 * @param vRef The reference voltage used by the Pico ADC.
-		 * @param vScale Scaling factor to apply to the Pico ADC to get the map sensor output voltage. Takes into account a
-		 *        voltage divider.
+		 * @param mapAdcReader The ADC reader that provides the map sensor output voltage. Its scale must take into account
+		 *        any voltage divider. Not owned by this.
 		 * @param vSysAdcReader The ADC reader that provides VSys voltage. Not owned by this.
 		 */
-		BoschMap_0261230119(unsigned adcInput, double vRef, double vScale, PicoAdcReader* vSysAdcReader);
+		BoschMap_0261230119(AdcReader* mapAdcReader, AdcReader* vSysAdcReader);
 
 		/**
 		 * Latch the current raw map sensor data.
@@ -38,6 +36,12 @@ class BoschMap_0261230119
 		 */
 		double readKpa();
 
+		/**
+		 * Read the map sensor and return the value in kpa, scaled by 1000.
+		 * @note This only uses integer maths.
+		 */
+		uint32_t readKpaScaled();
+
 		/**
 		 * Read the map sensor and return the value in psi.
 		 */
@@ -69,11 +73,20 @@ class BoschMap_0261230119
 		/** Ratio of voltage divider used to convert MAP sensor 5V output to VRef range. */
 		static double _voltageDividerRatio;
 
-		/** Pico ADC reader for the MAP sensor input. */
-		PicoAdcReader* _picoAdcReader;
+		/**
+		 * Multiplier that converts the ratio of raw map sensor ADC value to raw VSys ADC value into kPa scaled by 1000.
+		 * ie Takes into account the ADC voltage scales and the c1 constant.
+		 */
+		uint32_t _kpaScaledPerRawRatio;
+
+		/** The c0 constant divided by the c1 constant. Scaled by 1000. */
+		uint32_t _c0OnC1Scaled;
+
+		/** ADC reader for the MAP sensor input. */
+		AdcReader* _picoAdcReader;
 
-		/** Pico ADC reader for VSys. */
-		PicoAdcReader* _vSysAdcReader;
+		/** ADC reader for VSys. */
+		AdcReader* _vSysAdcReader;
 };
 
 #endif
\ No newline at end of file
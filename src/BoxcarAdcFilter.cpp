@@ -0,0 +1,35 @@
+#include "BoxcarAdcFilter.hpp"
+
+BoxcarAdcFilter::~BoxcarAdcFilter()
+{
+	delete[] _values;
+}
+
+BoxcarAdcFilter::BoxcarAdcFilter(unsigned length) : _length(length)
+{
+	if(_length == 0) _length = 1;
+
+	_values = new uint32_t[_length];
+
+	for(unsigned index = 0; index < _length; index++)
+	{
+		_values[index] = 0;
+	}
+}
+
+void BoxcarAdcFilter::push(uint32_t value)
+{
+	// Swap the oldest value in the sum for the new one.
+	_sum = _sum - _values[_curPosn] + value;
+
+	_values[_curPosn] = value;
+
+	_curPosn++;
+
+	if(_curPosn >= _length) _curPosn = 0;
+}
+
+uint32_t BoxcarAdcFilter::output()
+{
+	return _sum / _length;
+}
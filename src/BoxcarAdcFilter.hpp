@@ -0,0 +1,44 @@
+#ifndef BOXCAR_ADC_FILTER_H
+#define BOXCAR_ADC_FILTER_H
+
+#include <stdint.h>
+
+#include "AdcFilter.hpp"
+
+/**
+ * Moving average (boxcar) filter over the last N values.
+ * Keeps a running sum that is updated as each value is pushed, so the cost doesn't depend on N.
+ */
+class BoxcarAdcFilter : public AdcFilter
+{
+	public:
+
+		virtual ~BoxcarAdcFilter();
+
+		/**
+		 * @param length The number of values to average over.
+		 */
+		BoxcarAdcFilter(unsigned length);
+
+		// Impl.
+		void push(uint32_t value);
+
+		// Impl.
+		uint32_t output();
+
+	private:
+
+		/** Number of values averaged over. */
+		unsigned _length;
+
+		/** The last N values pushed. */
+		uint32_t* _values;
+
+		/** The current position that values are written into. */
+		unsigned _curPosn = 0;
+
+		/** Sum of all values in _values. */
+		uint32_t _sum = 0;
+};
+
+#endif
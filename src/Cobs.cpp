@@ -0,0 +1,66 @@
+#include "Cobs.hpp"
+
+unsigned Cobs::encode(const uint8_t* src, unsigned len, uint8_t* dst)
+{
+	// Each code byte is the distance to the next zero, which it replaces. A block of 254 non zero bytes gets a code of
+	// 0xFF, which doesn't stand for a zero.
+	unsigned codeIndex = 0;
+	unsigned dstIndex = 1;
+	uint8_t code = 1;
+
+	for(unsigned index = 0; index < len; index++)
+	{
+		if(src[index] == 0)
+		{
+			dst[codeIndex] = code;
+			codeIndex = dstIndex++;
+			code = 1;
+		}
+		else
+		{
+			dst[dstIndex++] = src[index];
+			code++;
+
+			if(code == 0xFF)
+			{
+				dst[codeIndex] = code;
+				codeIndex = dstIndex++;
+				code = 1;
+			}
+		}
+	}
+
+	dst[codeIndex] = code;
+
+	return dstIndex;
+}
+
+int Cobs::decode(const uint8_t* src, unsigned len, uint8_t* dst, unsigned maxLen)
+{
+	unsigned srcIndex = 0;
+	unsigned dstIndex = 0;
+
+	while(srcIndex < len)
+	{
+		uint8_t code = src[srcIndex++];
+
+		if(code == 0) return -1;
+
+		for(unsigned count = 1; count < code; count++)
+		{
+			if(srcIndex >= len || dstIndex >= maxLen || src[srcIndex] == 0) return -1;
+
+			dst[dstIndex++] = src[srcIndex++];
+		}
+
+		// Every code but 0xFF stands for a zero, except at the very end.
+		if(code != 0xFF && srcIndex < len)
+		{
+			if(dstIndex >= maxLen) return -1;
+
+			dst[dstIndex++] = 0;
+		}
+	}
+
+	return dstIndex;
+}
@@ -0,0 +1,39 @@
+#ifndef COBS_H
+#define COBS_H
+
+#include <stdint.h>
+
+/** Most bytes encoding can add to a block of len bytes. */
+#define COBS_MAX_OVERHEAD(len) ((len) / 254 + 1)
+
+/**
+ * Consistent overhead byte stuffing. Encodes a block of bytes so it contains no zeros, so a zero can mark the end of
+ * each frame in a byte stream. A reader that joins part way through, or sees corrupt bytes, resynchronises at the next
+ * zero.
+ * @note This has no hardware dependencies so it can be built on the host.
+ */
+class Cobs
+{
+	public:
+
+		/**
+		 * Encode a block of bytes. The zero delimiter is not added.
+		 * @param src Bytes to encode.
+		 * @param len Number of bytes to encode.
+		 * @param dst Encoded bytes are written here. Must have room for len + COBS_MAX_OVERHEAD(len) bytes.
+		 * @returns Number of encoded bytes.
+		 */
+		static unsigned encode(const uint8_t* src, unsigned len, uint8_t* dst);
+
+		/**
+		 * Decode a block of encoded bytes. The zero delimiter must not be included.
+		 * @param src Encoded bytes.
+		 * @param len Number of encoded bytes.
+		 * @param dst Decoded bytes are written here.
+		 * @param maxLen Size of dst.
+		 * @returns Number of decoded bytes. -1 if the encoding is invalid or the result doesn't fit.
+		 */
+		static int decode(const uint8_t* src, unsigned len, uint8_t* dst, unsigned maxLen);
+};
+
+#endif
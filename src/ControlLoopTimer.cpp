@@ -0,0 +1,68 @@
+#include "hardware/sync.h"
+
+#include "ControlLoopTimer.hpp"
+
+ControlLoopTimer::~ControlLoopTimer()
+{
+	if(_alarmPool)
+	{
+		cancel_repeating_timer(&_timer);
+		alarm_pool_destroy(_alarmPool);
+	}
+}
+
+ControlLoopTimer::ControlLoopTimer(BoostControl* boostControl, unsigned latchPeriodUs, unsigned latchesPerStep) :
+	_boostControl(boostControl), _latchPeriodUs(latchPeriodUs), _latchesPerStep(latchesPerStep)
+{
+	if(_latchesPerStep == 0) _latchesPerStep = 1;
+}
+
+void ControlLoopTimer::run()
+{
+	// The alarm pool interrupt is registered on the calling core, which keeps the latch interrupt off core 0.
+	_alarmPool = alarm_pool_create_with_unused_hardware_alarm(CONTROL_LOOP_TIMER_MAX_TIMERS);
+
+	// A negative delay means the period is measured between scheduled start times, rather than from the end of one
+	// callback to the start of the next. So the rate doesn't drift with how long the callback takes.
+	alarm_pool_add_repeating_timer_us(_alarmPool, -(int64_t)_latchPeriodUs, __timerCallback, this, &_timer);
+
+	while(1)
+	{
+		// Sleep until the next interrupt or event.
+		__wfe();
+
+		if(_stepPending)
+		{
+			_stepPending = false;
+
+			_boostControl -> controlTick();
+
+			// Commands from core 0 are only processed between steps, so they never delay one.
+			_boostControl -> processCommands();
+		}
+	}
+}
+
+bool ControlLoopTimer::__timerCallback(repeating_timer_t* timer)
+{
+	return ((ControlLoopTimer*)timer -> user_data) -> __processTimer();
+}
+
+bool ControlLoopTimer::__processTimer()
+{
+	_boostControl -> latchTick();
+
+	_latchCount++;
+
+	if(_latchCount >= _latchesPerStep)
+	{
+		_latchCount = 0;
+
+		_stepPending = true;
+
+		// Make sure WFE in the control loop wakes, even if the event was consumed before the flag was checked.
+		__sev();
+	}
+
+	return true;
+}
@@ -0,0 +1,69 @@
+#ifndef CONTROL_LOOP_TIMER_H
+#define CONTROL_LOOP_TIMER_H
+
+#include "pico/time.h"
+
+#include "BoostControl.hpp"
+
+/** Maximum number of timers in the control loop alarm pool. */
+#define CONTROL_LOOP_TIMER_MAX_TIMERS 2
+
+/**
+ * Drives the boost control loop from a hardware alarm instead of polling.
+ * A repeating timer latches the MAP sensor from its interrupt at a fixed rate. Every Nth latch a control step is flagged
+ * and the core is woken to run it. Between interrupts the core sleeps in WFE.
+ * @note The alarm pool is created on, and so the interrupts fire on, the core that calls run().
+ */
+class ControlLoopTimer
+{
+	public:
+
+		virtual ~ControlLoopTimer();
+
+		/**
+		 * @param boostControl Boost control instance to drive. Not owned by this.
+		 * @param latchPeriodUs Period, in microseconds, between MAP sensor latches.
+		 * @param latchesPerStep Number of latches per control step.
+		 */
+		ControlLoopTimer(BoostControl* boostControl, unsigned latchPeriodUs, unsigned latchesPerStep);
+
+		/**
+		 * Start the timer and process control steps, and the commands sent between them, forever.
+		 * @note This does not return.
+		 */
+		void run();
+
+	private:
+
+		/** Repeating timer callback. Forwards to the instance stored in the timer user data. */
+		static bool __timerCallback(repeating_timer_t* timer);
+
+		/**
+		 * Process a single timer interrupt.
+		 * @returns True to keep the timer repeating.
+		 */
+		bool __processTimer();
+
+		/** Boost control instance being driven. */
+		BoostControl* _boostControl;
+
+		/** Period between MAP sensor latches. */
+		unsigned _latchPeriodUs;
+
+		/** Number of latches per control step. */
+		unsigned _latchesPerStep;
+
+		/** Latches since the last control step was flagged. */
+		unsigned _latchCount = 0;
+
+		/** Set from the interrupt to indicate a control step is due. */
+		volatile bool _stepPending = false;
+
+		/** Alarm pool owned by the core running the control loop. */
+		alarm_pool_t* _alarmPool = 0;
+
+		/** The repeating latch timer. */
+		repeating_timer_t _timer;
+};
+
+#endif
@@ -0,0 +1,16 @@
+#include "Crc16.hpp"
+
+uint16_t Crc16::calc(const uint8_t* data, unsigned len, uint16_t crc)
+{
+	for(unsigned index = 0; index < len; index++)
+	{
+		crc ^= (uint16_t)data[index] << 8;
+
+		for(unsigned bit = 0; bit < 8; bit++)
+		{
+			crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+		}
+	}
+
+	return crc;
+}
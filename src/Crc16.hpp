@@ -0,0 +1,28 @@
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <stdint.h>
+
+/** Initial value of a CRC. */
+#define CRC16_INIT 0xFFFF
+
+/**
+ * CRC-16/CCITT-FALSE. Polynomial 0x1021, initial value 0xFFFF, not reflected, no final XOR.
+ * Calculated a bit at a time, so there is no table in flash. It is only used on short frames.
+ * @note This has no hardware dependencies so it can be built on the host.
+ */
+class Crc16
+{
+	public:
+
+		/**
+		 * Calculate, or continue calculating, the CRC of a block of bytes.
+		 * @param data Bytes to add to the CRC.
+		 * @param len Number of bytes.
+		 * @param crc CRC of the bytes before these. CRC16_INIT to start.
+		 * @returns The updated CRC.
+		 */
+		static uint16_t calc(const uint8_t* data, unsigned len, uint16_t crc = CRC16_INIT);
+};
+
+#endif
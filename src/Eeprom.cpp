@@ -1,16 +1,27 @@
 #include <stdio.h>
+#include <string.h>
 
 #include "Eeprom.hpp"
+#include "HalCrc.hpp"
+#include "HalTime.hpp"
 
 Eeprom::~Eeprom()
 {
+	for(unsigned index = 0; _pageInstances && index < _pageCount; index++)
+	{
+		if(_pageInstances[index].image) delete[] _pageInstances[index].image;
+	}
+
 	if(_pages) delete[] _pages;
 	if(_pageInstances) delete[] _pageInstances;
+	if(_writeRecords) delete[] _writeRecords;
+	if(_writeImage) delete[] _writeImage;
 }
 
-Eeprom::Eeprom(unsigned size, EepromPage* pages, uint8_t pageCount)
+Eeprom::Eeprom(unsigned size, unsigned writePageSize, EepromPage* pages, uint8_t pageCount)
 {
 	_eepromSize = size;
+	_writePageSize = writePageSize < EEPROM_MAX_WRITE_PAGE_SIZE ? writePageSize : EEPROM_MAX_WRITE_PAGE_SIZE;
 	_pages = 0;
 	_pageCount = pageCount;
 
@@ -31,23 +42,58 @@ Eeprom::Eeprom(unsigned size, EepromPage* pages, uint8_t pageCount)
 		{
 			_pages[index].pageSize = pages[index].pageSize;
 			_pages[index].wearCount = pages[index].wearCount & 0x7FFF;
+			_pages[index].delta = pages[index].delta;
 
 			_pageInstances[index].physPageIndex = 0;
 			_pageInstances[index].wearIndex = 0;
 			_pageInstances[index].regionStartAddress = curPageRegionStartAddr;
+			_pageInstances[index].image = 0;
+			_pageInstances[index].usedSlotCount = 0;
 
-			// Takes into account page instance wear index.
-			curPageRegionStartAddr += _pages[index].wearCount * (_pages[index].pageSize + 2);
+			// Takes into account page instance wear index and CRC.
+			curPageRegionStartAddr += _pages[index].wearCount * __getInstanceSize(index);
 		}
 
 		// This should now point to the start of the non-page region.
 		_nonPageRegionStartAddress = curPageRegionStartAddr;
+
+		// Delta pages are stored in the same memory as whole copies would be. There has to be room for a new base without
+		// overwriting the current one. Run offsets are a byte, which limits the size.
+		uint16_t maxBaseSlotCount = 0;
+		unsigned maxStoredSize = 0;
+
+		for(unsigned index = 0; index < pageCount; index++)
+		{
+			if(!_pages[index].delta) continue;
+
+			uint16_t baseSlotCount = __getBaseSlotCount(index);
+			unsigned storedSize = _pages[index].pageSize + EEPROM_PAGE_CRC_SIZE;
+
+			if(__getSlotCount(index) < baseSlotCount * 2 || storedSize > 256)
+			{
+				_pages[index].delta = false;
+				continue;
+			}
+
+			_pageInstances[index].image = new uint8_t[storedSize];
+
+			if(baseSlotCount > maxBaseSlotCount) maxBaseSlotCount = baseSlotCount;
+			if(storedSize > maxStoredSize) maxStoredSize = storedSize;
+		}
+
+		if(maxBaseSlotCount)
+		{
+			_writeRecords = new uint8_t[maxBaseSlotCount * _writePageSize];
+			_writeImage = new uint8_t[maxStoredSize];
+		}
 	}
 }
 
 bool Eeprom::writeBytes(uint32_t startAddr, uint8_t* values, unsigned count)
 {
-	return _writeBytes(startAddr, values, count);
+	bool okay = _writeBytes(startAddr, values, count);
+
+	return _flush() && okay;
 }
 
 bool Eeprom::readBytes(uint32_t startAddr, uint8_t* buffer, unsigned count)
@@ -60,6 +106,8 @@ void Eeprom::_init()
 	// First bytes (header) of EEPROM are the magic number followed by the page count and then the pages info.
 	// If any existing header doesn't match what is expected then the header is re-written and the pages region cleared.
 
+	uint64_t startUs = hal_time_us_64();
+
 	bool headerMatches = false;
 
 	uint8_t magic;
@@ -77,6 +125,25 @@ void Eeprom::_init()
 	// Current EEPROM byte address being processed.
 	uint32_t curAddr = 0;
 
+	// Pages in the original format are read before it is reformatted, and written again once it has been.
+	uint8_t** legacyPages = 0;
+
+	if(magic == EEPROM_LEGACY_MAGIC && _pageCount > 0)
+	{
+		legacyPages = new uint8_t*[_pageCount];
+
+		for(unsigned index = 0; index < _pageCount; index++)
+		{
+			legacyPages[index] = new uint8_t[_pages[index].pageSize];
+
+			if(!__readLegacyPage(index, legacyPages[index]))
+			{
+				delete[] legacyPages[index];
+				legacyPages[index] = 0;
+			}
+		}
+	}
+
 	if(magic == EEPROM_MAGIC)
 	{
 		// Check for header matching expected pages.
@@ -103,7 +170,7 @@ void Eeprom::_init()
 				curAddr += 2;
 
 				// Compare to expected page.
-				if(headerPageSize != _pages[index].pageSize || headerWearCount != _pages[index].wearCount)
+				if(headerPageSize != _pages[index].pageSize || headerWearCount != __getHeaderWearCount(index))
 				{
 					headerMatches = false;
 					break;
@@ -114,55 +181,20 @@ void Eeprom::_init()
 
 	if(headerMatches)
 	{
-		// Assume curAddr already points to the first page instance of the first page descr.
-
-		// Get the current wear index of all pages.
-
-		for(unsigned descrIndex = 0; descrIndex < _pageCount; descrIndex++)
-		{
-			uint16_t wearCount = _pages[descrIndex].wearCount;
-
-			// Add extra data per page instance for 16bit wear index.
-			uint32_t pageInstanceSize = _pages[descrIndex].pageSize + 2;
-
-			uint16_t nextWearIndex;
-			uint16_t prevWearIndex = 0;
-
-			curAddr = _pageInstances[descrIndex].regionStartAddress;
-
-			for(unsigned instIndex = 0; instIndex < wearCount; instIndex++)
-			{
-				_readBytes(curAddr + instIndex * pageInstanceSize, (uint8_t*)&nextWearIndex, 2);
-
-				// Wear page is blank. End of search.
-				if(nextWearIndex == 0xFFFF) break;
-
-				// Next wear index must be one more than the previous for the chain of indexes to be complete.
-				// A break in the chain indicates the end of the current wear indexes.
-
-				if(prevWearIndex == 0 || nextWearIndex == prevWearIndex + 1)
-				{
-					// Found more recent page instance.
-					_pageInstances[descrIndex].physPageIndex = instIndex;
-					_pageInstances[descrIndex].wearIndex = nextWearIndex;
-				}
-				else
-				{
-					break;
-				}
-
-				prevWearIndex = nextWearIndex;
-			}
-
-			// Jump to next page region.
-			curAddr += pageInstanceSize * wearCount;
-		}
+		// Get the current page instance of all pages.
+		for(unsigned descrIndex = 0; descrIndex < _pageCount; descrIndex++) __recoverPage(descrIndex);
 	}
 	else
 	{
-		// Write the magic to the first byte.
-		magic = EEPROM_MAGIC;
-		_writeBytes(0, &magic, 1);
+		// Invalidate the header, on the chip, before changing it. Otherwise a format cut short by power loss could leave
+		// the magic over the new page count and descriptors, but a pages region that hasn't been cleared yet.
+		if(magic != 0xFF)
+		{
+			magic = 0xFF;
+			_writeBytes(0, &magic, 1);
+
+			_flush();
+		}
 
 		// Write the page count to the header.
 		_writeBytes(EEPROM_PAGE_COUNT_ADDR, &_pageCount, 1);
@@ -178,29 +210,55 @@ void Eeprom::_init()
 		{
 			uint8_t pageSize = _pages[index].pageSize;
 			uint16_t wearCount = _pages[index].wearCount;
+			uint16_t headerWearCount = __getHeaderWearCount(index);
 
 			_writeBytes(curHeaderAddr++, &pageSize, 1);
 			// This is fine as long a everything is little endian.
-			_writeBytes(curHeaderAddr, (uint8_t*)&wearCount, 2);
+			_writeBytes(curHeaderAddr, (uint8_t*)&headerWearCount, 2);
 
 			// Move onto next header entry.
 			curHeaderAddr += 2;
 
 			// Clear the pages region.
-			uint32_t pageRegionAllocSize = (pageSize + 2) * wearCount;
+			uint32_t pageRegionAllocSize = __getInstanceSize(index) * wearCount;
 			_clear(0xFF, curPageRegionAddr, pageRegionAllocSize);
 
 			// Calc next page instance region start.
 			curPageRegionAddr += pageRegionAllocSize;
 		}
+
+		_pagesInitialised = true;
+
+		// Before the magic, so they are lost, rather than half written, if the power is cut. The format is started again,
+		// but they can't be read from the original format any more.
+		for(unsigned index = 0; legacyPages && index < _pageCount; index++)
+		{
+			if(!legacyPages[index]) continue;
+
+			writePage(index, legacyPages[index]);
+
+			delete[] legacyPages[index];
+		}
+
+		if(legacyPages) delete[] legacyPages;
+
+		// Write the magic to the first byte last, so the header only matches once the pages region has been cleared.
+		magic = EEPROM_MAGIC;
+		_writeBytes(0, &magic, 1);
+
+		_flush();
 	}
 
 	_pagesInitialised = true;
+
+	_initTimeUs = (uint32_t)(hal_time_us_64() - startUs);
 }
 
 void Eeprom::clear(uint8_t value, unsigned start, unsigned count)
 {
 	_clear(value, start, count);
+
+	_flush();
 }
 
 bool Eeprom::readPage(uint8_t pageId, uint8_t* page)
@@ -208,24 +266,41 @@ bool Eeprom::readPage(uint8_t pageId, uint8_t* page)
 	// Page subsystem not initialised or no pages have been written yet for the given page id.
 	if(!_pagesInitialised || _pageInstances[pageId].wearIndex == 0) return false;
 
-	uint8_t pageSize = _pages[pageId].pageSize;
+	if(_pages[pageId].delta)
+	{
+		uint8_t pageSize = _pages[pageId].pageSize;
 
-	// Get pages start byte address. The +2 is to account for the wear index.
-	uint32_t pageInstanceStartAddr = _pageInstances[pageId].regionStartAddress + (pageSize + 2) *
-		_pageInstances[pageId].physPageIndex + 2;
+		// Rebuilt from the records when initialised, and kept up to date since. Its CRC was checked as it was rebuilt.
+		if(_pageInstances[pageId].usedSlotCount == 0) return false;
 
-	return _readBytes(pageInstanceStartAddr, page, pageSize);
+		memcpy(page, _pageInstances[pageId].image, pageSize);
+
+		return true;
+	}
+
+	return __readInstance(pageId, _pageInstances[pageId].physPageIndex, page);
 }
 
 bool Eeprom::writePage(uint8_t pageId, uint8_t* pageData)
 {
-	if(!_pagesInitialised) return false;
+	// Don't interleave with an incremental write. It could be to the same page instance.
+	if(!_pagesInitialised || _writeState != EEPROM_WRITE_IDLE) return false;
+
+	if(_pages[pageId].delta)
+	{
+		// Records can wrap around the end of the page's memory, and there may be more than one. The incremental write
+		// already deals with that, so just wait for each of its steps.
+		if(!startWritePage(pageId, pageData)) return false;
 
-	// Get next wear index to write. Rely on unsigned 16 bit integer rolling over to 0 once maxed out.
-	uint16_t nextWearIndex = _pageInstances[pageId].wearIndex + 1;
+		EepromWriteResult result;
+
+		while((result = stepWritePage()) == EEPROM_WRITE_IN_PROGRESS);
+
+		return result == EEPROM_WRITE_COMPLETE;
+	}
 
 	// Wear index can't be 0 because that is reserved for "no pages present".
-	if(nextWearIndex == 0) nextWearIndex++;
+	uint16_t nextWearIndex = __getNextWearIndex(_pageInstances[pageId].wearIndex);
 
 	// Find the next page index to write to. Check for "no pages written yet".
 	uint16_t nextPageIndex = _pageInstances[pageId].wearIndex == 0 ? 0 : _pageInstances[pageId].physPageIndex + 1;
@@ -236,21 +311,836 @@ bool Eeprom::writePage(uint8_t pageId, uint8_t* pageData)
 	uint8_t pageSize = _pages[pageId].pageSize;
 
 	// Get byte address to write to.
-	uint32_t pageInstanceStartAddr = _pageInstances[pageId].regionStartAddress + (pageSize + 2) * nextPageIndex;
+	uint32_t pageInstanceStartAddr = __getSlotAddress(pageId, nextPageIndex);
+
+	uint32_t crc = hal_crc32(pageData, pageSize);
 
-	// Write wear index.
-	bool okay = _writeBytes(pageInstanceStartAddr, (uint8_t*)&nextWearIndex, 2);
+	// Write page data and its CRC. They must be on the chip before the wear index, which makes the instance current.
+	bool okay = _writeBytes(pageInstanceStartAddr, pageData, pageSize) &&
+		_writeBytes(pageInstanceStartAddr + pageSize, (uint8_t*)&crc, EEPROM_PAGE_CRC_SIZE) && _flush();
 
 	if(okay)
 	{
-		// Write page data.
-		okay = _writeBytes(pageInstanceStartAddr + 2, pageData, pageSize);
+		// Write wear index.
+		okay = _writeBytes(pageInstanceStartAddr + pageSize + EEPROM_PAGE_CRC_SIZE, (uint8_t*)&nextWearIndex,
+			EEPROM_WEAR_INDEX_SIZE);
 
 		_pageInstances[pageId].wearIndex = nextWearIndex;
 		_pageInstances[pageId].physPageIndex = nextPageIndex;
 	}
 
-	return okay;
+	return _flush() && okay;
+}
+
+bool Eeprom::startWritePage(uint8_t pageId, uint8_t* pageData)
+{
+	if(!_pagesInitialised || _writeState != EEPROM_WRITE_IDLE) return false;
+
+	// Same wear index and page instance selection as writePage().
+	uint16_t nextWearIndex = __getNextWearIndex(_pageInstances[pageId].wearIndex);
+
+	uint16_t nextPageIndex = _pageInstances[pageId].wearIndex == 0 ? 0 : _pageInstances[pageId].physPageIndex + 1;
+
+	if(nextPageIndex >= __getSlotCount(pageId)) nextPageIndex = 0;
+
+	_writePageId = pageId;
+	_writePageData = pageData;
+	_writeWearIndex = nextWearIndex;
+	_writePhysPageIndex = nextPageIndex;
+	_writeStartAddr = __getSlotAddress(pageId, nextPageIndex);
+	_writeSize = __getInstanceSize(pageId);
+	_writeCrc = hal_crc32(pageData, _pages[pageId].pageSize);
+	_writeOffset = 0;
+
+	if(_pages[pageId].delta)
+	{
+		uint16_t baseSlotCount = __getBaseSlotCount(pageId);
+		uint16_t usedSlotCount = _pageInstances[pageId].usedSlotCount;
+
+		// The CRC is stored after the data, as if part of the page. So it is in the changes.
+		memcpy(_writeImage, pageData, _pages[pageId].pageSize);
+		memcpy(_writeImage + _pages[pageId].pageSize, &_writeCrc, EEPROM_PAGE_CRC_SIZE);
+
+		// Only changes if there is a base to apply them to, and they leave room for the next base.
+		uint16_t recordCount = usedSlotCount ? __encodeRecords(pageId, _writeImage, false) : baseSlotCount;
+
+		_writeBase = recordCount >= baseSlotCount ||
+			(recordCount && usedSlotCount + recordCount + baseSlotCount > __getSlotCount(pageId));
+
+		if(_writeBase) recordCount = __encodeRecords(pageId, _writeImage, true);
+
+		_writeSize = recordCount * _writePageSize;
+
+		for(unsigned index = 1; index < recordCount; index++) _writeWearIndex = __getNextWearIndex(_writeWearIndex);
+	}
+
+	_writeState = EEPROM_WRITE_WRITING;
+
+	return true;
+}
+
+EepromWriteResult Eeprom::stepWritePage()
+{
+	if(_writeState == EEPROM_WRITE_IDLE) return EEPROM_WRITE_FAILED;
+
+	// Assembled chip page of the page instance.
+	uint8_t chunk[EEPROM_MAX_WRITE_PAGE_SIZE];
+
+	unsigned chunkSize = __getWriteChunkSize(_writeOffset);
+
+	if(_writeState == EEPROM_WRITE_WRITING)
+	{
+		EepromWriteCycleState cycleState = _pollWriteCycle();
+
+		if(cycleState == EEPROM_WRITE_CYCLE_BUSY) return EEPROM_WRITE_IN_PROGRESS;
+
+		if(cycleState == EEPROM_WRITE_CYCLE_FAILED)
+		{
+			_writeState = EEPROM_WRITE_IDLE;
+			return EEPROM_WRITE_FAILED;
+		}
+
+		if(_writeOffset == _writeSize)
+		{
+			// The last write cycle has finished. Read it all back.
+			_writeOffset = 0;
+			_writeState = EEPROM_WRITE_VERIFYING;
+
+			return EEPROM_WRITE_IN_PROGRESS;
+		}
+
+		for(unsigned index = 0; index < chunkSize; index++) chunk[index] = __getWriteByte(_writeOffset + index);
+
+		if(!_startWriteChipPage(__getWriteAddress(_writeOffset), chunk, chunkSize))
+		{
+			_writeState = EEPROM_WRITE_IDLE;
+			return EEPROM_WRITE_FAILED;
+		}
+
+		_writeOffset += chunkSize;
+
+		return EEPROM_WRITE_IN_PROGRESS;
+	}
+
+	// Verifying. A delta page write with no changes has nothing to verify.
+	if(_writeOffset < _writeSize)
+	{
+		bool verified = _readChipBytes(__getWriteAddress(_writeOffset), chunk, chunkSize);
+
+		for(unsigned index = 0; verified && index < chunkSize; index++)
+		{
+			if(chunk[index] != __getWriteByte(_writeOffset + index)) verified = false;
+		}
+
+		if(!verified)
+		{
+			_writeState = EEPROM_WRITE_IDLE;
+			return EEPROM_WRITE_FAILED;
+		}
+
+		_writeOffset += chunkSize;
+
+		if(_writeOffset < _writeSize) return EEPROM_WRITE_IN_PROGRESS;
+	}
+
+	EepromPageInstance* instance = &_pageInstances[_writePageId];
+
+	if(_pages[_writePageId].delta)
+	{
+		uint16_t recordCount = _writeSize / _writePageSize;
+
+		if(recordCount)
+		{
+			instance -> physPageIndex = (_writePhysPageIndex + recordCount - 1) % __getSlotCount(_writePageId);
+			instance -> wearIndex = _writeWearIndex;
+			instance -> usedSlotCount = _writeBase ? recordCount : instance -> usedSlotCount + recordCount;
+
+			memcpy(instance -> image, _writeImage, _pages[_writePageId].pageSize + EEPROM_PAGE_CRC_SIZE);
+
+			if(_writeBase) _baseWriteCount++; else _deltaWriteCount++;
+		}
+	}
+	else
+	{
+		instance -> wearIndex = _writeWearIndex;
+		instance -> physPageIndex = _writePhysPageIndex;
+	}
+
+	_writeState = EEPROM_WRITE_IDLE;
+
+	return EEPROM_WRITE_COMPLETE;
+}
+
+EepromWriteState Eeprom::getWriteState()
+{
+	return _writeState;
+}
+
+unsigned Eeprom::getWriteChipPageIndex()
+{
+	if(_writeState == EEPROM_WRITE_IDLE) return 0;
+
+	// Each delta page record is a chip page of its own.
+	if(_pages[_writePageId].delta) return _writeOffset / _writePageSize;
+
+	// Chip pages touched so far, less the one in progress.
+	uint32_t firstChipPage = _writeStartAddr / _writePageSize;
+	uint32_t curChipPage = (_writeStartAddr + _writeOffset) / _writePageSize;
+
+	return curChipPage - firstChipPage;
+}
+
+uint8_t Eeprom::getPageSize(uint8_t pageId)
+{
+	return _pages[pageId].pageSize;
+}
+
+uint8_t Eeprom::getPageCount()
+{
+	return _pageCount;
+}
+
+bool Eeprom::_readChipBytes(uint32_t startAddr, uint8_t* buffer, unsigned count)
+{
+	return _readBytes(startAddr, buffer, count);
+}
+
+bool Eeprom::_flush()
+{
+	return true;
+}
+
+unsigned Eeprom::getDeltaWriteCount()
+{
+	return _deltaWriteCount;
+}
+
+unsigned Eeprom::getBaseWriteCount()
+{
+	return _baseWriteCount;
+}
+
+uint32_t Eeprom::getInitTimeUs()
+{
+	return _initTimeUs;
+}
+
+unsigned Eeprom::getInitWearIndexReadCount()
+{
+	return _initWearIndexReadCount;
+}
+
+unsigned Eeprom::getInitFullScanCount()
+{
+	return _initFullScanCount;
+}
+
+uint8_t Eeprom::__getWriteByte(unsigned offset)
+{
+	if(_pages[_writePageId].delta) return _writeRecords[offset];
+
+	unsigned pageSize = _pages[_writePageId].pageSize;
+
+	if(offset < pageSize) return _writePageData[offset];
+
+	// This is fine as long a everything is little endian.
+	if(offset < pageSize + EEPROM_PAGE_CRC_SIZE) return ((uint8_t*)&_writeCrc)[offset - pageSize];
+
+	return ((uint8_t*)&_writeWearIndex)[offset - pageSize - EEPROM_PAGE_CRC_SIZE];
+}
+
+uint32_t Eeprom::__getWriteAddress(unsigned offset)
+{
+	if(!_pages[_writePageId].delta) return _writeStartAddr + offset;
+
+	// The records wrap around to the first slot.
+	uint16_t slotIndex = (_writePhysPageIndex + offset / _writePageSize) % __getSlotCount(_writePageId);
+
+	return __getSlotAddress(_writePageId, slotIndex) + offset % _writePageSize;
+}
+
+unsigned Eeprom::__getWriteChunkSize(unsigned offset)
+{
+	uint32_t addr = __getWriteAddress(offset);
+
+	unsigned chunkSize = _writePageSize - (addr % _writePageSize);
+
+	// The wear index of a page instance is a write cycle of its own, after everything before it. A delta page record is
+	// one write cycle, with the wear index last, and is dropped if any of it doesn't match its CRC.
+	unsigned endOffset = _writeSize;
+
+	if(!_pages[_writePageId].delta && offset < _writeSize - EEPROM_WEAR_INDEX_SIZE)
+	{
+		endOffset = _writeSize - EEPROM_WEAR_INDEX_SIZE;
+	}
+
+	return chunkSize < endOffset - offset ? chunkSize : endOffset - offset;
+}
+
+uint16_t Eeprom::__getNextWearIndex(uint16_t wearIndex)
+{
+	wearIndex++;
+
+	return wearIndex == 0 || wearIndex == 0xFFFF ? 1 : wearIndex;
+}
+
+uint16_t Eeprom::__offsetWearIndex(uint16_t wearIndex, int offset)
+{
+	// Wear indexes count from 1 to 0xFFFE and then start again.
+	int index = ((int)wearIndex - 1 + offset) % 0xFFFE;
+
+	return (index < 0 ? index + 0xFFFE : index) + 1;
+}
+
+uint16_t Eeprom::__getInstanceSize(uint8_t pageId)
+{
+	// Page data, its CRC and then the wear index.
+	return _pages[pageId].pageSize + EEPROM_PAGE_CRC_SIZE + EEPROM_WEAR_INDEX_SIZE;
+}
+
+uint16_t Eeprom::__getHeaderWearCount(uint8_t pageId)
+{
+	return _pages[pageId].wearCount | (_pages[pageId].delta ? EEPROM_HEADER_DELTA_FLAG : 0);
+}
+
+uint16_t Eeprom::__getSlotCount(uint8_t pageId)
+{
+	if(!_pages[pageId].delta) return _pages[pageId].wearCount;
+
+	// Whole chip pages within the page's memory.
+	uint32_t regionEndAddr = _pageInstances[pageId].regionStartAddress + _pages[pageId].wearCount *
+		__getInstanceSize(pageId);
+
+	uint32_t firstSlotAddr = __getSlotAddress(pageId, 0);
+
+	return regionEndAddr > firstSlotAddr ? (regionEndAddr - firstSlotAddr) / _writePageSize : 0;
+}
+
+uint32_t Eeprom::__getSlotAddress(uint8_t pageId, uint16_t slotIndex)
+{
+	uint32_t regionStartAddr = _pageInstances[pageId].regionStartAddress;
+
+	if(!_pages[pageId].delta) return regionStartAddr + __getInstanceSize(pageId) * slotIndex;
+
+	// Delta page records are aligned to chip pages.
+	return (regionStartAddr + _writePageSize - 1) / _writePageSize * _writePageSize + _writePageSize * slotIndex;
+}
+
+uint32_t Eeprom::__getWearIndexAddress(uint8_t pageId, uint16_t slotIndex)
+{
+	// Last bytes of the page instance, or record slot.
+	unsigned slotSize = _pages[pageId].delta ? _writePageSize : __getInstanceSize(pageId);
+
+	return __getSlotAddress(pageId, slotIndex) + slotSize - EEPROM_WEAR_INDEX_SIZE;
+}
+
+bool Eeprom::__isWearIndexChained(uint16_t prevWearIndex, uint16_t wearIndex)
+{
+	if(prevWearIndex == 0 || prevWearIndex == 0xFFFF) return false;
+
+	// The next wear index is never 0 or blank.
+	return wearIndex == __getNextWearIndex(prevWearIndex);
+}
+
+uint16_t Eeprom::__readWearIndex(uint8_t pageId, uint16_t slotIndex)
+{
+	uint16_t wearIndex;
+
+	_initWearIndexReadCount++;
+
+	// This is fine as long a everything is little endian.
+	if(!_readBytes(__getWearIndexAddress(pageId, slotIndex), (uint8_t*)&wearIndex, EEPROM_WEAR_INDEX_SIZE)) return 0xFFFF;
+
+	return wearIndex;
+}
+
+bool Eeprom::__readInstance(uint8_t pageId, uint16_t slotIndex, uint8_t* page)
+{
+	uint8_t pageSize = _pages[pageId].pageSize;
+
+	uint32_t pageInstanceStartAddr = __getSlotAddress(pageId, slotIndex);
+
+	uint32_t crc;
+
+	// CRC follows the page data. This is fine as long a everything is little endian.
+	if(!_readBytes(pageInstanceStartAddr, page, pageSize) ||
+		!_readBytes(pageInstanceStartAddr + pageSize, (uint8_t*)&crc, EEPROM_PAGE_CRC_SIZE))
+	{
+		return false;
+	}
+
+	return hal_crc32(page, pageSize) == crc;
+}
+
+void Eeprom::__recoverPage(uint8_t pageId)
+{
+	EepromPageInstance* instance = &_pageInstances[pageId];
+
+	uint16_t slotCount = __getSlotCount(pageId);
+
+	if(slotCount == 0) return;
+
+	uint16_t newestSlotIndex = 0;
+	uint16_t newestWearIndex = 0;
+	uint16_t chainLength = 0;
+
+	// Usually the wear indexes are as they were written, so only a few need reading to find the newest.
+	if(__findNewestSlot(pageId, &newestSlotIndex, &newestWearIndex, &chainLength))
+	{
+		instance -> physPageIndex = newestSlotIndex;
+		instance -> wearIndex = newestWearIndex;
+
+		if(_pages[pageId].delta)
+		{
+			if(__loadDeltaPage(pageId, chainLength)) return;
+		}
+		else
+		{
+			uint8_t* page = new uint8_t[_pages[pageId].pageSize];
+
+			bool recovered = __readInstance(pageId, newestSlotIndex, page);
+
+			delete[] page;
+
+			if(recovered) return;
+		}
+	}
+
+	// Otherwise read all of them. eg After a write cut short by power loss, or if the page has never been written.
+	_initFullScanCount++;
+
+	instance -> physPageIndex = 0;
+	instance -> wearIndex = 0;
+
+	// Wear index of each slot, and the length of the chain of consecutive wear indexes that ends at it. 0 if blank.
+	uint16_t* wearIndexes = new uint16_t[slotCount];
+	uint16_t* chainLengths = new uint16_t[slotCount];
+
+	for(unsigned slotIndex = 0; slotIndex < slotCount; slotIndex++)
+	{
+		wearIndexes[slotIndex] = __readWearIndex(pageId, slotIndex);
+	}
+
+	// Chains wrap around from the last slot to the first, so start where one doesn't. There is always such a slot, the
+	// one that is written next, unless every wear index is the same chain.
+	uint16_t startSlotIndex = 0;
+
+	for(unsigned slotIndex = 0; slotIndex < slotCount; slotIndex++)
+	{
+		if(!__isWearIndexChained(wearIndexes[(slotIndex + slotCount - 1) % slotCount], wearIndexes[slotIndex]))
+		{
+			startSlotIndex = slotIndex;
+			break;
+		}
+	}
+
+	for(unsigned count = 0; count < slotCount; count++)
+	{
+		uint16_t slotIndex = (startSlotIndex + count) % slotCount;
+		uint16_t prevSlotIndex = (slotIndex + slotCount - 1) % slotCount;
+		uint16_t wearIndex = wearIndexes[slotIndex];
+
+		if(wearIndex == 0 || wearIndex == 0xFFFF)
+		{
+			chainLengths[slotIndex] = 0;
+		}
+		else
+		{
+			bool chained = count > 0 && __isWearIndexChained(wearIndexes[prevSlotIndex], wearIndex);
+
+			chainLengths[slotIndex] = chained ? chainLengths[prevSlotIndex] + 1 : 1;
+		}
+	}
+
+	// Try the end of the longest chain first. A write cut short by power loss only leaves a chain of one, as the wear
+	// index is written last. If it doesn't check out, try the one before it, which then has the longest chain.
+	newestWearIndex = 0;
+	bool recovered = false;
+
+	uint8_t* page = _pages[pageId].delta ? 0 : new uint8_t[_pages[pageId].pageSize];
+
+	while(!recovered)
+	{
+		uint16_t slotIndex = 0;
+
+		chainLength = 0;
+
+		for(unsigned index = 0; index < slotCount; index++)
+		{
+			if(chainLengths[index] > chainLength)
+			{
+				slotIndex = index;
+				chainLength = chainLengths[index];
+			}
+		}
+
+		// Nothing left to try.
+		if(chainLength == 0) break;
+
+		// Writes carry on from the end of the longest chain if nothing checks out.
+		if(newestWearIndex == 0)
+		{
+			newestSlotIndex = slotIndex;
+			newestWearIndex = wearIndexes[slotIndex];
+		}
+
+		instance -> physPageIndex = slotIndex;
+		instance -> wearIndex = wearIndexes[slotIndex];
+
+		if(!_pages[pageId].delta)
+		{
+			recovered = __readInstance(pageId, slotIndex, page);
+
+			chainLengths[slotIndex] = 0;
+		}
+		else
+		{
+			// Every base in the chain has been tried. Older records in it don't make any difference.
+			recovered = __loadDeltaPage(pageId, chainLength);
+
+			for(uint16_t length = chainLength; length > 0 && chainLengths[slotIndex] == length; length--)
+			{
+				chainLengths[slotIndex] = 0;
+				slotIndex = (slotIndex + slotCount - 1) % slotCount;
+			}
+		}
+	}
+
+	if(!recovered)
+	{
+		// readPage() fails, as nothing checks out.
+		instance -> physPageIndex = newestSlotIndex;
+		instance -> wearIndex = newestWearIndex;
+	}
+
+	if(page) delete[] page;
+
+	delete[] chainLengths;
+	delete[] wearIndexes;
+}
+
+bool Eeprom::__readLegacyPage(uint8_t pageId, uint8_t* page)
+{
+	uint8_t headerPageCount;
+
+	if(!_readBytes(EEPROM_PAGE_COUNT_ADDR, &headerPageCount, 1) || pageId >= headerPageCount) return false;
+
+	uint32_t curHeaderAddr = EEPROM_PAGE_COUNT_ADDR + 1;
+
+	// Regions are in the same order as the descriptors, straight after them. An instance is the wear index then the data.
+	uint32_t regionStartAddr = curHeaderAddr + headerPageCount * 3;
+
+	uint8_t headerPageSize;
+	uint16_t headerWearCount;
+
+	for(unsigned index = 0; index <= pageId; index++)
+	{
+		_readBytes(curHeaderAddr++, &headerPageSize, 1);
+
+		// This is fine as long a everything is little endian.
+		_readBytes(curHeaderAddr, (uint8_t*)&headerWearCount, 2);
+
+		curHeaderAddr += 2;
+
+		if(index < pageId) regionStartAddr += (headerPageSize + 2) * headerWearCount;
+	}
+
+	uint32_t pageInstanceSize = headerPageSize + 2;
+
+	if(headerPageSize != _pages[pageId].pageSize || regionStartAddr + pageInstanceSize * headerWearCount > _eepromSize)
+	{
+		return false;
+	}
+
+	uint16_t nextWearIndex;
+	uint16_t prevWearIndex = 0;
+
+	uint32_t instAddr = 0;
+
+	for(unsigned instIndex = 0; instIndex < headerWearCount; instIndex++)
+	{
+		_readBytes(regionStartAddr + instIndex * pageInstanceSize, (uint8_t*)&nextWearIndex, 2);
+
+		// Wear page is blank. End of search.
+		if(nextWearIndex == 0xFFFF) break;
+
+		// A break in the chain of indexes indicates the end of the current wear indexes.
+		if(prevWearIndex != 0 && nextWearIndex != (uint16_t)(prevWearIndex + 1)) break;
+
+		instAddr = regionStartAddr + instIndex * pageInstanceSize;
+
+		prevWearIndex = nextWearIndex;
+	}
+
+	return prevWearIndex != 0 && _readBytes(instAddr + 2, page, headerPageSize);
+}
+
+bool Eeprom::__findNewestSlot(uint8_t pageId, uint16_t* slotIndex, uint16_t* wearIndex, uint16_t* chainLength)
+{
+	uint16_t slotCount = __getSlotCount(pageId);
+
+	uint16_t firstWearIndex = __readWearIndex(pageId, 0);
+
+	if(firstWearIndex == 0 || firstWearIndex == 0xFFFF) return false;
+
+	// The newest is somewhere from low up to, but not including, high. Slots up to low are known to follow on from the
+	// first.
+	uint16_t low = 0;
+	uint16_t high = slotCount;
+	uint16_t highWearIndex = 0xFFFF;
+
+	while(high - low > 1)
+	{
+		uint16_t mid = (low + high) / 2;
+		uint16_t midWearIndex = __readWearIndex(pageId, mid);
+
+		if(midWearIndex == __offsetWearIndex(firstWearIndex, mid))
+		{
+			low = mid;
+		}
+		else
+		{
+			high = mid;
+			highWearIndex = midWearIndex;
+		}
+	}
+
+	// The slot after the newest is blank on the first lap, and one lap older after that. Anything else is a write cut
+	// short, or the wear indexes not being laid out as expected.
+	if(high < slotCount && highWearIndex != 0xFFFF &&
+		highWearIndex != __offsetWearIndex(firstWearIndex, (int)high - slotCount))
+	{
+		return false;
+	}
+
+	*slotIndex = low;
+	*wearIndex = __offsetWearIndex(firstWearIndex, low);
+
+	// After the first lap, the older slots carry on the chain from the last slot to the first.
+	*chainLength = high < slotCount && highWearIndex == 0xFFFF ? low + 1 : slotCount;
+
+	return true;
+}
+
+uint16_t Eeprom::__getBaseSlotCount(uint8_t pageId)
+{
+	// A single run in each record.
+	unsigned runSize = _writePageSize - EEPROM_RECORD_HEADER_SIZE - EEPROM_RUN_HEADER_SIZE - EEPROM_WEAR_INDEX_SIZE;
+
+	return (_pages[pageId].pageSize + EEPROM_PAGE_CRC_SIZE + runSize - 1) / runSize;
+}
+
+uint16_t Eeprom::__encodeRecords(uint8_t pageId, uint8_t* pageData, bool base)
+{
+	unsigned pageSize = _pages[pageId].pageSize + EEPROM_PAGE_CRC_SIZE;
+	uint8_t* image = _pageInstances[pageId].image;
+
+	// Changes only must take fewer records than a base to be worth it.
+	uint16_t maxRecordCount = base ? __getBaseSlotCount(pageId) : __getBaseSlotCount(pageId) - 1;
+
+	uint16_t recordCount = 0;
+	uint16_t wearIndex = _pageInstances[pageId].wearIndex;
+
+	uint8_t* record = 0;
+	unsigned recordUsed = 0;
+
+	// Runs go between the header and the wear index.
+	unsigned recordEnd = _writePageSize - EEPROM_WEAR_INDEX_SIZE;
+
+	unsigned offset = 0;
+
+	while(offset < pageSize)
+	{
+		// Find the next run of changed bytes. Unchanged bytes between changes are included if that is smaller than the
+		// header of another run.
+		unsigned runStart = offset;
+		unsigned runEnd = pageSize;
+
+		if(!base)
+		{
+			while(runStart < pageSize && pageData[runStart] == image[runStart]) runStart++;
+
+			if(runStart == pageSize) break;
+
+			runEnd = runStart + 1;
+
+			for(unsigned index = runEnd; index < pageSize && index <= runEnd + EEPROM_RUN_HEADER_SIZE; index++)
+			{
+				if(pageData[index] != image[index]) runEnd = index + 1;
+			}
+		}
+
+		offset = runEnd;
+
+		// A run is split over records if it doesn't fit.
+		while(runStart < runEnd)
+		{
+			if(!record || recordUsed + EEPROM_RUN_HEADER_SIZE >= recordEnd ||
+				(record[0] & EEPROM_RECORD_RUN_COUNT_MASK) == EEPROM_RECORD_RUN_COUNT_MASK)
+			{
+				if(recordCount == maxRecordCount) return __getBaseSlotCount(pageId);
+
+				record = _writeRecords + recordCount * _writePageSize;
+				recordCount++;
+
+				// Unused bytes are left as if blank.
+				memset(record, 0xFF, _writePageSize);
+
+				wearIndex = __getNextWearIndex(wearIndex);
+
+				// This is fine as long a everything is little endian.
+				memcpy(record + recordEnd, &wearIndex, EEPROM_WEAR_INDEX_SIZE);
+
+				record[0] = base ? EEPROM_RECORD_BASE : 0;
+				recordUsed = EEPROM_RECORD_HEADER_SIZE;
+			}
+
+			unsigned runLength = runEnd - runStart;
+
+			if(runLength > recordEnd - recordUsed - EEPROM_RUN_HEADER_SIZE)
+			{
+				runLength = recordEnd - recordUsed - EEPROM_RUN_HEADER_SIZE;
+			}
+
+			record[recordUsed] = runStart;
+			record[recordUsed + 1] = runLength;
+
+			memcpy(record + recordUsed + EEPROM_RUN_HEADER_SIZE, pageData + runStart, runLength);
+
+			recordUsed += EEPROM_RUN_HEADER_SIZE + runLength;
+			record[0]++;
+
+			runStart += runLength;
+		}
+	}
+
+	if(recordCount)
+	{
+		_writeRecords[0] |= EEPROM_RECORD_FIRST;
+		record[0] |= EEPROM_RECORD_LAST;
+	}
+
+	return recordCount;
+}
+
+bool Eeprom::__loadDeltaPage(uint8_t pageId, uint16_t chainLength)
+{
+	EepromPageInstance* instance = &_pageInstances[pageId];
+
+	instance -> usedSlotCount = 0;
+
+	uint16_t slotCount = __getSlotCount(pageId);
+
+	// Walk back from the newest record, trying each base that has all of its records, newest first. An older base is
+	// only needed if the newest doesn't match its CRC. Records before the chain have since been overwritten.
+	bool baseLastFound = false;
+
+	for(uint16_t count = 1; count <= chainLength; count++)
+	{
+		uint16_t slotIndex = (instance -> physPageIndex + slotCount + 1 - count) % slotCount;
+
+		uint8_t flags;
+
+		if(!_readBytes(__getSlotAddress(pageId, slotIndex), &flags, EEPROM_RECORD_HEADER_SIZE)) return false;
+
+		if(!(flags & EEPROM_RECORD_BASE))
+		{
+			baseLastFound = false;
+			continue;
+		}
+
+		if(flags & EEPROM_RECORD_LAST) baseLastFound = true;
+
+		if(flags & EEPROM_RECORD_FIRST)
+		{
+			if(baseLastFound && __applyDeltaRecords(pageId, slotIndex, count))
+			{
+				instance -> usedSlotCount = count;
+				return true;
+			}
+
+			baseLastFound = false;
+		}
+	}
+
+	return false;
+}
+
+bool Eeprom::__applyDeltaRecords(uint8_t pageId, uint16_t baseSlotIndex, uint16_t usedSlotCount)
+{
+	EepromPageInstance* instance = &_pageInstances[pageId];
+
+	uint16_t slotCount = __getSlotCount(pageId);
+	uint8_t pageSize = _pages[pageId].pageSize;
+	unsigned storedSize = pageSize + EEPROM_PAGE_CRC_SIZE;
+	unsigned recordEnd = _writePageSize - EEPROM_WEAR_INDEX_SIZE;
+
+	uint8_t record[EEPROM_MAX_WRITE_PAGE_SIZE];
+
+	// Each write is applied to a copy first, in case not all its records are there. The contents are only changed once
+	// the base has been applied, so they are left as they were if it isn't.
+	uint8_t* pending = new uint8_t[storedSize];
+	bool writing = false;
+	bool baseApplied = false;
+
+	for(uint16_t count = 0; count < usedSlotCount; count++)
+	{
+		if(!_readBytes(__getSlotAddress(pageId, (baseSlotIndex + count) % slotCount), record, _writePageSize)) break;
+
+		uint8_t flags = record[0];
+
+		if(flags & EEPROM_RECORD_FIRST)
+		{
+			memcpy(pending, instance -> image, storedSize);
+			writing = true;
+		}
+
+		// Part of a write that was never finished.
+		if(!writing) continue;
+
+		unsigned recordUsed = EEPROM_RECORD_HEADER_SIZE;
+
+		for(unsigned run = 0; writing && run < (flags & EEPROM_RECORD_RUN_COUNT_MASK); run++)
+		{
+			unsigned runStart = record[recordUsed];
+			unsigned runLength = record[recordUsed + 1];
+
+			recordUsed += EEPROM_RUN_HEADER_SIZE;
+
+			// Corrupt. Drop the whole write.
+			if(recordUsed + runLength > recordEnd || runStart + runLength > storedSize)
+			{
+				writing = false;
+				break;
+			}
+
+			memcpy(pending + runStart, record + recordUsed, runLength);
+
+			recordUsed += runLength;
+		}
+
+		if(writing && (flags & EEPROM_RECORD_LAST))
+		{
+			uint32_t crc;
+
+			memcpy(&crc, pending + pageSize, EEPROM_PAGE_CRC_SIZE);
+
+			// Only take the page if it is exactly as it was written. Writes after one that doesn't match won't either, as
+			// its CRC changes with any change to the page.
+			if(hal_crc32(pending, pageSize) == crc && (baseApplied || (flags & EEPROM_RECORD_BASE)))
+			{
+				memcpy(instance -> image, pending, storedSize);
+
+				if(flags & EEPROM_RECORD_BASE) baseApplied = true;
+			}
+
+			writing = false;
+		}
+	}
+
+	delete[] pending;
+
+	return baseApplied;
 }
 
 uint32_t Eeprom::getNonPageRegionStartAddress()
@@ -278,7 +1168,7 @@ bool Eeprom::verifyMetaData(EepromPage* pages, uint8_t pageCount)
 	for(unsigned index = 0; index < _pageCount; index++)
 	{
 		uint8_t pageSize = _pages[index].pageSize;
-		uint16_t wearCount = _pages[index].wearCount;
+		uint16_t wearCount = __getHeaderWearCount(index);
 
 		_readBytes(curHeaderAddr, buffer, 1);
 
@@ -3,12 +3,93 @@
 
 #include <stdint.h>
 
-/** Magic byte to indicate EEPROM has been formated by this class. */
-#define EEPROM_MAGIC 0x55
+/**
+ * Magic byte to indicate EEPROM has been formated by this class.
+ * Changed whenever the way pages are stored changes, so older formats are reformatted rather than misread.
+ */
+#define EEPROM_MAGIC 0x57
+
+/**
+ * Magic byte of the original format. Its header is the same, but a page instance is the wear index and then the page data,
+ * with no CRC. Pages are carried over from it when it is reformatted, so what they hold isn't lost.
+ */
+#define EEPROM_LEGACY_MAGIC 0x55
 
 /** Address of wear levelled page count. */
 #define EEPROM_PAGE_COUNT_ADDR 0x01
 
+/** Size of the CRC-32 stored after each page's data, in bytes. */
+#define EEPROM_PAGE_CRC_SIZE 4
+
+/** Largest chip write page size supported, in bytes. */
+#define EEPROM_MAX_WRITE_PAGE_SIZE 64
+
+/** Bit of a page's wear count, as stored in the header, that marks it as a delta page. */
+#define EEPROM_HEADER_DELTA_FLAG 0x8000
+
+/**
+ * Size of the wear index at the end of each page instance and delta page record, in bytes. It is written last, so it
+ * marks the instance, or record, as complete.
+ */
+#define EEPROM_WEAR_INDEX_SIZE 2
+
+/** Size of a delta page record's header, in bytes. The flags. */
+#define EEPROM_RECORD_HEADER_SIZE 1
+
+/** Size of the header of each run of bytes in a delta page record, in bytes. The page offset and then the length. */
+#define EEPROM_RUN_HEADER_SIZE 2
+
+/** Delta page record flag. The record is part of a base, a copy of the whole page. */
+#define EEPROM_RECORD_BASE 0x80
+
+/** Delta page record flag. First record of a write. */
+#define EEPROM_RECORD_FIRST 0x40
+
+/** Delta page record flag. Last record of a write. A write is only applied if its last record was written. */
+#define EEPROM_RECORD_LAST 0x20
+
+/** Mask of the number of runs in a delta page record, in the flags. */
+#define EEPROM_RECORD_RUN_COUNT_MASK 0x1F
+
+/** State of the chip's internal write cycle. */
+enum EepromWriteCycleState
+{
+	/** Ready for the next access. */
+	EEPROM_WRITE_CYCLE_READY,
+
+	/** Still writing its memory. */
+	EEPROM_WRITE_CYCLE_BUSY,
+
+	/** Didn't finish writing its memory in time. */
+	EEPROM_WRITE_CYCLE_FAILED
+};
+
+/** State of an incremental wear levelled page write. */
+enum EepromWriteState
+{
+	/** No incremental page write in progress. */
+	EEPROM_WRITE_IDLE,
+
+	/** Writing the page instance, a chip page at a time. */
+	EEPROM_WRITE_WRITING,
+
+	/** Reading back the page instance and comparing it, a chip page at a time. */
+	EEPROM_WRITE_VERIFYING
+};
+
+/** Result of a step of an incremental wear levelled page write. */
+enum EepromWriteResult
+{
+	/** More steps are needed. */
+	EEPROM_WRITE_IN_PROGRESS,
+
+	/** Written and verified. The page instance is now the current one. */
+	EEPROM_WRITE_COMPLETE,
+
+	/** Write or verify failed. The previous page instance is still the current one. */
+	EEPROM_WRITE_FAILED
+};
+
 /**
  * Wear levelled page definition for EEPROM.
  */
@@ -19,9 +100,18 @@ struct EepromPage
 
 	/**
 	 * The number of pages used for wear levelling. This is clamped to 15 bits.
-	 * @note The total amout of memory used to store a page will be wearCount * (pageSize + 2)
+	 * @note The total amout of memory used to store a page will be wearCount * (pageSize + 6). A CRC-32 and a 16 bit wear
+	 *       index for each page instance.
 	 */
 	uint16_t wearCount;
+
+	/**
+	 * Store the page as a log of records, rather than as whole copies of it. Each record is a chip page, holding only the
+	 * runs of bytes a write changed, so a small change is a single write cycle. A base, a copy of the whole page spread
+	 * over as many records as needed, is written when there isn't room for more changes.
+	 * @note Ignored if the page's memory can't hold two bases.
+	 */
+	bool delta = false;
 };
 
 /**
@@ -41,6 +131,7 @@ struct EepromPageInstance
 	/**
 	 * The physical page index the page instance is stored in.
 	 * This will be between 0 and wearCount - 1 (from the page definition).
+	 * For a delta page, this is the record slot of the newest record instead.
 	 */
 	uint16_t physPageIndex;
 
@@ -48,12 +139,28 @@ struct EepromPageInstance
 	 * The byte address of the start of the wear levelled region for the page.
 	 */
 	uint32_t regionStartAddress;
+
+	/** Current page contents, followed by its CRC, for a delta page. 0 otherwise. */
+	uint8_t* image;
+
+	/**
+	 * For a delta page, the number of record slots from the start of the current base to the newest record. 0 if there
+	 * is no complete base, so no page.
+	 */
+	uint16_t usedSlotCount;
 };
 
 /**
  * Base of drivers for EEPROM chips.
  * @note All data is stored using little endian byte order and the Pico is assumed to be running in little endian mode.
  * @note This class does _not_ do any bounds checks.
+ * @note A page instance is the page data, its CRC and then the 16 bit wear index.
+ * @note A delta page record is a chip page aligned slot holding the flags and run count, each run as its page offset,
+ *       length and bytes, and then the 16 bit wear index in the last bytes of the slot. Unused bytes are left blank.
+ * @note The wear index is written after everything else in an instance or record, so a write cut short by power loss
+ *       leaves the previous one current. When initialised, the newest instance whose CRC matches is used.
+ * @note When a chip in the original format (EEPROM_LEGACY_MAGIC) is reformatted, each page that has the same size, and
+ *       index, as one of its pages is written with that page's newest instance.
  */
 class Eeprom
 {
@@ -63,13 +170,14 @@ class Eeprom
 
 		/**
 		 * @param size Size of EEPROM in bytes.
+		 * @param writePageSize Size of the chip's write pages in bytes. Clamped to EEPROM_MAX_WRITE_PAGE_SIZE.
 		 * @param pages Array of wear levelled pages. The index into this array needs to be used for future page accesses.
 		 * @param pageCount Number of entries in the pages array. Clamped to 8 bit number.
 		 * @note Wear levelled pages are always stored at the beginning of the EEPROM.
 		 * @note Memory calculations must take into account that the first bytes are reserved for the magic number and
 		 *       page information: (sizeof EepromPage) * pageCount + 2.
 		 */
-		Eeprom(unsigned size, EepromPage* pages, uint8_t pageCount);
+		Eeprom(unsigned size, unsigned writePageSize, EepromPage* pages, uint8_t pageCount);
 
 		/**
 		 * Write the given bytes to the Eeprom.
@@ -93,7 +201,7 @@ class Eeprom
 		 * Read wear balanced page from Eeprom.
 		 * @param pageId Identifier of page to read. This should match the index of the pages defined during construction.
 		 * @param pageBuffer Pointer to buffer to read page data into. Must be page length in size.
-		 * @returns True if read was successful. False if no page available or error.
+		 * @returns True if read was successful. False if no page available, its CRC doesn't match, or error.
 		 */
 		bool readPage(uint8_t pageId, uint8_t* pageBuffer);
 
@@ -105,6 +213,53 @@ class Eeprom
 		 */
 		bool writePage(uint8_t pageId, uint8_t* pageData);
 
+		/**
+		 * Start writing a wear balanced page incrementally, so it can be done without blocking.
+		 * Each call of stepWritePage() then does at most one chip page write or read. The wear index of a page instance
+		 * is a write cycle of its own, after the data and CRC. A delta page record is a single write cycle.
+		 * @param pageId Identifier of page to write. This should match the index of the pages defined during construction.
+		 * @param pageData Pointer to page data to write. Must be page length in size, and stay unchanged until the write
+		 *                 completes or fails.
+		 * @returns False if an incremental write is already in progress, or the pages aren't initialised.
+		 */
+		bool startWritePage(uint8_t pageId, uint8_t* pageData);
+
+		/**
+		 * Do the next step of the incremental page write. Never waits for the chip.
+		 * @returns Whether the write is still in progress, complete or failed.
+		 */
+		EepromWriteResult stepWritePage();
+
+		/** Get the state of the incremental page write. */
+		EepromWriteState getWriteState();
+
+		/** Get the index of the chip page, within the page instance, that the incremental page write is up to. */
+		unsigned getWriteChipPageIndex();
+
+		/** Get the size, in bytes, of a wear levelled page. */
+		uint8_t getPageSize(uint8_t pageId);
+
+		/** Get the number of wear levelled pages. */
+		uint8_t getPageCount();
+
+		/** Get the number of writes of delta pages that were written as changes only. */
+		unsigned getDeltaWriteCount();
+
+		/** Get the number of writes of delta pages that were written as a base. ie The first and compactions. */
+		unsigned getBaseWriteCount();
+
+		/** Get the time taken to initialise, in micro seconds. Checking the header and finding the current pages. */
+		uint32_t getInitTimeUs();
+
+		/** Get the number of wear indexes read to find the current pages when initialised. */
+		unsigned getInitWearIndexReadCount();
+
+		/**
+		 * Get the number of pages whose current instance had to be found by reading every wear index when initialised.
+		 * ie After a write cut short by power loss.
+		 */
+		unsigned getInitFullScanCount();
+
 		/**
 		 * Clear the Eeprom to the given value for the given region.
 		 * @param value Value to set each byte in region to.
@@ -161,6 +316,33 @@ class Eeprom
 		 */
 		virtual bool _readBytes(uint32_t startAddr, uint8_t* buffer, unsigned count) = 0;
 
+		/**
+		 * Start writing bytes within a single chip page, without waiting for the chip's write cycle to finish.
+		 * @param startAddr Address to start writing at.
+		 * @param values Pointer to byte values to write.
+		 * @param count Number of bytes to write. Must not cross a chip page boundary.
+		 * @returns True if the chip accepted the write.
+		 */
+		virtual bool _startWriteChipPage(uint32_t startAddr, uint8_t* values, unsigned count) = 0;
+
+		/**
+		 * Check, without waiting, whether the chip has finished the last write cycle started.
+		 * @returns Ready if there is no write cycle outstanding.
+		 */
+		virtual EepromWriteCycleState _pollWriteCycle() = 0;
+
+		/**
+		 * Read bytes from the chip itself, bypassing any caching done by the implementation. Used to verify writes.
+		 * @returns True if read was successful.
+		 */
+		virtual bool _readChipBytes(uint32_t startAddr, uint8_t* buffer, unsigned count);
+
+		/**
+		 * Write anything held back by the implementation to the chip, waiting for it to finish.
+		 * @returns True if successful, including if there was nothing to write.
+		 */
+		virtual bool _flush();
+
 	private:
 
 		/** Size of EEPROM in bytes. */
@@ -180,6 +362,160 @@ class Eeprom
 
 		/** The start address of the non-page region. The region after the wear levelled pages. */
 		uint32_t _nonPageRegionStartAddress;
+
+		/** Size of the chip's write pages in bytes. */
+		unsigned _writePageSize;
+
+		/** State of the incremental page write. */
+		EepromWriteState _writeState = EEPROM_WRITE_IDLE;
+
+		/** Page being written incrementally. */
+		uint8_t _writePageId;
+
+		/** Data of the page being written incrementally. */
+		uint8_t* _writePageData;
+
+		/** Wear index of the page instance being written incrementally. For a delta page, that of the last record. */
+		uint16_t _writeWearIndex;
+
+		/** Physical page index of the page instance being written incrementally. For a delta page, the first slot. */
+		uint16_t _writePhysPageIndex;
+
+		/** Byte address of the page instance being written incrementally. */
+		uint32_t _writeStartAddr;
+
+		/** Number of bytes of the page instance written, or verified, so far. */
+		unsigned _writeOffset;
+
+		/** Number of bytes being written incrementally. The page instance, or the delta page records. */
+		unsigned _writeSize;
+
+		/** CRC of the data of the page being written incrementally. */
+		uint32_t _writeCrc;
+
+		/** Data and CRC of the delta page being written. Big enough for the largest. 0 if there are no delta pages. */
+		uint8_t* _writeImage = 0;
+
+		/** True if the delta page records being written incrementally are a base. */
+		bool _writeBase;
+
+		/** Delta page records being written. Big enough for the largest base. 0 if there are no delta pages. */
+		uint8_t* _writeRecords = 0;
+
+		/** Number of writes of delta pages as changes only. */
+		unsigned _deltaWriteCount = 0;
+
+		/** Number of writes of delta pages as a base. */
+		unsigned _baseWriteCount = 0;
+
+		/** Time taken to initialise, in micro seconds. */
+		uint32_t _initTimeUs = 0;
+
+		/** Number of wear indexes read to find the current pages when initialised. */
+		unsigned _initWearIndexReadCount = 0;
+
+		/** Number of pages that needed every wear index read to find their current instance when initialised. */
+		unsigned _initFullScanCount = 0;
+
+		/** Get a byte of the page instance being written incrementally. The page data, its CRC, then the wear index. */
+		uint8_t __getWriteByte(unsigned offset);
+
+		/** Get the chip address of an offset in the page instance, or records, being written incrementally. */
+		uint32_t __getWriteAddress(unsigned offset);
+
+		/** Get the number of bytes from an offset in the page instance being written to the end of its chip page. */
+		unsigned __getWriteChunkSize(unsigned offset);
+
+		/** Get the wear index that follows another. Skips 0, which means no pages, and 0xFFFF, which is blank. */
+		uint16_t __getNextWearIndex(uint16_t wearIndex);
+
+		/** Get the wear index a number of writes after, or before if negative, another. It must not be 0 or blank. */
+		uint16_t __offsetWearIndex(uint16_t wearIndex, int offset);
+
+		/** Get the size of a page instance, in bytes. Includes the wear index and CRC. */
+		uint16_t __getInstanceSize(uint8_t pageId);
+
+		/** Get a page's wear count as stored in the header. Includes the delta flag. */
+		uint16_t __getHeaderWearCount(uint8_t pageId);
+
+		/** Get the number of page instances, or delta page record slots, of a page. */
+		uint16_t __getSlotCount(uint8_t pageId);
+
+		/** Get the byte address of a page instance, or delta page record slot. */
+		uint32_t __getSlotAddress(uint8_t pageId, uint16_t slotIndex);
+
+		/** Get the byte address of the wear index of a page instance, or delta page record slot. */
+		uint32_t __getWearIndexAddress(uint8_t pageId, uint16_t slotIndex);
+
+		/** Get whether a wear index follows on from the one before it. Neither can be 0 or blank. */
+		bool __isWearIndexChained(uint16_t prevWearIndex, uint16_t wearIndex);
+
+		/** Read the wear index of a page instance, or delta page record slot. Blank if it can't be read. */
+		uint16_t __readWearIndex(uint8_t pageId, uint16_t slotIndex);
+
+		/**
+		 * Read the data of a page instance, checking its CRC.
+		 * @param page Buffer to read the data into. Must be page length in size.
+		 * @returns True if read and the CRC matches.
+		 */
+		bool __readInstance(uint8_t pageId, uint16_t slotIndex, uint8_t* page);
+
+		/**
+		 * Read the newest instance of a page from a chip in the original format (EEPROM_LEGACY_MAGIC), as it did. ie The
+		 * end of the chain of consecutive wear indexes from the first slot.
+		 * @param page Buffer to read the data into. Must be page length in size.
+		 * @returns True if read. False if the chip has no page of the same size at the same index, or it was never written.
+		 */
+		bool __readLegacyPage(uint8_t pageId, uint8_t* page);
+
+		/**
+		 * Find a page's newest page instance, or delta page record, that is complete and checks out.
+		 * Usually found by __findNewestSlot(). Otherwise every wear index is read, and the newest is at the end of the
+		 * longest chain of consecutive wear indexes. Writes cut short leave shorter chains. If it doesn't check out, the
+		 * one before it is tried, and so on.
+		 */
+		void __recoverPage(uint8_t pageId);
+
+		/**
+		 * Find a page's newest page instance, or delta page record, by binary search. Instances are written in turn, so
+		 * from the first slot to the newest the wear indexes are consecutive, and after it they are blank or one lap
+		 * older. Reads about log2 of the number of slots wear indexes, rather than all of them.
+		 * @param slotIndex Set to the slot of the newest.
+		 * @param wearIndex Set to the wear index of the newest.
+		 * @param chainLength Set to the number of slots in the chain of consecutive wear indexes that ends at the newest.
+		 * @returns False if the wear indexes aren't laid out like that. eg After a write cut short, or if the page has
+		 *          never been written.
+		 */
+		bool __findNewestSlot(uint8_t pageId, uint16_t* slotIndex, uint16_t* wearIndex, uint16_t* chainLength);
+
+		/** Get the number of delta page records a base of a page takes. */
+		uint16_t __getBaseSlotCount(uint8_t pageId);
+
+		/**
+		 * Encode the delta page records of a write into _writeRecords, taking their wear indexes from the newest.
+		 * @param base True for a base, false for the changes from the current page contents only.
+		 * @returns The number of records. 0 if nothing has changed. For changes only, the number of records a base takes if
+		 *          they would need that many or more, without them being encoded.
+		 */
+		uint16_t __encodeRecords(uint8_t pageId, uint8_t* pageData, bool base);
+
+		/**
+		 * Rebuild a delta page's contents from its records, from the newest complete base that checks out onwards.
+		 * Records of a write are only applied if all of them are present. Every record from the base on is read in full, so
+		 * this costs up to the page's wear count of write pages. It is most of the time init takes without the RAM mirror,
+		 * not finding the newest record.
+		 * @param chainLength Number of slots in the chain of consecutive wear indexes that ends at the newest record.
+		 * @returns True if a base was applied.
+		 */
+		bool __loadDeltaPage(uint8_t pageId, uint16_t chainLength);
+
+		/**
+		 * Apply the writes in a delta page's records to its contents.
+		 * @param baseSlotIndex Slot of the first record of the base to start from.
+		 * @param usedSlotCount Number of slots from there to the newest record.
+		 * @returns True if the base was applied.
+		 */
+		bool __applyDeltaRecords(uint8_t pageId, uint16_t baseSlotIndex, uint16_t usedSlotCount);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "EepromCommitter.hpp"
+
+EepromCommitter::~EepromCommitter()
+{
+	for(unsigned index = 0; index < _pageCount; index++) delete[] _queuedData[index];
+
+	delete[] _queuedData;
+	delete[] _queued;
+	delete[] _failed;
+	delete[] _writeData;
+}
+
+EepromCommitter::EepromCommitter(Eeprom* eeprom) : _eeprom(eeprom)
+{
+	_pageCount = eeprom -> getPageCount();
+
+	_queuedData = new uint8_t*[_pageCount];
+	_queued = new bool[_pageCount];
+	_failed = new bool[_pageCount];
+
+	unsigned maxPageSize = 0;
+
+	for(unsigned index = 0; index < _pageCount; index++)
+	{
+		unsigned pageSize = eeprom -> getPageSize(index);
+
+		_queuedData[index] = new uint8_t[pageSize];
+		_queued[index] = false;
+		_failed[index] = false;
+
+		if(pageSize > maxPageSize) maxPageSize = pageSize;
+	}
+
+	_writeData = new uint8_t[maxPageSize];
+}
+
+void EepromCommitter::queue(uint8_t pageId, const uint8_t* pageData)
+{
+	if(pageId >= _pageCount) return;
+
+	if(_queued[pageId]) _coalesceCount++;
+
+	memcpy(_queuedData[pageId], pageData, _eeprom -> getPageSize(pageId));
+
+	_queued[pageId] = true;
+}
+
+void EepromCommitter::poll()
+{
+	if(!_writing)
+	{
+		__startNext();
+		return;
+	}
+
+	EepromWriteResult result = _eeprom -> stepWritePage();
+
+	if(result == EEPROM_WRITE_IN_PROGRESS) return;
+
+	_writing = false;
+
+	if(result == EEPROM_WRITE_COMPLETE)
+	{
+		_commitCount++;
+		return;
+	}
+
+	// Retry, unless newer data has been queued since, in which case that is written instead.
+	if(!_queued[_writePageId] && _retryCount < EEPROM_COMMIT_MAX_RETRIES)
+	{
+		_retryCount++;
+
+		if(_eeprom -> startWritePage(_writePageId, _writeData))
+		{
+			_writing = true;
+			return;
+		}
+	}
+
+	_failCount++;
+
+	_failed[_writePageId] = true;
+
+	printf("EEPROM page %u commit failed.\n", _writePageId);
+}
+
+EepromCommitState EepromCommitter::getState()
+{
+	if(_writing) return _eeprom -> getWriteState() == EEPROM_WRITE_VERIFYING ? EEPROM_COMMIT_VERIFYING :
+		EEPROM_COMMIT_WRITING;
+
+	for(unsigned index = 0; index < _pageCount; index++)
+	{
+		if(_queued[index]) return EEPROM_COMMIT_QUEUED;
+	}
+
+	return EEPROM_COMMIT_IDLE;
+}
+
+uint8_t EepromCommitter::getPageId()
+{
+	return _writePageId;
+}
+
+unsigned EepromCommitter::getChipPageIndex()
+{
+	return _writing ? _eeprom -> getWriteChipPageIndex() : 0;
+}
+
+bool EepromCommitter::isPending(uint8_t pageId)
+{
+	return pageId < _pageCount && (_queued[pageId] || (_writing && _writePageId == pageId));
+}
+
+unsigned EepromCommitter::getCommitCount()
+{
+	return _commitCount;
+}
+
+unsigned EepromCommitter::getCoalesceCount()
+{
+	return _coalesceCount;
+}
+
+unsigned EepromCommitter::getFailCount()
+{
+	return _failCount;
+}
+
+bool EepromCommitter::takeFailed(uint8_t pageId)
+{
+	if(pageId >= _pageCount || !_failed[pageId]) return false;
+
+	_failed[pageId] = false;
+
+	return true;
+}
+
+void EepromCommitter::__startNext()
+{
+	for(unsigned count = 0; count < _pageCount; count++)
+	{
+		uint8_t pageId = (_nextPageId + count) % _pageCount;
+
+		if(!_queued[pageId]) continue;
+
+		// Take a copy to write from, so the page can be queued again while it is being written.
+		memcpy(_writeData, _queuedData[pageId], _eeprom -> getPageSize(pageId));
+
+		if(!_eeprom -> startWritePage(pageId, _writeData)) return;
+
+		_queued[pageId] = false;
+		_writing = true;
+		_writePageId = pageId;
+		_retryCount = 0;
+		_nextPageId = (pageId + 1) % _pageCount;
+
+		return;
+	}
+}
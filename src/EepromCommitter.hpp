@@ -0,0 +1,124 @@
+#ifndef EEPROM_COMMITTER_H
+#define EEPROM_COMMITTER_H
+
+#include <stdint.h>
+
+#include "Eeprom.hpp"
+
+/** Number of times a failed page write is retried before it is given up on. */
+#ifndef EEPROM_COMMIT_MAX_RETRIES
+#define EEPROM_COMMIT_MAX_RETRIES 2
+#endif
+
+/** State of the commit pipeline. */
+enum EepromCommitState
+{
+	/** Nothing to write. */
+	EEPROM_COMMIT_IDLE,
+
+	/** Pages are waiting to be written. */
+	EEPROM_COMMIT_QUEUED,
+
+	/** Writing a page, a chip page at a time. */
+	EEPROM_COMMIT_WRITING,
+
+	/** Reading back the written page, a chip page at a time. */
+	EEPROM_COMMIT_VERIFYING
+};
+
+/**
+ * Non-blocking pipeline that writes wear levelled pages to EEPROM in the background.
+ * Pages are queued with a copy of their data, and each poll does at most one chip page write, acknowledge probe or
+ * read back, so the caller never waits for the chip's write cycle. Queueing a page that is already waiting replaces its
+ * data, so a burst of commits costs one write. A page queued while it is being written is written again afterwards.
+ */
+class EepromCommitter
+{
+	public:
+
+		virtual ~EepromCommitter();
+
+		/**
+		 * @param eeprom EEPROM to write pages to. Its pages must have been initialised.
+		 */
+		EepromCommitter(Eeprom* eeprom);
+
+		/**
+		 * Queue a page to be written.
+		 * @param pageId Identifier of the page.
+		 * @param pageData Page data. Page length in size. Copied, so it can be changed straight away.
+		 */
+		void queue(uint8_t pageId, const uint8_t* pageData);
+
+		/** Polling pass. Advances the pipeline by one step. */
+		void poll();
+
+		/** Get the state of the pipeline. */
+		EepromCommitState getState();
+
+		/** Get the page being written. Only valid while writing or verifying. */
+		uint8_t getPageId();
+
+		/** Get the index of the chip page, within the page instance, being written or verified. */
+		unsigned getChipPageIndex();
+
+		/** Get whether a page is waiting to be written, or being written. */
+		bool isPending(uint8_t pageId);
+
+		/** Get the number of page writes completed and verified. */
+		unsigned getCommitCount();
+
+		/** Get the number of queued pages that replaced data still waiting to be written. */
+		unsigned getCoalesceCount();
+
+		/** Get the number of page writes that failed, and were given up on after retrying. */
+		unsigned getFailCount();
+
+		/**
+		 * Get whether the write of a page was given up on since the last call, and clear it. So the owner of the page can
+		 * queue it again later.
+		 */
+		bool takeFailed(uint8_t pageId);
+
+	private:
+
+		Eeprom* _eeprom;
+
+		/** Number of pages. */
+		uint8_t _pageCount;
+
+		/** Data waiting to be written, per page. */
+		uint8_t** _queuedData;
+
+		/** Whether each page has data waiting to be written. */
+		bool* _queued;
+
+		/** Whether the last write of each page was given up on, and not yet taken. */
+		bool* _failed;
+
+		/** Data of the page being written. Sized for the largest page. */
+		uint8_t* _writeData;
+
+		/** Whether a page is being written. */
+		bool _writing = false;
+
+		/** Page being written. */
+		uint8_t _writePageId = 0;
+
+		/** Number of times the page being written has been retried. */
+		unsigned _retryCount = 0;
+
+		/** Page to look at first for the next write. Pages take turns, so a page queued often can't starve the others. */
+		uint8_t _nextPageId = 0;
+
+		unsigned _commitCount = 0;
+
+		unsigned _coalesceCount = 0;
+
+		unsigned _failCount = 0;
+
+		/** Start writing the next queued page, if there is one. */
+		void __startNext();
+};
+
+#endif
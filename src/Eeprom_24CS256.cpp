@@ -1,74 +1,259 @@
+#include <string.h>
+
 #include "Eeprom_24CS256.hpp"
+#include "HalTime.hpp"
+
+/** Source of the fill value for clears. Static so clearing doesn't need a page of stack. */
+static uint8_t clearFillBuffer[WRITE_PAGE_SIZE];
 
-Eeprom_24CS256::Eeprom_24CS256(i2c_inst_t* i2cBus, uint8_t i2cAddr, EepromPage* pages, uint8_t pageCount)
-	: Eeprom(32768, pages, pageCount), _i2cBus(i2cBus)
+Eeprom_24CS256::Eeprom_24CS256(hal_i2c_inst_t* i2cBus, uint8_t i2cAddr, EepromPage* pages, uint8_t pageCount,
+	EepromClearProgress clearProgress, bool mirror) : Eeprom(32768, WRITE_PAGE_SIZE, pages, pageCount), _i2cBus(i2cBus),
+	_clearProgress(clearProgress)
 {
 	_i2cAddr = i2cAddr & 0x07;
 
+	if(mirror) __loadMirror();
+
 	Eeprom::_init();
 }
 
 Eeprom_24CS256::~Eeprom_24CS256()
 {
+	if(_mirror) delete[] _mirror;
+	if(_mirrorDirty) delete[] _mirrorDirty;
 }
 
 void Eeprom_24CS256::_clear(uint8_t value, unsigned start, unsigned count)
 {
+	uint64_t startUs = hal_time_us_64();
+
+	memset(clearFillBuffer, value, WRITE_PAGE_SIZE);
+
+	unsigned clearedCount = 0;
+
+	while(clearedCount < count)
+	{
+		uint32_t addr = start + clearedCount;
+
+		// Up to the end of the chip page, so after the first write every write is a whole aligned page.
+		unsigned numToClear = WRITE_PAGE_SIZE - (addr & (WRITE_PAGE_SIZE - 1));
+
+		if(numToClear > count - clearedCount) numToClear = count - clearedCount;
+
+		// Give up on an error. The chip isn't responding, so the rest would fail too.
+		if(!_writeBytes(addr, clearFillBuffer, numToClear) || !__flushMirror(addr, numToClear)) break;
 
+		clearedCount += numToClear;
+
+		if(_clearProgress) _clearProgress(clearedCount, count);
+	}
+
+	_clearedByteCount += clearedCount;
+	_clearTimeUs += (uint32_t)(hal_time_us_64() - startUs);
 }
 
 bool Eeprom_24CS256::_writeBytes(uint32_t startAddr, uint8_t* values, unsigned count)
 {
-	// NOTE: To reference the device as EEPROM (there are other modes), bits 7-4 must be 1010
+	// The mirrored part is only written to the chip when flushed.
+	unsigned numMirrored = __calcMirroredCount(startAddr, count);
 
-	// Buffer to allow up to 64 byte page write. First extra two bytes are for the word address.
-	// The EEPROM addressing requires the high order address bits first so an address has to be assembled byte by byte.
-	uint8_t buffer[66];
+	if(numMirrored) __writeMirror(startAddr, values, numMirrored);
 
-	uint32_t writeAddr = startAddr;
-	uint32_t nextAddr = startAddr;
+	return numMirrored == count || __writeThrough(startAddr + numMirrored, values + numMirrored, count - numMirrored);
+}
 
-	unsigned numToWriteInPage;
-	unsigned totalNumWritten = 0;
+bool Eeprom_24CS256::_readBytes(uint32_t startAddr, uint8_t* buffer, unsigned count)
+{
+	unsigned numMirrored = __calcMirroredCount(startAddr, count);
 
-	int response = 1;
+	if(numMirrored) memcpy(buffer, _mirror + startAddr, numMirrored);
 
-	while(response > 0 && totalNumWritten < count)
+	return numMirrored == count || __readChip(startAddr + numMirrored, buffer + numMirrored, count - numMirrored);
+}
+
+bool Eeprom_24CS256::_readChipBytes(uint32_t startAddr, uint8_t* buffer, unsigned count)
+{
+	if(!__readChip(startAddr, buffer, count)) return false;
+
+	unsigned numMirrored = __calcMirroredCount(startAddr, count);
+
+	// The chip doesn't have what the mirror says it should. Make sure it is written again next time.
+	if(numMirrored && memcmp(buffer, _mirror + startAddr, numMirrored) != 0)
 	{
-		// Doesn't include address bytes.
-		numToWriteInPage = 0;
+		unsigned lastChipPage = (startAddr + numMirrored - 1) / WRITE_PAGE_SIZE;
+
+		for(unsigned chipPage = startAddr / WRITE_PAGE_SIZE; chipPage <= lastChipPage; chipPage++)
+		{
+			__setMirrorPageDirty(chipPage, true);
+		}
+	}
+
+	return true;
+}
+
+bool Eeprom_24CS256::_startWriteChipPage(uint32_t startAddr, uint8_t* values, unsigned count)
+{
+	if(__calcMirroredCount(startAddr, count) != count) return __startWriteChip(startAddr, values, count);
+
+	__writeMirror(startAddr, values, count);
+
+	unsigned chipPage = startAddr / WRITE_PAGE_SIZE;
+
+	// Nothing to do if the chip already has it. No write cycle is started, so it is ready straight away.
+	if(!__isMirrorPageDirty(chipPage)) return true;
+
+	// The whole chip page is written, which picks up anything else waiting to be flushed in it too.
+	if(!__startWriteChip(chipPage * WRITE_PAGE_SIZE, _mirror + chipPage * WRITE_PAGE_SIZE, WRITE_PAGE_SIZE)) return false;
 
-		// Assemble the buffer to write.
-		// Lowest order 6 bits is the address within a page.
-		do {
+	__setMirrorPageDirty(chipPage, false);
+	_mirrorFlushCount++;
+
+	// Made dirty again if the write cycle fails.
+	_mirrorWritingChipPage = chipPage;
+
+	return true;
+}
+
+EepromWriteCycleState Eeprom_24CS256::_pollWriteCycle()
+{
+	if(!_writeCycleActive) return EEPROM_WRITE_CYCLE_READY;
 
-			buffer[numToWriteInPage + 2] = values[totalNumWritten];
+	// The chip doesn't acknowledge its address until it has finished writing its memory. A one byte read is used as the
+	// probe as it has no effect on the memory. It just reads at the address pointer.
+	uint8_t probe;
 
-			numToWriteInPage++;
-			totalNumWritten++;
-			nextAddr++;
+	bool acked = hal_i2c_read_timeout_us(_i2cBus, 0x50 | (_i2cAddr & 0x7), &probe, 1, false, __calcTimeout(1)) > 0;
 
-		} while(totalNumWritten < count && (nextAddr & 0x3F));
+	uint32_t elapsedUs = (uint32_t)(hal_time_us_64() - _writeCycleStartUs);
 
-		// Only 15bits of the address is kept.
-		buffer[0] = (writeAddr & 0x7F00) >> 8;
-		buffer[1] = writeAddr & 0xFF;
+	if(!acked && elapsedUs < WRITE_CYCLE_TIMEOUT_US) return EEPROM_WRITE_CYCLE_BUSY;
 
-		// Write data to address.
-		response = i2c_write_timeout_us(_i2cBus, 0x50 | (_i2cAddr & 0x7), buffer, numToWriteInPage + 2, false,
-		__calcTimeout(2 + numToWriteInPage));
+	_writeCycleActive = false;
 
-		writeAddr = nextAddr;
+	_writeCycleCount++;
+	_writeCycleTotalUs += elapsedUs;
 
-		// Allow for enough time for the chip to write to it's memory.
-		// Twc (Write Cycle Time) is 5ms for this chip, as per the datasheet.
-		sleep_ms(5);
+	if(elapsedUs > _writeCycleMaxUs) _writeCycleMaxUs = elapsedUs;
+
+	int writingChipPage = _mirrorWritingChipPage;
+
+	_mirrorWritingChipPage = -1;
+
+	if(acked) return EEPROM_WRITE_CYCLE_READY;
+
+	if(writingChipPage >= 0) __setMirrorPageDirty(writingChipPage, true);
+
+	_writeCycleTimeoutCount++;
+
+	return EEPROM_WRITE_CYCLE_FAILED;
+}
+
+bool Eeprom_24CS256::_flush()
+{
+	return __flushMirror(0, _mirrorSize);
+}
+
+unsigned Eeprom_24CS256::getWriteCycleCount()
+{
+	return _writeCycleCount;
+}
+
+uint32_t Eeprom_24CS256::getWriteCycleTotalUs()
+{
+	return _writeCycleTotalUs;
+}
+
+uint32_t Eeprom_24CS256::getWriteCycleMaxUs()
+{
+	return _writeCycleMaxUs;
+}
+
+unsigned Eeprom_24CS256::getWriteCycleTimeoutCount()
+{
+	return _writeCycleTimeoutCount;
+}
+
+unsigned Eeprom_24CS256::getClearedByteCount()
+{
+	return _clearedByteCount;
+}
+
+uint32_t Eeprom_24CS256::getClearTimeUs()
+{
+	return _clearTimeUs;
+}
+
+unsigned Eeprom_24CS256::getMirrorSize()
+{
+	return _mirrorSize;
+}
+
+uint32_t Eeprom_24CS256::getMirrorLoadTimeUs()
+{
+	return _mirrorLoadTimeUs;
+}
+
+unsigned Eeprom_24CS256::getMirrorFlushCount()
+{
+	return _mirrorFlushCount;
+}
+
+unsigned Eeprom_24CS256::getMirrorUnchangedCount()
+{
+	return _mirrorUnchangedCount;
+}
+
+bool Eeprom_24CS256::__writeThrough(uint32_t startAddr, uint8_t* values, unsigned count)
+{
+	unsigned totalNumWritten = 0;
+
+	while(totalNumWritten < count)
+	{
+		uint32_t writeAddr = startAddr + totalNumWritten;
+
+		// Lowest order 6 bits is the address within a page. A write can't go past the end of the page.
+		unsigned numToWriteInPage = WRITE_PAGE_SIZE - (writeAddr & (WRITE_PAGE_SIZE - 1));
+
+		if(numToWriteInPage > count - totalNumWritten) numToWriteInPage = count - totalNumWritten;
+
+		if(!__startWriteChip(writeAddr, values + totalNumWritten, numToWriteInPage)) return false;
+
+		totalNumWritten += numToWriteInPage;
+
+		// The chip has to finish writing it's memory before it will accept anything else.
+		if(!__waitForWriteCycle()) return false;
 	}
 
-	return response > 0;
+	return true;
 }
 
-bool Eeprom_24CS256::_readBytes(uint32_t startAddr, uint8_t* buffer, unsigned count)
+bool Eeprom_24CS256::__startWriteChip(uint32_t startAddr, const uint8_t* values, unsigned count)
+{
+	// NOTE: To reference the device as EEPROM (there are other modes), bits 7-4 must be 1010
+
+	// Buffer to allow up to 64 byte page write. First extra two bytes are for the word address.
+	// The EEPROM addressing requires the high order address bits first so an address has to be assembled byte by byte.
+	uint8_t buffer[WRITE_PAGE_SIZE + 2];
+
+	// Only 15bits of the address is kept.
+	buffer[0] = (startAddr & 0x7F00) >> 8;
+	buffer[1] = startAddr & 0xFF;
+
+	memcpy(buffer + 2, values, count);
+
+	// Write data to address.
+	int response = hal_i2c_write_timeout_us(_i2cBus, 0x50 | (_i2cAddr & 0x7), buffer, count + 2, false,
+		__calcTimeout(2 + count));
+
+	if(response <= 0) return false;
+
+	_writeCycleActive = true;
+	_writeCycleStartUs = hal_time_us_64();
+
+	return true;
+}
+
+bool Eeprom_24CS256::__readChip(uint32_t startAddr, uint8_t* buffer, unsigned count)
 {
 	// Write address to start reading from with no stop so that subsequent read can "restart" instead of doing a full
 	// stop start cycle.
@@ -83,19 +268,132 @@ bool Eeprom_24CS256::_readBytes(uint32_t startAddr, uint8_t* buffer, unsigned co
 	// NOTE: To reference the device as EEPROM (there are other modes), bits 7-4 must be 1010.
 	//       Only bits 0, 1 and 2 of the device address are usable.
 
-	int response = i2c_write_timeout_us(_i2cBus, 0x50 | (_i2cAddr & 0x7), startAddrBytes, 2, true,
+	int response = hal_i2c_write_timeout_us(_i2cBus, 0x50 | (_i2cAddr & 0x7), startAddrBytes, 2, true,
 		__calcTimeout(2));
 
-	// Either PICO_ERROR_GENERIC, PICO_ERROR_TIMEOUT or the number of bytes written is returned.
+	// Either HAL_I2C_ERROR_GENERIC, HAL_I2C_ERROR_TIMEOUT or the number of bytes written is returned.
 	if(response == 2)
 	{
 		// Now read data.
-		response = i2c_read_timeout_us(_i2cBus, 0x50 | (_i2cAddr & 0x7), buffer, count, false, __calcTimeout(count));
+		response = hal_i2c_read_timeout_us(_i2cBus, 0x50 | (_i2cAddr & 0x7), buffer, count, false, __calcTimeout(count));
 	}
 
 	return response > 0;
 }
 
+void Eeprom_24CS256::__loadMirror()
+{
+	uint64_t startUs = hal_time_us_64();
+
+	// Only the header and wear levelled pages are mirrored. That is all that is accessed often.
+	unsigned size = (getNonPageRegionStartAddress() + WRITE_PAGE_SIZE - 1) & ~(WRITE_PAGE_SIZE - 1);
+
+	_mirror = new uint8_t[size];
+
+	for(unsigned offset = 0; offset < size; offset += MIRROR_LOAD_CHUNK_SIZE)
+	{
+		unsigned count = size - offset < MIRROR_LOAD_CHUNK_SIZE ? size - offset : MIRROR_LOAD_CHUNK_SIZE;
+
+		if(!__readChip(offset, _mirror + offset, count))
+		{
+			// Carry on without the mirror. Everything goes to the chip as if there wasn't one.
+			delete[] _mirror;
+			_mirror = 0;
+
+			return;
+		}
+	}
+
+	unsigned dirtyWords = (size / WRITE_PAGE_SIZE + 31) / 32;
+
+	_mirrorDirty = new uint32_t[dirtyWords];
+
+	for(unsigned index = 0; index < dirtyWords; index++) _mirrorDirty[index] = 0;
+
+	_mirrorSize = size;
+	_mirrorLoadTimeUs = (uint32_t)(hal_time_us_64() - startUs);
+}
+
+unsigned Eeprom_24CS256::__calcMirroredCount(uint32_t startAddr, unsigned count)
+{
+	if(startAddr >= _mirrorSize) return 0;
+
+	return count < _mirrorSize - startAddr ? count : _mirrorSize - startAddr;
+}
+
+void Eeprom_24CS256::__writeMirror(uint32_t startAddr, const uint8_t* values, unsigned count)
+{
+	unsigned offset = 0;
+
+	while(offset < count)
+	{
+		uint32_t addr = startAddr + offset;
+		unsigned chipPage = addr / WRITE_PAGE_SIZE;
+
+		unsigned numInPage = WRITE_PAGE_SIZE - (addr & (WRITE_PAGE_SIZE - 1));
+
+		if(numInPage > count - offset) numInPage = count - offset;
+
+		if(memcmp(_mirror + addr, values + offset, numInPage) != 0)
+		{
+			memcpy(_mirror + addr, values + offset, numInPage);
+
+			__setMirrorPageDirty(chipPage, true);
+		}
+		else
+		{
+			_mirrorUnchangedCount++;
+		}
+
+		offset += numInPage;
+	}
+}
+
+bool Eeprom_24CS256::__flushMirror(uint32_t startAddr, unsigned count)
+{
+	unsigned numMirrored = __calcMirroredCount(startAddr, count);
+
+	if(numMirrored == 0) return true;
+
+	unsigned lastChipPage = (startAddr + numMirrored - 1) / WRITE_PAGE_SIZE;
+
+	for(unsigned chipPage = startAddr / WRITE_PAGE_SIZE; chipPage <= lastChipPage; chipPage++)
+	{
+		if(!__isMirrorPageDirty(chipPage)) continue;
+
+		// Always whole aligned chip pages, so each is a single write cycle.
+		if(!__startWriteChip(chipPage * WRITE_PAGE_SIZE, _mirror + chipPage * WRITE_PAGE_SIZE, WRITE_PAGE_SIZE) ||
+			!__waitForWriteCycle())
+		{
+			return false;
+		}
+
+		__setMirrorPageDirty(chipPage, false);
+		_mirrorFlushCount++;
+	}
+
+	return true;
+}
+
+bool Eeprom_24CS256::__isMirrorPageDirty(unsigned chipPage)
+{
+	return (_mirrorDirty[chipPage / 32] >> (chipPage % 32)) & 1;
+}
+
+void Eeprom_24CS256::__setMirrorPageDirty(unsigned chipPage, bool dirty)
+{
+	if(dirty) _mirrorDirty[chipPage / 32] |= 1u << (chipPage % 32); else _mirrorDirty[chipPage / 32] &= ~(1u << (chipPage % 32));
+}
+
+bool Eeprom_24CS256::__waitForWriteCycle()
+{
+	EepromWriteCycleState state;
+
+	while((state = _pollWriteCycle()) == EEPROM_WRITE_CYCLE_BUSY);
+
+	return state == EEPROM_WRITE_CYCLE_READY;
+}
+
 unsigned Eeprom_24CS256::__calcTimeout(unsigned numBytesTransf)
 {
 	return (READ_WRITE_TIMEOUT_OVERHEAD + numBytesTransf) * PER_BYTE_TIMEOUT_US;
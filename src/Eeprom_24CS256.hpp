@@ -3,9 +3,8 @@
 
 #include <stdint.h>
 
-#include "hardware/i2c.h"
-
 #include "Eeprom.hpp"
+#include "HalI2c.hpp"
 
 /**
  * The timeout, in micro seconds, to apply on per byte transfered.
@@ -19,8 +18,30 @@
  */
 #define READ_WRITE_TIMEOUT_OVERHEAD 4
 
+/**
+ * The longest to wait, in micro seconds, for a write cycle to finish before giving up.
+ * Twc (Write Cycle Time) is 5ms max for this chip, as per the datasheet, so this allows plenty of margin.
+ */
+#define WRITE_CYCLE_TIMEOUT_US 10000
+
+/** Size of the chip's write pages in bytes. A single write can't cross a page boundary. */
+#define WRITE_PAGE_SIZE 64
+
+/** Number of bytes read at a time when loading the mirror. A few large sequential reads, rather than many small ones. */
+#define MIRROR_LOAD_CHUNK_SIZE 4096
+
+/**
+ * Called as a clear progresses. eg To show how far the first boot format has got.
+ * @param clearedCount Number of bytes cleared so far.
+ * @param totalCount Number of bytes being cleared.
+ */
+typedef void (*EepromClearProgress)(unsigned clearedCount, unsigned totalCount);
+
 /**
  * Driver for 24CS256 EEPROM chip.
+ * Optionally keeps a RAM mirror of the header and wear levelled pages, loaded once at construction. Reads of the
+ * mirrored region then come from RAM, and writes only update RAM and mark the 64 byte chip pages they change as dirty.
+ * Dirty chip pages are written, whole, when flushed. Writes that don't change anything cost nothing.
  */
 class Eeprom_24CS256 : public Eeprom
 {
@@ -33,8 +54,42 @@ class Eeprom_24CS256 : public Eeprom
 		 * @param i2cAddr 3 bit address of the EEPROM chip.
 		 * @param pages Array of wear levelled pages. The index into this array needs to be used for future page accesses.
 		 * @param pageCount Number of entries in the pages array. Clamped to 8 bit number.
+		 * @param clearProgress Called after each chip page is cleared, including while formatting during construction.
+		 *                      Can be 0.
+		 * @param mirror Whether to keep a RAM mirror of the header and wear levelled pages.
 		 */
-		Eeprom_24CS256(i2c_inst_t* i2cBus, uint8_t i2cAddr, EepromPage* pages, uint8_t pageCount);
+		Eeprom_24CS256(hal_i2c_inst_t* i2cBus, uint8_t i2cAddr, EepromPage* pages, uint8_t pageCount,
+			EepromClearProgress clearProgress = 0, bool mirror = false);
+
+		/** Get the number of chip page write cycles seen to finish, or time out, since construction. */
+		unsigned getWriteCycleCount();
+
+		/** Get the total time from starting write cycles to seeing them finish, in micro seconds. */
+		uint32_t getWriteCycleTotalUs();
+
+		/** Get the longest time from starting a write cycle to seeing it finish, in micro seconds. */
+		uint32_t getWriteCycleMaxUs();
+
+		/** Get the number of write cycles that didn't finish within WRITE_CYCLE_TIMEOUT_US. */
+		unsigned getWriteCycleTimeoutCount();
+
+		/** Get the number of bytes cleared since construction. */
+		unsigned getClearedByteCount();
+
+		/** Get the total time spent clearing since construction, in micro seconds. */
+		uint32_t getClearTimeUs();
+
+		/** Get the size of the RAM mirror, in bytes. 0 if there isn't one, including if it couldn't be loaded. */
+		unsigned getMirrorSize();
+
+		/** Get the time taken to load the RAM mirror, in micro seconds. */
+		uint32_t getMirrorLoadTimeUs();
+
+		/** Get the number of dirty chip pages written from the RAM mirror. */
+		unsigned getMirrorFlushCount();
+
+		/** Get the number of chip pages written to the RAM mirror without changing them. ie Chip writes saved. */
+		unsigned getMirrorUnchangedCount();
 
 	protected:
 
@@ -47,16 +102,119 @@ class Eeprom_24CS256 : public Eeprom
 		// Impl.
 		bool _readBytes(uint32_t startAddr, uint8_t* buffer, unsigned count);
 
+		// Impl.
+		bool _readChipBytes(uint32_t startAddr, uint8_t* buffer, unsigned count);
+
+		// Impl. When mirrored, the whole chip page is written, and only if it has changed.
+		bool _startWriteChipPage(uint32_t startAddr, uint8_t* values, unsigned count);
+
+		// Impl.
+		EepromWriteCycleState _pollWriteCycle();
+
+		// Impl.
+		bool _flush();
+
 	private:
 
 		/** i2c bus (instance) that EEPROM is attached to. */
-		i2c_inst_t* _i2cBus;
+		hal_i2c_inst_t* _i2cBus;
 
 		/**
 		 * Address of the EEPROM chip, clamped to 3 bits (which is the maximum this chip supports).
 		 */
 		uint8_t _i2cAddr;
 
+		/** Whether a write cycle has been started that hasn't been seen to finish yet. */
+		bool _writeCycleActive = false;
+
+		/** Time the outstanding write cycle started. */
+		uint64_t _writeCycleStartUs = 0;
+
+		/** Number of write cycles waited for. */
+		unsigned _writeCycleCount = 0;
+
+		/** Total time waited for write cycles, in micro seconds. */
+		uint32_t _writeCycleTotalUs = 0;
+
+		/** Longest time waited for a write cycle, in micro seconds. */
+		uint32_t _writeCycleMaxUs = 0;
+
+		/** Number of write cycles that timed out. */
+		unsigned _writeCycleTimeoutCount = 0;
+
+		/** Called as a clear progresses. */
+		EepromClearProgress _clearProgress;
+
+		/** Number of bytes cleared. */
+		unsigned _clearedByteCount = 0;
+
+		/** Total time spent clearing, in micro seconds. */
+		uint32_t _clearTimeUs = 0;
+
+		/** RAM mirror of the start of the chip. 0 if there isn't one. */
+		uint8_t* _mirror = 0;
+
+		/** Size of the RAM mirror, in bytes. A whole number of chip pages. */
+		unsigned _mirrorSize = 0;
+
+		/** One bit per chip page of the mirror, set if the chip page has changed and not been written to the chip. */
+		uint32_t* _mirrorDirty = 0;
+
+		/** Chip page of the mirror whose write cycle is in progress, from _startWriteChipPage. -1 if none. */
+		int _mirrorWritingChipPage = -1;
+
+		/** Time taken to load the mirror, in micro seconds. */
+		uint32_t _mirrorLoadTimeUs = 0;
+
+		/** Number of dirty chip pages written from the mirror. */
+		unsigned _mirrorFlushCount = 0;
+
+		/** Number of chip pages written to the mirror without changing them. */
+		unsigned _mirrorUnchangedCount = 0;
+
+		/**
+		 * Write bytes straight to the chip, waiting for each chip page's write cycle.
+		 * @returns True if write was successful.
+		 */
+		bool __writeThrough(uint32_t startAddr, uint8_t* values, unsigned count);
+
+		/**
+		 * Start writing bytes within a single chip page straight to the chip, without waiting for the write cycle.
+		 * @returns True if the chip accepted the write.
+		 */
+		bool __startWriteChip(uint32_t startAddr, const uint8_t* values, unsigned count);
+
+		/**
+		 * Read bytes straight from the chip.
+		 * @returns True if read was successful.
+		 */
+		bool __readChip(uint32_t startAddr, uint8_t* buffer, unsigned count);
+
+		/** Load the RAM mirror from the chip. Carries on without one if the chip can't be read. */
+		void __loadMirror();
+
+		/** Get the number of bytes, from the start of a range, that are in the mirror. */
+		unsigned __calcMirroredCount(uint32_t startAddr, unsigned count);
+
+		/** Write bytes to the mirror, marking the chip pages changed as dirty. The bytes must all be in the mirror. */
+		void __writeMirror(uint32_t startAddr, const uint8_t* values, unsigned count);
+
+		/**
+		 * Write dirty chip pages of the mirror in a range to the chip, waiting for each write cycle.
+		 * @returns True if they were all written.
+		 */
+		bool __flushMirror(uint32_t startAddr, unsigned count);
+
+		bool __isMirrorPageDirty(unsigned chipPage);
+
+		void __setMirrorPageDirty(unsigned chipPage, bool dirty);
+
+		/**
+		 * Wait for the write cycle in progress to finish by acknowledge polling.
+		 * @returns True if the chip acknowledged within WRITE_CYCLE_TIMEOUT_US.
+		 */
+		bool __waitForWriteCycle();
+
 		/**
 		 * Calculate the timeout required for a number of bytes transferred.
 		 * @param numBytesTransf Number of bytes that will be transferred to/from chip.
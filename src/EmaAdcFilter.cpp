@@ -0,0 +1,30 @@
+#include "EmaAdcFilter.hpp"
+
+EmaAdcFilter::~EmaAdcFilter()
+{
+}
+
+EmaAdcFilter::EmaAdcFilter(unsigned shift) : _shift(shift)
+{
+	// Keep the scaled accumulator inside 32 bits for 16 bit values.
+	if(_shift > 15) _shift = 15;
+}
+
+void EmaAdcFilter::push(uint32_t value)
+{
+	if(!_primed)
+	{
+		// Start from the first value rather than ramping up from zero.
+		_acc = value << _shift;
+		_primed = true;
+	}
+	else
+	{
+		_acc = _acc - (_acc >> _shift) + value;
+	}
+}
+
+uint32_t EmaAdcFilter::output()
+{
+	return _acc >> _shift;
+}
@@ -0,0 +1,42 @@
+#ifndef EMA_ADC_FILTER_H
+#define EMA_ADC_FILTER_H
+
+#include <stdint.h>
+
+#include "AdcFilter.hpp"
+
+/**
+ * Exponential moving average filter.
+ * The smoothing factor is 1 / 2^shift so the update is a subtract and a shift. Roughly equivalent to a boxcar filter of
+ * length 2^shift but with no history to store.
+ */
+class EmaAdcFilter : public AdcFilter
+{
+	public:
+
+		virtual ~EmaAdcFilter();
+
+		/**
+		 * @param shift log2 of the inverse smoothing factor. Clamped to 15.
+		 */
+		EmaAdcFilter(unsigned shift);
+
+		// Impl.
+		void push(uint32_t value);
+
+		// Impl.
+		uint32_t output();
+
+	private:
+
+		/** log2 of the inverse smoothing factor. */
+		unsigned _shift;
+
+		/** Whether a value has been pushed yet. The first value primes the filter. */
+		bool _primed = false;
+
+		/** Filter state. This is the average scaled by 2^shift so no precision is lost. */
+		uint32_t _acc = 0;
+};
+
+#endif
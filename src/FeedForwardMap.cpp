@@ -0,0 +1,102 @@
+#include "FeedForwardMap.hpp"
+#include "FixedPointPid.hpp"
+
+const int32_t FeedForwardMap::boostAxis[FEED_FORWARD_BOOST_POINTS] = FEED_FORWARD_BOOST_AXIS;
+
+const int32_t FeedForwardMap::loadAxis[FEED_FORWARD_LOAD_POINTS] = FEED_FORWARD_LOAD_AXIS;
+
+void FeedForwardMap::setTable(const BoostControlParameters* params)
+{
+	for(unsigned boostIndex = 0; boostIndex < FEED_FORWARD_BOOST_POINTS; boostIndex++)
+	{
+		for(unsigned loadIndex = 0; loadIndex < FEED_FORWARD_LOAD_POINTS; loadIndex++)
+		{
+			_duty[boostIndex][loadIndex] = FixedPointPid::fromDeci(params -> feedForwardDuty[boostIndex][loadIndex] +
+				params -> learnedDuty[boostIndex][loadIndex]);
+		}
+	}
+
+	// The axes are constant, but doing this here keeps the divides off the control loop without a static initialiser.
+	for(unsigned index = 0; index < FEED_FORWARD_BOOST_POINTS - 1; index++)
+	{
+		uint32_t width = boostAxis[index + 1] - boostAxis[index];
+
+		_invBoostWidths[index] = width > 1 ? ((uint64_t)1 << 32) / width : UINT32_MAX;
+	}
+
+	for(unsigned index = 0; index < FEED_FORWARD_LOAD_POINTS - 1; index++)
+	{
+		uint32_t width = loadAxis[index + 1] - loadAxis[index];
+
+		_invLoadWidths[index] = width > 1 ? ((uint64_t)1 << 32) / width : UINT32_MAX;
+	}
+}
+
+int32_t FeedForwardMap::evaluate(int32_t targetKpaScaled, int32_t load)
+{
+	int32_t boostFrac;
+	int32_t loadFrac;
+
+	unsigned boostIndex = __locate(boostAxis, _invBoostWidths, FEED_FORWARD_BOOST_POINTS, targetKpaScaled, &boostFrac);
+	unsigned loadIndex = __locate(loadAxis, _invLoadWidths, FEED_FORWARD_LOAD_POINTS, load, &loadFrac);
+
+	int32_t* low = _duty[boostIndex];
+	int32_t* high = _duty[boostIndex + 1];
+
+	// Interpolate along the load axis at both boost points, then between them.
+	int32_t lowDuty = __lerp(low[loadIndex], low[loadIndex + 1], loadFrac);
+	int32_t highDuty = __lerp(high[loadIndex], high[loadIndex + 1], loadFrac);
+
+	return __lerp(lowDuty, highDuty, boostFrac);
+}
+
+void FeedForwardMap::populateDefaultTable(BoostControlParameters* params)
+{
+	for(unsigned boostIndex = 0; boostIndex < FEED_FORWARD_BOOST_POINTS; boostIndex++)
+	{
+		for(unsigned loadIndex = 0; loadIndex < FEED_FORWARD_LOAD_POINTS; loadIndex++)
+		{
+			params -> feedForwardDuty[boostIndex][loadIndex] = 0;
+			params -> learnedDuty[boostIndex][loadIndex] = 0;
+		}
+	}
+}
+
+unsigned FeedForwardMap::nearestIndex(const int32_t* axis, unsigned pointCount, int32_t val)
+{
+	unsigned index = 0;
+
+	while(index < pointCount - 1 && val - axis[index] > axis[index + 1] - val) index++;
+
+	return index;
+}
+
+unsigned FeedForwardMap::__locate(const int32_t* axis, const uint32_t* invWidths, unsigned pointCount, int32_t val,
+	int32_t* frac)
+{
+	if(val <= axis[0])
+	{
+		*frac = 0;
+		return 0;
+	}
+
+	if(val >= axis[pointCount - 1])
+	{
+		*frac = (int32_t)1 << FEED_FORWARD_FRAC_BITS;
+		return pointCount - 2;
+	}
+
+	unsigned index = 0;
+
+	// Only a handful of points, so a linear search is quickest.
+	while(val >= axis[index + 1]) index++;
+
+	*frac = ((uint64_t)(uint32_t)(val - axis[index]) * invWidths[index]) >> (32 - FEED_FORWARD_FRAC_BITS);
+
+	return index;
+}
+
+int32_t FeedForwardMap::__lerp(int32_t a, int32_t b, int32_t frac)
+{
+	return a + (int32_t)(((int64_t)(b - a) * frac) >> FEED_FORWARD_FRAC_BITS);
+}
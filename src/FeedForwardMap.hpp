@@ -0,0 +1,95 @@
+#ifndef FEED_FORWARD_MAP_H
+#define FEED_FORWARD_MAP_H
+
+#include <stdint.h>
+
+#include "BoostControlParameters.hpp"
+
+/** Number of fractional bits used for interpolation between table points. */
+#define FEED_FORWARD_FRAC_BITS 16
+
+/** Target boost axis of the feed forward table, relative to std atm. In kPa, scaled by 1000. Must be ascending. */
+#define FEED_FORWARD_BOOST_AXIS {0, 50000, 100000, 150000, 200000}
+
+/**
+ * Load axis of the feed forward table. Must be ascending.
+ * Currently the load input is VSys, in millivolts. A future RPM input would replace it.
+ */
+#define FEED_FORWARD_LOAD_AXIS {4000, 4500, 5000, 5500}
+
+/**
+ * Feed forward duty cycle map. A 2-D table, per preset, of the duty cycle that holds a target boost at a given load.
+ * This is looked up with bilinear interpolation and added to the PID output, so the integral term only has to make up the
+ * difference rather than the whole steady state duty.
+ * All lookups are fixed point. The table is converted to the PID fixed point format, and the reciprocal of each axis
+ * segment is calculated, when it is set. So a lookup is only compares, multiplies and shifts.
+ * @note This is plain data so that it can be copied as part of a parameter snapshot.
+ * @note This has no hardware dependencies so it can be built on the host.
+ */
+class FeedForwardMap
+{
+	public:
+
+		/**
+		 * Set the table from boost control parameters. The learned offsets are added to the feed forward duty.
+		 * @param params Parameters containing the feed forward and learned tables to use.
+		 */
+		void setTable(const BoostControlParameters* params);
+
+		/**
+		 * Look up the feed forward duty.
+		 * @param targetKpaScaled Target boost, relative to std atm. In kPa, scaled by 1000.
+		 * @param load Load. See FEED_FORWARD_LOAD_AXIS for units.
+		 * @returns Duty cycle to add to the zero point duty. In %, PID fixed point. Clamped at the table edges.
+		 */
+		int32_t evaluate(int32_t targetKpaScaled, int32_t load);
+
+		/**
+		 * Set the given feed forward and learned tables to all zeros, so feed forward is just the zero point duty.
+		 * @param params Parameters containing the tables to set.
+		 */
+		static void populateDefaultTable(BoostControlParameters* params);
+
+		/**
+		 * Find the axis point nearest to a value.
+		 * @param axis Axis points. boostAxis or loadAxis.
+		 * @param pointCount Number of axis points.
+		 * @param val Value to find.
+		 * @returns Index of the nearest point.
+		 */
+		static unsigned nearestIndex(const int32_t* axis, unsigned pointCount, int32_t val);
+
+		/** Target boost axis. */
+		static const int32_t boostAxis[FEED_FORWARD_BOOST_POINTS];
+
+		/** Load axis. */
+		static const int32_t loadAxis[FEED_FORWARD_LOAD_POINTS];
+
+	private:
+
+		/**
+		 * Find the axis segment a value is in, and how far along it.
+		 * @param axis Axis points.
+		 * @param invWidths Reciprocal of each segment width, scaled by 2^32.
+		 * @param pointCount Number of axis points.
+		 * @param val Value to find.
+		 * @param frac Set to the fraction along the segment. Fixed point with FEED_FORWARD_FRAC_BITS.
+		 * @returns Index of the first point of the segment.
+		 */
+		static unsigned __locate(const int32_t* axis, const uint32_t* invWidths, unsigned pointCount, int32_t val,
+			int32_t* frac);
+
+		/** Linearly interpolate between two values. */
+		static int32_t __lerp(int32_t a, int32_t b, int32_t frac);
+
+		/** Table, in %, PID fixed point. */
+		int32_t _duty[FEED_FORWARD_BOOST_POINTS][FEED_FORWARD_LOAD_POINTS] = {};
+
+		/** Reciprocal of each target boost axis segment width, scaled by 2^32. */
+		uint32_t _invBoostWidths[FEED_FORWARD_BOOST_POINTS - 1] = {};
+
+		/** Reciprocal of each load axis segment width, scaled by 2^32. */
+		uint32_t _invLoadWidths[FEED_FORWARD_LOAD_POINTS - 1] = {};
+};
+
+#endif
@@ -0,0 +1,147 @@
+#include "FixedPointPid.hpp"
+
+/**
+ * Multiplier to convert a value scaled by 1000 into fixed point. Has an extra 16 bits of precision that is shifted out
+ * after the multiply.
+ */
+#define FIXED_PID_MILLI_MUL ((((int64_t)1 << (FIXED_PID_FRAC_BITS + 16)) + 500) / 1000)
+
+/**
+ * Multiplier to convert a value scaled by 10 into fixed point. Has an extra 16 bits of precision that is shifted out
+ * after the multiply.
+ */
+#define FIXED_PID_DECI_MUL ((((int64_t)1 << (FIXED_PID_FRAC_BITS + 16)) + 5) / 10)
+
+/**
+ * Multiplier to convert microseconds into seconds in fixed point. Has an extra 24 bits of precision that is shifted out
+ * after the multiply.
+ */
+#define FIXED_PID_MICRO_MUL ((((int64_t)1 << (FIXED_PID_FRAC_BITS + 24)) + 500000) / 1000000)
+
+FixedPointPid::~FixedPointPid()
+{
+}
+
+FixedPointPid::FixedPointPid(uint32_t integSumTimeUs)
+{
+	if(integSumTimeUs == 0) integSumTimeUs = 1;
+
+	_invIntegSumTime = __sat(((int64_t)1000000 << FIXED_PID_FRAC_BITS) / integSumTimeUs);
+}
+
+void FixedPointPid::setParameters(const BoostControlParameters* params)
+{
+	calcGains(params, &_gains);
+}
+
+void FixedPointPid::setGains(const FixedPointPidGains* gains)
+{
+	_gains = *gains;
+}
+
+void FixedPointPid::calcGains(const BoostControlParameters* params, FixedPointPidGains* gains)
+{
+	gains -> propConst = fromMilli(params -> pidPropConstScaled);
+	gains -> integConst = fromMilli(params -> pidIntegConstScaled);
+	gains -> derivConst = fromMilli(params -> pidDerivConstScaled);
+
+	gains -> zeroPointDuty = fromDeci(params -> zeroPointDuty);
+	gains -> maxDuty = fromDeci(params -> maxDuty);
+}
+
+void FixedPointPid::reset()
+{
+	_prevError = 0;
+	_integ = 0;
+
+	_propTerm = 0;
+	_integTerm = 0;
+	_derivTerm = 0;
+}
+
+int32_t FixedPointPid::process(int32_t targetKpaScaled, int32_t curKpaScaled, uint32_t deltaTimeUs,
+	int32_t feedForwardDuty)
+{
+	// Positive error means boost is below target, which requires more duty.
+	int32_t error = fromMilli(targetKpaScaled - curKpaScaled);
+
+	int32_t deltaTime = __sat(((int64_t)deltaTimeUs * FIXED_PID_MICRO_MUL) >> 24);
+
+	// Calc proportional and derivative terms.
+	_propTerm = __mul(error, _gains.propConst);
+	_derivTerm = __mul(__sat((int64_t)error - _prevError), _gains.derivConst);
+
+	// Use an approximation to a time limited integration term.
+	// This removes a proportion of the average from the term and adds in the value associated with the current
+	// delta time.
+	int32_t leak = __mul(deltaTime, _invIntegSumTime);
+	if(leak > FIXED_PID_ONE) leak = FIXED_PID_ONE;
+
+	_integ = __sat((int64_t)_integ - __mul(leak, _integ) + __mul(error, deltaTime));
+
+	_integTerm = __mul(_integ, _gains.integConst);
+
+	// Map control var to duty cycle.
+	// Use one to one correspondence between control var and duty cycle with zero point (and feed forward) adjustment so
+	// that a control var of zero should match the required boost output.
+	int32_t duty = __sat((int64_t)_propTerm + _integTerm + _derivTerm + _gains.zeroPointDuty + feedForwardDuty);
+
+	if(duty > _gains.maxDuty) duty = _gains.maxDuty;
+	if(duty < 0) duty = 0;
+
+	_prevError = error;
+
+	return duty;
+}
+
+int32_t FixedPointPid::getPropTerm()
+{
+	return _propTerm;
+}
+
+int32_t FixedPointPid::getIntegTerm()
+{
+	return _integTerm;
+}
+
+int32_t FixedPointPid::getDerivTerm()
+{
+	return _derivTerm;
+}
+
+int32_t FixedPointPid::getInteg()
+{
+	return _integ;
+}
+
+void FixedPointPid::shiftIntegTerm(int32_t duty)
+{
+	if(_gains.integConst == 0) return;
+
+	// A divide, but this is only called occasionally, not every step.
+	_integ = __sat((int64_t)_integ - (((int64_t)duty << FIXED_PID_FRAC_BITS) / _gains.integConst));
+	_integTerm = __mul(_integ, _gains.integConst);
+}
+
+int32_t FixedPointPid::fromMilli(int32_t milliVal)
+{
+	return __sat(((int64_t)milliVal * FIXED_PID_MILLI_MUL) >> 16);
+}
+
+int32_t FixedPointPid::fromDeci(int32_t deciVal)
+{
+	return __sat(((int64_t)deciVal * FIXED_PID_DECI_MUL) >> 16);
+}
+
+int32_t FixedPointPid::__mul(int32_t a, int32_t b)
+{
+	return __sat(((int64_t)a * b) >> FIXED_PID_FRAC_BITS);
+}
+
+int32_t FixedPointPid::__sat(int64_t val)
+{
+	if(val > INT32_MAX) return INT32_MAX;
+	if(val < INT32_MIN) return INT32_MIN;
+
+	return (int32_t)val;
+}
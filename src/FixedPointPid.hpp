@@ -0,0 +1,152 @@
+#ifndef FIXED_POINT_PID_H
+#define FIXED_POINT_PID_H
+
+#include <stdint.h>
+
+#include "BoostControlParameters.hpp"
+
+/**
+ * Number of fractional bits used by the fixed point PID engine. The default of 16 gives Q16.16.
+ * @note Must be small enough that 300 kPa of error and a 100% duty cycle still fit in the integer part.
+ */
+#ifndef FIXED_PID_FRAC_BITS
+#define FIXED_PID_FRAC_BITS 16
+#endif
+
+/** The value 1.0 in the fixed point format used by the PID engine. */
+#define FIXED_PID_ONE ((int32_t)1 << FIXED_PID_FRAC_BITS)
+
+/**
+ * Fixed point constants used by the PID engine. Derived from the scaled boost control parameters.
+ */
+struct FixedPointPidGains
+{
+	/** Proportional constant. In %/kPa, fixed point. */
+	int32_t propConst;
+
+	/** Integral constant. In %/(kPa.s), fixed point. */
+	int32_t integConst;
+
+	/** Derivative constant. In %/kPa (applied per step), fixed point. */
+	int32_t derivConst;
+
+	/** Duty cycle that gives zero control var. In %, fixed point. */
+	int32_t zeroPointDuty;
+
+	/** Maximum duty cycle. In %, fixed point. */
+	int32_t maxDuty;
+};
+
+/**
+ * Integer only PID engine for the boost control solenoid.
+ * The whole error -> P/I/D -> duty path is done in fixed point so that no soft float library calls are required on a
+ * Cortex-M0+.
+ * Units used internally:
+ *   - Error is in kPa.
+ *   - Time is in seconds.
+ *   - Duty cycle is in %.
+ * @note This has no hardware dependencies so it can be built and benchmarked on the host.
+ */
+class FixedPointPid
+{
+	public:
+
+		virtual ~FixedPointPid();
+
+		/**
+		 * @param integSumTimeUs Time, in microseconds, over which the integral term is (approximately) summed.
+		 */
+		FixedPointPid(uint32_t integSumTimeUs);
+
+		/**
+		 * Set the gains and duty limits from the scaled boost control parameters.
+		 * All required fixed point constants are derived here so that process() only needs multiplies and shifts.
+		 */
+		void setParameters(const BoostControlParameters* params);
+
+		/**
+		 * Set the gains and duty limits from pre-calculated constants.
+		 */
+		void setGains(const FixedPointPidGains* gains);
+
+		/**
+		 * Calculate the fixed point constants from the scaled boost control parameters.
+		 * @param params Parameters to calculate from.
+		 * @param gains Populate this with the calculated constants.
+		 */
+		static void calcGains(const BoostControlParameters* params, FixedPointPidGains* gains);
+
+		/** Reset the PID state. ie Clear the integral and previous error. */
+		void reset();
+
+		/**
+		 * Process one step of the PID algorithm.
+		 * @param targetKpaScaled Target boost, relative to std atm. In kPa, scaled by 1000.
+		 * @param curKpaScaled Current boost, relative to std atm. In kPa, scaled by 1000.
+		 * @param deltaTimeUs Time since the previous step, in microseconds.
+		 * @param feedForwardDuty Duty cycle to add to the zero point duty. In %, fixed point.
+		 * @returns Duty cycle, in %, as a fixed point number. Clamped between 0 and the maximum duty.
+		 */
+		int32_t process(int32_t targetKpaScaled, int32_t curKpaScaled, uint32_t deltaTimeUs, int32_t feedForwardDuty);
+
+		/** Get the proportional term of the last step. In %, fixed point. */
+		int32_t getPropTerm();
+
+		/** Get the integral term of the last step. In %, fixed point. */
+		int32_t getIntegTerm();
+
+		/** Get the derivative term of the last step. In %, fixed point. */
+		int32_t getDerivTerm();
+
+		/** Get the current integral value. This is _not_ multiplied by the constant. In kPa.s, fixed point. */
+		int32_t getInteg();
+
+		/**
+		 * Remove duty from the integral term, without a step in the output, when it has been moved somewhere else.
+		 * eg Into a learned zero point offset that is now added to the feed forward duty.
+		 * Does nothing if the integral constant is zero.
+		 * @param duty Duty to remove. In %, fixed point.
+		 */
+		void shiftIntegTerm(int32_t duty);
+
+		/**
+		 * Convert a value scaled by 1000 (eg kPa scaled) into the PID fixed point format.
+		 */
+		static int32_t fromMilli(int32_t milliVal);
+
+		/**
+		 * Convert a value scaled by 10 (eg duty scaled) into the PID fixed point format.
+		 */
+		static int32_t fromDeci(int32_t deciVal);
+
+	private:
+
+		/** Multiply two fixed point numbers, saturating the result to 32 bits. */
+		static int32_t __mul(int32_t a, int32_t b);
+
+		/** Saturate a 64 bit intermediate to 32 bits. */
+		static int32_t __sat(int64_t val);
+
+		/** 1 / integration sum time. In 1/s, fixed point. */
+		int32_t _invIntegSumTime;
+
+		/** Gains and duty limits. */
+		FixedPointPidGains _gains = {};
+
+		/** Previous error. In kPa, fixed point. */
+		int32_t _prevError = 0;
+
+		/** Current integral value. This is _not_ multiplied by the constant. In kPa.s, fixed point. */
+		int32_t _integ = 0;
+
+		/** Proportional term of the last step. */
+		int32_t _propTerm = 0;
+
+		/** Integral term of the last step. */
+		int32_t _integTerm = 0;
+
+		/** Derivative term of the last step. */
+		int32_t _derivTerm = 0;
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef HAL_ADC_H
+#define HAL_ADC_H
+
+#include <stdint.h>
+
+// Hardware abstraction of one shot ADC reads.
+// On the Pico these are inline wrappers around the SDK. When PICO_BOOST_HOST is defined they are implemented by a
+// simulated back end instead (see host/SimHal.cpp).
+// @note Free running DMA capture (PicoAdcDmaCapture) is not abstracted. It only exists on the Pico.
+
+#ifdef PICO_BOOST_HOST
+
+void hal_adc_init();
+
+/** Prepare a GPIO for use as an ADC input. ie Make it high impedance. */
+void hal_adc_gpio_init(unsigned gpio);
+
+/** Select the ADC input used by hal_adc_read(). */
+void hal_adc_select_input(unsigned input);
+
+/** Do a single conversion of the selected input. 12 bits. */
+uint16_t hal_adc_read();
+
+#else
+
+#include "hardware/adc.h"
+
+inline void hal_adc_init()
+{
+	adc_init();
+}
+
+inline void hal_adc_gpio_init(unsigned gpio)
+{
+	adc_gpio_init(gpio);
+}
+
+inline void hal_adc_select_input(unsigned input)
+{
+	adc_select_input(input);
+}
+
+inline uint16_t hal_adc_read()
+{
+	return adc_read();
+}
+
+#endif
+
+#endif
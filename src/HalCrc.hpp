@@ -0,0 +1,54 @@
+#ifndef HAL_CRC_H
+#define HAL_CRC_H
+
+#include <stdint.h>
+
+// Hardware abstraction of CRC calculation.
+// On the Pico the DMA sniffer calculates it, as a DMA channel copies the data to a dummy location that is never read.
+// The CPU only sets up the transfer and waits the few cycles a byte it takes. When PICO_BOOST_HOST is defined a table
+// driven calculation is used instead (see host/SimHal.cpp).
+// The CRC is CRC-32/ISO-HDLC, as used by zlib and Ethernet. Polynomial 0x04C11DB7, initial value 0xFFFFFFFF, reflected,
+// final XOR 0xFFFFFFFF.
+
+#ifdef PICO_BOOST_HOST
+
+/** Calculate the CRC-32 of a block of bytes. */
+uint32_t hal_crc32(const uint8_t* data, unsigned len);
+
+#else
+
+#include "hardware/dma.h"
+
+inline uint32_t hal_crc32(const uint8_t* data, unsigned len)
+{
+	// Claimed the first time, and kept. Only ever used from one core.
+	static int dmaChan = dma_claim_unused_channel(true);
+	static uint8_t sink;
+
+	dma_channel_config config = dma_channel_get_default_config(dmaChan);
+
+	channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+	channel_config_set_read_increment(&config, true);
+	channel_config_set_write_increment(&config, false);
+	channel_config_set_sniff_enable(&config, true);
+
+	// Bit reversed data and a bit reversed, inverted, result make it the reflected CRC-32 rather than the sniffer's
+	// native, unreflected, one. The reversal and inversion of the result happen as it is read.
+	dma_sniffer_set_data_accumulator(0xFFFFFFFF);
+	dma_sniffer_set_output_reverse_enabled(true);
+	dma_sniffer_set_output_invert_enabled(true);
+	dma_sniffer_enable(dmaChan, DMA_SNIFF_CTRL_CALC_VALUE_CRC32R, true);
+
+	dma_channel_configure(dmaChan, &config, &sink, data, len, true);
+	dma_channel_wait_for_finish_blocking(dmaChan);
+
+	uint32_t crc = dma_sniffer_get_data_accumulator();
+
+	dma_sniffer_disable();
+
+	return crc;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef HAL_GPIO_H
+#define HAL_GPIO_H
+
+#include <stdint.h>
+
+// Hardware abstraction of GPIO.
+// On the Pico these are inline wrappers around the SDK. When PICO_BOOST_HOST is defined they are implemented by a
+// simulated back end instead (see host/SimHal.cpp).
+
+#ifdef PICO_BOOST_HOST
+
+/** GPIO directions. */
+#define HAL_GPIO_IN false
+#define HAL_GPIO_OUT true
+
+/** GPIO output overrides. See hal_gpio_set_outover(). */
+#define HAL_GPIO_OVERRIDE_NORMAL 0
+#define HAL_GPIO_OVERRIDE_LOW 2
+#define HAL_GPIO_OVERRIDE_HIGH 3
+
+/** GPIO functions. See hal_gpio_set_function(). */
+#define HAL_GPIO_FUNC_I2C 3
+#define HAL_GPIO_FUNC_PWM 4
+
+void hal_gpio_init(unsigned gpio);
+
+void hal_gpio_deinit(unsigned gpio);
+
+void hal_gpio_set_dir(unsigned gpio, bool out);
+
+void hal_gpio_put(unsigned gpio, bool value);
+
+bool hal_gpio_get(unsigned gpio);
+
+void hal_gpio_pull_up(unsigned gpio);
+
+void hal_gpio_pull_down(unsigned gpio);
+
+/** Set the function of a GPIO. One of HAL_GPIO_FUNC_*. */
+void hal_gpio_set_function(unsigned gpio, unsigned function);
+
+/** Override the output of a GPIO, regardless of its function. One of HAL_GPIO_OVERRIDE_*. */
+void hal_gpio_set_outover(unsigned gpio, unsigned value);
+
+#else
+
+#include "hardware/gpio.h"
+
+#define HAL_GPIO_IN GPIO_IN
+#define HAL_GPIO_OUT GPIO_OUT
+
+#define HAL_GPIO_OVERRIDE_NORMAL GPIO_OVERRIDE_NORMAL
+#define HAL_GPIO_OVERRIDE_LOW GPIO_OVERRIDE_LOW
+#define HAL_GPIO_OVERRIDE_HIGH GPIO_OVERRIDE_HIGH
+
+#define HAL_GPIO_FUNC_I2C GPIO_FUNC_I2C
+#define HAL_GPIO_FUNC_PWM GPIO_FUNC_PWM
+
+inline void hal_gpio_init(unsigned gpio)
+{
+	gpio_init(gpio);
+}
+
+inline void hal_gpio_deinit(unsigned gpio)
+{
+	gpio_deinit(gpio);
+}
+
+inline void hal_gpio_set_dir(unsigned gpio, bool out)
+{
+	gpio_set_dir(gpio, out);
+}
+
+inline void hal_gpio_put(unsigned gpio, bool value)
+{
+	gpio_put(gpio, value);
+}
+
+inline bool hal_gpio_get(unsigned gpio)
+{
+	return gpio_get(gpio);
+}
+
+inline void hal_gpio_pull_up(unsigned gpio)
+{
+	gpio_pull_up(gpio);
+}
+
+inline void hal_gpio_pull_down(unsigned gpio)
+{
+	gpio_pull_down(gpio);
+}
+
+inline void hal_gpio_set_function(unsigned gpio, unsigned function)
+{
+	gpio_set_function(gpio, (gpio_function)function);
+}
+
+inline void hal_gpio_set_outover(unsigned gpio, unsigned value)
+{
+	gpio_set_outover(gpio, value);
+}
+
+#endif
+
+#endif
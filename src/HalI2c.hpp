@@ -0,0 +1,60 @@
+#ifndef HAL_I2C_H
+#define HAL_I2C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Hardware abstraction of i2c.
+// On the Pico these are inline wrappers around the SDK. When PICO_BOOST_HOST is defined they are implemented by a
+// simulated back end instead (see host/SimHal.cpp), which has a 24CS256 EEPROM on bus 0.
+// Transfers return the number of bytes transferred, or one of the HAL_I2C_ERROR_* codes.
+
+#ifdef PICO_BOOST_HOST
+
+/** The address wasn't acknowledged, or a byte wasn't acknowledged. */
+#define HAL_I2C_ERROR_GENERIC -1
+
+/** The transfer didn't complete in time. */
+#define HAL_I2C_ERROR_TIMEOUT -2
+
+/** An i2c bus instance. */
+typedef struct hal_i2c_inst hal_i2c_inst_t;
+
+/** i2c bus 0. */
+hal_i2c_inst_t* hal_i2c0();
+
+int hal_i2c_write_timeout_us(hal_i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop,
+	unsigned timeoutUs);
+
+int hal_i2c_read_timeout_us(hal_i2c_inst_t* i2c, uint8_t addr, uint8_t* dst, size_t len, bool nostop,
+	unsigned timeoutUs);
+
+#else
+
+#include "hardware/i2c.h"
+
+#define HAL_I2C_ERROR_GENERIC PICO_ERROR_GENERIC
+#define HAL_I2C_ERROR_TIMEOUT PICO_ERROR_TIMEOUT
+
+typedef i2c_inst_t hal_i2c_inst_t;
+
+inline hal_i2c_inst_t* hal_i2c0()
+{
+	return i2c0;
+}
+
+inline int hal_i2c_write_timeout_us(hal_i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop,
+	unsigned timeoutUs)
+{
+	return i2c_write_timeout_us(i2c, addr, src, len, nostop, timeoutUs);
+}
+
+inline int hal_i2c_read_timeout_us(hal_i2c_inst_t* i2c, uint8_t addr, uint8_t* dst, size_t len, bool nostop,
+	unsigned timeoutUs)
+{
+	return i2c_read_timeout_us(i2c, addr, dst, len, nostop, timeoutUs);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef HAL_PWM_H
+#define HAL_PWM_H
+
+#include <stdint.h>
+
+// Hardware abstraction of PWM slices.
+// On the Pico these are inline wrappers around the SDK. When PICO_BOOST_HOST is defined they are implemented by a
+// simulated back end instead (see host/SimHal.cpp).
+
+#ifdef PICO_BOOST_HOST
+
+/** PWM slice channels. */
+#define HAL_PWM_CHAN_A 0
+#define HAL_PWM_CHAN_B 1
+
+/** Get the PWM slice a GPIO is driven by. */
+unsigned hal_pwm_gpio_to_slice_num(unsigned gpio);
+
+void hal_pwm_set_phase_correct(unsigned slice, bool phaseCorrect);
+
+/** Set the counter wrap (TOP) value. */
+void hal_pwm_set_wrap(unsigned slice, uint16_t wrap);
+
+/** Set the clock divider. An 8.4 fixed point value. */
+void hal_pwm_set_clkdiv_int_frac4(unsigned slice, uint8_t divInt, uint8_t divFrac);
+
+/** Set a channel compare (CC) level. wrap + 1 is 100% duty. */
+void hal_pwm_set_chan_level(unsigned slice, unsigned chan, uint16_t level);
+
+void hal_pwm_set_enabled(unsigned slice, bool enabled);
+
+#else
+
+#include "hardware/pwm.h"
+
+#define HAL_PWM_CHAN_A PWM_CHAN_A
+#define HAL_PWM_CHAN_B PWM_CHAN_B
+
+inline unsigned hal_pwm_gpio_to_slice_num(unsigned gpio)
+{
+	return pwm_gpio_to_slice_num(gpio);
+}
+
+inline void hal_pwm_set_phase_correct(unsigned slice, bool phaseCorrect)
+{
+	pwm_set_phase_correct(slice, phaseCorrect);
+}
+
+inline void hal_pwm_set_wrap(unsigned slice, uint16_t wrap)
+{
+	pwm_set_wrap(slice, wrap);
+}
+
+inline void hal_pwm_set_clkdiv_int_frac4(unsigned slice, uint8_t divInt, uint8_t divFrac)
+{
+	pwm_set_clkdiv_int_frac4(slice, divInt, divFrac);
+}
+
+inline void hal_pwm_set_chan_level(unsigned slice, unsigned chan, uint16_t level)
+{
+	pwm_set_chan_level(slice, chan, level);
+}
+
+inline void hal_pwm_set_enabled(unsigned slice, bool enabled)
+{
+	pwm_set_enabled(slice, enabled);
+}
+
+#endif
+
+#endif
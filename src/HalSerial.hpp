@@ -0,0 +1,67 @@
+#ifndef HAL_SERIAL_H
+#define HAL_SERIAL_H
+
+#include <stdint.h>
+
+// Hardware abstraction of the USB CDC serial port, for binary data that must not block.
+// On the Pico these are inline wrappers around TinyUSB, which stdio USB is already built on. When PICO_BOOST_HOST is
+// defined they are implemented by a simulated back end instead (see host/SimHal.cpp), which can be attached to a file
+// descriptor such as a pseudo-terminal.
+// Text from printf goes through stdio to the same port. Anything binary written here must be framed so a reader can
+// tell the two apart.
+
+#ifdef PICO_BOOST_HOST
+
+/** Get whether a host has the port open. ie DTR is asserted. */
+bool hal_serial_connected();
+
+/** Get the number of bytes that can be written without blocking. */
+unsigned hal_serial_write_available();
+
+/**
+ * Write bytes without blocking.
+ * @returns Number of bytes written. Less than len if there wasn't room for all of them.
+ */
+unsigned hal_serial_write(const uint8_t* data, unsigned len);
+
+/** Send anything written so far, rather than waiting for a full USB packet. */
+void hal_serial_flush();
+
+/**
+ * Read bytes without blocking.
+ * @returns Number of bytes read. 0 if none are waiting.
+ */
+unsigned hal_serial_read(uint8_t* data, unsigned maxLen);
+
+#else
+
+#include "tusb.h"
+
+inline bool hal_serial_connected()
+{
+	return tud_cdc_connected();
+}
+
+inline unsigned hal_serial_write_available()
+{
+	return tud_cdc_write_available();
+}
+
+inline unsigned hal_serial_write(const uint8_t* data, unsigned len)
+{
+	return tud_cdc_write(data, len);
+}
+
+inline void hal_serial_flush()
+{
+	tud_cdc_write_flush();
+}
+
+inline unsigned hal_serial_read(uint8_t* data, unsigned maxLen)
+{
+	return tud_cdc_available() ? tud_cdc_read(data, maxLen) : 0;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef HAL_SYNC_H
+#define HAL_SYNC_H
+
+#include <stdint.h>
+
+// Hardware abstraction of interrupt masking, for state shared between an interrupt and the code it interrupts on the
+// same core.
+// On the Pico these are inline wrappers around the SDK. When PICO_BOOST_HOST is defined they are implemented by a
+// simulated back end instead (see host/SimHal.cpp). The simulation has no interrupts, so they do nothing there.
+
+#ifdef PICO_BOOST_HOST
+
+/**
+ * Mask interrupts on the calling core.
+ * @returns The previous interrupt state, to pass to hal_restore_interrupts().
+ */
+uint32_t hal_save_and_disable_interrupts();
+
+/** Restore interrupts on the calling core to the state they were in before hal_save_and_disable_interrupts(). */
+void hal_restore_interrupts(uint32_t state);
+
+#else
+
+#include "hardware/sync.h"
+
+inline uint32_t hal_save_and_disable_interrupts()
+{
+	return save_and_disable_interrupts();
+}
+
+inline void hal_restore_interrupts(uint32_t state)
+{
+	restore_interrupts(state);
+}
+
+#endif
+
+#endif
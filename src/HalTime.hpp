@@ -0,0 +1,92 @@
+#ifndef HAL_TIME_H
+#define HAL_TIME_H
+
+#include <stdint.h>
+
+// Hardware abstraction of time and the system clock.
+// On the Pico these are inline wrappers around the SDK, so they cost nothing. When PICO_BOOST_HOST is defined they are
+// implemented by a simulated back end instead (see host/SimHal.cpp), where time only moves when it is slept or advanced.
+
+/** Absolute time, in microseconds since boot. */
+typedef uint64_t hal_time_t;
+
+#ifdef PICO_BOOST_HOST
+
+/** Get the time since boot, in microseconds. Wraps after about 71 minutes. */
+uint32_t hal_time_us_32();
+
+/** Get the time since boot, in microseconds. */
+uint64_t hal_time_us_64();
+
+/** Sleep for at least the given number of microseconds. */
+void hal_sleep_us(uint64_t us);
+
+/** Busy wait for at least the given number of system clock cycles. */
+void hal_busy_wait_cycles(uint32_t cycles);
+
+/** Get the system clock frequency, in hz. */
+uint32_t hal_clock_sys_hz();
+
+#else
+
+#include "hardware/clocks.h"
+#include "pico/time.h"
+
+inline uint32_t hal_time_us_32()
+{
+	return time_us_32();
+}
+
+inline uint64_t hal_time_us_64()
+{
+	return time_us_64();
+}
+
+inline void hal_sleep_us(uint64_t us)
+{
+	sleep_us(us);
+}
+
+inline void hal_busy_wait_cycles(uint32_t cycles)
+{
+	busy_wait_at_least_cycles(cycles);
+}
+
+inline uint32_t hal_clock_sys_hz()
+{
+	return clock_get_hz(clk_sys);
+}
+
+#endif
+
+/** Sleep for at least the given number of milliseconds. */
+inline void hal_sleep_ms(uint32_t ms)
+{
+	hal_sleep_us((uint64_t)ms * 1000);
+}
+
+/** Get the current absolute time. */
+inline hal_time_t hal_get_absolute_time()
+{
+	return hal_time_us_64();
+}
+
+/** Get the difference, in microseconds, from one absolute time to another. Negative if to is before from. */
+inline int64_t hal_absolute_time_diff_us(hal_time_t from, hal_time_t to)
+{
+	return (int64_t)(to - from);
+}
+
+/** Get an absolute time a number of microseconds after another. */
+inline hal_time_t hal_delayed_by_us(hal_time_t time, uint64_t us)
+{
+	return time + us;
+}
+
+/** Get an absolute time a number of milliseconds after another. */
+inline hal_time_t hal_delayed_by_ms(hal_time_t time, uint32_t ms)
+{
+	return time + (uint64_t)ms * 1000;
+}
+
+#endif
@@ -0,0 +1,59 @@
+#include "MedianAdcFilter.hpp"
+
+MedianAdcFilter::~MedianAdcFilter()
+{
+	delete[] _values;
+	delete[] _sorted;
+}
+
+MedianAdcFilter::MedianAdcFilter(unsigned length) : _length(length)
+{
+	if(_length == 0) _length = 1;
+	if(_length > MEDIAN_ADC_FILTER_MAX_LENGTH) _length = MEDIAN_ADC_FILTER_MAX_LENGTH;
+
+	_values = new uint32_t[_length];
+	_sorted = new uint32_t[_length];
+
+	for(unsigned index = 0; index < _length; index++)
+	{
+		_values[index] = 0;
+		_sorted[index] = 0;
+	}
+}
+
+void MedianAdcFilter::push(uint32_t value)
+{
+	uint32_t oldest = _values[_curPosn];
+
+	_values[_curPosn] = value;
+
+	_curPosn++;
+
+	if(_curPosn >= _length) _curPosn = 0;
+
+	// Find the oldest value in the sorted window. It must be there.
+	unsigned posn = 0;
+
+	while(posn < _length - 1 && _sorted[posn] != oldest) posn++;
+
+	// Replace it with the new value and move the new value to its sorted position. Only one of these loops will run.
+
+	while(posn > 0 && _sorted[posn - 1] > value)
+	{
+		_sorted[posn] = _sorted[posn - 1];
+		posn--;
+	}
+
+	while(posn < _length - 1 && _sorted[posn + 1] < value)
+	{
+		_sorted[posn] = _sorted[posn + 1];
+		posn++;
+	}
+
+	_sorted[posn] = value;
+}
+
+uint32_t MedianAdcFilter::output()
+{
+	return _sorted[_length / 2];
+}
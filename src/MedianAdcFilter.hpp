@@ -0,0 +1,48 @@
+#ifndef MEDIAN_ADC_FILTER_H
+#define MEDIAN_ADC_FILTER_H
+
+#include <stdint.h>
+
+#include "AdcFilter.hpp"
+
+/** Maximum length of a median filter. */
+#define MEDIAN_ADC_FILTER_MAX_LENGTH 31
+
+/**
+ * Median of the last N values. Good at rejecting single sample spikes.
+ * A sorted copy of the window is kept up to date as values are pushed, so the output is always O(1).
+ */
+class MedianAdcFilter : public AdcFilter
+{
+	public:
+
+		virtual ~MedianAdcFilter();
+
+		/**
+		 * @param length The number of values to take the median of. Clamped to MEDIAN_ADC_FILTER_MAX_LENGTH. Odd lengths
+		 *        give a true median.
+		 */
+		MedianAdcFilter(unsigned length);
+
+		// Impl.
+		void push(uint32_t value);
+
+		// Impl.
+		uint32_t output();
+
+	private:
+
+		/** Number of values in the window. */
+		unsigned _length;
+
+		/** Window of values in the order they were pushed. */
+		uint32_t* _values;
+
+		/** Window of values in ascending order. */
+		uint32_t* _sorted;
+
+		/** The current position that values are written into. */
+		unsigned _curPosn = 0;
+};
+
+#endif
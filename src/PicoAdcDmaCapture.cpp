@@ -0,0 +1,167 @@
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+
+#include "PicoAdcDmaCapture.hpp"
+
+/** ADC clock frequency. The ADC always runs from the 48MHz USB PLL. */
+#define PICO_ADC_CLOCK_HZ 48000000
+
+/** Number of ADC clock cycles per conversion. */
+#define PICO_ADC_CYCLES_PER_CONVERSION 96
+
+/**
+ * Ring buffer the ADC samples are written into. The DMA ring wrap requires it to be aligned to its size.
+ * Static because there is only one ADC.
+ */
+static volatile uint16_t __adcRingBuffer[(1 << PICO_ADC_DMA_MAX_RING_BITS) / 2]
+	__attribute__((aligned(1 << PICO_ADC_DMA_MAX_RING_BITS)));
+
+/** Transfer count the control DMA channel writes back into the data channel. Must stay in memory for DMA to read. */
+static uint32_t __adcDataTransferCount = 0xFFFFFFFF;
+
+PicoAdcDmaCapture::~PicoAdcDmaCapture()
+{
+	stop();
+
+	if(_ctrlDmaChan > -1) dma_channel_unclaim(_ctrlDmaChan);
+	if(_dataDmaChan > -1) dma_channel_unclaim(_dataDmaChan);
+}
+
+PicoAdcDmaCapture::PicoAdcDmaCapture(uint8_t channelMask, unsigned sampleRate, unsigned ringBits) :
+	_channelMask(channelMask & 0x1F), _sampleRate(sampleRate), _ringBits(ringBits)
+{
+	if(_ringBits > PICO_ADC_DMA_MAX_RING_BITS) _ringBits = PICO_ADC_DMA_MAX_RING_BITS;
+
+	for(unsigned index = 0; index < 5; index++)
+	{
+		if(_channelMask & (1 << index))
+		{
+			// Inputs 0 to 2 are GPIO 26 to 28. This should make the GPIO high-impedance.
+			if(index < 3) adc_gpio_init(index + 26);
+
+			_channelCount++;
+		}
+	}
+
+	_dataDmaChan = dma_claim_unused_channel(true);
+	_ctrlDmaChan = dma_claim_unused_channel(true);
+}
+
+void PicoAdcDmaCapture::start()
+{
+	if(_running || _channelCount == 0) return;
+
+	// Start the round robin from the lowest channel so samples are in ascending channel order.
+	for(unsigned index = 0; index < 5; index++)
+	{
+		if(_channelMask & (1 << index))
+		{
+			adc_select_input(index);
+			break;
+		}
+	}
+
+	adc_set_round_robin(_channelMask);
+
+	// Enable FIFO with DREQ asserted as soon as there is a single sample. No error bit and no byte shift.
+	adc_fifo_setup(true, true, 1, false, false);
+
+	// A conversion happens every (1 + div) ADC clock cycles, but can't be any faster than a conversion takes.
+	float clkDiv = (float)PICO_ADC_CLOCK_HZ / (_sampleRate > 0 ? _sampleRate : 1) - 1;
+	if(clkDiv < PICO_ADC_CYCLES_PER_CONVERSION - 1) clkDiv = 0;
+
+	adc_set_clkdiv(clkDiv);
+
+	// Data channel: ADC FIFO -> ring buffer, paced by the ADC DREQ.
+
+	dma_channel_config dataConfig = dma_channel_get_default_config(_dataDmaChan);
+
+	channel_config_set_transfer_data_size(&dataConfig, DMA_SIZE_16);
+	channel_config_set_read_increment(&dataConfig, false);
+	channel_config_set_write_increment(&dataConfig, true);
+	channel_config_set_ring(&dataConfig, true, _ringBits);
+	channel_config_set_dreq(&dataConfig, DREQ_ADC);
+	channel_config_set_chain_to(&dataConfig, _ctrlDmaChan);
+
+	dma_channel_configure(_dataDmaChan, &dataConfig, __adcRingBuffer, &adc_hw -> fifo, __adcDataTransferCount, false);
+
+	// Control channel: Re-trigger the data channel with a full transfer count. The write address carries on from where it
+	// was, inside the ring.
+
+	dma_channel_config ctrlConfig = dma_channel_get_default_config(_ctrlDmaChan);
+
+	channel_config_set_transfer_data_size(&ctrlConfig, DMA_SIZE_32);
+	channel_config_set_read_increment(&ctrlConfig, false);
+	channel_config_set_write_increment(&ctrlConfig, false);
+
+	dma_channel_configure(_ctrlDmaChan, &ctrlConfig, &dma_hw -> ch[_dataDmaChan].al1_transfer_count_trig,
+		&__adcDataTransferCount, 1, false);
+
+	dma_channel_start(_dataDmaChan);
+
+	adc_run(true);
+
+	_running = true;
+}
+
+void PicoAdcDmaCapture::stop()
+{
+	if(!_running) return;
+
+	adc_run(false);
+
+	dma_channel_abort(_ctrlDmaChan);
+	dma_channel_abort(_dataDmaChan);
+
+	adc_fifo_setup(false, false, 0, false, false);
+	adc_fifo_drain();
+	adc_set_round_robin(0);
+
+	_running = false;
+}
+
+bool PicoAdcDmaCapture::isRunning()
+{
+	return _running;
+}
+
+const volatile uint16_t* PicoAdcDmaCapture::getBuffer()
+{
+	return __adcRingBuffer;
+}
+
+unsigned PicoAdcDmaCapture::getBufferSampleCount()
+{
+	return (1 << _ringBits) / 2;
+}
+
+unsigned PicoAdcDmaCapture::getWriteIndex()
+{
+	uint32_t writeAddr = dma_hw -> ch[_dataDmaChan].write_addr;
+
+	return ((writeAddr - (uint32_t)(uintptr_t)__adcRingBuffer) / 2) & (getBufferSampleCount() - 1);
+}
+
+unsigned PicoAdcDmaCapture::getChannelCount()
+{
+	return _channelCount;
+}
+
+int PicoAdcDmaCapture::getChannelSlot(unsigned adcInput)
+{
+	if(adcInput > 4 || !(_channelMask & (1 << adcInput))) return -1;
+
+	int slot = 0;
+
+	for(unsigned index = 0; index < adcInput; index++)
+	{
+		if(_channelMask & (1 << index)) slot++;
+	}
+
+	return slot;
+}
+
+unsigned PicoAdcDmaCapture::getChannelSampleRate()
+{
+	return _channelCount ? _sampleRate / _channelCount : 0;
+}
@@ -0,0 +1,87 @@
+#ifndef PICO_ADC_DMA_CAPTURE_H
+#define PICO_ADC_DMA_CAPTURE_H
+
+#include <stdint.h>
+
+/** Maximum log2 of the ring buffer size, in bytes. ie 4096 bytes, 2048 samples. */
+#define PICO_ADC_DMA_MAX_RING_BITS 12
+
+/**
+ * Free running capture of the Pi Pico ADC into a ring buffer.
+ * The ADC converts the channels in its round robin mask back to back at a fixed rate and pushes each result into its FIFO.
+ * A DMA channel moves the FIFO into the ring buffer and a second DMA channel re-arms the first when its transfer count
+ * runs out, so no CPU time is spent per sample.
+ * Samples are interleaved in ascending channel order. ie With channels 0 and 3: 0, 3, 0, 3, ...
+ * @note There is only one ADC so there should only ever be one instance of this.
+ * @note The number of channels must be a power of two (1, 2 or 4) so that channel interleaving survives the ring wrap.
+ * @note adc_init() must have been called first. The ADC can't be used for one-shot reads while capture is running.
+ */
+class PicoAdcDmaCapture
+{
+	public:
+
+		virtual ~PicoAdcDmaCapture();
+
+		/**
+		 * @param channelMask Bit mask of ADC inputs to capture. eg (1 << 0) | (1 << 3) for inputs 0 and 3.
+		 * @param sampleRate Total ADC conversions per second, shared between all channels. Max 500000.
+		 * @param ringBits log2 of the ring buffer size in bytes. Clamped to PICO_ADC_DMA_MAX_RING_BITS.
+		 */
+		PicoAdcDmaCapture(uint8_t channelMask, unsigned sampleRate, unsigned ringBits);
+
+		/** Start capturing. */
+		void start();
+
+		/** Stop capturing. */
+		void stop();
+
+		/** Get whether capture is running. */
+		bool isRunning();
+
+		/** Get the ring buffer of samples. */
+		const volatile uint16_t* getBuffer();
+
+		/** Get the number of samples the ring buffer holds. Always a power of two. */
+		unsigned getBufferSampleCount();
+
+		/** Get the index, into the ring buffer, of the next sample that will be written. */
+		unsigned getWriteIndex();
+
+		/** Get the number of channels being captured. */
+		unsigned getChannelCount();
+
+		/**
+		 * Get the position of a channel in the interleaved sample sequence.
+		 * @param adcInput ADC input number.
+		 * @returns Slot position, or -1 if the input isn't being captured.
+		 */
+		int getChannelSlot(unsigned adcInput);
+
+		/** Get the per channel sample rate, in hz. */
+		unsigned getChannelSampleRate();
+
+	private:
+
+		/** Bit mask of ADC inputs captured. */
+		uint8_t _channelMask;
+
+		/** Number of channels captured. */
+		unsigned _channelCount = 0;
+
+		/** Total ADC conversions per second. */
+		unsigned _sampleRate;
+
+		/** log2 of the ring buffer size in bytes. */
+		unsigned _ringBits;
+
+		/** DMA channel that moves ADC FIFO data into the ring buffer. */
+		int _dataDmaChan = -1;
+
+		/** DMA channel that re-arms the data channel when its transfer count is exhausted. */
+		int _ctrlDmaChan = -1;
+
+		/** Whether capture is running. */
+		bool _running = false;
+};
+
+#endif
@@ -1,5 +1,4 @@
-#include "hardware/adc.h"
-
+#include "HalAdc.hpp"
 #include "PicoAdcReader.hpp"
 
 PicoAdcReader::~PicoAdcReader()
@@ -12,11 +11,11 @@ PicoAdcReader::PicoAdcReader(unsigned adcInput, unsigned avgCount, double vRef,
 	unsigned gpioPin = adcInput + 26;
 
 	// This should make the GPIO high-impedance.
-    adc_gpio_init(gpioPin);
+    hal_adc_gpio_init(gpioPin);
 }
 
 uint32_t PicoAdcReader::_readFromAdc(unsigned adcInput)
 {
-	adc_select_input(adcInput);
-	return adc_read();
+	hal_adc_select_input(adcInput);
+	return hal_adc_read();
 }
@@ -0,0 +1,56 @@
+#include "PicoDmaAdcReader.hpp"
+
+PicoDmaAdcReader::~PicoDmaAdcReader()
+{
+}
+
+PicoDmaAdcReader::PicoDmaAdcReader(PicoAdcDmaCapture* capture, unsigned adcInput, unsigned avgCount, double vRef,
+	double scale) : AdcReader(adcInput, avgCount, vRef, 12 + PICO_DMA_ADC_OVERSAMPLE_BITS, scale), _capture(capture)
+{
+	_readIndex = _capture -> getWriteIndex();
+}
+
+unsigned PicoDmaAdcReader::getLastSampleCount()
+{
+	return _lastSampleCount;
+}
+
+uint32_t PicoDmaAdcReader::_readFromAdc(unsigned adcInput)
+{
+	int slot = _capture -> getChannelSlot(adcInput);
+
+	if(slot < 0) return 0;
+
+	const volatile uint16_t* buffer = _capture -> getBuffer();
+
+	unsigned ringMask = _capture -> getBufferSampleCount() - 1;
+	unsigned channelCount = _capture -> getChannelCount();
+
+	unsigned writeIndex = _capture -> getWriteIndex();
+
+	// Number of samples, of all channels, written since the last read.
+	unsigned available = (writeIndex - _readIndex) & ringMask;
+
+	// Skip forward to the first sample belonging to this input.
+	unsigned offset = (slot - (_readIndex & (channelCount - 1))) & (channelCount - 1);
+
+	uint32_t sum = 0;
+	unsigned count = 0;
+
+	for(unsigned index = offset; index < available; index += channelCount)
+	{
+		sum += buffer[(_readIndex + index) & ringMask] & 0xFFF;
+		count++;
+	}
+
+	_readIndex = writeIndex;
+
+	_lastSampleCount = count;
+
+	// No new samples. Keep returning the last value rather than a bogus zero.
+	if(count == 0) return _lastValue;
+
+	_lastValue = (sum << PICO_DMA_ADC_OVERSAMPLE_BITS) / count;
+
+	return _lastValue;
+}
@@ -0,0 +1,60 @@
+#ifndef PICO_DMA_ADC_READER_H
+#define PICO_DMA_ADC_READER_H
+
+#include <stdint.h>
+
+#include "AdcReader.hpp"
+#include "PicoAdcDmaCapture.hpp"
+
+/**
+ * Number of extra bits of resolution reported by the DMA ADC reader. Each latch averages many samples, so the result
+ * has more resolution than a single 12 bit conversion.
+ */
+#define PICO_DMA_ADC_OVERSAMPLE_BITS 4
+
+/**
+ * On board Pi Pico ADC reader that consumes samples captured by DMA.
+ * Each latch averages every sample of the input captured since the previous latch. So, unlike PicoAdcReader, nothing
+ * waits on the ADC.
+ */
+class PicoDmaAdcReader : public AdcReader
+{
+	public:
+
+		virtual ~PicoDmaAdcReader();
+
+		/**
+		 * @param capture The DMA capture to consume samples from. Must be capturing adcInput, and already started, as
+		 *        samples are consumed from its position now. Not owned by this.
+		 * @param adcInput ADC input number.
+		 * @param avgCount The number of latched values to average the result over.
+		 * @param vRef Voltage reference to ADC.
+		 * @param scale Scale the read voltage by this amount to get the final voltage.
+		 *        Supports voltage divided input to the ADC.
+		 */
+		PicoDmaAdcReader(PicoAdcDmaCapture* capture, unsigned adcInput, unsigned avgCount, double vRef, double scale);
+
+		/** Get the number of samples averaged by the last latch. */
+		unsigned getLastSampleCount();
+
+	protected:
+
+		// Impl.
+		uint32_t _readFromAdc(unsigned adcInput);
+
+	private:
+
+		/** Capture that samples are consumed from. */
+		PicoAdcDmaCapture* _capture;
+
+		/** Ring buffer index up to which samples have been consumed. */
+		unsigned _readIndex = 0;
+
+		/** The last value returned. Used again if no new samples have been captured. */
+		uint32_t _lastValue = 0;
+
+		/** Number of samples averaged by the last latch. */
+		unsigned _lastSampleCount = 0;
+};
+
+#endif
@@ -1,8 +1,8 @@
 #include "math.h"
 
-#include "hardware/clocks.h"
-#include "hardware/gpio.h"
-#include "hardware/pwm.h"
+#include "HalGpio.hpp"
+#include "HalPwm.hpp"
+#include "HalTime.hpp"
 
 #include "PicoPwm.hpp"
 
@@ -13,19 +13,19 @@ PicoPwm::~PicoPwm()
 PicoPwm::PicoPwm(int chanAGpio, int chanBGpio, float initFreq, float initDutyCycleA, float initDutyCycleB, bool phaseCorrect,
 	bool initDisableState) : _chanAGpio(chanAGpio), _chanBGpio(chanBGpio)
 {
-	_curDutyA = 0.0;
-	_curDutyB = 0.0;
+	_curDutyA = 0;
+	_curDutyB = 0;
 
-	if(chanAGpio > -1) gpio_set_function(chanAGpio, GPIO_FUNC_PWM);
-    if(chanBGpio > -1) gpio_set_function(chanBGpio, GPIO_FUNC_PWM);
+	if(chanAGpio > -1) hal_gpio_set_function(chanAGpio, HAL_GPIO_FUNC_PWM);
+    if(chanBGpio > -1) hal_gpio_set_function(chanBGpio, HAL_GPIO_FUNC_PWM);
 
 	if(chanAGpio > -1)
 	{
-		_sliceNumber = pwm_gpio_to_slice_num(chanAGpio);
+		_sliceNumber = hal_pwm_gpio_to_slice_num(chanAGpio);
 	}
 	else if(chanBGpio > -1)
 	{
-		_sliceNumber = pwm_gpio_to_slice_num(chanBGpio);
+		_sliceNumber = hal_pwm_gpio_to_slice_num(chanBGpio);
 	}
 	else
 	{
@@ -34,11 +34,11 @@ PicoPwm::PicoPwm(int chanAGpio, int chanBGpio, float initFreq, float initDutyCyc
 
 	_phaseCorrect = phaseCorrect ? 1 : 0;
 
-	if(_sliceNumber > -1) pwm_set_phase_correct(_sliceNumber, phaseCorrect);
+	if(_sliceNumber > -1) hal_pwm_set_phase_correct(_sliceNumber, phaseCorrect);
 
 	__setFreq(initFreq);
 
-	__setDuty(initDutyCycleA, initDutyCycleB);
+	setDuty(initDutyCycleA, initDutyCycleB);
 
 	__disable(initDisableState);
 }
@@ -55,10 +55,10 @@ void PicoPwm::enable()
 
 void PicoPwm::__enable()
 {
-	if(_chanAGpio > -1) gpio_set_outover(_chanAGpio, GPIO_OVERRIDE_NORMAL);
-	if(_chanBGpio > -1) gpio_set_outover(_chanBGpio, GPIO_OVERRIDE_NORMAL);
+	if(_chanAGpio > -1) hal_gpio_set_outover(_chanAGpio, HAL_GPIO_OVERRIDE_NORMAL);
+	if(_chanBGpio > -1) hal_gpio_set_outover(_chanBGpio, HAL_GPIO_OVERRIDE_NORMAL);
 
-	if(_sliceNumber > -1) pwm_set_enabled(_sliceNumber, true);
+	if(_sliceNumber > -1) hal_pwm_set_enabled(_sliceNumber, true);
 
 	_enabled = true;
 }
@@ -70,10 +70,10 @@ void PicoPwm::disable(bool setHigh)
 
 void PicoPwm::__disable(bool setHigh)
 {
-	if(_sliceNumber > -1) pwm_set_enabled(_sliceNumber, false);
+	if(_sliceNumber > -1) hal_pwm_set_enabled(_sliceNumber, false);
 
-	if(_chanAGpio > -1) gpio_set_outover(_chanAGpio, setHigh ? GPIO_OVERRIDE_HIGH : GPIO_OVERRIDE_LOW);
-	if(_chanBGpio > -1) gpio_set_outover(_chanBGpio, setHigh ? GPIO_OVERRIDE_HIGH : GPIO_OVERRIDE_LOW);
+	if(_chanAGpio > -1) hal_gpio_set_outover(_chanAGpio, setHigh ? HAL_GPIO_OVERRIDE_HIGH : HAL_GPIO_OVERRIDE_LOW);
+	if(_chanBGpio > -1) hal_gpio_set_outover(_chanBGpio, setHigh ? HAL_GPIO_OVERRIDE_HIGH : HAL_GPIO_OVERRIDE_LOW);
 
 	_enabled = false;
 }
@@ -87,7 +87,7 @@ void PicoPwm::__setFreq(float freq)
 {
 	if(_sliceNumber == -1) return;
 
-	uint32_t f_sys = clock_get_hz(clk_sys);
+	uint32_t f_sys = hal_clock_sys_hz();
 
 	float f_ratio = (float) f_sys / freq;
 
@@ -100,7 +100,10 @@ void PicoPwm::__setFreq(float freq)
 	if(counterWrap > 0xFFF0) counterWrap = 0xFFF0;
 
 	_counterWrap = counterWrap;
-	pwm_set_wrap(_sliceNumber, counterWrap);
+	hal_pwm_set_wrap(_sliceNumber, counterWrap);
+
+	// Note: For channel level (CC) to be at 100% duty cycle it must be set to wrap + 1 (TOP +1)
+	_levelPerDutyPercent = (((uint32_t)counterWrap + 1) << PICO_PWM_DUTY_FRAC_BITS) / 100;
 
 	// Full precision divider value.
 	float divInt_divFrac = f_ratio / ((counterWrap + 1.0) * (_phaseCorrect + 1.0));
@@ -116,40 +119,67 @@ void PicoPwm::__setFreq(float freq)
 	uint8_t divFrac = 16.0 * fracPart;
 
 	// This together with the previously calculated wrap value should approximate the required frequency.
-	pwm_set_clkdiv_int_frac4(_sliceNumber, divInt, divFrac);
+	hal_pwm_set_clkdiv_int_frac4(_sliceNumber, divInt, divFrac);
 }
 
 float PicoPwm::getDutyA()
 {
-	return _curDutyA;
+	return _curDutyA / (float)(1 << PICO_PWM_DUTY_FRAC_BITS);
 }
 
 float PicoPwm::getDutyB()
+{
+	return _curDutyB / (float)(1 << PICO_PWM_DUTY_FRAC_BITS);
+}
+
+int32_t PicoPwm::getDutyAFixed()
+{
+	return _curDutyA;
+}
+
+int32_t PicoPwm::getDutyBFixed()
 {
 	return _curDutyB;
 }
 
 void PicoPwm::setDuty(float dutyA, float dutyB)
+{
+	// Negative values still mean "Don't set" after conversion.
+	int32_t dutyAFixed = dutyA < 0 ? -1 : dutyA * (1 << PICO_PWM_DUTY_FRAC_BITS);
+	int32_t dutyBFixed = dutyB < 0 ? -1 : dutyB * (1 << PICO_PWM_DUTY_FRAC_BITS);
+
+	__setDuty(dutyAFixed, dutyBFixed);
+}
+
+void PicoPwm::setDutyFixed(int32_t dutyA, int32_t dutyB)
 {
 	__setDuty(dutyA, dutyB);
 }
 
-void PicoPwm::__setDuty(float dutyA, float dutyB)
+void PicoPwm::__setDuty(int32_t dutyA, int32_t dutyB)
 {
 	if(_sliceNumber > -1)
 	{
-		// Note: For channel level (CC) to be at 100% duty cycle it must be set to wrap + 1 (TOP +1)
-
 		if(dutyA >= 0)
 		{
-			pwm_set_chan_level(_sliceNumber, PWM_CHAN_A, (_counterWrap + 1) * (dutyA / 100.0));
+			hal_pwm_set_chan_level(_sliceNumber, HAL_PWM_CHAN_A, __dutyToLevel(dutyA));
 			_curDutyA = dutyA;
 		}
 
 		if(dutyB >= 0)
 		{
-			pwm_set_chan_level(_sliceNumber, PWM_CHAN_B, (_counterWrap + 1) * (dutyB / 100.0));
+			hal_pwm_set_chan_level(_sliceNumber, HAL_PWM_CHAN_B, __dutyToLevel(dutyB));
 			_curDutyB = dutyB;
 		}
 	}
 }
+
+uint16_t PicoPwm::__dutyToLevel(int32_t duty)
+{
+	uint32_t level = ((uint64_t)duty * _levelPerDutyPercent) >> (2 * PICO_PWM_DUTY_FRAC_BITS);
+
+	// Note: For channel level (CC) to be at 100% duty cycle it must be set to wrap + 1 (TOP +1)
+	if(level > (uint32_t)_counterWrap + 1) level = (uint32_t)_counterWrap + 1;
+
+	return level;
+}
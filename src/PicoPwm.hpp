@@ -3,6 +3,9 @@
 
 #include <stdint.h>
 
+/** Number of fractional bits of fixed point duty cycles. ie Fixed point duty cycles are in Q16.16 format. */
+#define PICO_PWM_DUTY_FRAC_BITS 16
+
 /**
  * Encapsulates the standard Pico PWM for a single slice only.
  * See the RP2040 datasheet for slice GPIO mappings.
@@ -56,6 +59,18 @@ class PicoPwm
 		 */
 		float getDutyB();
 
+		/**
+		 * Get the current duty cycle for channel A.
+		 * @returns Duty cycle, in %, as a Q16.16 fixed point number.
+		 */
+		int32_t getDutyAFixed();
+
+		/**
+		 * Get the current duty cycle for channel B.
+		 * @returns Duty cycle, in %, as a Q16.16 fixed point number.
+		 */
+		int32_t getDutyBFixed();
+
 		/**
 		 * Set the duty cycle for one or both channels of the slice.
 		 * @param dutyA Percentage duty cycle for channel A. A negative value means "Don't set".
@@ -63,6 +78,13 @@ class PicoPwm
 		 */
 		void setDuty(float dutyA, float dutyB);
 
+		/**
+		 * Set the duty cycle for one or both channels of the slice without using any floating point maths.
+		 * @param dutyA Percentage duty cycle for channel A, Q16.16 fixed point. A negative value means "Don't set".
+		 * @param dutyB Percentage duty cycle for channel B, Q16.16 fixed point. A negative value means "Don't set".
+		 */
+		void setDutyFixed(int32_t dutyA, int32_t dutyB);
+
 	private:
 
 		/** Enable PWM. */
@@ -85,7 +107,13 @@ class PicoPwm
 		 * @param dutyA Duty cycle for channel A, in %. A negative value means "Don't set".
 		 * @param dutyB Duty cycle for channel B, in %. A negative value means "Don't set".
 		 */
-		void __setDuty(float dutyA, float dutyB);
+		void __setDuty(int32_t dutyA, int32_t dutyB);
+
+		/**
+		 * Convert a fixed point duty cycle to a channel level.
+		 * @param duty Duty cycle, in %, Q16.16 fixed point.
+		 */
+		uint16_t __dutyToLevel(int32_t duty);
 
 		/** Whether PWM is currently enabled. */
 		bool _enabled = false;
@@ -109,11 +137,17 @@ class PicoPwm
 		/** Whether phase correct is being used. 0 for false, 1 for true. */
 		uint8_t _phaseCorrect;
 
-		/** The current duty cycle for channel A. */
-		float _curDutyA;
+		/**
+		 * Channel level (CC) per 1% of duty cycle, Q16.16 fixed point.
+		 * Allows a duty cycle to be converted to a level with a single multiply.
+		 */
+		uint32_t _levelPerDutyPercent = 0;
+
+		/** The current duty cycle for channel A. In %, Q16.16 fixed point. */
+		int32_t _curDutyA;
 
-		/** The current duty cycle for channel B. */
-		float _curDutyB;
+		/** The current duty cycle for channel B. In %, Q16.16 fixed point. */
+		int32_t _curDutyB;
 };
 
 #endif
\ No newline at end of file
@@ -1,23 +1,22 @@
-#include "hardware/gpio.h"
-
+#include "HalGpio.hpp"
 #include "PicoSwitch.hpp"
 
 PicoSwitch::~PicoSwitch()
 {
-	gpio_deinit(_gpio);
+	hal_gpio_deinit(_gpio);
 }
 
 PicoSwitch::PicoSwitch(unsigned gpio, PullUpDown pullUpDown, unsigned activeCountThreshold, unsigned sampleDuration) :
 	_gpio(gpio), _pullUpDown(pullUpDown), _activeCountThreshold(activeCountThreshold), _sampleDuration(sampleDuration)
 {
-	gpio_init(gpio);
-	gpio_set_dir(gpio, GPIO_IN);
+	hal_gpio_init(gpio);
+	hal_gpio_set_dir(gpio, HAL_GPIO_IN);
 
 	switch(pullUpDown)
 	{
 		case PULL_UP:
 
-			gpio_pull_up(gpio);
+			hal_gpio_pull_up(gpio);
 			// Because there is a delay in counting the active state, if this is not done then the switch state will be
 			// initially incorrect.
 			_activeCount = _activeCountThreshold;
@@ -25,22 +24,22 @@ PicoSwitch::PicoSwitch(unsigned gpio, PullUpDown pullUpDown, unsigned activeCoun
 
 		case PULL_DOWN:
 
-			gpio_pull_down(gpio);
+			hal_gpio_pull_down(gpio);
 			break;
 	}
 
-	_lastSampleTime = get_absolute_time();
+	_lastSampleTime = hal_get_absolute_time();
 }
 
 void PicoSwitch::poll()
 {
-	absolute_time_t curTime = get_absolute_time();
+	hal_time_t curTime = hal_get_absolute_time();
 
-	if(absolute_time_diff_us(_lastSampleTime, curTime) >= _sampleDuration)
+	if(hal_absolute_time_diff_us(_lastSampleTime, curTime) >= _sampleDuration)
 	{
 		_lastSampleTime = curTime;
 
-		bool switchState = gpio_get(_gpio);
+		bool switchState = hal_gpio_get(_gpio);
 
 		if(switchState)
 		{
@@ -75,7 +74,7 @@ void PicoSwitch::poll()
 			}
 			else
 			{
-				_lastPressDuration = absolute_time_diff_us(_curStateTime, curTime) / 1000;
+				_lastPressDuration = hal_absolute_time_diff_us(_curStateTime, curTime) / 1000;
 			}
 
 			_currentState = curState;
@@ -91,7 +90,7 @@ bool PicoSwitch::getSwitchState()
 
 unsigned PicoSwitch::getSwitchStateDuration()
 {
-	return absolute_time_diff_us(_curStateTime, get_absolute_time()) / 1000;
+	return hal_absolute_time_diff_us(_curStateTime, hal_get_absolute_time()) / 1000;
 }
 
 unsigned PicoSwitch::getCurrentStateCycleIndex()
@@ -3,7 +3,7 @@
 
 #include <stdint.h>
 
-#include "pico/time.h"
+#include "HalTime.hpp"
 
 /**
  * Generic switch.
@@ -75,13 +75,13 @@ class PicoSwitch
 		unsigned _sampleDuration = 0;
 
 		/** The time of the last sample. */
-		absolute_time_t _lastSampleTime;
+		hal_time_t _lastSampleTime;
 
 		/** Current switch state. True for pressed, false for not pressed (released). */
 		bool _currentState = false;
 
 		/** The time the current switch (pressed/released) state became definite. */
-		absolute_time_t _curStateTime;
+		hal_time_t _curStateTime;
 
 		/** Counter used to indicate a unique instance of the the start of the "leading edge" of a switch press. */
 		unsigned _stateCycleCounter = 0;
@@ -0,0 +1,203 @@
+#include "RelayAutoTuner.hpp"
+
+RelayAutoTuner::~RelayAutoTuner()
+{
+}
+
+RelayAutoTuner::RelayAutoTuner()
+{
+}
+
+void RelayAutoTuner::start(int32_t targetKpaScaled, uint32_t biasDutyScaled, uint32_t relayDutyScaled,
+	uint32_t maxDutyScaled, uint32_t timeUs)
+{
+	_state = IDLE;
+
+	_targetKpaScaled = targetKpaScaled;
+
+	if(biasDutyScaled > maxDutyScaled) biasDutyScaled = maxDutyScaled;
+
+	_highDutyScaled = biasDutyScaled + relayDutyScaled;
+	if(_highDutyScaled > maxDutyScaled) _highDutyScaled = maxDutyScaled;
+
+	_lowDutyScaled = biasDutyScaled > relayDutyScaled ? biasDutyScaled - relayDutyScaled : 0;
+
+	_relayAmplitudeScaled = (_highDutyScaled - _lowDutyScaled) / 2;
+
+	_startTimeUs = timeUs;
+	_cycleStarted = false;
+	_cycleCount = 0;
+
+	_heightSum = 0;
+	_heightCount = 0;
+	_periodSum = 0;
+	_periodCount = 0;
+
+	// Start high so the boost rises to the target.
+	_relayHigh = true;
+	_troughKpaScaled = targetKpaScaled;
+	_peakKpaScaled = targetKpaScaled;
+
+	_state = _relayAmplitudeScaled ? RUNNING : FAILED;
+}
+
+void RelayAutoTuner::stop()
+{
+	_state = IDLE;
+}
+
+void RelayAutoTuner::sample(int32_t kpaScaled, uint32_t timeUs)
+{
+	if(_state != RUNNING) return;
+
+	if(timeUs - _startTimeUs > AUTO_TUNE_TIMEOUT_US || kpaScaled > _targetKpaScaled + AUTO_TUNE_OVERBOOST_KPA_SCALED)
+	{
+		_state = FAILED;
+		return;
+	}
+
+	if(_relayHigh)
+	{
+		if(kpaScaled < _troughKpaScaled) _troughKpaScaled = kpaScaled;
+
+		if(kpaScaled > _targetKpaScaled + AUTO_TUNE_HYSTERESIS_KPA_SCALED) __switchRelay(false, timeUs);
+	}
+	else
+	{
+		if(kpaScaled > _peakKpaScaled) _peakKpaScaled = kpaScaled;
+
+		if(kpaScaled < _targetKpaScaled - AUTO_TUNE_HYSTERESIS_KPA_SCALED) __switchRelay(true, timeUs);
+	}
+}
+
+void RelayAutoTuner::__switchRelay(bool high, uint32_t timeUs)
+{
+	bool measuring = _cycleCount >= AUTO_TUNE_SETTLE_CYCLES;
+
+	if(high)
+	{
+		// End of the above target half cycle.
+		if(measuring && _cycleStarted)
+		{
+			_heightSum += _peakKpaScaled - _troughKpaScaled;
+			_heightCount++;
+		}
+
+		_troughKpaScaled = _targetKpaScaled;
+	}
+	else
+	{
+		// Rising through the target marks the start of a cycle.
+		if(_cycleStarted)
+		{
+			if(measuring)
+			{
+				_periodSum += timeUs - _cycleStartUs;
+				_periodCount++;
+			}
+
+			_cycleCount++;
+		}
+
+		_cycleStarted = true;
+		_cycleStartUs = timeUs;
+
+		_peakKpaScaled = _targetKpaScaled;
+	}
+
+	_relayHigh = high;
+
+	if(_periodCount >= AUTO_TUNE_MEASURE_CYCLES && _heightCount >= AUTO_TUNE_MEASURE_CYCLES) _state = COMPLETE;
+}
+
+RelayAutoTuner::State RelayAutoTuner::getState()
+{
+	return _state;
+}
+
+uint32_t RelayAutoTuner::getDutyScaled()
+{
+	return _relayHigh ? _highDutyScaled : _lowDutyScaled;
+}
+
+unsigned RelayAutoTuner::getProgress()
+{
+	if(_state == COMPLETE) return 100;
+
+	unsigned cycleCount = _cycleCount;
+
+	// Each cycle is reported as an equal share.
+	return (cycleCount * 100) / (AUTO_TUNE_SETTLE_CYCLES + AUTO_TUNE_MEASURE_CYCLES + 1);
+}
+
+void RelayAutoTuner::getResult(uint32_t controlStepPeriodUs, RelayAutoTuneResult* result)
+{
+	result -> success = false;
+	result -> ultimateGainScaled = 0;
+	result -> ultimatePeriodUs = 0;
+	result -> amplitudeKpaScaled = 0;
+	result -> pidPropConstScaled = 0;
+	result -> pidIntegConstScaled = 0;
+	result -> pidDerivConstScaled = 0;
+
+	if(_state != COMPLETE || !_heightCount || !_periodCount || !controlStepPeriodUs) return;
+
+	// Peak to mean.
+	uint64_t amplitude = _heightSum / (2 * _heightCount);
+
+	uint64_t hyst = AUTO_TUNE_HYSTERESIS_KPA_SCALED;
+
+	// The relay hysteresis makes the oscillation larger than it would be for an ideal relay, so correct for it.
+	uint64_t effAmplitude = amplitude > hyst ? __isqrt(amplitude * amplitude - hyst * hyst) : 0;
+
+	if(!effAmplitude) return;
+
+	// Ku = 4d / (pi * a). With d in % scaled by 10, a in kPa scaled by 1000 and Ku in %/kPa scaled by 1000:
+	//   Ku = 400000 * d / (pi * a). pi is approximated by 355 / 113.
+	uint64_t ultimateGain = ((uint64_t)400000 * 113 * _relayAmplitudeScaled) / (355 * effAmplitude);
+
+	uint64_t ultimatePeriodUs = _periodSum / _periodCount;
+
+	uint64_t propConst = (ultimateGain * AUTO_TUNE_KP_RATIO_SCALED) / 1000;
+	uint64_t integTimeUs = (ultimatePeriodUs * AUTO_TUNE_TI_RATIO_SCALED) / 1000;
+	uint64_t derivTimeUs = (ultimatePeriodUs * AUTO_TUNE_TD_RATIO_SCALED) / 1000;
+
+	if(!integTimeUs) return;
+
+	result -> success = true;
+	result -> ultimateGainScaled = ultimateGain;
+	result -> ultimatePeriodUs = ultimatePeriodUs;
+	result -> amplitudeKpaScaled = amplitude;
+	result -> pidPropConstScaled = propConst;
+
+	// Ki = Kp / Ti, with Ti in seconds.
+	result -> pidIntegConstScaled = (propConst * 1000000) / integTimeUs;
+
+	// The derivative term is applied to the change in error per step, rather than per second. So Kd = Kp * Td / dt.
+	result -> pidDerivConstScaled = (propConst * derivTimeUs) / controlStepPeriodUs;
+}
+
+uint64_t RelayAutoTuner::__isqrt(uint64_t val)
+{
+	uint64_t result = 0;
+	uint64_t bit = (uint64_t)1 << 62;
+
+	while(bit > val) bit >>= 2;
+
+	while(bit)
+	{
+		if(val >= result + bit)
+		{
+			val -= result + bit;
+			result = (result >> 1) + bit;
+		}
+		else
+		{
+			result >>= 1;
+		}
+
+		bit >>= 2;
+	}
+
+	return result;
+}
@@ -0,0 +1,204 @@
+#ifndef RELAY_AUTO_TUNER_H
+#define RELAY_AUTO_TUNER_H
+
+#include <stdint.h>
+
+/** Relay hysteresis either side of the target boost. Stops noise switching the relay. In kPa, scaled by 1000. */
+#ifndef AUTO_TUNE_HYSTERESIS_KPA_SCALED
+#define AUTO_TUNE_HYSTERESIS_KPA_SCALED 1000
+#endif
+
+/** Number of oscillation cycles to ignore while the oscillation settles. */
+#ifndef AUTO_TUNE_SETTLE_CYCLES
+#define AUTO_TUNE_SETTLE_CYCLES 2
+#endif
+
+/** Number of oscillation cycles that are measured and averaged. */
+#ifndef AUTO_TUNE_MEASURE_CYCLES
+#define AUTO_TUNE_MEASURE_CYCLES 4
+#endif
+
+/** Time the whole tune must complete within. In microseconds. */
+#ifndef AUTO_TUNE_TIMEOUT_US
+#define AUTO_TUNE_TIMEOUT_US 30000000
+#endif
+
+/** Boost above target at which the tune is abandoned. In kPa, scaled by 1000. */
+#ifndef AUTO_TUNE_OVERBOOST_KPA_SCALED
+#define AUTO_TUNE_OVERBOOST_KPA_SCALED 30000
+#endif
+
+// Tuning rule, as ratios of the ultimate gain and period. Scaled by 1000.
+// The defaults are the Ziegler-Nichols "no overshoot" rule, because overshoot is what damages engines.
+
+/** Proportional gain as a ratio of the ultimate gain. Scaled by 1000. */
+#ifndef AUTO_TUNE_KP_RATIO_SCALED
+#define AUTO_TUNE_KP_RATIO_SCALED 200
+#endif
+
+/** Integral time as a ratio of the ultimate period. Scaled by 1000. */
+#ifndef AUTO_TUNE_TI_RATIO_SCALED
+#define AUTO_TUNE_TI_RATIO_SCALED 500
+#endif
+
+/** Derivative time as a ratio of the ultimate period. Scaled by 1000. */
+#ifndef AUTO_TUNE_TD_RATIO_SCALED
+#define AUTO_TUNE_TD_RATIO_SCALED 333
+#endif
+
+/**
+ * Result of a relay auto tune.
+ */
+struct RelayAutoTuneResult
+{
+	/** Whether the tune completed and the rest of the result is valid. */
+	bool success;
+
+	/** Ultimate gain. In %/kPa, scaled by 1000. */
+	uint32_t ultimateGainScaled;
+
+	/** Ultimate (oscillation) period. In microseconds. */
+	uint32_t ultimatePeriodUs;
+
+	/** Oscillation amplitude, peak to mean. In kPa, scaled by 1000. */
+	uint32_t amplitudeKpaScaled;
+
+	/** Calculated PID proportional constant. Scaled by 1000. See BoostControlParameters. */
+	uint32_t pidPropConstScaled;
+
+	/** Calculated PID integration constant. Scaled by 1000. See BoostControlParameters. */
+	uint32_t pidIntegConstScaled;
+
+	/** Calculated PID derivative constant. Scaled by 1000. See BoostControlParameters. */
+	uint32_t pidDerivConstScaled;
+};
+
+/**
+ * Astrom-Hagglund relay feedback auto tuner.
+ * The solenoid duty is switched between bias + relay and bias - relay as the boost crosses the target. This makes the
+ * boost oscillate about the target at the ultimate (critical) period. The ultimate gain comes from the relay amplitude and
+ * the measured oscillation amplitude, using the describing function of a relay with hysteresis:
+ *   Ku = 4d / (pi * sqrt(a^2 - e^2))
+ * The PID constants are then calculated from Ku and Tu with the AUTO_TUNE_*_RATIO_SCALED rule.
+ * @note This has no hardware dependencies so it can be run against a simulated plant on the host.
+ * @note The integral of FixedPointPid leaks away over its sum time, so the integral time is only approximated.
+ */
+class RelayAutoTuner
+{
+	public:
+
+		/** Tuner state. */
+		enum State
+		{
+			/** Not started, or stopped. */
+			IDLE,
+
+			/** Relay is running and the oscillation is being measured. */
+			RUNNING,
+
+			/** Tune completed. The result is available. */
+			COMPLETE,
+
+			/** Tune failed. eg Timed out, or boost went too far over target. */
+			FAILED
+		};
+
+		virtual ~RelayAutoTuner();
+
+		RelayAutoTuner();
+
+		/**
+		 * Start a tune.
+		 * @param targetKpaScaled Boost to oscillate about, relative to std atm. In kPa, scaled by 1000.
+		 * @param biasDutyScaled Duty cycle the relay switches about. In %, scaled by 10.
+		 * @param relayDutyScaled Relay amplitude. ie How far the duty switches either side of the bias. In %, scaled by 10.
+		 * @param maxDutyScaled Maximum duty cycle. In %, scaled by 10.
+		 * @param timeUs Current time, from a 32 bit microsecond timer.
+		 */
+		void start(int32_t targetKpaScaled, uint32_t biasDutyScaled, uint32_t relayDutyScaled, uint32_t maxDutyScaled,
+			uint32_t timeUs);
+
+		/** Stop the tune. */
+		void stop();
+
+		/**
+		 * Process one boost sample. Intended to be called for every MAP sensor latch.
+		 * @param kpaScaled Current boost, relative to std atm. In kPa, scaled by 1000.
+		 * @param timeUs Time of the sample, from a 32 bit microsecond timer.
+		 */
+		void sample(int32_t kpaScaled, uint32_t timeUs);
+
+		/** Get the current state. */
+		State getState();
+
+		/** Get the duty cycle the relay is currently demanding. In %, scaled by 10. */
+		uint32_t getDutyScaled();
+
+		/** Get progress through the tune. In %. */
+		unsigned getProgress();
+
+		/**
+		 * Calculate the result of a completed tune.
+		 * @param controlStepPeriodUs Period between PID control steps. The derivative constant is applied per step.
+		 * @param result Populate this with the result. Success is false if the tune isn't complete.
+		 */
+		void getResult(uint32_t controlStepPeriodUs, RelayAutoTuneResult* result);
+
+	private:
+
+		/** Integer square root. */
+		static uint64_t __isqrt(uint64_t val);
+
+		/** Switch the relay output. Records the oscillation timing and peaks. */
+		void __switchRelay(bool high, uint32_t timeUs);
+
+		/** Current state. */
+		volatile State _state = IDLE;
+
+		/** Target boost. In kPa, scaled by 1000. */
+		int32_t _targetKpaScaled = 0;
+
+		/** Duty when the relay is high. In %, scaled by 10. */
+		uint32_t _highDutyScaled = 0;
+
+		/** Duty when the relay is low. In %, scaled by 10. */
+		uint32_t _lowDutyScaled = 0;
+
+		/** Actual relay amplitude, after limiting to the duty range. Half the high to low difference. In %, scaled by 10. */
+		uint32_t _relayAmplitudeScaled = 0;
+
+		/** Whether the relay is currently high. ie Boost is, or was last, below target. */
+		volatile bool _relayHigh = true;
+
+		/** Time the tune started. */
+		uint32_t _startTimeUs = 0;
+
+		/** Time the relay last switched low. ie Start of the current cycle. 0 if not switched yet. */
+		uint32_t _cycleStartUs = 0;
+
+		/** Whether a cycle start has been seen. */
+		bool _cycleStarted = false;
+
+		/** Number of completed oscillation cycles, including the settle cycles. */
+		volatile unsigned _cycleCount = 0;
+
+		/** Maximum boost seen since the relay switched low. In kPa, scaled by 1000. */
+		int32_t _peakKpaScaled = 0;
+
+		/** Minimum boost seen since the relay switched high. In kPa, scaled by 1000. */
+		int32_t _troughKpaScaled = 0;
+
+		/** Sum of the measured peak to trough heights. In kPa, scaled by 1000. */
+		int64_t _heightSum = 0;
+
+		/** Number of peak to trough heights summed. */
+		unsigned _heightCount = 0;
+
+		/** Sum of the measured cycle periods. In microseconds. */
+		uint64_t _periodSum = 0;
+
+		/** Number of cycle periods summed. */
+		unsigned _periodCount = 0;
+};
+
+#endif
@@ -0,0 +1,395 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "HalSerial.hpp"
+#include "SerialConsole.hpp"
+
+/** Most words on a command line. */
+#define CONSOLE_MAX_ARGS 6
+
+// Ranges match editing with the buttons. The display shows three digits: kPa, constants to 0.01 and duty to 0.1 %.
+const SerialConsoleField SerialConsole::fields[] = {
+	{"maxKpaScaled", offsetof(BoostControlParameters, maxKpaScaled), 0, 999000},
+	{"deEnergiseKpaScaled", offsetof(BoostControlParameters, deEnergiseKpaScaled), 0, 999000},
+	{"pidActiveKpaScaled", offsetof(BoostControlParameters, pidActiveKpaScaled), 0, 999000},
+	{"pidPropConstScaled", offsetof(BoostControlParameters, pidPropConstScaled), 0, 9990},
+	{"pidIntegConstScaled", offsetof(BoostControlParameters, pidIntegConstScaled), 0, 9990},
+	{"pidDerivConstScaled", offsetof(BoostControlParameters, pidDerivConstScaled), 0, 9990},
+	{"maxDuty", offsetof(BoostControlParameters, maxDuty), 0, 999},
+	{"zeroPointDuty", offsetof(BoostControlParameters, zeroPointDuty), 0, 999}
+};
+
+const unsigned SerialConsole::fieldCount = sizeof(fields) / sizeof(fields[0]);
+
+SerialConsole::~SerialConsole()
+{
+}
+
+SerialConsole::SerialConsole(BoostControl* boostControl, BoostOptions* boostOptions, TelemetryStream* telemetryStream) :
+	_boostControl(boostControl), _boostOptions(boostOptions), _telemetryStream(telemetryStream)
+{
+}
+
+void SerialConsole::poll()
+{
+	__flushOutput();
+
+	uint8_t c;
+	unsigned readCount = 0;
+
+	// Only read a character once a reply to it would fit, so no reply is ever cut short.
+	while(readCount < CONSOLE_MAX_READ_PER_POLL && CONSOLE_OUTPUT_SIZE - _outputLen >= CONSOLE_MAX_RESPONSE &&
+		hal_serial_read(&c, 1))
+	{
+		readCount++;
+
+		if(c == '\r' || c == '\n')
+		{
+			if(_lineOverflow)
+			{
+				__print("err line too long\n");
+			}
+			else if(_lineLen)
+			{
+				_line[_lineLen] = 0;
+				__processLine(_line);
+			}
+
+			_lineLen = 0;
+			_lineOverflow = false;
+		}
+		else if(_lineLen < CONSOLE_LINE_SIZE - 1)
+		{
+			_line[_lineLen++] = c;
+		}
+		else
+		{
+			_lineOverflow = true;
+		}
+	}
+
+	__flushOutput();
+}
+
+void SerialConsole::__flushOutput()
+{
+	if(_outputLen == 0) return;
+
+	unsigned available = hal_serial_write_available();
+
+	if(available == 0) return;
+
+	unsigned written = hal_serial_write((const uint8_t*)_output, _outputLen < available ? _outputLen : available);
+
+	memmove(_output, _output + written, _outputLen - written);
+	_outputLen -= written;
+
+	hal_serial_flush();
+}
+
+void SerialConsole::__print(const char* format, ...)
+{
+	unsigned room = CONSOLE_OUTPUT_SIZE - _outputLen;
+
+	if(room <= 1) return;
+
+	va_list args;
+	va_start(args, format);
+
+	int len = vsnprintf(_output + _outputLen, room, format, args);
+
+	va_end(args);
+
+	if(len < 0) return;
+
+	_outputLen += (unsigned)len < room ? len : room - 1;
+}
+
+void SerialConsole::__processLine(char* line)
+{
+	char* args[CONSOLE_MAX_ARGS];
+	unsigned argCount = 0;
+
+	// Split into words, in place.
+	char* posn = line;
+
+	while(*posn)
+	{
+		while(*posn == ' ' || *posn == '\t') *posn++ = 0;
+
+		if(!*posn) break;
+
+		if(argCount == CONSOLE_MAX_ARGS)
+		{
+			__print("err too many arguments\n");
+			return;
+		}
+
+		args[argCount++] = posn;
+
+		while(*posn && *posn != ' ' && *posn != '\t') posn++;
+	}
+
+	if(argCount == 0) return;
+
+	if(strcmp(args[0], "get") == 0)
+	{
+		__processGet(args + 1, argCount - 1);
+	}
+	else if(strcmp(args[0], "set") == 0)
+	{
+		__processSet(args + 1, argCount - 1);
+	}
+	else if(strcmp(args[0], "preset") == 0)
+	{
+		__processPreset(args + 1, argCount - 1);
+	}
+	else if(strcmp(args[0], "commit") == 0)
+	{
+		__processCommit(args + 1, argCount - 1);
+	}
+	else if(strcmp(args[0], "telemetry") == 0)
+	{
+		__processTelemetry(args + 1, argCount - 1);
+	}
+	else if(strcmp(args[0], "help") == 0)
+	{
+		__print("ok get [<field>] | get|set feedForwardDuty|learnedDuty <b> <l> [<value>] | set <field> <value>\n");
+		__print("ok preset [<index>] | commit [status] | telemetry [on|off|decimation <n>]\n");
+	}
+	else
+	{
+		__print("err unknown command %s\n", args[0]);
+	}
+}
+
+void SerialConsole::__processGet(char** args, unsigned argCount)
+{
+	BoostControlParameters params;
+	_boostControl -> getParameters(&params);
+
+	if(argCount == 0)
+	{
+		for(unsigned index = 0; index < fieldCount; index++)
+		{
+			__print("ok %s %u\n", fields[index].name, *(uint32_t*)((uint8_t*)&params + fields[index].offset));
+		}
+
+		return;
+	}
+
+	unsigned boostIndex;
+	unsigned loadIndex;
+
+	if(strcmp(args[0], "feedForwardDuty") == 0 || strcmp(args[0], "learnedDuty") == 0)
+	{
+		if(argCount != 3)
+		{
+			__print("err expected get %s <b> <l>\n", args[0]);
+			return;
+		}
+
+		if(!__parseCell(args + 1, &boostIndex, &loadIndex)) return;
+
+		int duty = args[0][0] == 'f' ? _boostControl -> getFeedForwardDutyScaled(boostIndex, loadIndex) :
+			_boostControl -> getLearnedDutyScaled(boostIndex, loadIndex);
+
+		__print("ok %s %u %u %d\n", args[0], boostIndex, loadIndex, duty);
+		return;
+	}
+
+	const SerialConsoleField* field = __findField(args[0]);
+
+	if(!field || argCount != 1)
+	{
+		__print("err unknown field %s\n", args[0]);
+		return;
+	}
+
+	__print("ok %s %u\n", field -> name, *(uint32_t*)((uint8_t*)&params + field -> offset));
+}
+
+void SerialConsole::__processSet(char** args, unsigned argCount)
+{
+	long value;
+	unsigned boostIndex;
+	unsigned loadIndex;
+
+	if(argCount > 0 && (strcmp(args[0], "feedForwardDuty") == 0 || strcmp(args[0], "learnedDuty") == 0))
+	{
+		if(argCount != 4 || !__parseInt(args[3], &value))
+		{
+			__print("err expected set %s <b> <l> <value>\n", args[0]);
+			return;
+		}
+
+		if(!__parseCell(args + 1, &boostIndex, &loadIndex)) return;
+
+		int duty;
+
+		// The setters clamp, so read back what was actually set.
+		if(args[0][0] == 'f')
+		{
+			_boostControl -> setFeedForwardDutyScaled(boostIndex, loadIndex, value);
+			duty = _boostControl -> getFeedForwardDutyScaled(boostIndex, loadIndex);
+		}
+		else
+		{
+			_boostControl -> setLearnedDutyScaled(boostIndex, loadIndex, value);
+			duty = _boostControl -> getLearnedDutyScaled(boostIndex, loadIndex);
+		}
+
+		__print("ok %s %u %u %d\n", args[0], boostIndex, loadIndex, duty);
+		return;
+	}
+
+	if(argCount != 2 || !__parseInt(args[1], &value))
+	{
+		__print("err expected set <field> <value>\n");
+		return;
+	}
+
+	const SerialConsoleField* field = __findField(args[0]);
+
+	if(!field)
+	{
+		__print("err unknown field %s\n", args[0]);
+		return;
+	}
+
+	if(value < (long)field -> min || value > (long)field -> max)
+	{
+		__print("err %s out of range %u-%u\n", field -> name, (unsigned)field -> min, (unsigned)field -> max);
+		return;
+	}
+
+	BoostControlParameters params;
+	_boostControl -> getParameters(&params);
+
+	*(uint32_t*)((uint8_t*)&params + field -> offset) = value;
+
+	// Published to the control loop as a complete snapshot, the same as an edit from the buttons.
+	_boostControl -> setParameters(&params);
+
+	_boostControl -> getParameters(&params);
+
+	__print("ok %s %u\n", field -> name, *(uint32_t*)((uint8_t*)&params + field -> offset));
+}
+
+void SerialConsole::__processPreset(char** args, unsigned argCount)
+{
+	long value;
+
+	if(argCount == 1)
+	{
+		if(!__parseInt(args[0], &value) || !_boostOptions -> setPresetIndex(value))
+		{
+			__print("err expected preset 0-4\n");
+			return;
+		}
+	}
+	else if(argCount != 0)
+	{
+		__print("err expected preset [<index>]\n");
+		return;
+	}
+
+	__print("ok preset %d%s\n", _boostOptions -> getPresetIndex(),
+		_boostOptions -> isPresetSelectActive() ? " (preset select active)" : "");
+}
+
+void SerialConsole::__processCommit(char** args, unsigned argCount)
+{
+	static const char* const stateNames[] = {"idle", "queued", "writing", "verifying"};
+
+	if(argCount == 0)
+	{
+		// Written in the background. Check on it with commit status.
+		if(!_boostOptions -> commit())
+		{
+			__print("err options don't fit the EEPROM page\n");
+			return;
+		}
+	}
+	else if(argCount != 1 || strcmp(args[0], "status") != 0)
+	{
+		__print("err expected commit [status]\n");
+		return;
+	}
+
+	__print("ok commit %s pages %u failed %u\n", stateNames[_boostOptions -> getCommitState()],
+		_boostOptions -> getCommitCount(), _boostOptions -> getCommitFailCount());
+}
+
+void SerialConsole::__processTelemetry(char** args, unsigned argCount)
+{
+	if(!_telemetryStream)
+	{
+		__print("err no telemetry stream\n");
+		return;
+	}
+
+	long value;
+
+	if(argCount == 1 && strcmp(args[0], "on") == 0)
+	{
+		_telemetryStream -> setEnabled(true);
+	}
+	else if(argCount == 1 && strcmp(args[0], "off") == 0)
+	{
+		_telemetryStream -> setEnabled(false);
+	}
+	else if(argCount == 2 && strcmp(args[0], "decimation") == 0 && __parseInt(args[1], &value) && value > 0)
+	{
+		_telemetryStream -> setDecimation(value);
+	}
+	else if(argCount != 0)
+	{
+		__print("err expected telemetry [on|off|decimation <n>]\n");
+		return;
+	}
+
+	__print("ok telemetry %s decimation %u dropped %u\n", _telemetryStream -> isEnabled() ? "on" : "off",
+		_telemetryStream -> getDecimation(), (unsigned)_telemetryStream -> getStreamDropCount());
+}
+
+bool SerialConsole::__parseCell(char** args, unsigned* boostIndex, unsigned* loadIndex)
+{
+	long boost;
+	long load;
+
+	if(!__parseInt(args[0], &boost) || !__parseInt(args[1], &load) || boost < 0 || boost >= FEED_FORWARD_BOOST_POINTS ||
+		load < 0 || load >= FEED_FORWARD_LOAD_POINTS)
+	{
+		__print("err cell out of range, boost 0-%u load 0-%u\n", FEED_FORWARD_BOOST_POINTS - 1,
+			FEED_FORWARD_LOAD_POINTS - 1);
+		return false;
+	}
+
+	*boostIndex = boost;
+	*loadIndex = load;
+
+	return true;
+}
+
+bool SerialConsole::__parseInt(const char* text, long* value)
+{
+	char* end;
+
+	*value = strtol(text, &end, 0);
+
+	return end != text && *end == 0;
+}
+
+const SerialConsoleField* SerialConsole::__findField(const char* name)
+{
+	for(unsigned index = 0; index < fieldCount; index++)
+	{
+		if(strcmp(fields[index].name, name) == 0) return &fields[index];
+	}
+
+	return 0;
+}
@@ -0,0 +1,150 @@
+#ifndef SERIAL_CONSOLE_H
+#define SERIAL_CONSOLE_H
+
+#include <stdint.h>
+
+#include "BoostControl.hpp"
+#include "BoostOptions.hpp"
+#include "TelemetryStream.hpp"
+
+/** Longest command line, in characters. Longer lines are rejected. */
+#define CONSOLE_LINE_SIZE 80
+
+/** Size of the buffer of output waiting for room on the serial port, in bytes. */
+#define CONSOLE_OUTPUT_SIZE 512
+
+/** Most output one command can produce, in bytes. A command is only run once there is this much room for its output. */
+#define CONSOLE_MAX_RESPONSE 320
+
+/** Most bytes read from the serial port per poll. Bounds the time a poll can take. */
+#define CONSOLE_MAX_READ_PER_POLL 64
+
+// Commands. Fields and values are in the units of BoostControlParameters. ie Scaled integers.
+// Every command replies with one or more lines starting "ok" or a single line starting "err".
+//
+// get                               All scalar fields.
+// get <field>                       A scalar field. eg get pidPropConstScaled
+// get feedForwardDuty <b> <l>       A feed forward table cell, by boost and load axis index.
+// get learnedDuty <b> <l>           A learned offset table cell.
+// set <field> <value>               Replies with the value set. Values outside what the buttons can edit are rejected.
+// set feedForwardDuty <b> <l> <value>
+// set learnedDuty <b> <l> <value>
+// preset [<index>]                  Get, or switch to, the preset index.
+// commit                            Queue all presets and options to be committed to EEPROM, in the background. Fails
+//                                   if the options don't fit their page.
+// commit status                     Get the state of the commit, and the number of pages committed and failed.
+// telemetry [on|off]                Get, or enable/disable, the telemetry stream.
+// telemetry decimation <n>          Only send every n'th telemetry record.
+// help
+
+/**
+ * A scalar field of BoostControlParameters.
+ */
+struct SerialConsoleField
+{
+	/** Field name, as in BoostControlParameters. */
+	const char* name;
+
+	/** Offset of the field in BoostControlParameters. */
+	unsigned offset;
+
+	/** Smallest value that can be set. */
+	uint32_t min;
+
+	/** Largest value that can be set. The most the display shows when editing it with the buttons. */
+	uint32_t max;
+};
+
+/**
+ * Line based command console on the USB serial port, for live parameter tuning without the buttons.
+ * Reads and writes go through HalSerial and never block. Input is only read when there is room to buffer the reply,
+ * and the reply is sent as the port takes it, so a host that stops reading just stalls the console.
+ * Parameters changed here take effect immediately, the same as in edit mode, but are only written to EEPROM on commit.
+ * @note Must only be used on core 0.
+ */
+class SerialConsole
+{
+	public:
+
+		virtual ~SerialConsole();
+
+		/**
+		 * @param boostControl Boost control to get and set the parameters of.
+		 * @param boostOptions Boost options, for presets and commits.
+		 * @param telemetryStream Telemetry stream to control. Can be 0 if there isn't one.
+		 */
+		SerialConsole(BoostControl* boostControl, BoostOptions* boostOptions, TelemetryStream* telemetryStream);
+
+		/** Polling pass. Sends pending output and runs any complete command lines. */
+		void poll();
+
+		/** Scalar fields, in BoostControlParameters order. */
+		static const SerialConsoleField fields[];
+
+		/** Number of scalar fields. */
+		static const unsigned fieldCount;
+
+	private:
+
+		BoostControl* _boostControl;
+
+		BoostOptions* _boostOptions;
+
+		TelemetryStream* _telemetryStream;
+
+		/** Command line being received. */
+		char _line[CONSOLE_LINE_SIZE];
+
+		/** Number of characters in _line. */
+		unsigned _lineLen = 0;
+
+		/** Whether the line being received is too long, and will be rejected. */
+		bool _lineOverflow = false;
+
+		/** Output waiting for room on the serial port. */
+		char _output[CONSOLE_OUTPUT_SIZE];
+
+		/** Number of bytes in _output. */
+		unsigned _outputLen = 0;
+
+		/** Send as much pending output as the serial port will take. */
+		void __flushOutput();
+
+		/** Add formatted text to the output. Truncated if there isn't room. */
+		void __print(const char* format, ...);
+
+		/** Run a command line. */
+		void __processLine(char* line);
+
+		void __processGet(char** args, unsigned argCount);
+
+		void __processSet(char** args, unsigned argCount);
+
+		void __processPreset(char** args, unsigned argCount);
+
+		void __processCommit(char** args, unsigned argCount);
+
+		void __processTelemetry(char** args, unsigned argCount);
+
+		/**
+		 * Parse a table cell reference.
+		 * @param args Boost index then load index.
+		 * @param boostIndex Set to the boost axis index.
+		 * @param loadIndex Set to the load axis index.
+		 * @returns False, having replied with an error, if either is invalid.
+		 */
+		bool __parseCell(char** args, unsigned* boostIndex, unsigned* loadIndex);
+
+		/**
+		 * Parse an integer.
+		 * @param text Text to parse. Decimal, or hex with 0x.
+		 * @param value Set to the value.
+		 * @returns False if the text isn't an integer.
+		 */
+		static bool __parseInt(const char* text, long* value);
+
+		/** Find a scalar field by name. 0 if there isn't one. */
+		static const SerialConsoleField* __findField(const char* name);
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * Lock free, single producer, single consumer ring buffer of fixed size entries.
+ * Intended for passing messages between the two cores. The producer only writes the head and the consumer only writes
+ * the tail, so only plain atomic loads and stores are required. The Cortex-M0+ doesn't have exclusive load/store so
+ * read-modify-write atomics would not be lock free.
+ * @note Neither side ever waits on the other. push() fails if the ring is full and pop() fails if it is empty.
+ * @tparam T Entry type. Copied in and out so should be plain data.
+ * @tparam SIZE_BITS log2 of the number of entries.
+ */
+template<typename T, unsigned SIZE_BITS> class SpscRing
+{
+	public:
+
+		/** Number of entries the ring can hold. */
+		static const uint32_t SIZE = (uint32_t)1 << SIZE_BITS;
+
+		SpscRing() : _head(0), _tail(0)
+		{
+		}
+
+		/**
+		 * Add an entry. Must only be called by the single producer.
+		 * @param entry Entry to copy in.
+		 * @returns False if the ring is full, in which case the entry is not added.
+		 */
+		bool push(const T* entry)
+		{
+			uint32_t head = _head.load(std::memory_order_relaxed);
+
+			// Indexes are free running so full and empty can be told apart without a spare entry.
+			if(head - _tail.load(std::memory_order_acquire) >= SIZE) return false;
+
+			_entries[head & (SIZE - 1)] = *entry;
+
+			// Release so the entry is visible before the new head.
+			_head.store(head + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		/**
+		 * Remove the oldest entry. Must only be called by the single consumer.
+		 * @param entry Copy the entry into this.
+		 * @returns False if the ring is empty.
+		 */
+		bool pop(T* entry)
+		{
+			uint32_t tail = _tail.load(std::memory_order_relaxed);
+
+			if(tail == _head.load(std::memory_order_acquire)) return false;
+
+			*entry = _entries[tail & (SIZE - 1)];
+
+			// Release so the entry has been copied out before the producer can reuse it.
+			_tail.store(tail + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		/** Get the number of entries currently in the ring. Can be called from either side. */
+		uint32_t count()
+		{
+			return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+		}
+
+		/** Get whether the ring is empty. Can be called from either side. */
+		bool isEmpty()
+		{
+			return count() == 0;
+		}
+
+	private:
+
+		/** Free running count of entries pushed. Only written by the producer. */
+		std::atomic<uint32_t> _head;
+
+		/** Free running count of entries popped. Only written by the consumer. */
+		std::atomic<uint32_t> _tail;
+
+		/** The entries. */
+		T _entries[SIZE];
+};
+
+#endif
@@ -1,26 +1,25 @@
 #include "TM1637_pico.hpp"
-#include "hardware/gpio.h"
-#include "hardware/clocks.h"
-#include "pico/platform.h"
+#include "HalGpio.hpp"
+#include "HalTime.hpp"
 
 TM1637Display::TM1637Display(uint8_t clk, uint8_t dio) : _clk(clk), _dio(dio)
 {
 	// Aim for 2 microsecond clock cycle duration.
-	_cpuCyclesPerQuarterClock = clock_get_hz(clk_sys) / 2000000;
+	_cpuCyclesPerQuarterClock = hal_clock_sys_hz() / 2000000;
 	_cpuCyclesPerHalfClock = _cpuCyclesPerQuarterClock * (uint32_t) 2;
 	_cpuCyclesPerClock = _cpuCyclesPerHalfClock * (uint32_t) 2;
 
-	gpio_init(_clk);
-	gpio_set_dir(_clk, GPIO_OUT);
-	gpio_init(_dio);
-	gpio_set_dir(_dio, GPIO_OUT);
+	hal_gpio_init(_clk);
+	hal_gpio_set_dir(_clk, HAL_GPIO_OUT);
+	hal_gpio_init(_dio);
+	hal_gpio_set_dir(_dio, HAL_GPIO_OUT);
 
 	// Put the chip into the stop state. This should be the state it stays in unless data is being transmitted to it.
-	gpio_put(_clk, 1);
-	gpio_put(_dio, 1);
+	hal_gpio_put(_clk, 1);
+	hal_gpio_put(_dio, 1);
 
 	// Wait a full clock to give it time to react.
-	busy_wait_at_least_cycles(_cpuCyclesPerClock);
+	hal_busy_wait_cycles(_cpuCyclesPerClock);
 
 	clear();
 }
@@ -32,13 +31,13 @@ void TM1637Display::__start()
 	// Assume the GPIO's are already in the stop state.
 
 	// High to low indicates start.
-	gpio_put(_dio, 0);
+	hal_gpio_put(_dio, 0);
 
 	// Wait a full clock. This comes from the start of the timing diagrams from the datasheet.
-	busy_wait_at_least_cycles(_cpuCyclesPerClock);
+	hal_busy_wait_cycles(_cpuCyclesPerClock);
 
 	// Set clock ready for data to be written. This is required by write function.
-	gpio_put(_clk, 0);
+	hal_gpio_put(_clk, 0);
 }
 
 void TM1637Display::__stop()
@@ -48,14 +47,14 @@ void TM1637Display::__stop()
 	// Assume clk and dio are both low entering into this function.
 
 	// Wait half a clock because a stop always follows the falling edge of the end of the ACK.
-	busy_wait_at_least_cycles(_cpuCyclesPerHalfClock);
+	hal_busy_wait_cycles(_cpuCyclesPerHalfClock);
 
-	gpio_put(_clk, 1);
-	busy_wait_at_least_cycles(_cpuCyclesPerHalfClock);
-	gpio_put(_dio, 1);
+	hal_gpio_put(_clk, 1);
+	hal_busy_wait_cycles(_cpuCyclesPerHalfClock);
+	hal_gpio_put(_dio, 1);
 
 	// Wait another half clock so that stop has holding period.
-	busy_wait_at_least_cycles(_cpuCyclesPerHalfClock);
+	hal_busy_wait_cycles(_cpuCyclesPerHalfClock);
 }
 
 uint8_t TM1637Display::__writeByte(uint8_t data)
@@ -79,21 +78,21 @@ uint8_t TM1637Display::__writeByte(uint8_t data)
 
 		// Wait a quarter clock after previous falling edge before setting dio. This should also give more than
 		// enough setup time prior to clk going high.
-		busy_wait_at_least_cycles(_cpuCyclesPerQuarterClock);
-		gpio_put(_dio, (data & 0x01) ? 1 : 0);
+		hal_busy_wait_cycles(_cpuCyclesPerQuarterClock);
+		hal_gpio_put(_dio, (data & 0x01) ? 1 : 0);
 		data >>= 1;
 
 		// Allow another quarter clock to satisfy tSetup.
-		busy_wait_at_least_cycles(_cpuCyclesPerClock);
+		hal_busy_wait_cycles(_cpuCyclesPerClock);
 
 		// Latch data on rising edge.
-		gpio_put(_clk, 1);
+		hal_gpio_put(_clk, 1);
 
 		// Wait half clock to satisfy tHOLD.
-		busy_wait_at_least_cycles(_cpuCyclesPerHalfClock);
+		hal_busy_wait_cycles(_cpuCyclesPerHalfClock);
 
 		// Create clock falling edge ready for next bit transfer.
-		gpio_put(_clk, 0);
+		hal_gpio_put(_clk, 0);
 	}
 
 	// At this point the clock should be at the end of the falling edge.
@@ -103,26 +102,26 @@ uint8_t TM1637Display::__writeByte(uint8_t data)
 	// after the end of the ninth clock."
 
 	// Get dio ready to read ACK.
-	gpio_set_dir(_dio, GPIO_IN);
+	hal_gpio_set_dir(_dio, HAL_GPIO_IN);
 	// The dio pin is reported to be open drain so needs a pull up resistor to be read accurately.
-	gpio_pull_up(_dio);
+	hal_gpio_pull_up(_dio);
 
 	// Timing diagram suggests ACK at clock low should last a full clock.
 	// Sample in the middle of that period.
-	busy_wait_at_least_cycles(_cpuCyclesPerHalfClock);
-	ack = gpio_get(_dio);
-	busy_wait_at_least_cycles(_cpuCyclesPerHalfClock);
+	hal_busy_wait_cycles(_cpuCyclesPerHalfClock);
+	ack = hal_gpio_get(_dio);
+	hal_busy_wait_cycles(_cpuCyclesPerHalfClock);
 
 	// Rising edge of 9th clock.
-	gpio_put(_clk, 1);
+	hal_gpio_put(_clk, 1);
 	// Half clock of "top" of waveform.
-	busy_wait_at_least_cycles(_cpuCyclesPerHalfClock);
+	hal_busy_wait_cycles(_cpuCyclesPerHalfClock);
 	// Falling edge. ACK period should end.
-	gpio_put(_clk, 0);
+	hal_gpio_put(_clk, 0);
 
 	// Set dio back to output and pull low as default. This makes it ready for a stop if necessary.
-	gpio_set_dir(_dio, GPIO_OUT);
-	gpio_put(_dio, 0);
+	hal_gpio_set_dir(_dio, HAL_GPIO_OUT);
+	hal_gpio_put(_dio, 0);
 
 	return ack;
 }
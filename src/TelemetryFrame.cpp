@@ -0,0 +1,45 @@
+#include <string.h>
+
+#include "Crc16.hpp"
+#include "TelemetryFrame.hpp"
+
+unsigned TelemetryFrame::encode(uint8_t type, const void* payload, unsigned len, uint8_t* frame)
+{
+	if(len > TELEMETRY_FRAME_MAX_PAYLOAD) return 0;
+
+	uint8_t decoded[TELEMETRY_FRAME_MAX_DECODED];
+
+	decoded[0] = type;
+	memcpy(decoded + 1, payload, len);
+
+	uint16_t crc = Crc16::calc(decoded, len + 1);
+
+	decoded[len + 1] = crc;
+	decoded[len + 2] = crc >> 8;
+
+	frame[0] = 0;
+
+	unsigned encodedLen = Cobs::encode(decoded, len + 3, frame + 1);
+
+	frame[encodedLen + 1] = 0;
+
+	return encodedLen + 2;
+}
+
+int TelemetryFrame::decode(const uint8_t* encoded, unsigned len, uint8_t* type, uint8_t* payload)
+{
+	uint8_t decoded[TELEMETRY_FRAME_MAX_DECODED];
+
+	int decodedLen = Cobs::decode(encoded, len, decoded, sizeof(decoded));
+
+	if(decodedLen < 3) return -1;
+
+	uint16_t crc = decoded[decodedLen - 2] | (decoded[decodedLen - 1] << 8);
+
+	if(crc != Crc16::calc(decoded, decodedLen - 2)) return -1;
+
+	*type = decoded[0];
+	memcpy(payload, decoded + 1, decodedLen - 3);
+
+	return decodedLen - 3;
+}
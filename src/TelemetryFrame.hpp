@@ -0,0 +1,81 @@
+#ifndef TELEMETRY_FRAME_H
+#define TELEMETRY_FRAME_H
+
+#include <stdint.h>
+
+#include "BoostTelemetry.hpp"
+#include "Cobs.hpp"
+
+// Binary framing of telemetry sent over the USB serial port.
+// A frame is a type byte, the payload and a CRC-16 (Crc16) of both, little endian. That is COBS encoded (Cobs) and
+// sent between two zero bytes. The leading zero means any printf text written to the port between frames is cut off
+// into a frame of its own, which fails its CRC, rather than corrupting the next frame.
+// All payloads are little endian, as laid out in memory on the Pico.
+
+/** Largest frame payload, in bytes. */
+#define TELEMETRY_FRAME_MAX_PAYLOAD 64
+
+/** Largest decoded frame. Type byte, payload and CRC. */
+#define TELEMETRY_FRAME_MAX_DECODED (1 + TELEMETRY_FRAME_MAX_PAYLOAD + 2)
+
+/** Largest frame on the wire, including both delimiters. */
+#define TELEMETRY_FRAME_MAX_ENCODED (TELEMETRY_FRAME_MAX_DECODED + COBS_MAX_OVERHEAD(TELEMETRY_FRAME_MAX_DECODED) + 2)
+
+/** Telemetry frame types. */
+enum TelemetryFrameType
+{
+	/** Payload is a BoostTelemetryRecord. */
+	TELEMETRY_FRAME_RECORD = 1,
+
+	/** Payload is TelemetryCounters. Sent periodically. */
+	TELEMETRY_FRAME_COUNTERS = 2
+};
+
+/**
+ * Telemetry stream counters. Lets a reader tell which records it missed were never sent, and why.
+ */
+struct TelemetryCounters
+{
+	/** Number of records logged by boost control, including those dropped. */
+	uint32_t recordCount;
+
+	/** Number of records dropped by boost control because core 0 fell behind. */
+	uint32_t ringDropCount;
+
+	/** Number of record frames dropped because the serial port couldn't take them. */
+	uint32_t streamDropCount;
+
+	/** Only every decimation'th record is sent. */
+	uint32_t decimation;
+};
+
+/**
+ * Encodes and decodes telemetry frames.
+ * @note This has no hardware dependencies so it can be built on the host.
+ */
+class TelemetryFrame
+{
+	public:
+
+		/**
+		 * Encode a frame, including both delimiters.
+		 * @param type One of TelemetryFrameType.
+		 * @param payload Payload bytes.
+		 * @param len Payload length. At most TELEMETRY_FRAME_MAX_PAYLOAD.
+		 * @param frame Encoded frame is written here. Must have room for TELEMETRY_FRAME_MAX_ENCODED bytes.
+		 * @returns Length of the encoded frame. 0 if the payload is too long.
+		 */
+		static unsigned encode(uint8_t type, const void* payload, unsigned len, uint8_t* frame);
+
+		/**
+		 * Decode a frame.
+		 * @param encoded Encoded frame, without the delimiters.
+		 * @param len Length of the encoded frame.
+		 * @param type Set to the frame type.
+		 * @param payload Payload is written here. Must have room for TELEMETRY_FRAME_MAX_PAYLOAD bytes.
+		 * @returns Payload length. -1 if the frame is invalid or fails its CRC.
+		 */
+		static int decode(const uint8_t* encoded, unsigned len, uint8_t* type, uint8_t* payload);
+};
+
+#endif
@@ -0,0 +1,113 @@
+#include "HalSerial.hpp"
+#include "TelemetryStream.hpp"
+
+TelemetryStream::~TelemetryStream()
+{
+}
+
+TelemetryStream::TelemetryStream(BoostControl* boostControl) : _boostControl(boostControl)
+{
+	_nextCountersTime = hal_get_absolute_time();
+}
+
+void TelemetryStream::poll()
+{
+	bool stream = _enabled && hal_serial_connected();
+
+	if(stream != _streaming && __setControlTelemetry(stream))
+	{
+		_streaming = stream;
+		_decimationCount = 0;
+	}
+
+	bool sent = false;
+
+	BoostTelemetryRecord record;
+
+	// Always drain everything, even records logged before streaming stopped, so the ring is empty for next time.
+	while(_boostControl -> readTelemetry(&record))
+	{
+		if(!_streaming) continue;
+
+		if(++_decimationCount < _decimation) continue;
+
+		_decimationCount = 0;
+
+		if(__sendFrame(TELEMETRY_FRAME_RECORD, &record, sizeof(record))) sent = true; else _streamDropCount++;
+	}
+
+	if(_streaming && hal_get_absolute_time() >= _nextCountersTime)
+	{
+		_nextCountersTime = hal_delayed_by_ms(hal_get_absolute_time(), TELEMETRY_STREAM_COUNTERS_PERIOD_MS);
+
+		__sendCounters();
+
+		sent = true;
+	}
+
+	if(sent) hal_serial_flush();
+}
+
+bool TelemetryStream::isEnabled()
+{
+	return _enabled;
+}
+
+void TelemetryStream::setEnabled(bool enabled)
+{
+	_enabled = enabled;
+}
+
+unsigned TelemetryStream::getDecimation()
+{
+	return _decimation;
+}
+
+void TelemetryStream::setDecimation(unsigned decimation)
+{
+	if(decimation < 1) decimation = 1;
+	if(decimation > TELEMETRY_STREAM_MAX_DECIMATION) decimation = TELEMETRY_STREAM_MAX_DECIMATION;
+
+	_decimation = decimation;
+}
+
+uint32_t TelemetryStream::getStreamDropCount()
+{
+	return _streamDropCount;
+}
+
+bool TelemetryStream::__setControlTelemetry(bool enabled)
+{
+	BoostControlCommand command;
+
+	command.type = BOOST_COMMAND_SET_TELEMETRY;
+	command.telemetryEnabled = enabled;
+
+	return _boostControl -> sendCommand(&command);
+}
+
+bool TelemetryStream::__sendFrame(uint8_t type, const void* payload, unsigned len)
+{
+	uint8_t frame[TELEMETRY_FRAME_MAX_ENCODED];
+
+	unsigned frameLen = TelemetryFrame::encode(type, payload, len, frame);
+
+	// All or nothing, so a frame is never left half written.
+	if(frameLen == 0 || hal_serial_write_available() < frameLen) return false;
+
+	hal_serial_write(frame, frameLen);
+
+	return true;
+}
+
+void TelemetryStream::__sendCounters()
+{
+	TelemetryCounters counters;
+
+	counters.recordCount = _boostControl -> getTelemetryRecordCount();
+	counters.ringDropCount = _boostControl -> getTelemetryDropCount();
+	counters.streamDropCount = _streamDropCount;
+	counters.decimation = _decimation;
+
+	__sendFrame(TELEMETRY_FRAME_COUNTERS, &counters, sizeof(counters));
+}
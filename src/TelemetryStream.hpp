@@ -0,0 +1,110 @@
+#ifndef TELEMETRY_STREAM_H
+#define TELEMETRY_STREAM_H
+
+#include <stdint.h>
+
+#include "BoostControl.hpp"
+#include "HalTime.hpp"
+#include "TelemetryFrame.hpp"
+
+/** Only every TELEMETRY_STREAM_DECIMATION'th record is sent by default. 1 sends every control step. */
+#ifndef TELEMETRY_STREAM_DECIMATION
+#define TELEMETRY_STREAM_DECIMATION 1
+#endif
+
+/** Largest decimation that can be set. */
+#define TELEMETRY_STREAM_MAX_DECIMATION 100
+
+/** Period between counter frames, in milliseconds. */
+#define TELEMETRY_STREAM_COUNTERS_PERIOD_MS 1000
+
+/**
+ * Set to 1 to stream whenever a host opens the serial port, or 0 to wait until streaming is enabled, ie with the console
+ * telemetry on command. Off by default, as the serial console shares the port and binary frames would garble it.
+ */
+#ifndef TELEMETRY_STREAM_ON_CONNECT
+#define TELEMETRY_STREAM_ON_CONNECT 0
+#endif
+
+/**
+ * Streams boost control telemetry records over the USB serial port as binary frames (see TelemetryFrame).
+ * Core 1 only logs telemetry while a host is connected and streaming is enabled. Every record is drained from boost
+ * control each poll, so the telemetry ring never fills because of a slow port. Frames the port has no room for are
+ * dropped, and counted, rather than waited on.
+ * @note Must only be used on core 0.
+ */
+class TelemetryStream
+{
+	public:
+
+		virtual ~TelemetryStream();
+
+		/**
+		 * @param boostControl Boost control to stream the telemetry of.
+		 */
+		TelemetryStream(BoostControl* boostControl);
+
+		/** Polling pass. Sends any telemetry logged since the last poll. */
+		void poll();
+
+		/** Get whether streaming is enabled. It still only happens while a host is connected. */
+		bool isEnabled();
+
+		/** Enable or disable streaming. */
+		void setEnabled(bool enabled);
+
+		/** Get the decimation. Only every decimation'th record is sent. */
+		unsigned getDecimation();
+
+		/**
+		 * Set the decimation. Only every decimation'th record is sent.
+		 * @param decimation Clamped between 1 and TELEMETRY_STREAM_MAX_DECIMATION.
+		 */
+		void setDecimation(unsigned decimation);
+
+		/** Get the number of record frames dropped because the serial port couldn't take them. */
+		uint32_t getStreamDropCount();
+
+	private:
+
+		/** Boost control to stream the telemetry of. */
+		BoostControl* _boostControl;
+
+		/** Whether streaming is enabled. */
+		bool _enabled = TELEMETRY_STREAM_ON_CONNECT;
+
+		/** Whether boost control has been told to log telemetry. */
+		bool _streaming = false;
+
+		/** Only every _decimation'th record is sent. */
+		unsigned _decimation = TELEMETRY_STREAM_DECIMATION;
+
+		/** Records skipped since the last one sent. */
+		unsigned _decimationCount = 0;
+
+		/** Number of record frames dropped. */
+		uint32_t _streamDropCount = 0;
+
+		/** Time the next counter frame is due. */
+		hal_time_t _nextCountersTime;
+
+		/**
+		 * Tell boost control to start or stop logging telemetry.
+		 * @returns False if the command couldn't be sent. It should be tried again later.
+		 */
+		bool __setControlTelemetry(bool enabled);
+
+		/**
+		 * Send a frame, if the serial port has room for all of it.
+		 * @param type One of TelemetryFrameType.
+		 * @param payload Payload bytes.
+		 * @param len Payload length.
+		 * @returns False if there wasn't room, in which case nothing is sent.
+		 */
+		bool __sendFrame(uint8_t type, const void* payload, unsigned len);
+
+		/** Send the stream counters. */
+		void __sendCounters();
+};
+
+#endif
@@ -0,0 +1,102 @@
+#include "TlvReader.hpp"
+
+TlvReader::~TlvReader()
+{
+}
+
+TlvReader::TlvReader(const uint8_t* buffer, unsigned size) : _buffer(buffer), _size(size)
+{
+}
+
+bool TlvReader::next()
+{
+	if(_malformed || _offset >= _size) return false;
+
+	uint8_t key = _buffer[_offset];
+
+	// Zero is the end.
+	if(key == 0) return false;
+
+	if(key > ((TLV_MAX_TAG << 1) | 1))
+	{
+		_malformed = true;
+		return false;
+	}
+
+	_offset++;
+	_tag = key >> 1;
+	_bytes = key & TLV_TYPE_BYTES;
+
+	if(_bytes)
+	{
+		if(_offset >= _size || _buffer[_offset] > _size - _offset - 1)
+		{
+			_malformed = true;
+			return false;
+		}
+
+		_value = _buffer[_offset++];
+		_bytesOffset = _offset;
+		_offset += _value;
+
+		return true;
+	}
+
+	_value = 0;
+
+	// At most 5 bytes for 32 bits.
+	for(unsigned shift = 0; shift < 35; shift += 7)
+	{
+		if(_offset >= _size) break;
+
+		uint8_t byte = _buffer[_offset++];
+
+		_value |= (uint32_t)(byte & 0x7F) << shift;
+
+		if(!(byte & 0x80)) return true;
+	}
+
+	_malformed = true;
+
+	return false;
+}
+
+uint8_t TlvReader::getTag()
+{
+	return _tag;
+}
+
+bool TlvReader::isBytes()
+{
+	return _bytes;
+}
+
+uint32_t TlvReader::getUnsigned()
+{
+	return _bytes ? 0 : _value;
+}
+
+int32_t TlvReader::getSigned()
+{
+	return _bytes ? 0 : (int32_t)((_value >> 1) ^ -(_value & 1));
+}
+
+const uint8_t* TlvReader::getBytes()
+{
+	return _bytes ? _buffer + _bytesOffset : nullptr;
+}
+
+unsigned TlvReader::getBytesLength()
+{
+	return _bytes ? _value : 0;
+}
+
+TlvReader TlvReader::getGroup()
+{
+	return TlvReader(_buffer + _bytesOffset, getBytesLength());
+}
+
+bool TlvReader::isMalformed()
+{
+	return _malformed;
+}
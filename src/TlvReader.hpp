@@ -0,0 +1,76 @@
+#ifndef TLV_READER_H
+#define TLV_READER_H
+
+#include <stdint.h>
+
+#include "TlvWriter.hpp"
+
+/**
+ * Reads tagged values written by TlvWriter. Entries are read in order with next(). The caller picks out the tags it
+ * knows and ignores the rest, so it can read what was written by older and newer versions of itself.
+ * @note This has no hardware dependencies so it can be built on the host.
+ */
+class TlvReader
+{
+	public:
+
+		virtual ~TlvReader();
+
+		/**
+		 * @param buffer Buffer to read from.
+		 * @param size Size of buffer, in bytes.
+		 */
+		TlvReader(const uint8_t* buffer, unsigned size);
+
+		/**
+		 * Move to the next entry.
+		 * @returns true if there is one. false at the end, or if the rest of the buffer is malformed.
+		 */
+		bool next();
+
+		/** Get the tag of the current entry. */
+		uint8_t getTag();
+
+		/** Get whether the current entry is bytes, or a group, rather than a number. */
+		bool isBytes();
+
+		/** Get the current entry as an unsigned number. 0 if it is bytes. */
+		uint32_t getUnsigned();
+
+		/** Get the current entry as a signed number. 0 if it is bytes. */
+		int32_t getSigned();
+
+		/** Get the bytes of the current entry. nullptr if it is a number. */
+		const uint8_t* getBytes();
+
+		/** Get the number of bytes of the current entry. 0 if it is a number. */
+		unsigned getBytesLength();
+
+		/** Get a reader of the entries in the current entry, if it is a group. */
+		TlvReader getGroup();
+
+		/** Get whether reading stopped early because the buffer didn't hold valid entries. */
+		bool isMalformed();
+
+	private:
+
+		const uint8_t* _buffer;
+
+		unsigned _size;
+
+		/** Offset of the next entry. */
+		unsigned _offset = 0;
+
+		uint8_t _tag = 0;
+
+		bool _bytes = false;
+
+		uint32_t _value = 0;
+
+		/** Offset of the bytes of the current entry, if it is bytes. Their length is _value. */
+		unsigned _bytesOffset = 0;
+
+		bool _malformed = false;
+};
+
+#endif
@@ -0,0 +1,112 @@
+#include "TlvWriter.hpp"
+
+TlvWriter::~TlvWriter()
+{
+}
+
+TlvWriter::TlvWriter(uint8_t* buffer, unsigned size) : _buffer(buffer), _size(size)
+{
+	for(unsigned index = 0; index < size; index++) buffer[index] = 0;
+}
+
+void TlvWriter::putUnsigned(uint8_t tag, uint32_t value)
+{
+	__putKey(tag, TLV_TYPE_VARINT);
+	__putVarint(value);
+}
+
+void TlvWriter::putSigned(uint8_t tag, int32_t value)
+{
+	// Sign moves to the low bit. -1 is 1, 1 is 2, -2 is 3 and so on.
+	__putKey(tag, TLV_TYPE_VARINT);
+	__putVarint(((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
+
+void TlvWriter::putBytes(uint8_t tag, const uint8_t* data, unsigned len)
+{
+	if(len > 255)
+	{
+		_overflowed = true;
+		return;
+	}
+
+	__putKey(tag, TLV_TYPE_BYTES);
+	__putByte(len);
+
+	for(unsigned index = 0; index < len; index++) __putByte(data[index]);
+}
+
+void TlvWriter::beginGroup(uint8_t tag)
+{
+	if(_groupLengthOffset >= 0)
+	{
+		_overflowed = true;
+		return;
+	}
+
+	__putKey(tag, TLV_TYPE_BYTES);
+
+	// Filled in when the group ends.
+	_groupLengthOffset = _length;
+	__putByte(0);
+}
+
+void TlvWriter::endGroup()
+{
+	if(_groupLengthOffset < 0 || _overflowed)
+	{
+		_groupLengthOffset = -1;
+		return;
+	}
+
+	unsigned groupLength = _length - _groupLengthOffset - 1;
+
+	if(groupLength > TLV_MAX_GROUP_SIZE) _overflowed = true; else _buffer[_groupLengthOffset] = groupLength;
+
+	_groupLengthOffset = -1;
+}
+
+unsigned TlvWriter::getLength()
+{
+	return _length;
+}
+
+bool TlvWriter::isOverflowed()
+{
+	return _overflowed;
+}
+
+void TlvWriter::__putKey(uint8_t tag, uint8_t type)
+{
+	if(tag == 0 || tag > TLV_MAX_TAG)
+	{
+		_overflowed = true;
+		return;
+	}
+
+	__putByte((tag << 1) | type);
+}
+
+void TlvWriter::__putVarint(uint32_t value)
+{
+	while(value >= 0x80)
+	{
+		__putByte((value & 0x7F) | 0x80);
+		value >>= 7;
+	}
+
+	__putByte(value);
+}
+
+void TlvWriter::__putByte(uint8_t value)
+{
+	if(_overflowed) return;
+
+	if(_length == _size)
+	{
+		_overflowed = true;
+		return;
+	}
+
+	_buffer[_length++] = value;
+}
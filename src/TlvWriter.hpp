@@ -0,0 +1,81 @@
+#ifndef TLV_WRITER_H
+#define TLV_WRITER_H
+
+#include <stdint.h>
+
+/** Type of a TLV entry, in the low bit of its key. */
+#define TLV_TYPE_VARINT 0
+#define TLV_TYPE_BYTES 1
+
+/** Largest tag. Keeps the key to a single byte. */
+#define TLV_MAX_TAG 63
+
+/** Largest group, in bytes. Keeps its length to a single byte. */
+#define TLV_MAX_GROUP_SIZE 127
+
+/**
+ * Writes tagged values to a buffer, for storage that has to stay readable as what is stored changes.
+ * Each entry is a key byte, the tag shifted up one with the type in the low bit, then the value. A varint value is 7 bits
+ * a byte, least significant first, with the top bit set on all but the last byte. So small numbers take little room
+ * whatever their C type. A bytes value is a length byte and then the bytes, and is also used for groups of entries.
+ * A reader can skip entries with tags it doesn't know, as the type says how long they are. Tag 0 is the end.
+ * @note This has no hardware dependencies so it can be built on the host.
+ */
+class TlvWriter
+{
+	public:
+
+		virtual ~TlvWriter();
+
+		/**
+		 * @param buffer Buffer to write to. Unused bytes at the end are zeroed, which reads as the end.
+		 * @param size Size of buffer, in bytes.
+		 */
+		TlvWriter(uint8_t* buffer, unsigned size);
+
+		/** Write an unsigned number as a varint. */
+		void putUnsigned(uint8_t tag, uint32_t value);
+
+		/** Write a signed number as a varint. Zig zag encoded, so small negative numbers are small too. */
+		void putSigned(uint8_t tag, int32_t value);
+
+		/** Write bytes. At most 255. */
+		void putBytes(uint8_t tag, const uint8_t* data, unsigned len);
+
+		/**
+		 * Start a group of entries, written as a bytes entry. Entries up to endGroup() are in it.
+		 * @note Groups can't be nested, and must be at most TLV_MAX_GROUP_SIZE bytes.
+		 */
+		void beginGroup(uint8_t tag);
+
+		/** End the group of entries started by beginGroup(). */
+		void endGroup();
+
+		/** Get the number of bytes written so far. */
+		unsigned getLength();
+
+		/** Get whether anything didn't fit, in the buffer or in a group. The buffer shouldn't be used if so. */
+		bool isOverflowed();
+
+	private:
+
+		uint8_t* _buffer;
+
+		unsigned _size;
+
+		/** Number of bytes written. */
+		unsigned _length = 0;
+
+		/** Offset of the length byte of the open group. -1 if there isn't one. */
+		int _groupLengthOffset = -1;
+
+		bool _overflowed = false;
+
+		void __putKey(uint8_t tag, uint8_t type);
+
+		void __putVarint(uint32_t value);
+
+		void __putByte(uint8_t value);
+};
+
+#endif
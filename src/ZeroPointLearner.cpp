@@ -0,0 +1,40 @@
+#include "FixedPointPid.hpp"
+#include "ZeroPointLearner.hpp"
+
+ZeroPointLearner::~ZeroPointLearner()
+{
+}
+
+ZeroPointLearner::ZeroPointLearner()
+{
+}
+
+void ZeroPointLearner::reset()
+{
+	_settledUs = 0;
+	_sinceLearnUs = 0;
+}
+
+int32_t ZeroPointLearner::process(int32_t errorKpaScaled, int32_t integTerm, uint32_t deltaTimeUs)
+{
+	if(errorKpaScaled > LEARN_SETTLED_KPA_SCALED || errorKpaScaled < -LEARN_SETTLED_KPA_SCALED)
+	{
+		reset();
+		return 0;
+	}
+
+	if(_settledUs < LEARN_SETTLE_TIME_US) _settledUs += deltaTimeUs;
+	if(_sinceLearnUs < LEARN_INTERVAL_US) _sinceLearnUs += deltaTimeUs;
+
+	if(_settledUs < LEARN_SETTLE_TIME_US || _sinceLearnUs < LEARN_INTERVAL_US) return 0;
+
+	_sinceLearnUs = 0;
+
+	// Fixed point % to % scaled by 10, rounded towards zero so a tiny integral doesn't keep nudging the offset.
+	int32_t transfer = (int32_t)(((int64_t)(integTerm >> LEARN_TRANSFER_SHIFT) * 10) / FIXED_PID_ONE);
+
+	if(transfer > LEARN_STEP_MAX) transfer = LEARN_STEP_MAX;
+	if(transfer < -LEARN_STEP_MAX) transfer = -LEARN_STEP_MAX;
+
+	return transfer;
+}
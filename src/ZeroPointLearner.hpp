@@ -0,0 +1,71 @@
+#ifndef ZERO_POINT_LEARNER_H
+#define ZERO_POINT_LEARNER_H
+
+#include <stdint.h>
+
+/** Boost error within which the PID is considered settled. In kPa, scaled by 1000. */
+#ifndef LEARN_SETTLED_KPA_SCALED
+#define LEARN_SETTLED_KPA_SCALED 3000
+#endif
+
+/** Time the PID must stay settled before anything is learnt. In microseconds. */
+#ifndef LEARN_SETTLE_TIME_US
+#define LEARN_SETTLE_TIME_US 1000000
+#endif
+
+/** Minimum time between learning steps. In microseconds. */
+#ifndef LEARN_INTERVAL_US
+#define LEARN_INTERVAL_US 1000000
+#endif
+
+/** Each learning step moves 1 / 2^LEARN_TRANSFER_SHIFT of the integral term. */
+#ifndef LEARN_TRANSFER_SHIFT
+#define LEARN_TRANSFER_SHIFT 2
+#endif
+
+/** Maximum duty moved per learning step. In %, scaled by 10. */
+#ifndef LEARN_STEP_MAX
+#define LEARN_STEP_MAX 5
+#endif
+
+/** Maximum magnitude of a learned offset. In %, scaled by 10. */
+#ifndef LEARN_OFFSET_MAX
+#define LEARN_OFFSET_MAX 150
+#endif
+
+/**
+ * Decides when, and how much, of the PID integral term to move into the learned zero point offsets.
+ * Once the PID has settled on target the integral term holds the error in the zero point (plus feed forward) duty. This
+ * moves part of it across at a limited rate, so each boost event starts closer to steady state.
+ * @note This has no hardware dependencies so it can be built on the host.
+ */
+class ZeroPointLearner
+{
+	public:
+
+		virtual ~ZeroPointLearner();
+
+		ZeroPointLearner();
+
+		/** Forget any settling progress. eg When the PID is reset or the parameters change. */
+		void reset();
+
+		/**
+		 * Process one PID step.
+		 * @param errorKpaScaled Target - current boost. In kPa, scaled by 1000.
+		 * @param integTerm PID integral term of this step. In %, PID fixed point.
+		 * @param deltaTimeUs Time since the previous step, in microseconds.
+		 * @returns Duty to move from the integral term to the learned offset. In %, scaled by 10. 0 if nothing is due.
+		 */
+		int32_t process(int32_t errorKpaScaled, int32_t integTerm, uint32_t deltaTimeUs);
+
+	private:
+
+		/** Time the PID has been settled for. In microseconds. */
+		uint32_t _settledUs = 0;
+
+		/** Time since the last learning step. In microseconds. */
+		uint32_t _sinceLearnUs = 0;
+};
+
+#endif
@@ -10,6 +10,9 @@
 #include "gpioAlloc.hpp"
 #include "BoostControl.hpp"
 #include "BoostOptions.hpp"
+#include "ControlLoopTimer.hpp"
+#include "SerialConsole.hpp"
+#include "TelemetryStream.hpp"
 
 /** The ADC channel used to get VSYS voltage. */
 #define VSYS_REF_CHANNEL 3
@@ -27,8 +30,17 @@ bool debug = false;
 /** Single boost control instance, instantiated on core 1. */
 BoostControl* boostControl = 0;
 
+/** Timer that drives the boost control loop, instantiated on core 1. */
+ControlLoopTimer* controlLoopTimer = 0;
+
 BoostOptions* boostOptions = 0;
 
+/** Binary telemetry over USB serial, on core 0. */
+TelemetryStream* telemetryStream = 0;
+
+/** Command console over USB serial, on core 0. */
+SerialConsole* serialConsole = 0;
+
 void __core1_entry();
 
 /**
@@ -94,6 +106,10 @@ int main()
 
 	boostOptions = new BoostOptions(boostControl);
 
+	telemetryStream = new TelemetryStream(boostControl);
+
+	serialConsole = new SerialConsole(boostControl, boostOptions, telemetryStream);
+
 	lastonBoardLedToggleTime = get_absolute_time();
 
 	// Main processing loop. Used for user interaction.
@@ -108,6 +124,10 @@ int main()
 		}
 
 		boostOptions -> poll();
+
+		telemetryStream -> poll();
+
+		serialConsole -> poll();
 	}
 }
 
@@ -115,8 +135,16 @@ void __core1_entry()
 {
 	boostControl = new BoostControl();
 
-	while(1)
+	if(debug)
 	{
-		boostControl -> poll();
+		// Timer interrupts get in the way of stepping through code so just poll.
+		while(1)
+		{
+			boostControl -> poll();
+		}
 	}
+
+	// Latch and control from timer interrupts. Core 1 sleeps in between. This doesn't return.
+	controlLoopTimer = new ControlLoopTimer(boostControl, CONTROL_LATCH_PERIOD_US, CONTROL_LATCHES_PER_STEP);
+	controlLoopTimer -> run();
 }